@@ -58,6 +58,9 @@
 #define CONFDB_SERVICE_DEBUG_TIMESTAMPS "debug_timestamps"
 #define CONFDB_SERVICE_DEBUG_MICROSECONDS "debug_microseconds"
 #define CONFDB_SERVICE_DEBUG_BACKTRACE_ENABLED "debug_backtrace_enabled"
+#define CONFDB_SERVICE_DEBUG_TRACE_SPANS "debug_trace_spans"
+#define CONFDB_SERVICE_DEBUG_SYSDB_QUERY_TRACE "debug_sysdb_query_trace"
+#define CONFDB_SERVICE_EVENT_LOOP_THRESHOLD "event_loop_threshold"
 #define CONFDB_SERVICE_RECON_RETRIES "reconnection_retries"
 #define CONFDB_SERVICE_FD_LIMIT "fd_limit"
 #define CONFDB_SERVICE_ALLOWED_UIDS "allowed_uids"
@@ -97,6 +100,7 @@
 #define CONFDB_RESPONDER_IDLE_TIMEOUT "responder_idle_timeout"
 #define CONFDB_RESPONDER_IDLE_DEFAULT_TIMEOUT 300
 #define CONFDB_RESPONDER_CACHE_FIRST "cache_first"
+#define CONFDB_RESPONDER_PARALLEL_DOMAIN_LOOKUP "parallel_domain_lookup"
 #ifdef BUILD_FILES_PROVIDER
 /* There is a subtile issue with this option when 'files' + another domain is enabled */
 #define CONFDB_RESPONDER_CACHE_FIRST_DEFAILT false
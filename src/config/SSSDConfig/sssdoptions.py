@@ -22,6 +22,9 @@ class SSSDOptions(object):
         'debug_timestamps': _('Include timestamps in debug logs'),
         'debug_microseconds': _('Include microseconds in timestamps in debug logs'),
         'debug_backtrace_enabled': _('Enable/disable debug backtrace'),
+        'debug_trace_spans': _('Record request trace spans'),
+        'debug_sysdb_query_trace': _('Log unindexed and slow cache searches'),
+        'event_loop_threshold': _('Log event handlers blocking the event loop for longer than this many milliseconds'),
         'timeout': _('Watchdog timeout before restarting service'),
         'command': _('Command to start service'),
         'reconnection_retries': _('Number of times to attempt connection to Data Providers'),
@@ -29,6 +32,7 @@ class SSSDOptions(object):
         'client_idle_timeout': _('Idle time before automatic disconnection of a client'),
         'responder_idle_timeout': _('Idle time before automatic shutdown of the responder'),
         'cache_first': _('Always query all the caches before querying the Data Providers'),
+        'parallel_domain_lookup': _('Query all candidate domains at once for lookups without a domain name'),
         'offline_timeout': _('When SSSD switches to offline mode the amount of time before it tries to go back online '
                              'will increase based upon the time spent disconnected. This value is in seconds and '
                              'calculated by the following: offline_timeout + random_offset.'),
@@ -403,6 +407,7 @@ class SSSDOptions(object):
         # [provider/ldap/id]
         'ldap_search_timeout': _('Length of time to wait for a search request'),
         'ldap_enumeration_search_timeout': _('Length of time to wait for a enumeration request'),
+        'ldap_enumeration_max_searches': _('Maximum number of enumeration searches running at the same time'),
         'ldap_enumeration_refresh_timeout': _('Length of time between enumeration updates'),
         'ldap_enumeration_refresh_offset': _('Maximum period deviation between enumeration updates'),
         'ldap_purge_cache_timeout': _('Length of time between cache cleanups'),
@@ -492,6 +497,7 @@ class SSSDOptions(object):
         'ldap_min_id': _('Set lower boundary for allowed IDs from the LDAP server'),
         'ldap_max_id': _('Set upper boundary for allowed IDs from the LDAP server'),
         'ldap_pwdlockout_dn': _('DN for ppolicy queries'),
+        'ldap_pwdlockout_cache_timeout': _('How long the pwdLockout setting of the password policy is cached'),
         'wildcard_limit': _('How many maximum entries to fetch during a wildcard request'),
         'ldap_library_debug_level': _('Set libldap debug level'),
 
@@ -500,6 +506,7 @@ class SSSDOptions(object):
 
         # [provider/ldap/access]
         'ldap_access_filter': _('LDAP filter to determine access privileges'),
+        'ldap_access_filter_local': _('Evaluate the access filter against fresh cached entries when possible'),
         'ldap_account_expire_policy': _('Which attributes shall be used to evaluate if an account is expired'),
         'ldap_access_order': _('Which rules should be used to evaluate access control'),
 
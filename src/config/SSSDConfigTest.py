@@ -337,12 +337,16 @@ class SSSDConfigTestSSSDService(unittest.TestCase):
             'debug_timestamps',
             'debug_microseconds',
             'debug_backtrace_enabled',
+            'debug_trace_spans',
+            'debug_sysdb_query_trace',
+            'event_loop_threshold',
             'command',
             'reconnection_retries',
             'fd_limit',
             'client_idle_timeout',
             'responder_idle_timeout',
             'cache_first',
+            'parallel_domain_lookup',
             'description',
             'certificate_verification',
             'override_space',
@@ -538,6 +538,57 @@ int sysdb_attrs_add_val(struct sysdb_attrs *attrs,
     return sysdb_attrs_add_val_int(attrs, name, false, val);
 }
 
+int sysdb_attrs_add_vals(struct sysdb_attrs *attrs, const char *name,
+                         const struct ldb_val *vals, size_t num)
+{
+    struct ldb_message_element *el = NULL;
+    struct ldb_val *new_vals;
+    uint8_t *buf;
+    size_t size = 0;
+    size_t i;
+    int ret;
+
+    if (num == 0) {
+        return EOK;
+    }
+
+    ret = sysdb_attrs_get_el(attrs, name, &el);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    for (i = 0; i < num; i++) {
+        size += vals[i].length + 1;
+    }
+
+    new_vals = talloc_realloc(attrs->a, el->values,
+                              struct ldb_val, el->num_values + num);
+    if (new_vals == NULL) {
+        return ENOMEM;
+    }
+    el->values = new_vals;
+
+    /* All values share one buffer, each of them NULL-terminated like the
+     * ones created by ldb_val_dup() */
+    buf = talloc_size(new_vals, size);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num; i++) {
+        memcpy(buf, vals[i].data, vals[i].length);
+        buf[vals[i].length] = '\0';
+
+        new_vals[el->num_values].data = buf;
+        new_vals[el->num_values].length = vals[i].length;
+        el->num_values++;
+
+        buf += vals[i].length + 1;
+    }
+
+    return EOK;
+}
+
 /* Check if the same value already exists. */
 int sysdb_attrs_add_val_safe(struct sysdb_attrs *attrs,
                              const char *name, const struct ldb_val *val)
@@ -877,6 +928,492 @@ char *sysdb_group_strdn(TALLOC_CTX *mem_ctx,
     return build_dom_dn_str_escape(mem_ctx, SYSDB_TMPL_GROUP, domain, name);
 }
 
+/* =Lookup-Cache========================================================== */
+
+/* Backend requests which save many objects in one transaction look up the
+ * same users and groups over and over again, e.g. every member group during
+ * nested group processing or every group sdap_add_incomplete_groups() checks
+ * for existence. Inside a transaction the results of lookups of a single
+ * user or group by DN, name or ID are therefore kept until the outermost
+ * transaction ends.
+ *
+ * The entries are keyed by their DN. A lookup by name or ID maps its base DN
+ * and filter to the DN of the entry it found, or remembers that nothing was
+ * found. Writes to a user or group entry drop the entry with that DN, which
+ * also makes all name and ID lookups mapped to it miss. Writes which can
+ * make a missing entry appear, i.e. adds and changes of the attributes the
+ * lookups search by, additionally drop all negative results.
+ *
+ * The memberof plugin changes the member, memberOf, ghost and memberUid
+ * attributes of entries other than the one being written. Lookups which
+ * request any of those attributes, or all attributes, are never cached, so
+ * dropping the written DN is always enough. */
+
+#define SYSDB_LOOKUP_CACHE_MAX_ENTRIES 4096
+
+struct sysdb_lookup_cache {
+    /* casefolded DN -> struct sysdb_lookup_cache_entry */
+    hash_table_t *entries;
+    /* base DN and filter of a lookup -> struct sysdb_lookup_cache_key */
+    hash_table_t *keys;
+    /* DN or base DN and filter of the lookups which found nothing */
+    hash_table_t *missing;
+    uint64_t generation;
+};
+
+struct sysdb_lookup_cache_entry {
+    uint64_t generation;
+    const char **attrs;
+    struct ldb_message *msg;
+};
+
+struct sysdb_lookup_cache_key {
+    /* a key only refers to the entry it was added with, not to an entry
+     * cached again for the same DN after a write */
+    uint64_t generation;
+    char *dn;
+};
+
+static bool sysdb_lookup_cache_attrs_ok(const char **attrs)
+{
+    static const char *plugin_attrs[] = { SYSDB_MEMBER, SYSDB_MEMBEROF,
+                                          SYSDB_GHOST, SYSDB_MEMBERUID,
+                                          NULL };
+    size_t i;
+
+    if (attrs == NULL) {
+        return false;
+    }
+
+    for (i = 0; attrs[i] != NULL; i++) {
+        if (strcmp(attrs[i], "*") == 0
+                || string_in_list(attrs[i], discard_const(plugin_attrs),
+                                  false)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Only user and group entries are cached, all their writes are done by the
+ * sysdb write functions which call sysdb_lookup_cache_invalidate() */
+static bool sysdb_lookup_cache_dn_ok(struct ldb_dn *dn)
+{
+    const struct ldb_val *val;
+    const char *name;
+
+    if (ldb_dn_get_comp_num(dn) != 4) {
+        return false;
+    }
+
+    name = ldb_dn_get_component_name(dn, 1);
+    val = ldb_dn_get_component_val(dn, 1);
+    if (name == NULL || val == NULL || strcasecmp(name, "cn") != 0) {
+        return false;
+    }
+
+    return (val->length == 5 && strncasecmp((const char *) val->data,
+                                            "users", 5) == 0)
+            || (val->length == 6 && strncasecmp((const char *) val->data,
+                                               "groups", 6) == 0);
+}
+
+static char *sysdb_lookup_cache_dn_key(TALLOC_CTX *mem_ctx,
+                                       struct ldb_dn *dn)
+{
+    const char *casefold;
+
+    casefold = ldb_dn_get_casefold(dn);
+    if (casefold == NULL) {
+        return NULL;
+    }
+
+    return talloc_strdup(mem_ctx, casefold);
+}
+
+static char *sysdb_lookup_cache_search_key(TALLOC_CTX *mem_ctx,
+                                           struct ldb_dn *base_dn,
+                                           const char *filter)
+{
+    const char *casefold;
+
+    casefold = ldb_dn_get_casefold(base_dn);
+    if (casefold == NULL) {
+        return NULL;
+    }
+
+    if (filter == NULL) {
+        return talloc_asprintf(mem_ctx, "dn:%s", casefold);
+    }
+
+    return talloc_asprintf(mem_ctx, "search:%s:%s", casefold, filter);
+}
+
+static bool sysdb_lookup_cache_has_attrs(struct sysdb_lookup_cache_entry *entry,
+                                         const char **attrs)
+{
+    size_t i;
+
+    for (i = 0; attrs[i] != NULL; i++) {
+        if (!string_in_list(attrs[i], discard_const(entry->attrs), false)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Returns a copy of the cached entry with the requested attributes only */
+static struct ldb_message *
+sysdb_lookup_cache_copy(TALLOC_CTX *mem_ctx,
+                        struct sysdb_lookup_cache_entry *entry,
+                        const char **attrs)
+{
+    struct ldb_message *msg;
+    unsigned int i;
+
+    msg = ldb_msg_copy(mem_ctx, entry->msg);
+    if (msg == NULL) {
+        return NULL;
+    }
+
+    for (i = msg->num_elements; i > 0; i--) {
+        if (!string_in_list(msg->elements[i - 1].name, discard_const(attrs),
+                            false)) {
+            ldb_msg_remove_element(msg, &msg->elements[i - 1]);
+        }
+    }
+
+    return msg;
+}
+
+static void *sysdb_lookup_cache_find(hash_table_t *table, const char *str)
+{
+    hash_key_t key;
+    hash_value_t value;
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    if (hash_lookup(table, &key, &value) != HASH_SUCCESS) {
+        return NULL;
+    }
+
+    return value.ptr;
+}
+
+static void sysdb_lookup_cache_remove(hash_table_t *table, const char *str)
+{
+    hash_key_t key;
+    hash_value_t value;
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+
+    if (hash_lookup(table, &key, &value) != HASH_SUCCESS) {
+        return;
+    }
+
+    hash_delete(table, &key);
+    talloc_free(value.ptr);
+}
+
+static errno_t sysdb_lookup_cache_enter(hash_table_t *table,
+                                        const char *str,
+                                        void *ptr)
+{
+    hash_key_t key;
+    hash_value_t value;
+    int hret;
+
+    sysdb_lookup_cache_remove(table, str);
+
+    key.type = HASH_KEY_STRING;
+    key.str = discard_const(str);
+    value.type = HASH_VALUE_PTR;
+    value.ptr = ptr;
+
+    hret = hash_enter(table, &key, &value);
+    if (hret != HASH_SUCCESS) {
+        return EIO;
+    }
+
+    return EOK;
+}
+
+static void sysdb_lookup_cache_drop(struct sysdb_ctx *sysdb)
+{
+    if (sysdb->lookup_cache == NULL) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_ALL, "Lookup cache: %"PRIu64" hits, %"PRIu64" misses, "
+          "%"PRIu64" invalidations\n", sysdb->lookup_stats.hits,
+          sysdb->lookup_stats.misses, sysdb->lookup_stats.invalidations);
+
+    talloc_zfree(sysdb->lookup_cache);
+}
+
+static struct sysdb_lookup_cache *
+sysdb_lookup_cache_create(struct sysdb_ctx *sysdb)
+{
+    struct sysdb_lookup_cache *cache;
+    errno_t ret;
+
+    cache = talloc_zero(sysdb, struct sysdb_lookup_cache);
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    ret = sss_hash_create(cache, 0, &cache->entries);
+    if (ret == EOK) {
+        ret = sss_hash_create(cache, 0, &cache->keys);
+    }
+    if (ret == EOK) {
+        ret = sss_hash_create(cache, 0, &cache->missing);
+    }
+    if (ret != EOK) {
+        talloc_free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+errno_t sysdb_lookup_cache_get(TALLOC_CTX *mem_ctx,
+                               struct sysdb_ctx *sysdb,
+                               struct ldb_dn *base_dn,
+                               const char *filter,
+                               const char **attrs,
+                               struct ldb_message **_msg)
+{
+    struct sysdb_lookup_cache *cache = sysdb->lookup_cache;
+    struct sysdb_lookup_cache_entry *entry;
+    struct sysdb_lookup_cache_key *key = NULL;
+    struct ldb_message *msg;
+    char *search_key;
+    char *dn_key;
+    bool missing;
+
+    if (cache == NULL || sysdb->transaction_nesting == 0
+            || !sysdb_lookup_cache_attrs_ok(attrs)
+            || (filter == NULL && !sysdb_lookup_cache_dn_ok(base_dn))) {
+        return ENOENT;
+    }
+
+    search_key = sysdb_lookup_cache_search_key(NULL, base_dn, filter);
+    if (search_key == NULL) {
+        return ENOENT;
+    }
+
+    missing = sysdb_lookup_cache_find(cache->missing, search_key) != NULL;
+    if (missing) {
+        talloc_free(search_key);
+        sysdb->lookup_stats.hits++;
+        *_msg = NULL;
+        return EOK;
+    }
+
+    if (filter == NULL) {
+        dn_key = sysdb_lookup_cache_dn_key(search_key, base_dn);
+    } else {
+        key = sysdb_lookup_cache_find(cache->keys, search_key);
+        dn_key = key != NULL ? key->dn : NULL;
+    }
+
+    entry = NULL;
+    if (dn_key != NULL) {
+        entry = sysdb_lookup_cache_find(cache->entries, dn_key);
+    }
+    talloc_free(search_key);
+
+    if (entry == NULL
+            || (key != NULL && key->generation != entry->generation)
+            || !sysdb_lookup_cache_has_attrs(entry, attrs)) {
+        sysdb->lookup_stats.misses++;
+        return ENOENT;
+    }
+
+    msg = sysdb_lookup_cache_copy(mem_ctx, entry, attrs);
+    if (msg == NULL) {
+        return ENOENT;
+    }
+
+    sysdb->lookup_stats.hits++;
+    *_msg = msg;
+    return EOK;
+}
+
+void sysdb_lookup_cache_put(struct sysdb_ctx *sysdb,
+                            struct ldb_dn *base_dn,
+                            const char *filter,
+                            const char **attrs,
+                            struct ldb_message *msg)
+{
+    struct sysdb_lookup_cache *cache;
+    struct sysdb_lookup_cache_entry *entry;
+    struct sysdb_lookup_cache_entry *new_entry;
+    struct sysdb_lookup_cache_key *key;
+    char *search_key;
+    char *dn_key;
+    errno_t ret;
+
+    if (sysdb->transaction_nesting == 0
+            || !sysdb_lookup_cache_attrs_ok(attrs)
+            || (filter == NULL && !sysdb_lookup_cache_dn_ok(base_dn))
+            || (msg != NULL && !sysdb_lookup_cache_dn_ok(msg->dn))) {
+        return;
+    }
+
+    if (sysdb->lookup_cache == NULL) {
+        sysdb->lookup_cache = sysdb_lookup_cache_create(sysdb);
+        if (sysdb->lookup_cache == NULL) {
+            return;
+        }
+    }
+    cache = sysdb->lookup_cache;
+
+    if (hash_count(cache->entries) + hash_count(cache->keys)
+            + hash_count(cache->missing) >= SYSDB_LOOKUP_CACHE_MAX_ENTRIES) {
+        return;
+    }
+
+    if (msg == NULL) {
+        search_key = sysdb_lookup_cache_search_key(cache->missing, base_dn,
+                                                   filter);
+        if (search_key == NULL) {
+            return;
+        }
+
+        ret = sysdb_lookup_cache_enter(cache->missing, search_key, search_key);
+        if (ret != EOK) {
+            talloc_free(search_key);
+        }
+        return;
+    }
+
+    dn_key = sysdb_lookup_cache_dn_key(cache, msg->dn);
+    if (dn_key == NULL) {
+        return;
+    }
+
+    entry = sysdb_lookup_cache_find(cache->entries, dn_key);
+    if (entry == NULL || !sysdb_lookup_cache_has_attrs(entry, attrs)) {
+        new_entry = talloc_zero(cache->entries,
+                                struct sysdb_lookup_cache_entry);
+        if (new_entry == NULL) {
+            talloc_free(dn_key);
+            return;
+        }
+
+        new_entry->attrs = dup_string_list(new_entry, attrs);
+        new_entry->msg = ldb_msg_copy(new_entry, msg);
+        if (new_entry->attrs == NULL || new_entry->msg == NULL) {
+            talloc_free(new_entry);
+            talloc_free(dn_key);
+            return;
+        }
+
+        /* An entry which is read again with other attributes was not
+         * written in the meantime, the keys of the previous one still
+         * refer to it */
+        new_entry->generation = entry != NULL ? entry->generation
+                                              : ++cache->generation;
+
+        ret = sysdb_lookup_cache_enter(cache->entries, dn_key, new_entry);
+        if (ret != EOK) {
+            talloc_free(new_entry);
+            talloc_free(dn_key);
+            return;
+        }
+        entry = new_entry;
+    }
+
+    if (filter == NULL) {
+        talloc_free(dn_key);
+        return;
+    }
+
+    key = talloc_zero(cache->keys, struct sysdb_lookup_cache_key);
+    if (key == NULL) {
+        talloc_free(dn_key);
+        return;
+    }
+
+    key->generation = entry->generation;
+    key->dn = talloc_steal(key, dn_key);
+    search_key = sysdb_lookup_cache_search_key(key, base_dn, filter);
+    if (search_key == NULL) {
+        talloc_free(key);
+        return;
+    }
+
+    ret = sysdb_lookup_cache_enter(cache->keys, search_key, key);
+    if (ret != EOK) {
+        talloc_free(key);
+    }
+}
+
+void sysdb_lookup_cache_invalidate(struct sysdb_ctx *sysdb,
+                                   struct ldb_dn *dn,
+                                   unsigned int num_elements,
+                                   struct ldb_message_element *elements)
+{
+    /* attributes the cached name and ID lookups search by */
+    static const char *key_attrs[] = { SYSDB_NAME, SYSDB_NAME_ALIAS,
+                                       SYSDB_UIDNUM, SYSDB_GIDNUM,
+                                       ORIGINALAD_PREFIX SYSDB_GIDNUM,
+                                       SYSDB_OBJECTCATEGORY, NULL };
+    struct sysdb_lookup_cache *cache = sysdb->lookup_cache;
+    struct sysdb_lookup_cache_entry *entry;
+    char *dn_key;
+    unsigned int i;
+    errno_t ret;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    dn_key = sysdb_lookup_cache_dn_key(NULL, dn);
+    if (dn_key == NULL) {
+        /* cannot tell which entry is affected */
+        sysdb->lookup_stats.invalidations++;
+        sysdb_lookup_cache_drop(sysdb);
+        return;
+    }
+
+    entry = sysdb_lookup_cache_find(cache->entries, dn_key);
+    if (entry != NULL) {
+        sysdb_lookup_cache_remove(cache->entries, dn_key);
+        sysdb->lookup_stats.invalidations++;
+    }
+    talloc_free(dn_key);
+
+    for (i = 0; i < num_elements; i++) {
+        if (string_in_list(elements[i].name, discard_const(key_attrs),
+                           false)) {
+            break;
+        }
+    }
+
+    if (i == num_elements || hash_count(cache->missing) == 0) {
+        return;
+    }
+
+    talloc_zfree(cache->missing);
+    ret = sss_hash_create(cache, 0, &cache->missing);
+    if (ret != EOK) {
+        sysdb_lookup_cache_drop(sysdb);
+    }
+}
+
+void sysdb_get_lookup_cache_stats(struct sysdb_ctx *sysdb,
+                                  struct sysdb_lookup_cache_stats *_stats)
+{
+    *_stats = sysdb->lookup_stats;
+}
+
 /* =Transactions========================================================== */
 
 int sysdb_transaction_start(struct sysdb_ctx *sysdb)
@@ -905,6 +1442,9 @@ int sysdb_transaction_commit(struct sysdb_ctx *sysdb)
     ret = ldb_transaction_commit(sysdb->ldb);
     if (ret == LDB_SUCCESS) {
         sysdb->transaction_nesting--;
+        if (sysdb->transaction_nesting == 0) {
+            sysdb_lookup_cache_drop(sysdb);
+        }
         PROBE(SYSDB_TRANSACTION_COMMIT_AFTER, sysdb->transaction_nesting);
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -920,6 +1460,8 @@ int sysdb_transaction_cancel(struct sysdb_ctx *sysdb)
     ret = ldb_transaction_cancel(sysdb->ldb);
     if (ret == LDB_SUCCESS) {
         sysdb->transaction_nesting--;
+        /* the cancelled writes may have been cached already */
+        sysdb_lookup_cache_drop(sysdb);
         PROBE(SYSDB_TRANSACTION_CANCEL, sysdb->transaction_nesting);
     } else {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -1404,6 +1946,141 @@ done:
     return ret;
 }
 
+/* The cursor is stored as "<usn>:<server_id>". The USN is numeric, so the
+ * first colon always separates the two parts. */
+errno_t sysdb_get_enum_cursor(TALLOC_CTX *mem_ctx,
+                              struct sss_domain_info *domain,
+                              const char *cursor_name,
+                              const char *server_id,
+                              char **_usn)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_dn *dn;
+    struct ldb_result *res;
+    const char *attrs[] = { cursor_name, NULL };
+    const char *value;
+    const char *sep;
+    errno_t ret;
+    int lret;
+
+    if (cursor_name == NULL || _usn == NULL) {
+        return EINVAL;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    dn = sysdb_domain_dn(tmp_ctx, domain);
+    if (dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    lret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, dn, LDB_SCOPE_BASE,
+                      attrs, NULL);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    if (res->count != 1) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    value = ldb_msg_find_attr_as_string(res->msgs[0], cursor_name, NULL);
+    if (value == NULL) {
+        ret = ENOENT;
+        goto done;
+    }
+
+    sep = strchr(value, ':');
+    if (sep == NULL || sep == value) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Malformed enumeration cursor [%s], ignoring\n", value);
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (server_id != NULL && strcmp(sep + 1, server_id) != 0) {
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Enumeration cursor %s belongs to server [%s], not [%s]\n",
+              cursor_name, sep + 1, server_id);
+        ret = ENOENT;
+        goto done;
+    }
+
+    *_usn = talloc_strndup(mem_ctx, value, sep - value);
+    if (*_usn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+errno_t sysdb_set_enum_cursor(struct sss_domain_info *domain,
+                              const char *cursor_name,
+                              const char *server_id,
+                              const char *usn)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_message *msg;
+    errno_t ret;
+    int lret;
+
+    if (cursor_name == NULL || server_id == NULL || usn == NULL) {
+        return EINVAL;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    msg = ldb_msg_new(tmp_ctx);
+    if (msg == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    msg->dn = sysdb_domain_dn(msg, domain);
+    if (msg->dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    lret = ldb_msg_add_empty(msg, cursor_name, LDB_FLAG_MOD_REPLACE, NULL);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    lret = ldb_msg_add_fmt(msg, cursor_name, "%s:%s", usn, server_id);
+    if (lret != LDB_SUCCESS) {
+        ret = sysdb_error_to_errno(lret);
+        goto done;
+    }
+
+    lret = ldb_modify(domain->sysdb->ldb, msg);
+    if (lret != LDB_SUCCESS) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Failed to save enumeration cursor: [%s](%d)[%s]\n",
+              ldb_strerror(lret), lret, ldb_errstring(domain->sysdb->ldb));
+    }
+    ret = sysdb_error_to_errno(lret);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 /*
  * An entity with multiple names would have multiple SYSDB_NAME attributes
  * after being translated into sysdb names using a map.
@@ -1930,6 +2607,93 @@ done:
     return differs;
 }
 
+/* =Query-Trace=========================================================== */
+
+/* The query trace is enabled by the debug_sysdb_query_trace option, its
+ * value is the time in milliseconds above which indexed searches are logged
+ * as well. Unindexed searches are always logged. */
+static bool sysdb_trace_enabled;
+static uint32_t sysdb_trace_threshold;
+static uint64_t sysdb_trace_full_searches;
+
+/* Prefix of the message the ldb key-value backends log for searches which
+ * cannot use an index if LDB_WARN_UNINDEXED is set */
+#define LDB_FULL_SEARCH_MSG "ldb FULL SEARCH"
+
+void sysdb_query_trace_enable(uint32_t threshold_ms)
+{
+    /* must be set before the ldb backend is connected */
+    if (setenv("LDB_WARN_UNINDEXED", "1", 0) != 0) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot enable warnings about unindexed searches\n");
+    }
+
+    sysdb_trace_threshold = threshold_ms;
+    sysdb_trace_enabled = true;
+    DEBUG(SSSDBG_CONF_SETTINGS, "sysdb query trace enabled, logging "
+          "unindexed searches and searches slower than %"PRIu32" ms\n",
+          sysdb_trace_threshold);
+}
+
+int sysdb_ldb_search(struct ldb_context *ldb,
+                     TALLOC_CTX *mem_ctx,
+                     struct ldb_result **_res,
+                     struct ldb_dn *base,
+                     enum ldb_scope scope,
+                     const char * const *attrs,
+                     const char *exp_fmt, ...)
+{
+    va_list ap;
+    char *expression = NULL;
+    struct timespec start;
+    struct timespec end;
+    uint64_t full_searches;
+    uint64_t usec;
+    bool unindexed;
+    int ret;
+
+    if (exp_fmt != NULL) {
+        va_start(ap, exp_fmt);
+        expression = talloc_vasprintf(mem_ctx, exp_fmt, ap);
+        va_end(ap);
+        if (expression == NULL) {
+            return LDB_ERR_OPERATIONS_ERROR;
+        }
+    }
+
+    if (!sysdb_trace_enabled) {
+        ret = ldb_search(ldb, mem_ctx, _res, base, scope, attrs,
+                         expression != NULL ? "%s" : NULL, expression);
+        talloc_free(expression);
+        return ret;
+    }
+
+    full_searches = sysdb_trace_full_searches;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    ret = ldb_search(ldb, mem_ctx, _res, base, scope, attrs,
+                     expression != NULL ? "%s" : NULL, expression);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    usec = (end.tv_sec - start.tv_sec) * 1000000
+           + (end.tv_nsec - start.tv_nsec) / 1000;
+    unindexed = (sysdb_trace_full_searches != full_searches);
+
+    if (unindexed || usec >= (uint64_t) sysdb_trace_threshold * 1000) {
+        DEBUG(unindexed ? SSSDBG_OP_FAILURE : SSSDBG_TRACE_FUNC,
+              "%s search [%s] base [%s] scope [%d] returned %u entries "
+              "in %"PRIu64".%03"PRIu64" ms\n",
+              unindexed ? "Unindexed" : "Slow",
+              expression != NULL ? expression : "(none)",
+              base != NULL ? ldb_dn_get_linearized(base) : "(root)",
+              scope, (ret == LDB_SUCCESS) ? (*_res)->count : 0,
+              usec / 1000, usec % 1000);
+    }
+
+    talloc_free(expression);
+    return ret;
+}
+
 void ldb_debug_messages(void *context, enum ldb_debug_level level,
                         const char *fmt, va_list ap)
 {
@@ -1950,6 +2714,14 @@ void ldb_debug_messages(void *context, enum ldb_debug_level level,
         break;
     }
 
+    if (sysdb_trace_enabled
+            && strncmp(fmt, LDB_FULL_SEARCH_MSG,
+                       sizeof(LDB_FULL_SEARCH_MSG) - 1) == 0) {
+        /* reported with the timing by sysdb_ldb_search() */
+        sysdb_trace_full_searches++;
+        loglevel = SSSDBG_TRACE_FUNC;
+    }
+
     sss_vdebug_fn(__FILE__, __LINE__, "ldb", loglevel, APPEND_LINE_FEED,
                   fmt, ap);
 }
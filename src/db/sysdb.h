@@ -253,6 +253,10 @@
 #define SYSDB_HAS_ENUMERATED_ID       0x00000001
 #define SYSDB_HAS_ENUMERATED_RESOLVER 0x00000002
 
+#define SYSDB_ENUM_USER_CURSOR "enumUserCursor"
+#define SYSDB_ENUM_GROUP_CURSOR "enumGroupCursor"
+#define SYSDB_ENUM_SERVICE_CURSOR "enumServiceCursor"
+
 #define SYSDB_DEFAULT_ATTRS SYSDB_LAST_UPDATE, \
                             SYSDB_CACHE_EXPIRE, \
                             SYSDB_INITGR_EXPIRE, \
@@ -407,6 +411,11 @@ int sysdb_attrs_add_val(struct sysdb_attrs *attrs,
                         const char *name, const struct ldb_val *val);
 int sysdb_attrs_add_val_safe(struct sysdb_attrs *attrs,
                              const char *name, const struct ldb_val *val);
+/* adds num values at once, the values array is grown only once and the
+ * values are copied into a single buffer, so they must not be freed or
+ * stolen one by one */
+int sysdb_attrs_add_vals(struct sysdb_attrs *attrs, const char *name,
+                         const struct ldb_val *vals, size_t num);
 int sysdb_attrs_add_string_safe(struct sysdb_attrs *attrs,
                                 const char *name, const char *str);
 int sysdb_attrs_add_string(struct sysdb_attrs *attrs,
@@ -525,6 +534,31 @@ int sysdb_transaction_start(struct sysdb_ctx *sysdb);
 int sysdb_transaction_commit(struct sysdb_ctx *sysdb);
 int sysdb_transaction_cancel(struct sysdb_ctx *sysdb);
 
+/* Lookups of a single user or group by DN, name or ID are cached inside a
+ * transaction. These counters are kept for the lifetime of the sysdb
+ * context. */
+struct sysdb_lookup_cache_stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+};
+
+void sysdb_get_lookup_cache_stats(struct sysdb_ctx *sysdb,
+                                  struct sysdb_lookup_cache_stats *_stats);
+
+/* Drops the cached lookups of the entry dn. The elements are the attributes
+ * written to it, if any of them is a name or ID the results of lookups which
+ * found nothing are dropped as well. The sysdb write functions call it, only
+ * code which writes user or group entries with ldb directly has to. */
+void sysdb_lookup_cache_invalidate(struct sysdb_ctx *sysdb,
+                                   struct ldb_dn *dn,
+                                   unsigned int num_elements,
+                                   struct ldb_message_element *elements);
+
+/* Logs the searches which cannot use an index and the searches which take
+ * longer than threshold_ms. Must be called before the sysdb is opened. */
+void sysdb_query_trace_enable(uint32_t threshold_ms);
+
 /* functions related to subdomains */
 errno_t sysdb_domain_create(struct sysdb_ctx *sysdb, const char *domain_name);
 
@@ -1385,6 +1419,22 @@ errno_t sysdb_set_enumerated(struct sss_domain_info *domain,
                              uint32_t provider,
                              bool has_enumerated);
 
+/* Enumeration cursors remember the highest USN downloaded for an object
+ * class together with the server it came from, so that an enumeration
+ * interrupted by a restart can continue where it stopped. ENOENT is
+ * returned if there is no cursor or if it was saved for another server.
+ * A NULL server_id matches any server. */
+errno_t sysdb_get_enum_cursor(TALLOC_CTX *mem_ctx,
+                              struct sss_domain_info *domain,
+                              const char *cursor_name,
+                              const char *server_id,
+                              char **_usn);
+
+errno_t sysdb_set_enum_cursor(struct sss_domain_info *domain,
+                              const char *cursor_name,
+                              const char *server_id,
+                              const char *usn);
+
 errno_t sysdb_remove_attrs(struct sss_domain_info *domain,
                            const char *name,
                            enum sysdb_member_type type,
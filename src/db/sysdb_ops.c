@@ -170,6 +170,8 @@ int sysdb_delete_entry(struct sysdb_ctx *sysdb,
     errno_t ret;
     errno_t tret;
 
+    sysdb_lookup_cache_invalidate(sysdb, dn, 0, NULL);
+
     ret = sysdb_delete_cache_entry(sysdb->ldb, dn, ignore_not_found);
     if (ret == EOK) {
         tret = sysdb_delete_ts_entry(sysdb, dn);
@@ -281,9 +283,9 @@ int sysdb_cache_search_entry(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(ldb, tmp_ctx, &res,
-                     base_dn, scope, attrs,
-                     filter?"%s":NULL, filter);
+    ret = sysdb_ldb_search(ldb, tmp_ctx, &res,
+                           base_dn, scope, attrs,
+                           filter?"%s":NULL, filter);
     if (ret != EOK) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -302,14 +304,14 @@ done:
     return ret;
 }
 
-int sysdb_search_entry(TALLOC_CTX *mem_ctx,
-                       struct sysdb_ctx *sysdb,
-                       struct ldb_dn *base_dn,
-                       enum ldb_scope scope,
-                       const char *filter,
-                       const char **attrs,
-                       size_t *_msgs_count,
-                       struct ldb_message ***_msgs)
+static int sysdb_search_entry_uncached(TALLOC_CTX *mem_ctx,
+                                       struct sysdb_ctx *sysdb,
+                                       struct ldb_dn *base_dn,
+                                       enum ldb_scope scope,
+                                       const char *filter,
+                                       const char **attrs,
+                                       size_t *_msgs_count,
+                                       struct ldb_message ***_msgs)
 {
     errno_t ret;
 
@@ -323,6 +325,73 @@ int sysdb_search_entry(TALLOC_CTX *mem_ctx,
                                          attrs);
 }
 
+/* Looks up a single user or group, either the entry base_dn itself if the
+ * filter is NULL or the entry below base_dn matching a filter on its name or
+ * ID. Inside a transaction the result is kept in the lookup cache. */
+static int sysdb_search_single_entry(TALLOC_CTX *mem_ctx,
+                                     struct sysdb_ctx *sysdb,
+                                     struct ldb_dn *base_dn,
+                                     const char *filter,
+                                     const char **attrs,
+                                     size_t *_msgs_count,
+                                     struct ldb_message ***_msgs)
+{
+    struct ldb_message **msgs;
+    struct ldb_message *msg;
+    errno_t ret;
+
+    ret = sysdb_lookup_cache_get(mem_ctx, sysdb, base_dn, filter, attrs,
+                                 &msg);
+    if (ret == EOK) {
+        if (msg == NULL) {
+            *_msgs_count = 0;
+            *_msgs = NULL;
+            return ENOENT;
+        }
+
+        msgs = talloc_zero_array(mem_ctx, struct ldb_message *, 2);
+        if (msgs == NULL) {
+            talloc_free(msg);
+            return ENOMEM;
+        }
+        msgs[0] = talloc_steal(msgs, msg);
+
+        *_msgs_count = 1;
+        *_msgs = msgs;
+        return EOK;
+    }
+
+    ret = sysdb_search_entry_uncached(mem_ctx, sysdb, base_dn,
+                                      filter == NULL ? LDB_SCOPE_BASE
+                                                     : LDB_SCOPE_SUBTREE,
+                                      filter, attrs, _msgs_count, _msgs);
+    if (ret == ENOENT) {
+        sysdb_lookup_cache_put(sysdb, base_dn, filter, attrs, NULL);
+    } else if (ret == EOK && *_msgs_count == 1) {
+        sysdb_lookup_cache_put(sysdb, base_dn, filter, attrs, (*_msgs)[0]);
+    }
+
+    return ret;
+}
+
+int sysdb_search_entry(TALLOC_CTX *mem_ctx,
+                       struct sysdb_ctx *sysdb,
+                       struct ldb_dn *base_dn,
+                       enum ldb_scope scope,
+                       const char *filter,
+                       const char **attrs,
+                       size_t *_msgs_count,
+                       struct ldb_message ***_msgs)
+{
+    if (scope == LDB_SCOPE_BASE && filter == NULL) {
+        return sysdb_search_single_entry(mem_ctx, sysdb, base_dn, NULL, attrs,
+                                         _msgs_count, _msgs);
+    }
+
+    return sysdb_search_entry_uncached(mem_ctx, sysdb, base_dn, scope, filter,
+                                       attrs, _msgs_count, _msgs);
+}
+
 int sysdb_search_ts_entry(TALLOC_CTX *mem_ctx,
                           struct sysdb_ctx *sysdb,
                           struct ldb_dn *base_dn,
@@ -534,9 +603,9 @@ static int sysdb_search_by_name(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, basedn, LDB_SCOPE_SUBTREE,
-                             filter, attrs?attrs:def_attrs,
-                             &msgs_count, &msgs);
+    ret = sysdb_search_single_entry(tmp_ctx, domain->sysdb, basedn, filter,
+                                    attrs?attrs:def_attrs,
+                                    &msgs_count, &msgs);
     if (ret) {
         goto done;
     }
@@ -603,9 +672,8 @@ int sysdb_search_user_by_uid(TALLOC_CTX *mem_ctx,
      * There is a bug in LDB that makes ONELEVEL searches extremely
      * slow (it ignores indexing)
      */
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, basedn,
-                             LDB_SCOPE_SUBTREE, filter,
-                             attrs?attrs:def_attrs, &msgs_count, &msgs);
+    ret = sysdb_search_single_entry(tmp_ctx, domain->sysdb, basedn, filter,
+                                    attrs?attrs:def_attrs, &msgs_count, &msgs);
     if (ret) {
         goto done;
     }
@@ -795,9 +863,9 @@ sysdb_search_group_by_id(TALLOC_CTX *mem_ctx,
      * There is a bug in LDB that makes ONELEVEL searches extremely
      * slow (it ignores indexing)
      */
-    ret = sysdb_search_entry(tmp_ctx, domain->sysdb, basedn, LDB_SCOPE_SUBTREE,
-                             filter, attrs?attrs:def_attrs,
-                             &msgs_count, &msgs);
+    ret = sysdb_search_single_entry(tmp_ctx, domain->sysdb, basedn, filter,
+                                    attrs?attrs:def_attrs,
+                                    &msgs_count, &msgs);
     if (ret) {
         goto done;
     }
@@ -1352,6 +1420,8 @@ int sysdb_set_entry_attr(struct sysdb_ctx *sysdb,
     errno_t tret = EOK;
     int state_mask = SSS_SYSDB_NO_CACHE;
 
+    sysdb_lookup_cache_invalidate(sysdb, entry_dn, attrs->num, attrs->a);
+
     sysdb_write = sysdb_entry_attrs_diff(sysdb, entry_dn, attrs, mod_op);
     if (sysdb_write == true) {
         ret = sysdb_set_cache_entry_attr(sysdb->ldb, entry_dn, attrs, mod_op);
@@ -1418,6 +1488,9 @@ static int sysdb_set_ts_entry_attr(struct sysdb_ctx *sysdb,
         return EOK;
     }
 
+    /* the timestamps are merged into the cached lookups */
+    sysdb_lookup_cache_invalidate(sysdb, entry_dn, 0, NULL);
+
     tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
         return ENOMEM;
@@ -1641,6 +1714,9 @@ int sysdb_add_basic_user(struct sss_domain_info *domain,
     ret = sysdb_add_ulong(msg, SYSDB_CREATE_TIME, (unsigned long)time(NULL));
     if (ret) goto done;
 
+    sysdb_lookup_cache_invalidate(domain->sysdb, msg->dn, msg->num_elements,
+                                  msg->elements);
+
     ret = ldb_add(domain->sysdb->ldb, msg);
     ret = sysdb_error_to_errno(ret);
 
@@ -1722,6 +1798,8 @@ sysdb_remove_ghost_from_group(struct sss_domain_info *dom,
         }
     }
 
+    sysdb_lookup_cache_invalidate(dom->sysdb, msg->dn, msg->num_elements,
+                                  msg->elements);
 
     ret = sss_ldb_modify_permissive(dom->sysdb->ldb, msg);
     if (ret != LDB_SUCCESS) {
@@ -2059,6 +2137,9 @@ int sysdb_add_basic_group(struct sss_domain_info *domain,
     ret = sysdb_add_ulong(msg, SYSDB_CREATE_TIME, (unsigned long)time(NULL));
     if (ret) goto done;
 
+    sysdb_lookup_cache_invalidate(domain->sysdb, msg->dn, msg->num_elements,
+                                  msg->elements);
+
     ret = ldb_add(domain->sysdb->ldb, msg);
     ret = sysdb_error_to_errno(ret);
 
@@ -2376,6 +2457,9 @@ int sysdb_mod_group_member(struct sss_domain_info *domain,
         ERROR_OUT(ret, EINVAL, fail);
     }
 
+    sysdb_lookup_cache_invalidate(domain->sysdb, msg->dn, msg->num_elements,
+                                  msg->elements);
+
     ret = ldb_modify(domain->sysdb->ldb, msg);
     if (ret != LDB_SUCCESS) {
         DEBUG(SSSDBG_MINOR_FAILURE,
@@ -3002,19 +3086,16 @@ static errno_t sysdb_store_group_attrs(struct sss_domain_info *domain,
 }
 
 /* =Add-User-to-Group(Native/Legacy)====================================== */
-static int
-sysdb_group_membership_mod(struct sss_domain_info *domain,
-                           const char *group,
-                           const char *member,
-                           enum sysdb_member_type type,
-                           int modify_op,
-                           bool is_dn)
+static errno_t
+sysdb_group_membership_member_dn(TALLOC_CTX *mem_ctx,
+                                 struct sss_domain_info *domain,
+                                 const char *member,
+                                 enum sysdb_member_type type,
+                                 struct ldb_dn **_member_dn)
 {
-    struct ldb_dn *group_dn;
     struct ldb_dn *member_dn;
     char *member_domname;
     struct sss_domain_info *member_dom;
-    struct sss_domain_info *group_dom;
     int ret;
     TALLOC_CTX *tmp_ctx = talloc_new(NULL);
     if (!tmp_ctx) {
@@ -3040,9 +3121,9 @@ sysdb_group_membership_mod(struct sss_domain_info *domain,
     }
 
     if (type == SYSDB_MEMBER_USER) {
-        member_dn = sysdb_user_dn(tmp_ctx, member_dom, member);
+        member_dn = sysdb_user_dn(mem_ctx, member_dom, member);
     } else if (type == SYSDB_MEMBER_GROUP) {
-        member_dn = sysdb_group_dn(tmp_ctx, member_dom, member);
+        member_dn = sysdb_group_dn(mem_ctx, member_dom, member);
     } else {
         ret = EINVAL;
         goto done;
@@ -3053,6 +3134,24 @@ sysdb_group_membership_mod(struct sss_domain_info *domain,
         goto done;
     }
 
+    *_member_dn = member_dn;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t
+sysdb_group_membership_group_dn(TALLOC_CTX *mem_ctx,
+                                struct sss_domain_info *domain,
+                                const char *group,
+                                bool is_dn,
+                                struct ldb_dn **_group_dn)
+{
+    struct ldb_dn *group_dn;
+    struct sss_domain_info *group_dom;
+
     if (!is_dn) {
         /* To create a correct DN we have to check if the group belongs to */
         /* child domain */
@@ -3061,16 +3160,46 @@ sysdb_group_membership_mod(struct sss_domain_info *domain,
             DEBUG(SSSDBG_OP_FAILURE,
                   "The right (sub)domain for the group [%s] was not found\n",
                   group);
-            ret = EINVAL;
-            goto done;
+            return EINVAL;
         }
-        group_dn = sysdb_group_dn(tmp_ctx, group_dom, group);
+        group_dn = sysdb_group_dn(mem_ctx, group_dom, group);
     } else {
-        group_dn = ldb_dn_new(tmp_ctx, domain->sysdb->ldb, group);
+        group_dn = ldb_dn_new(mem_ctx, domain->sysdb->ldb, group);
     }
 
     if (!group_dn) {
-        ret = ENOMEM;
+        return ENOMEM;
+    }
+
+    *_group_dn = group_dn;
+    return EOK;
+}
+
+static int
+sysdb_group_membership_mod(struct sss_domain_info *domain,
+                           const char *group,
+                           const char *member,
+                           enum sysdb_member_type type,
+                           int modify_op,
+                           bool is_dn)
+{
+    struct ldb_dn *group_dn;
+    struct ldb_dn *member_dn;
+    int ret;
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    if (!tmp_ctx) {
+        return ENOMEM;
+    }
+
+    ret = sysdb_group_membership_member_dn(tmp_ctx, domain, member, type,
+                                           &member_dn);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_group_membership_group_dn(tmp_ctx, domain, group, is_dn,
+                                          &group_dn);
+    if (ret != EOK) {
         goto done;
     }
 
@@ -3990,6 +4119,9 @@ int sysdb_delete_user(struct sss_domain_info *domain,
             ret = sysdb_delete_string(msg, SYSDB_GHOST, name);
             if (ret) goto fail;
 
+            sysdb_lookup_cache_invalidate(domain->sysdb, msg->dn,
+                                          msg->num_elements, msg->elements);
+
             ret = ldb_modify(domain->sysdb->ldb, msg);
             if (ret != LDB_SUCCESS) {
                 DEBUG(SSSDBG_MINOR_FAILURE,
@@ -4764,6 +4896,54 @@ done:
     return ret;
 }
 
+/* Adds or removes the member from each of the groups. The member DN is
+ * resolved only once, which matters for users with thousands of groups.
+ * The member attribute lives in the group entries, so there is still one
+ * ldb modify per group; the caller wraps them in a single transaction. */
+static void sysdb_update_members_mod(struct sss_domain_info *domain,
+                                     const char *member,
+                                     struct ldb_dn *member_dn,
+                                     const char *const *groups,
+                                     int mod_op,
+                                     bool is_dn)
+{
+    struct ldb_dn *group_dn;
+    errno_t ret;
+    int i;
+
+    for (i = 0; groups[i]; i++) {
+        ret = sysdb_group_membership_group_dn(NULL, domain, groups[i], is_dn,
+                                              &group_dn);
+        if (ret == EOK) {
+            ret = sysdb_mod_group_member(domain, member_dn, group_dn, mod_op);
+            talloc_free(group_dn);
+        }
+
+        if (mod_op == SYSDB_MOD_ADD) {
+            if (ret == EEXIST) {
+                DEBUG(SSSDBG_FUNC_DATA,
+                      "Group [%s] already has member [%s]. Skipping.\n",
+                      groups[i], member);
+            } else if (ret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "Could not add member [%s] to group [%s]. "
+                          "Skipping.\n", member, groups[i]);
+            }
+        } else {
+            if (ret == ENOENT) {
+                DEBUG(SSSDBG_FUNC_DATA,
+                      "No member [%s] in group [%s]. "
+                          "Skipping\n", member, groups[i]);
+            } else if (ret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "Could not remove member [%s] from group [%s]. "
+                          "Skipping\n", member, groups[i]);
+            }
+        }
+        /* Continue on, we should try to finish the rest */
+    }
+}
+
 static errno_t sysdb_update_members_ex(struct sss_domain_info *domain,
                                        const char *member,
                                        enum sysdb_member_type type,
@@ -4773,7 +4953,7 @@ static errno_t sysdb_update_members_ex(struct sss_domain_info *domain,
 {
     errno_t ret;
     errno_t sret;
-    int i;
+    struct ldb_dn *member_dn = NULL;
     bool in_transaction = false;
 
     TALLOC_CTX *tmp_ctx = talloc_new(NULL);
@@ -4789,44 +4969,27 @@ static errno_t sysdb_update_members_ex(struct sss_domain_info *domain,
 
     in_transaction = true;
 
-    if (add_groups) {
-        /* Add the user to all add_groups */
-        for (i = 0; add_groups[i]; i++) {
-            ret = sysdb_add_group_member(domain, add_groups[i],
-                                         member, type, is_dn);
-            if (ret != EOK) {
-                if (ret != EEXIST) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "Could not add member [%s] to group [%s]. "
-                              "Skipping.\n", member, add_groups[i]);
-                } else {
-                    DEBUG(SSSDBG_FUNC_DATA,
-                          "Group [%s] already has member [%s]. Skipping.\n",
-                          add_groups[i], member);
-                }
-                /* Continue on, we should try to finish the rest */
-            }
+    if ((add_groups && add_groups[0]) || (del_groups && del_groups[0])) {
+        ret = sysdb_group_membership_member_dn(tmp_ctx, domain, member, type,
+                                               &member_dn);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Could not build the DN of member [%s]. Skipping.\n",
+                  member);
+            member_dn = NULL;
         }
     }
 
-    if (del_groups) {
+    if (member_dn != NULL && add_groups) {
+        /* Add the user to all add_groups */
+        sysdb_update_members_mod(domain, member, member_dn, add_groups,
+                                 SYSDB_MOD_ADD, is_dn);
+    }
+
+    if (member_dn != NULL && del_groups) {
         /* Remove the user from all del_groups */
-        for (i = 0; del_groups[i]; i++) {
-            ret = sysdb_remove_group_member(domain, del_groups[i],
-                                            member, type, is_dn);
-            if (ret != EOK) {
-                if (ret != ENOENT) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "Could not remove member [%s] from group [%s]. "
-                              "Skipping\n", member, del_groups[i]);
-                } else {
-                    DEBUG(SSSDBG_FUNC_DATA,
-                          "No member [%s] in group [%s]. "
-                              "Skipping\n", member, del_groups[i]);
-                }
-                /* Continue on, we should try to finish the rest */
-            }
-        }
+        sysdb_update_members_mod(domain, member, member_dn, del_groups,
+                                 SYSDB_MOD_DEL, is_dn);
     }
 
     ret = sysdb_transaction_commit(domain->sysdb);
@@ -4938,6 +5101,8 @@ errno_t sysdb_remove_attrs(struct sss_domain_info *domain,
          * attribute in the sysdb will cause other removals to
          * fail.
          */
+        sysdb_lookup_cache_invalidate(domain->sysdb, msg->dn,
+                                      msg->num_elements, msg->elements);
         lret = ldb_modify(domain->sysdb->ldb, msg);
         if (lret != LDB_SUCCESS && lret != LDB_ERR_NO_SUCH_ATTRIBUTE) {
             DEBUG(SSSDBG_MINOR_FAILURE,
@@ -5278,6 +5443,8 @@ errno_t sysdb_remove_mapped_data(struct sss_domain_info *domain,
         DEBUG(SSSDBG_TRACE_ALL, "Removing mapped data from [%s].\n",
                                 ldb_dn_get_linearized(res->msgs[c]->dn));
         /* The timestamp cache is skipped on purpose here. */
+        sysdb_lookup_cache_invalidate(domain->sysdb, res->msgs[c]->dn,
+                                      mapped_attr->num, mapped_attr->a);
         ret = sysdb_set_cache_entry_attr(domain->sysdb->ldb, res->msgs[c]->dn,
                                          mapped_attr, SYSDB_MOD_DEL);
         if (ret != EOK) {
@@ -5598,6 +5765,9 @@ errno_t sysdb_mark_entry_as_expired_ldb_dn(struct sss_domain_info *dom,
         goto done;
     }
 
+    sysdb_lookup_cache_invalidate(dom->sysdb, msg->dn, msg->num_elements,
+                                  msg->elements);
+
     ret = ldb_modify(dom->sysdb->ldb, msg);
     if (ret != LDB_SUCCESS) {
         ret = sysdb_error_to_errno(ret);
@@ -5690,6 +5860,8 @@ int sysdb_invalidate_cache_entry(struct sss_domain_info *domain,
         goto done;
     }
 
+    sysdb_lookup_cache_invalidate(sysdb, entry_dn, attrs->num, attrs->a);
+
     ret = sysdb_set_cache_entry_attr(sysdb->ldb, entry_dn,
                                      attrs, SYSDB_MOD_REP);
     if (ret != EOK) {
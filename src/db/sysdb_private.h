@@ -135,6 +135,10 @@ struct sysdb_ctx {
     char *ldb_ts_file;
 
     int transaction_nesting;
+
+    /* users and groups looked up in the current transaction */
+    struct sysdb_lookup_cache *lookup_cache;
+    struct sysdb_lookup_cache_stats lookup_stats;
 };
 
 /* Internal utility functions */
@@ -168,6 +172,30 @@ int sysdb_domain_init_internal(TALLOC_CTX *mem_ctx,
                                struct sysdb_dom_upgrade_ctx *upgrade_ctx,
                                struct sysdb_ctx **_ctx);
 
+/* Lookup cache of single users and groups, see sysdb.c. A NULL filter
+ * stands for the lookup of the entry base_dn itself. */
+errno_t sysdb_lookup_cache_get(TALLOC_CTX *mem_ctx,
+                               struct sysdb_ctx *sysdb,
+                               struct ldb_dn *base_dn,
+                               const char *filter,
+                               const char **attrs,
+                               struct ldb_message **_msg);
+void sysdb_lookup_cache_put(struct sysdb_ctx *sysdb,
+                            struct ldb_dn *base_dn,
+                            const char *filter,
+                            const char **attrs,
+                            struct ldb_message *msg);
+
+/* Same as ldb_search(), but reports unindexed and slow searches if the
+ * query trace is enabled */
+int sysdb_ldb_search(struct ldb_context *ldb,
+                     TALLOC_CTX *mem_ctx,
+                     struct ldb_result **_res,
+                     struct ldb_dn *base,
+                     enum ldb_scope scope,
+                     const char * const *attrs,
+                     const char *exp_fmt, ...) SSS_ATTRIBUTE_PRINTF(7, 8);
+
 /* Upgrade routines */
 int sysdb_upgrade_16(struct sysdb_ctx *sysdb, const char **ver);
 int sysdb_upgrade_17(struct sysdb_ctx *sysdb,
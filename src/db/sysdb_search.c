@@ -311,10 +311,10 @@ int sysdb_getpwnam(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                     LDB_SCOPE_SUBTREE, attrs, SYSDB_PWNAM_FILTER,
-                     lc_sanitized_name,
-                     sanitized_name, sanitized_name);
+    ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                           LDB_SCOPE_SUBTREE, attrs, SYSDB_PWNAM_FILTER,
+                           lc_sanitized_name,
+                           sanitized_name, sanitized_name);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -441,8 +441,9 @@ int sysdb_getpwuid(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                     LDB_SCOPE_SUBTREE, attrs, SYSDB_PWUID_FILTER, ul_uid);
+    ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                           LDB_SCOPE_SUBTREE, attrs, SYSDB_PWUID_FILTER,
+                           ul_uid);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -656,8 +657,8 @@ errno_t sysdb_search_ts_matches(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(sysdb->ldb, tmp_ctx, &res, NULL,
-                     LDB_SCOPE_SUBTREE, attrs, "%s", filter);
+    ret = sysdb_ldb_search(sysdb->ldb, tmp_ctx, &res, NULL,
+                           LDB_SCOPE_SUBTREE, attrs, "%s", filter);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -945,8 +946,8 @@ int sysdb_enumpwent_filter(TALLOC_CTX *mem_ctx,
     }
     DEBUG(SSSDBG_TRACE_LIBS, "Searching cache with [%s]\n", filter);
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                     LDB_SCOPE_SUBTREE, attrs, "%s", filter);
+    ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                           LDB_SCOPE_SUBTREE, attrs, "%s", filter);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -1212,9 +1213,10 @@ int sysdb_getgrnam(TALLOC_CTX *mem_ctx,
             goto done;
         }
 
-        ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                         LDB_SCOPE_SUBTREE, attrs, fmt_filter,
-                         lc_sanitized_name, sanitized_name, sanitized_name);
+        ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                               LDB_SCOPE_SUBTREE, attrs, fmt_filter,
+                               lc_sanitized_name, sanitized_name,
+                               sanitized_name);
         if (ret != EOK) {
             ret = sysdb_error_to_errno(ret);
             goto done;
@@ -1246,9 +1248,10 @@ int sysdb_getgrnam(TALLOC_CTX *mem_ctx,
      * it's a MPG and we're dealing with a overridden group, which has to
      * use the very same filter as a non MPG domain. */
     if (res == NULL) {
-        ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                         LDB_SCOPE_SUBTREE, attrs, fmt_filter,
-                         lc_sanitized_name, sanitized_name, sanitized_name);
+        ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                               LDB_SCOPE_SUBTREE, attrs, fmt_filter,
+                               lc_sanitized_name, sanitized_name,
+                               sanitized_name);
         if (ret != EOK) {
             ret = sysdb_error_to_errno(ret);
             goto done;
@@ -1413,8 +1416,9 @@ int sysdb_getgrgid_attrs(TALLOC_CTX *mem_ctx,
             goto done;
         }
 
-        ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                         LDB_SCOPE_SUBTREE, attrs, fmt_filter, ul_gid, ul_gid, ul_gid);
+        ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                               LDB_SCOPE_SUBTREE, attrs, fmt_filter,
+                               ul_gid, ul_gid, ul_gid);
         if (ret != EOK) {
             ret = sysdb_error_to_errno(ret);
             goto done;
@@ -1443,8 +1447,8 @@ int sysdb_getgrgid_attrs(TALLOC_CTX *mem_ctx,
      * it's a MPG and we're dealing with a overridden group, which has to
      * use the very same filter as a non MPG domain. */
     if (res == NULL) {
-        ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                         LDB_SCOPE_SUBTREE, attrs, fmt_filter, ul_gid);
+        ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                               LDB_SCOPE_SUBTREE, attrs, fmt_filter, ul_gid);
         if (ret != EOK) {
             ret = sysdb_error_to_errno(ret);
             goto done;
@@ -1556,8 +1560,8 @@ int sysdb_enumgrent_filter(TALLOC_CTX *mem_ctx,
     }
     DEBUG(SSSDBG_TRACE_LIBS, "Searching cache with [%s]\n", filter);
 
-    lret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                      LDB_SCOPE_SUBTREE, attrs, "%s", filter);
+    lret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                            LDB_SCOPE_SUBTREE, attrs, "%s", filter);
     if (lret != LDB_SUCCESS) {
         ret = sysdb_error_to_errno(lret);
         goto done;
@@ -1963,10 +1967,10 @@ int sysdb_get_user_attr(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
-                     LDB_SCOPE_SUBTREE, attributes,
-                     SYSDB_PWNAM_FILTER, lc_sanitized_name, sanitized_name,
-                     sanitized_name);
+    ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &res, base_dn,
+                           LDB_SCOPE_SUBTREE, attributes,
+                           SYSDB_PWNAM_FILTER, lc_sanitized_name,
+                           sanitized_name, sanitized_name);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -2408,12 +2412,12 @@ int sysdb_get_netgroup_attr(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = ldb_search(domain->sysdb->ldb, tmp_ctx, &result, base_dn,
-                     LDB_SCOPE_SUBTREE, attributes,
-                     SYSDB_NETGR_FILTER,
-                     lc_sanitized_netgroup,
-                     sanitized_netgroup,
-                     sanitized_netgroup);
+    ret = sysdb_ldb_search(domain->sysdb->ldb, tmp_ctx, &result, base_dn,
+                           LDB_SCOPE_SUBTREE, attributes,
+                           SYSDB_NETGR_FILTER,
+                           lc_sanitized_netgroup,
+                           sanitized_netgroup,
+                           sanitized_netgroup);
     if (ret) {
         ret = sysdb_error_to_errno(ret);
         goto done;
@@ -289,6 +289,9 @@ static errno_t invalidate_entry_override(struct sysdb_ctx *sysdb,
     msg_del->dn = dn;
     msg_repl->dn = dn;
 
+    sysdb_lookup_cache_invalidate(sysdb, dn, msg_del->num_elements,
+                                  msg_del->elements);
+
     ret = ldb_modify(sysdb->ldb, msg_del);
     if (ret != LDB_SUCCESS && ret != LDB_ERR_NO_SUCH_ATTRIBUTE) {
         DEBUG(SSSDBG_OP_FAILURE,
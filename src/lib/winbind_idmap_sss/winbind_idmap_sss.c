@@ -64,16 +64,98 @@ static NTSTATUS idmap_sss_initialize(struct idmap_domain *dom)
     return NT_STATUS_OK;
 }
 
+static void idmap_sss_set_xid_type(struct id_map *map,
+                                   enum sss_id_type id_type)
+{
+    switch (id_type) {
+    case SSS_ID_TYPE_UID:
+        map->xid.type = ID_TYPE_UID;
+        break;
+    case SSS_ID_TYPE_GID:
+        map->xid.type = ID_TYPE_GID;
+        break;
+    case SSS_ID_TYPE_BOTH:
+        map->xid.type = ID_TYPE_BOTH;
+        break;
+    default:
+        return;
+    }
+
+    map->status = ID_MAPPED;
+}
+
+static void idmap_sss_map_sid(struct idmap_sss_ctx *ctx,
+                              struct id_map *map,
+                              int ret,
+                              char *sid_str,
+                              enum sss_id_type id_type)
+{
+    enum idmap_error_code err;
+    struct dom_sid *sid;
+
+    if (ret != 0) {
+        if (ret == ENOENT) {
+            map->status = ID_UNMAPPED;
+        }
+        return;
+    }
+
+    switch (id_type) {
+    case SSS_ID_TYPE_UID:
+    case SSS_ID_TYPE_GID:
+    case SSS_ID_TYPE_BOTH:
+        break;
+    default:
+        return;
+    }
+
+    err = sss_idmap_sid_to_smb_sid(ctx->idmap_ctx, sid_str, &sid);
+    if (err != IDMAP_SUCCESS) {
+        return;
+    }
+
+    memcpy(map->sid, sid, sizeof(struct dom_sid));
+    sss_idmap_free_smb_sid(ctx->idmap_ctx, sid);
+
+    idmap_sss_set_xid_type(map, id_type);
+}
+
+/* winbindd passes all IDs of a directory listing or a token in one call,
+ * each kind of ID is translated with a single batch request to SSSD */
+static int idmap_sss_getsidbyxid_list(enum id_type type,
+                                      const uint32_t *ids, size_t num,
+                                      char **sids, enum sss_id_type *types,
+                                      int *rets)
+{
+    switch (type) {
+    case ID_TYPE_UID:
+        return sss_nss_getsidbyuid_list(ids, num, sids, types, rets);
+    case ID_TYPE_GID:
+        return sss_nss_getsidbygid_list(ids, num, sids, types, rets);
+    default:
+        return sss_nss_getsidbyid_list(ids, num, sids, types, rets);
+    }
+}
+
 static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
                                           struct id_map **map)
 {
+    static const enum id_type kinds[] = { ID_TYPE_UID, ID_TYPE_GID,
+                                          ID_TYPE_NOT_SPECIFIED };
+    TALLOC_CTX *tmp_ctx;
+    size_t num;
     size_t c;
+    size_t n;
+    size_t k;
     int ret;
-    char *sid_str;
-    enum sss_id_type id_type;
-    struct dom_sid *sid;
-    enum idmap_error_code err;
+    enum id_type *id_kinds;
+    uint32_t *ids;
+    size_t *pos;
+    char **sids;
+    enum sss_id_type *types;
+    int *rets;
     struct idmap_sss_ctx *ctx;
+    NTSTATUS status;
 
     if (dom == NULL) {
         return ERROR_INVALID_PARAMETER;
@@ -84,68 +166,92 @@ static NTSTATUS idmap_sss_unixids_to_sids(struct idmap_domain *dom,
         return ERROR_INVALID_PARAMETER;
     }
 
-    for (c = 0; map[c]; c++) {
-        map[c]->status = ID_UNKNOWN;
+    for (num = 0; map[num]; num++) {
+        map[num]->status = ID_UNKNOWN;
     }
 
-    for (c = 0; map[c]; c++) {
+    if (num == 0) {
+        return NT_STATUS_OK;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return NT_STATUS_NO_MEMORY;
+    }
+
+    id_kinds = talloc_array(tmp_ctx, enum id_type, num);
+    ids = talloc_array(tmp_ctx, uint32_t, num);
+    pos = talloc_array(tmp_ctx, size_t, num);
+    sids = talloc_array(tmp_ctx, char *, num);
+    types = talloc_array(tmp_ctx, enum sss_id_type, num);
+    rets = talloc_array(tmp_ctx, int, num);
+    if (id_kinds == NULL || ids == NULL || pos == NULL || sids == NULL
+            || types == NULL || rets == NULL) {
+        status = NT_STATUS_NO_MEMORY;
+        goto done;
+    }
+
+    /* a successful lookup changes xid.type, group the entries first */
+    for (c = 0; c < num; c++) {
         switch (map[c]->xid.type) {
         case ID_TYPE_UID:
-            ret = sss_nss_getsidbyuid(map[c]->xid.id, &sid_str, &id_type);
-            break;
         case ID_TYPE_GID:
-            ret = sss_nss_getsidbygid(map[c]->xid.id, &sid_str, &id_type);
+            id_kinds[c] = map[c]->xid.type;
             break;
         default:
-            ret = sss_nss_getsidbyid(map[c]->xid.id, &sid_str, &id_type);
+            id_kinds[c] = ID_TYPE_NOT_SPECIFIED;
         }
-        if (ret != 0) {
-            if (ret == ENOENT) {
-                map[c]->status = ID_UNMAPPED;
+    }
+
+    for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        n = 0;
+        for (c = 0; c < num; c++) {
+            if (id_kinds[c] == kinds[k]) {
+                ids[n] = map[c]->xid.id;
+                pos[n] = c;
+                n++;
             }
-            continue;
         }
 
-        switch (id_type) {
-        case SSS_ID_TYPE_UID:
-            map[c]->xid.type = ID_TYPE_UID;
-            break;
-        case SSS_ID_TYPE_GID:
-            map[c]->xid.type = ID_TYPE_GID;
-            break;
-        case SSS_ID_TYPE_BOTH:
-            map[c]->xid.type = ID_TYPE_BOTH;
-            break;
-        default:
-            free(sid_str);
+        if (n == 0) {
             continue;
         }
 
-        err = sss_idmap_sid_to_smb_sid(ctx->idmap_ctx, sid_str, &sid);
-        free(sid_str);
-        if (err != IDMAP_SUCCESS) {
+        ret = idmap_sss_getsidbyxid_list(kinds[k], ids, n, sids, types, rets);
+        if (ret != 0) {
+            /* the entries stay ID_UNKNOWN like failed single lookups */
             continue;
         }
 
-        memcpy(map[c]->sid, sid, sizeof(struct dom_sid));
-        sss_idmap_free_smb_sid(ctx->idmap_ctx, sid);
-
-        map[c]->status = ID_MAPPED;
+        for (c = 0; c < n; c++) {
+            idmap_sss_map_sid(ctx, map[pos[c]], rets[c], sids[c], types[c]);
+            free(sids[c]);
+        }
     }
 
-    return NT_STATUS_OK;
+    status = NT_STATUS_OK;
+
+done:
+    talloc_free(tmp_ctx);
+    return status;
 }
 
 static NTSTATUS idmap_sss_sids_to_unixids(struct idmap_domain *dom,
                                           struct id_map **map)
 {
+    TALLOC_CTX *tmp_ctx;
+    size_t num;
     size_t c;
+    size_t n = 0;
     int ret;
-    char *sid_str;
-    enum sss_id_type id_type;
+    char **sid_strs;
+    size_t *pos;
+    uint32_t *ids;
+    enum sss_id_type *types;
+    int *rets;
     enum idmap_error_code err;
     struct idmap_sss_ctx *ctx;
-    uint32_t id;
+    NTSTATUS status;
 
     if (dom == NULL) {
         return ERROR_INVALID_PARAMETER;
@@ -156,45 +262,75 @@ static NTSTATUS idmap_sss_sids_to_unixids(struct idmap_domain *dom,
         return ERROR_INVALID_PARAMETER;
     }
 
-    for (c = 0; map[c]; c++) {
-        map[c]->status = ID_UNKNOWN;
+    for (num = 0; map[num]; num++) {
+        map[num]->status = ID_UNKNOWN;
+    }
+
+    if (num == 0) {
+        return NT_STATUS_OK;
+    }
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return NT_STATUS_NO_MEMORY;
+    }
+
+    sid_strs = talloc_zero_array(tmp_ctx, char *, num);
+    pos = talloc_array(tmp_ctx, size_t, num);
+    ids = talloc_array(tmp_ctx, uint32_t, num);
+    types = talloc_array(tmp_ctx, enum sss_id_type, num);
+    rets = talloc_array(tmp_ctx, int, num);
+    if (sid_strs == NULL || pos == NULL || ids == NULL || types == NULL
+            || rets == NULL) {
+        status = NT_STATUS_NO_MEMORY;
+        goto done;
     }
 
-    for (c = 0; map[c]; c++) {
-        err = sss_idmap_smb_sid_to_sid(ctx->idmap_ctx, map[c]->sid, &sid_str);
+    for (c = 0; c < num; c++) {
+        err = sss_idmap_smb_sid_to_sid(ctx->idmap_ctx, map[c]->sid,
+                                       &sid_strs[n]);
         if (err != IDMAP_SUCCESS) {
             continue;
         }
+        pos[n] = c;
+        n++;
+    }
 
-        ret = sss_nss_getidbysid(sid_str, &id, &id_type);
-        sss_idmap_free_sid(ctx->idmap_ctx, sid_str);
-        if (ret != 0) {
-            if (ret == ENOENT) {
-                map[c]->status = ID_UNMAPPED;
+    if (n == 0) {
+        status = NT_STATUS_OK;
+        goto done;
+    }
+
+    ret = sss_nss_getidbysid_list((const char * const *) sid_strs, n,
+                                  ids, types, rets);
+    if (ret != 0) {
+        /* the entries stay ID_UNKNOWN like failed single lookups */
+        status = NT_STATUS_OK;
+        goto done;
+    }
+
+    for (c = 0; c < n; c++) {
+        if (rets[c] != 0) {
+            if (rets[c] == ENOENT) {
+                map[pos[c]]->status = ID_UNMAPPED;
             }
             continue;
         }
 
-        switch (id_type) {
-        case SSS_ID_TYPE_UID:
-            map[c]->xid.type = ID_TYPE_UID;
-            break;
-        case SSS_ID_TYPE_GID:
-            map[c]->xid.type = ID_TYPE_GID;
-            break;
-        case SSS_ID_TYPE_BOTH:
-            map[c]->xid.type = ID_TYPE_BOTH;
-            break;
-        default:
-            continue;
+        idmap_sss_set_xid_type(map[pos[c]], types[c]);
+        if (map[pos[c]]->status == ID_MAPPED) {
+            map[pos[c]]->xid.id = ids[c];
         }
+    }
 
-        map[c]->xid.id = id;
+    status = NT_STATUS_OK;
 
-        map[c]->status = ID_MAPPED;
+done:
+    for (c = 0; c < n; c++) {
+        sss_idmap_free_sid(ctx->idmap_ctx, sid_strs[c]);
     }
-
-    return NT_STATUS_OK;
+    talloc_free(tmp_ctx);
+    return status;
 }
 
 static struct idmap_methods sss_methods = {
@@ -21,6 +21,8 @@
 
 #include "config.h"
 #include "util/util.h"
+#include "util/sss_talloc_report.h"
+#include "util/sss_loop_stats.h"
 #include "util/child_common.h"
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -1612,7 +1614,11 @@ static void monitor_sbus_connected(struct tevent_req *req)
     );
     SBUS_INTERFACE(iface_service,
         sssd_service,
-        SBUS_METHODS(SBUS_NO_METHODS),
+        SBUS_METHODS(
+            SBUS_SYNC(METHOD, sssd_service, tallocReport, generic_talloc_report, NULL),
+            SBUS_SYNC(METHOD, sssd_service, tallocSampling, generic_talloc_sampling, ctx->ev),
+            SBUS_SYNC(METHOD, sssd_service, loopStats, generic_loop_stats, NULL)
+        ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(
             SBUS_SYNC(GETTER, sssd_service, debug_level, generic_get_debug_level, NULL),
@@ -35,6 +35,7 @@
 #include "util/crypto/sss_crypto.h"
 #include "util/cert.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 #include "p11_child/p11_child.h"
 
 static const char *op_mode_str(enum op_mode mode)
@@ -166,6 +167,7 @@ int main(int argc, const char *argv[])
     char *cert_b64 = NULL;
     long chain_id = 0;
     bool wait_for_card = false;
+    struct sss_trace_span *span = NULL;
     char *uri = NULL;
 
     struct poptOption long_options[] = {
@@ -329,6 +331,9 @@ int main(int argc, const char *argv[])
 
     DEBUG_INIT(debug_level, opt_logger);
 
+    span = sss_trace_span_begin(NULL, SSS_TRACE_CHILD, "p11_child %s",
+                                op_mode_str(mode));
+
     DEBUG(SSSDBG_TRACE_FUNC, "p11_child started.\n");
 
     DEBUG(SSSDBG_TRACE_INTERNAL, "Running in [%s] mode.\n", op_mode_str(mode));
@@ -387,6 +392,7 @@ int main(int argc, const char *argv[])
                   &multi);
 
 done:
+    sss_trace_span_end(span, ret);
     fprintf(stdout, "%d\n%s", ret, multi ? multi : "");
 
     talloc_free(main_ctx);
@@ -314,6 +314,8 @@ ad_sdap_access_step(struct tevent_req *req, struct sdap_id_conn_ctx *conn)
     }
     req_ctx->id_ctx = state->ctx->sdap_access_ctx->id_ctx;
     req_ctx->filter = state->filter;
+    req_ctx->local_filter = NULL;
+    req_ctx->ppolicy_cache = state->ctx->sdap_access_ctx->ppolicy_cache;
     memcpy(&req_ctx->access_rule,
            state->ctx->sdap_access_ctx->access_rule,
            sizeof(int) * LDAP_ACCESS_LAST);
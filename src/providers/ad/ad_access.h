@@ -25,6 +25,8 @@
 
 #include "providers/data_provider.h"
 
+struct ad_gpo_child;
+
 struct ad_access_ctx {
     struct dp_option *ad_options;
     struct sdap_access_ctx *sdap_access_ctx;
@@ -50,6 +52,8 @@ struct ad_access_ctx {
     hash_table_t *gpo_map_options_table;
     enum gpo_map_type gpo_default_right;
     struct sdap_attr_map *host_attr_map;
+    /* resident gpo_child processes, one per domain controller */
+    struct ad_gpo_child *gpo_children;
 };
 
 struct tevent_req *
@@ -137,6 +137,7 @@ struct gp_gpo {
     int gpo_func_version;
     int gpo_flags;
     bool send_to_child;
+    int cached_gpt_version;
     const char *policy_filename;
 };
 
@@ -177,15 +178,12 @@ int ad_gpo_process_gpo_recv(struct tevent_req *req,
 
 struct tevent_req *ad_gpo_process_cse_send(TALLOC_CTX *mem_ctx,
                                            struct tevent_context *ev,
-                                           bool send_to_child,
+                                           struct ad_access_ctx *access_ctx,
                                            struct sss_domain_info *domain,
-                                           const char *gpo_guid,
-                                           const char *gpo_dpname,
                                            const char *smb_server,
-                                           const char *smb_share,
-                                           const char *smb_path,
+                                           struct gp_gpo **gpos,
+                                           int num_gpos,
                                            const char *smb_cse_suffix,
-                                           int cached_gpt_version,
                                            int gpo_timeout_option);
 
 int ad_gpo_process_cse_recv(struct tevent_req *req);
@@ -1943,8 +1941,10 @@ static void ad_gpo_target_dn_retrieval_done(struct tevent_req *subreq);
 static void ad_gpo_process_som_done(struct tevent_req *subreq);
 static void ad_gpo_process_gpo_done(struct tevent_req *subreq);
 
+static errno_t ad_gpo_cse_prepare(struct ad_gpo_access_state *state);
 static errno_t ad_gpo_cse_step(struct tevent_req *req);
 static void ad_gpo_cse_done(struct tevent_req *subreq);
+static errno_t ad_gpo_cse_finish(struct ad_gpo_access_state *state);
 
 struct tevent_req *
 ad_gpo_access_send(TALLOC_CTX *mem_ctx,
@@ -2470,9 +2470,10 @@ ad_gpo_process_som_done(struct tevent_req *subreq)
  * reduces it to a list of cse_filtered_gpos, based on whether each GPO's list
  * of cse_guids includes the "SecuritySettings" CSE GUID (used for HBAC).
  *
- * Ultimately, this function then sends each cse_filtered_gpo to the gpo_child,
- * which retrieves the GPT.INI and policy files (as needed). Once all files
- * have been downloaded, the ad_gpo_cse_done function performs HBAC processing.
+ * Ultimately, this function then sends the cse_filtered_gpos whose cache
+ * entries have timed out to the gpo_child, which retrieves the GPT.INI and
+ * policy files (as needed). Once all files have been downloaded, the
+ * ad_gpo_cse_finish function performs HBAC processing.
  */
 static void
 ad_gpo_process_gpo_done(struct tevent_req *subreq)
@@ -2645,7 +2646,16 @@ ad_gpo_process_gpo_done(struct tevent_req *subreq)
         }
     }
 
+    ret = ad_gpo_cse_prepare(state);
+    if (ret != EOK) {
+        goto done;
+    }
+
     ret = ad_gpo_cse_step(req);
+    if (ret == EOK) {
+        /* all policy files are up to date in the GPO cache */
+        ret = ad_gpo_cse_finish(state);
+    }
 
  done:
 
@@ -2656,103 +2666,167 @@ ad_gpo_process_gpo_done(struct tevent_req *subreq)
     }
 }
 
+/*
+ * This function looks up the GPO cache entry of every cse_filtered_gpo to
+ * determine whether the gpo_child has to be asked for its GPT.INI file (and
+ * possibly its policy file) at all.
+ */
 static errno_t
-ad_gpo_cse_step(struct tevent_req *req)
+ad_gpo_cse_prepare(struct ad_gpo_access_state *state)
 {
-    struct tevent_req *subreq;
-    struct ad_gpo_access_state *state;
-    int i = 0;
+    struct gp_gpo *cse_filtered_gpo;
     struct ldb_result *res;
+    time_t policy_file_timeout;
+    int i;
+    int j;
     errno_t ret;
-    bool send_to_child = true;
-    int cached_gpt_version = 0;
-    time_t policy_file_timeout = 0;
 
-    state = tevent_req_data(req, struct ad_gpo_access_state);
+    for (i = 0; state->cse_filtered_gpos[i] != NULL; i++) {
+        cse_filtered_gpo = state->cse_filtered_gpos[i];
+
+        DEBUG(SSSDBG_TRACE_FUNC, "cse filtered_gpos[%d]->gpo_guid is %s\n",
+              i, cse_filtered_gpo->gpo_guid);
+        for (j = 0; j < cse_filtered_gpo->num_gpo_cse_guids; j++) {
+            DEBUG(SSSDBG_TRACE_ALL,
+                  "cse_filtered_gpos[%d]->gpo_cse_guids[%d]->gpo_guid is %s\n",
+                  i, j, cse_filtered_gpo->gpo_cse_guids[j]);
+        }
 
-    struct gp_gpo *cse_filtered_gpo =
-        state->cse_filtered_gpos[state->cse_gpo_index];
+        DEBUG(SSSDBG_TRACE_FUNC, "smb_server: %s\n",
+              cse_filtered_gpo->smb_server);
+        DEBUG(SSSDBG_TRACE_FUNC, "smb_share: %s\n", cse_filtered_gpo->smb_share);
+        DEBUG(SSSDBG_TRACE_FUNC, "smb_path: %s\n", cse_filtered_gpo->smb_path);
+        DEBUG(SSSDBG_TRACE_FUNC, "gpo_guid: %s\n", cse_filtered_gpo->gpo_guid);
+
+        cse_filtered_gpo->policy_filename =
+            talloc_asprintf(state,
+                            GPO_CACHE_PATH"%s%s",
+                            cse_filtered_gpo->smb_path,
+                            GP_EXT_GUID_SECURITY_SUFFIX);
+        if (cse_filtered_gpo->policy_filename == NULL) {
+            return ENOMEM;
+        }
 
-    /* cse_filtered_gpo is NULL after all GPO policy files have been downloaded */
-    if (cse_filtered_gpo == NULL) return EOK;
+        cse_filtered_gpo->send_to_child = true;
+        cse_filtered_gpo->cached_gpt_version = 0;
+
+        /* retrieve gpo cache entry; set cached_gpt_version to -1 if
+         * unavailable */
+        DEBUG(SSSDBG_TRACE_FUNC, "retrieving GPO from cache [%s]\n",
+              cse_filtered_gpo->gpo_guid);
+        ret = sysdb_gpo_get_gpo_by_guid(state,
+                                        state->host_domain,
+                                        cse_filtered_gpo->gpo_guid,
+                                        &res);
+        if (ret == EOK) {
+            /*
+             * Note: if the timeout is valid, then we can later avoid
+             * downloading the GPT.INI file, as well as any policy files (i.e.
+             * we don't need to interact with the gpo_child at all). However,
+             * even if the timeout is not valid, while we will have to interact
+             * with the gpo child to download the GPT.INI file, we may still be
+             * able to avoid downloading the policy files (if the
+             * cached_gpt_version is the same as the GPT.INI version). In other
+             * words, the timeout is *not* an expiration for the entire cache
+             * entry; the cached_gpt_version never expires.
+             */
 
-    DEBUG(SSSDBG_TRACE_FUNC, "cse filtered_gpos[%d]->gpo_guid is %s\n",
-          state->cse_gpo_index, cse_filtered_gpo->gpo_guid);
-    for (i = 0; i < cse_filtered_gpo->num_gpo_cse_guids; i++) {
-        DEBUG(SSSDBG_TRACE_ALL,
-              "cse_filtered_gpos[%d]->gpo_cse_guids[%d]->gpo_guid is %s\n",
-              state->cse_gpo_index, i, cse_filtered_gpo->gpo_cse_guids[i]);
+            cse_filtered_gpo->cached_gpt_version =
+                ldb_msg_find_attr_as_int(res->msgs[0],
+                                         SYSDB_GPO_VERSION_ATTR, 0);
+
+            policy_file_timeout = ldb_msg_find_attr_as_uint64
+                (res->msgs[0], SYSDB_GPO_TIMEOUT_ATTR, 0);
+
+            if (policy_file_timeout >= time(NULL)) {
+                cse_filtered_gpo->send_to_child = false;
+            }
+            talloc_free(res);
+        } else if (ret == ENOENT) {
+            DEBUG(SSSDBG_TRACE_FUNC, "ENOENT\n");
+            cse_filtered_gpo->cached_gpt_version = -1;
+        } else {
+            DEBUG(SSSDBG_FATAL_FAILURE, "Could not read GPO from cache: [%s]\n",
+                  sss_strerror(ret));
+            return ret;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC, "send_to_child: %d\n",
+              cse_filtered_gpo->send_to_child);
+        DEBUG(SSSDBG_TRACE_FUNC, "cached_gpt_version: %d\n",
+              cse_filtered_gpo->cached_gpt_version);
     }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "smb_server: %s\n", cse_filtered_gpo->smb_server);
-    DEBUG(SSSDBG_TRACE_FUNC, "smb_share: %s\n", cse_filtered_gpo->smb_share);
-    DEBUG(SSSDBG_TRACE_FUNC, "smb_path: %s\n", cse_filtered_gpo->smb_path);
-    DEBUG(SSSDBG_TRACE_FUNC, "gpo_guid: %s\n", cse_filtered_gpo->gpo_guid);
+    return EOK;
+}
+
+/*
+ * This function sends all cse_filtered_gpos that are stored on the same
+ * domain controller and need to be refreshed to the gpo_child in a single
+ * request. EOK is returned once no GPO is left to be sent.
+ */
+static errno_t
+ad_gpo_cse_step(struct tevent_req *req)
+{
+    struct tevent_req *subreq;
+    struct ad_gpo_access_state *state;
+    struct gp_gpo **cse_filtered_gpos;
+    struct gp_gpo **batch;
+    const char *smb_server;
+    int num_batch = 0;
+    int i;
+
+    state = tevent_req_data(req, struct ad_gpo_access_state);
+    cse_filtered_gpos = state->cse_filtered_gpos;
 
-    cse_filtered_gpo->policy_filename =
-        talloc_asprintf(state,
-                        GPO_CACHE_PATH"%s%s",
-                        cse_filtered_gpo->smb_path,
-                        GP_EXT_GUID_SECURITY_SUFFIX);
-    if (cse_filtered_gpo->policy_filename == NULL) {
-        return ENOMEM;
+    /* skip the GPOs whose cache entries are still valid or which have already
+     * been sent to the child */
+    while (cse_filtered_gpos[state->cse_gpo_index] != NULL
+            && !cse_filtered_gpos[state->cse_gpo_index]->send_to_child) {
+        state->cse_gpo_index++;
     }
 
-    /* retrieve gpo cache entry; set cached_gpt_version to -1 if unavailable */
-    DEBUG(SSSDBG_TRACE_FUNC, "retrieving GPO from cache [%s]\n",
-          cse_filtered_gpo->gpo_guid);
-    ret = sysdb_gpo_get_gpo_by_guid(state,
-                                    state->host_domain,
-                                    cse_filtered_gpo->gpo_guid,
-                                    &res);
-    if (ret == EOK) {
-        /*
-         * Note: if the timeout is valid, then we can later avoid downloading
-         * the GPT.INI file, as well as any policy files (i.e. we don't need
-         * to interact with the gpo_child at all). However, even if the timeout
-         * is not valid, while we will have to interact with the gpo child to
-         * download the GPT.INI file, we may still be able to avoid downloading
-         * the policy files (if the cached_gpt_version is the same as the
-         * GPT.INI version). In other words, the timeout is *not* an expiration
-         * for the entire cache entry; the cached_gpt_version never expires.
-         */
+    /* cse_filtered_gpo is NULL after all GPO policy files have been downloaded */
+    if (cse_filtered_gpos[state->cse_gpo_index] == NULL) return EOK;
 
-        cached_gpt_version = ldb_msg_find_attr_as_int(res->msgs[0],
-                                                      SYSDB_GPO_VERSION_ATTR,
-                                                      0);
+    smb_server = cse_filtered_gpos[state->cse_gpo_index]->smb_server;
 
-        policy_file_timeout = ldb_msg_find_attr_as_uint64
-            (res->msgs[0], SYSDB_GPO_TIMEOUT_ATTR, 0);
+    for (i = state->cse_gpo_index; cse_filtered_gpos[i] != NULL; i++);
+    batch = talloc_zero_array(state, struct gp_gpo *,
+                              i - state->cse_gpo_index + 1);
+    if (batch == NULL) {
+        return ENOMEM;
+    }
 
-        if (policy_file_timeout >= time(NULL)) {
-            send_to_child = false;
+    for (i = state->cse_gpo_index; cse_filtered_gpos[i] != NULL; i++) {
+        if (!cse_filtered_gpos[i]->send_to_child
+                || strcasecmp(cse_filtered_gpos[i]->smb_server,
+                              smb_server) != 0) {
+            continue;
         }
-    } else if (ret == ENOENT) {
-        DEBUG(SSSDBG_TRACE_FUNC, "ENOENT\n");
-        cached_gpt_version = -1;
-    } else {
-        DEBUG(SSSDBG_FATAL_FAILURE, "Could not read GPO from cache: [%s]\n",
-              sss_strerror(ret));
-        return ret;
-    }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "send_to_child: %d\n", send_to_child);
-    DEBUG(SSSDBG_TRACE_FUNC, "cached_gpt_version: %d\n", cached_gpt_version);
+        batch[num_batch] = cse_filtered_gpos[i];
+        num_batch++;
+
+        /* the GPO is handled by this request now */
+        cse_filtered_gpos[i]->send_to_child = false;
+    }
 
-    cse_filtered_gpo->send_to_child = send_to_child;
+    DEBUG(SSSDBG_TRACE_FUNC, "Sending %d GPOs stored on %s to gpo_child\n",
+          num_batch, smb_server);
 
     subreq = ad_gpo_process_cse_send(state,
                                      state->ev,
-                                     send_to_child,
+                                     state->access_ctx,
                                      state->host_domain,
-                                     cse_filtered_gpo->gpo_guid,
-                                     cse_filtered_gpo->gpo_dpname,
-                                     cse_filtered_gpo->smb_server,
-                                     cse_filtered_gpo->smb_share,
-                                     cse_filtered_gpo->smb_path,
+                                     smb_server,
+                                     batch,
+                                     num_batch,
                                      GP_EXT_GUID_SECURITY_SUFFIX,
-                                     cached_gpt_version,
                                      state->gpo_timeout_option);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
 
     tevent_req_set_callback(subreq, ad_gpo_cse_done, req);
     return EAGAIN;
@@ -2796,12 +2870,8 @@ store_hash_maps_in_cache(struct sss_domain_info *domain,
 }
 
 /*
- * This cse-specific function (GP_EXT_GUID_SECURITY) increments the
- * cse_gpo_index until the policy settings for all applicable GPOs have been
- * stored as part of the GPO Result object in the sysdb cache. Once all
- * GPOs have been processed, this functions performs HBAC processing by
- * comparing the resultant policy setting values in the GPO Result object
- * with the user_sid/group_sids of interest.
+ * This function keeps sending the cse_filtered_gpos to the gpo_child until
+ * the policy files of all applicable GPOs are up to date in the GPO cache.
  */
 static void
 ad_gpo_cse_done(struct tevent_req *subreq)
@@ -2813,15 +2883,6 @@ ad_gpo_cse_done(struct tevent_req *subreq)
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct ad_gpo_access_state);
 
-    struct gp_gpo *cse_filtered_gpo =
-        state->cse_filtered_gpos[state->cse_gpo_index];
-
-    const char *gpo_guid = cse_filtered_gpo->gpo_guid;
-    const char *gpo_dpname = cse_filtered_gpo->gpo_dpname;
-
-    DEBUG(SSSDBG_TRACE_FUNC, "gpo_guid: %s, display name: %s\n",
-          gpo_guid, gpo_dpname);
-
     ret = ad_gpo_process_cse_recv(subreq);
 
     talloc_zfree(subreq);
@@ -2832,47 +2893,11 @@ ad_gpo_cse_done(struct tevent_req *subreq)
         goto done;
     }
 
-    /*
-     * now that the policy file for this gpo have been downloaded to the
-     * GPO CACHE, we store all of the supported keys present in the file
-     * (as part of the GPO Result object in the sysdb cache).
-     */
-    ret = ad_gpo_store_policy_settings(state->host_domain,
-                                       state->allow_maps, state->deny_maps,
-                                       cse_filtered_gpo->policy_filename);
-    if (ret != EOK && ret != ENOENT) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "ad_gpo_store_policy_settings failed: [%d](%s)\n",
-              ret, sss_strerror(ret));
-        goto done;
-    }
-
-    state->cse_gpo_index++;
     ret = ad_gpo_cse_step(req);
 
     if (ret == EOK) {
         /* ret is EOK only after all GPO policy files have been downloaded */
-        ret = store_hash_maps_in_cache(state->host_domain,
-                                       state->allow_maps, state->deny_maps);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE, "Failed to store evaluated GPO maps "
-                                     "[%d][%s].\n", ret, sss_strerror(ret));
-            goto done;
-        }
-        ret = ad_gpo_perform_hbac_processing(state,
-                                             state->gpo_mode,
-                                             state->gpo_map_type,
-                                             state->user,
-                                             state->gpo_implicit_deny,
-                                             state->user_domain,
-                                             state->host_domain,
-                                             state->opts->idmap_ctx->map);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE, "HBAC processing failed: [%d](%s}\n",
-                  ret, sss_strerror(ret));
-            goto done;
-        }
-
+        ret = ad_gpo_cse_finish(state);
     }
 
  done:
@@ -2884,6 +2909,67 @@ ad_gpo_cse_done(struct tevent_req *subreq)
     }
 }
 
+/*
+ * This cse-specific function (GP_EXT_GUID_SECURITY) stores the policy
+ * settings for all applicable GPOs as part of the GPO Result object in the
+ * sysdb cache. Once all GPOs have been processed, this functions performs
+ * HBAC processing by comparing the resultant policy setting values in the
+ * GPO Result object with the user_sid/group_sids of interest.
+ */
+static errno_t
+ad_gpo_cse_finish(struct ad_gpo_access_state *state)
+{
+    struct gp_gpo *cse_filtered_gpo;
+    int i;
+    errno_t ret;
+
+    for (i = 0; state->cse_filtered_gpos[i] != NULL; i++) {
+        cse_filtered_gpo = state->cse_filtered_gpos[i];
+
+        DEBUG(SSSDBG_TRACE_FUNC, "gpo_guid: %s, display name: %s\n",
+              cse_filtered_gpo->gpo_guid, cse_filtered_gpo->gpo_dpname);
+
+        /*
+         * now that the policy file for this gpo have been downloaded to the
+         * GPO CACHE, we store all of the supported keys present in the file
+         * (as part of the GPO Result object in the sysdb cache).
+         */
+        ret = ad_gpo_store_policy_settings(state->host_domain,
+                                           state->allow_maps, state->deny_maps,
+                                           cse_filtered_gpo->policy_filename);
+        if (ret != EOK && ret != ENOENT) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "ad_gpo_store_policy_settings failed: [%d](%s)\n",
+                  ret, sss_strerror(ret));
+            return ret;
+        }
+    }
+
+    ret = store_hash_maps_in_cache(state->host_domain,
+                                   state->allow_maps, state->deny_maps);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to store evaluated GPO maps "
+                                 "[%d][%s].\n", ret, sss_strerror(ret));
+        return ret;
+    }
+
+    ret = ad_gpo_perform_hbac_processing(state,
+                                         state->gpo_mode,
+                                         state->gpo_map_type,
+                                         state->user,
+                                         state->gpo_implicit_deny,
+                                         state->user_domain,
+                                         state->host_domain,
+                                         state->opts->idmap_ctx->map);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "HBAC processing failed: [%d](%s}\n",
+              ret, sss_strerror(ret));
+        return ret;
+    }
+
+    return EOK;
+}
+
 errno_t
 ad_gpo_access_recv(struct tevent_req *req)
 {
@@ -4590,332 +4676,199 @@ ad_gpo_process_gpo_recv(struct tevent_req *req,
     return EOK;
 }
 
-/* == ad_gpo_process_cse_send/recv helpers ================================= */
-static errno_t
-create_cse_send_buffer(TALLOC_CTX *mem_ctx,
-                       const char *smb_server,
-                       const char *smb_share,
-                       const char *smb_path,
-                       const char *smb_cse_suffix,
-                       int cached_gpt_version,
-                       struct io_buffer **io_buf)
-{
-    struct io_buffer *buf;
-    size_t rp;
-    int smb_server_length;
-    int smb_share_length;
-    int smb_path_length;
-    int smb_cse_suffix_length;
-
-    smb_server_length = strlen(smb_server);
-    smb_share_length = strlen(smb_share);
-    smb_path_length = strlen(smb_path);
-    smb_cse_suffix_length = strlen(smb_cse_suffix);
+/* == resident gpo_child handling ========================================== */
 
-    buf = talloc(mem_ctx, struct io_buffer);
-    if (buf == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc failed.\n");
-        return ENOMEM;
-    }
+/* how long an idle gpo_child is kept around for its domain controller */
+#define GPO_CHILD_IDLE_TIMEOUT 300
+/* how long the gpo_child may take to answer a single request */
+#define GPO_CHILD_EXCHANGE_TIMEOUT 60
 
-    buf->size = 5 * sizeof(uint32_t);
-    buf->size += smb_server_length + smb_share_length + smb_path_length +
-        smb_cse_suffix_length;
+struct gpo_child_exchange_state;
 
-    DEBUG(SSSDBG_TRACE_ALL, "buffer size: %zu\n", buf->size);
+/*
+ * A gpo_child keeps its SMB session to the domain controller open between
+ * requests. Requests for the same domain controller are queued and passed
+ * to the child one at a time over length-prefixed messages; the child exits
+ * when the write end of its input pipe is closed.
+ */
+struct ad_gpo_child {
+    struct ad_gpo_child *prev;
+    struct ad_gpo_child *next;
 
-    buf->data = talloc_size(buf, buf->size);
-    if (buf->data == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_size failed.\n");
-        talloc_free(buf);
-        return ENOMEM;
-    }
+    struct ad_access_ctx *access_ctx;
+    struct tevent_context *ev;
+    const char *smb_server;
+    pid_t pid;
+    struct child_io_fds *io;
+    struct sss_child_ctx_old *child_ctx;
+    struct tevent_timer *idle_timer;
 
-    rp = 0;
-    /* cached_gpt_version */
-    SAFEALIGN_SET_UINT32(&buf->data[rp], cached_gpt_version, &rp);
+    /* requests waiting for the child, the head is being processed */
+    struct gpo_child_exchange_state *queue;
+    /* no longer in access_ctx->gpo_children, new requests use another child */
+    bool closing;
+};
 
-    /* smb_server */
-    SAFEALIGN_SET_UINT32(&buf->data[rp], smb_server_length, &rp);
-    safealign_memcpy(&buf->data[rp], smb_server, smb_server_length, &rp);
+struct gpo_child_exchange_state {
+    struct gpo_child_exchange_state *prev;
+    struct gpo_child_exchange_state *next;
 
-    /* smb_share */
-    SAFEALIGN_SET_UINT32(&buf->data[rp], smb_share_length, &rp);
-    safealign_memcpy(&buf->data[rp], smb_share, smb_share_length, &rp);
+    struct tevent_context *ev;
+    struct tevent_req *req;
+    struct ad_access_ctx *access_ctx;
+    const char *smb_server;
+    struct io_buffer *io_buf;
 
-    /* smb_path */
-    SAFEALIGN_SET_UINT32(&buf->data[rp], smb_path_length, &rp);
-    safealign_memcpy(&buf->data[rp], smb_path, smb_path_length, &rp);
+    struct ad_gpo_child *child;
+    bool running;
+    struct tevent_req *subreq;
+    struct tevent_timer *timeout;
 
-    /* smb_cse_suffix */
-    SAFEALIGN_SET_UINT32(&buf->data[rp], smb_cse_suffix_length, &rp);
-    safealign_memcpy(&buf->data[rp], smb_cse_suffix, smb_cse_suffix_length, &rp);
+    uint8_t *buf;
+    ssize_t len;
+};
 
-    *io_buf = buf;
-    return EOK;
-}
+static errno_t gpo_child_exchange_dispatch(struct gpo_child_exchange_state *state);
 
-static errno_t
-ad_gpo_parse_gpo_child_response(uint8_t *buf,
-                                ssize_t size,
-                                uint32_t *_sysvol_gpt_version,
-                                uint32_t *_result)
+static int gpo_child_destructor(struct ad_gpo_child *child)
 {
+    struct gpo_child_exchange_state *state;
 
-    int ret;
-    size_t p = 0;
-    uint32_t sysvol_gpt_version;
-    uint32_t result;
-
-    /* sysvol_gpt_version */
-    SAFEALIGN_COPY_UINT32_CHECK(&sysvol_gpt_version, buf + p, size, &p);
+    if (!child->closing) {
+        DLIST_REMOVE(child->access_ctx->gpo_children, child);
+        child->closing = true;
+    }
 
-    /* operation result code */
-    SAFEALIGN_COPY_UINT32_CHECK(&result, buf + p, size, &p);
+    DLIST_FOR_EACH(state, child->queue) {
+        state->child = NULL;
+    }
 
-    *_sysvol_gpt_version = sysvol_gpt_version;
-    *_result = result;
+    if (child->child_ctx != NULL) {
+        /* stop watching the child and make sure it does not linger */
+        child_handler_destroy(child->child_ctx);
+        child->child_ctx = NULL;
+    }
 
-    ret = EOK;
-    return ret;
+    return 0;
 }
 
-/* == ad_gpo_process_cse_send/recv implementation ========================== */
-
-struct ad_gpo_process_cse_state {
-    struct tevent_context *ev;
-    struct sss_domain_info *domain;
-    int gpo_timeout_option;
-    const char *gpo_dpname;
-    const char *gpo_guid;
-    const char *smb_path;
-    const char *smb_cse_suffix;
-    const char *gpo_cache_path;
-    pid_t child_pid;
-    uint8_t *buf;
-    ssize_t len;
-    struct child_io_fds *io;
-};
-
-static errno_t gpo_fork_child(struct tevent_req *req);
-static void gpo_cse_step(struct tevent_req *subreq);
-static void gpo_cse_done(struct tevent_req *subreq);
-
 /*
- * This cse-specific function (GP_EXT_GUID_SECURITY) sends the input smb uri
- * components and cached_gpt_version to the gpo child, which, in turn,
- * will download the GPT.INI file and policy files (as needed) and store
- * them in the GPO_CACHE directory. Note that if the send_to_child input is
- * false, this function simply completes the request.
+ * Drops the child. The request it is processing fails with the given error,
+ * the requests still waiting for it are passed to a new child.
  */
-struct tevent_req *
-ad_gpo_process_cse_send(TALLOC_CTX *mem_ctx,
-                        struct tevent_context *ev,
-                        bool send_to_child,
-                        struct sss_domain_info *domain,
-                        const char *gpo_guid,
-                        const char *gpo_dpname,
-                        const char *smb_server,
-                        const char *smb_share,
-                        const char *smb_path,
-                        const char *smb_cse_suffix,
-                        int cached_gpt_version,
-                        int gpo_timeout_option)
+static void gpo_child_release(struct ad_gpo_child *child, errno_t error)
 {
-    struct tevent_req *req;
-    struct tevent_req *subreq;
-    struct ad_gpo_process_cse_state *state;
-    struct io_buffer *buf = NULL;
+    struct gpo_child_exchange_state *queue;
+    struct gpo_child_exchange_state *state;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct ad_gpo_process_cse_state);
-    if (req == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
-        return NULL;
-    }
+    queue = child->queue;
+    child->queue = NULL;
 
-    if (!send_to_child) {
-        /*
-         * if we don't need to talk to child (b/c cache timeout is still valid),
-         * we simply complete the request
-         */
-        ret = EOK;
-        goto immediately;
+    /* stop the pipe I/O before the pipes are closed */
+    DLIST_FOR_EACH(state, queue) {
+        talloc_zfree(state->subreq);
     }
+    talloc_free(child);
 
-    state->ev = ev;
-    state->buf = NULL;
-    state->len = 0;
-    state->domain = domain;
-    state->gpo_timeout_option = gpo_timeout_option;
-    state->gpo_guid = gpo_guid;
-    state->gpo_dpname = gpo_dpname;
-    state->smb_path = smb_path;
-    state->smb_cse_suffix = smb_cse_suffix;
-    state->io = talloc(state, struct child_io_fds);
-    if (state->io == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc failed.\n");
-        ret = ENOMEM;
-        goto immediately;
-    }
+    while ((state = queue) != NULL) {
+        DLIST_REMOVE(queue, state);
+        state->child = NULL;
+        talloc_zfree(state->timeout);
 
-    state->gpo_cache_path =
-        talloc_asprintf(state, "%s%s", GPO_CACHE_PATH, state->smb_path);
-    if (state->gpo_cache_path == NULL) {
-        ret = ENOMEM;
-        goto immediately;
-    }
+        /* the callbacks must not run while the queue is being walked */
+        tevent_req_defer_callback(state->req, state->ev);
 
-    state->io->write_to_child_fd = -1;
-    state->io->read_from_child_fd = -1;
-    talloc_set_destructor((void *) state->io, child_io_destructor);
+        if (state->running) {
+            state->running = false;
+            tevent_req_error(state->req, error);
+            continue;
+        }
 
-    /* prepare the data to pass to child */
-    ret = create_cse_send_buffer(state, smb_server, smb_share, smb_path,
-                                 smb_cse_suffix, cached_gpt_version, &buf);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "create_cse_send_buffer failed.\n");
-        goto immediately;
+        ret = gpo_child_exchange_dispatch(state);
+        if (ret != EOK) {
+            tevent_req_error(state->req, ret);
+        }
     }
+}
 
-    ret = gpo_fork_child(req);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "gpo_fork_child failed.\n");
-        goto immediately;
-    }
+/* Closing the input pipe makes the child exit, gpo_child_exited() frees it. */
+static void gpo_child_close(struct ad_gpo_child *child)
+{
+    DEBUG(SSSDBG_TRACE_FUNC, "Closing gpo_child [%d] for %s\n",
+          child->pid, child->smb_server);
 
-    subreq = write_pipe_send(state, ev, buf->data, buf->size,
-                             state->io->write_to_child_fd);
-    if (subreq == NULL) {
-        ret = ENOMEM;
-        goto immediately;
+    if (!child->closing) {
+        DLIST_REMOVE(child->access_ctx->gpo_children, child);
+        child->closing = true;
     }
-    tevent_req_set_callback(subreq, gpo_cse_step, req);
 
-    return req;
+    talloc_zfree(child->idle_timer);
+    PIPE_FD_CLOSE(child->io->write_to_child_fd);
+}
 
-immediately:
+static void gpo_child_exited(int child_status,
+                             struct tevent_signal *sige,
+                             void *pvt)
+{
+    struct ad_gpo_child *child = talloc_get_type(pvt, struct ad_gpo_child);
 
-    if (ret == EOK) {
-        tevent_req_done(req);
-        tevent_req_post(req, ev);
-    } else {
-        tevent_req_error(req, ret);
-        tevent_req_post(req, ev);
-    }
+    /* the signal handler context is freed by the caller */
+    child->child_ctx = NULL;
 
-    return req;
+    DEBUG(child->closing ? SSSDBG_TRACE_FUNC : SSSDBG_MINOR_FAILURE,
+          "gpo_child [%d] for %s exited\n", child->pid, child->smb_server);
+
+    gpo_child_release(child, EIO);
 }
 
-static void gpo_cse_step(struct tevent_req *subreq)
+static void gpo_child_idle_timeout(struct tevent_context *ev,
+                                   struct tevent_timer *te,
+                                   struct timeval tv,
+                                   void *pvt)
 {
-    struct tevent_req *req;
-    struct ad_gpo_process_cse_state *state;
-    int ret;
-
-    req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct ad_gpo_process_cse_state);
-
-    ret = write_pipe_recv(subreq);
-    talloc_zfree(subreq);
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
-
-    PIPE_FD_CLOSE(state->io->write_to_child_fd);
+    struct ad_gpo_child *child = talloc_get_type(pvt, struct ad_gpo_child);
 
-    subreq = read_pipe_send(state, state->ev, state->io->read_from_child_fd);
-
-    if (subreq == NULL) {
-        tevent_req_error(req, ENOMEM);
-        return;
-    }
-    tevent_req_set_callback(subreq, gpo_cse_done, req);
+    child->idle_timer = NULL;
+    gpo_child_close(child);
 }
 
-static void gpo_cse_done(struct tevent_req *subreq)
-{
-    struct tevent_req *req;
-    struct ad_gpo_process_cse_state *state;
-    uint32_t sysvol_gpt_version = -1;
-    uint32_t child_result;
-    time_t now;
-
-    req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct ad_gpo_process_cse_state);
-    int ret;
-
-    ret = read_pipe_recv(subreq, state, &state->buf, &state->len);
-    talloc_zfree(subreq);
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
-
-    PIPE_FD_CLOSE(state->io->read_from_child_fd);
-
-    ret = ad_gpo_parse_gpo_child_response(state->buf, state->len,
-                                          &sysvol_gpt_version, &child_result);
-    if (ret != EOK) {
-        if (ret == EINVAL) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "ad_gpo_parse_gpo_child_response failed: [%d][%s]. "
-                  "Broken GPO data received from AD. Check AD child logs for "
-                  "more information.\n",
-                  ret, sss_strerror(ret));
-        } else {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "ad_gpo_parse_gpo_child_response failed: [%d][%s]\n",
-                  ret, sss_strerror(ret));
-        }
-
-        tevent_req_error(req, ret);
-        return;
-    } else if (child_result != 0){
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "Error in gpo_child: [%d][%s]\n",
-              child_result, strerror(child_result));
-        tevent_req_error(req, child_result);
-        return;
-    }
-
-    now = time(NULL);
-    DEBUG(SSSDBG_TRACE_FUNC, "sysvol_gpt_version: %d\n", sysvol_gpt_version);
-    ret = sysdb_gpo_store_gpo(state->domain, state->gpo_dpname, state->gpo_guid,
-                              state->gpo_cache_path, sysvol_gpt_version,
-                              state->gpo_timeout_option, now);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Unable to store gpo cache entry: [%d](%s}\n",
-              ret, sss_strerror(ret));
-        tevent_req_error(req, ret);
-        return;
-    }
-
-    tevent_req_done(req);
-    return;
-}
-
-int ad_gpo_process_cse_recv(struct tevent_req *req)
-{
-    TEVENT_REQ_RETURN_ON_ERROR(req);
-    return EOK;
-}
-
-static errno_t
-gpo_fork_child(struct tevent_req *req)
+static errno_t gpo_child_spawn(struct ad_access_ctx *access_ctx,
+                               struct tevent_context *ev,
+                               const char *smb_server,
+                               struct ad_gpo_child **_child)
 {
     int pipefd_to_child[2] = PIPE_INIT;
     int pipefd_from_child[2] = PIPE_INIT;
+    struct ad_gpo_child *child;
     pid_t pid;
     errno_t ret;
     const char **extra_args;
     int c = 0;
-    struct ad_gpo_process_cse_state *state;
 
-    state = tevent_req_data(req, struct ad_gpo_process_cse_state);
+    child = talloc_zero(access_ctx, struct ad_gpo_child);
+    if (child == NULL) {
+        return ENOMEM;
+    }
 
-    extra_args = talloc_array(state, const char *, 2);
+    child->access_ctx = access_ctx;
+    child->ev = ev;
+    child->smb_server = talloc_strdup(child, smb_server);
+    child->io = talloc(child, struct child_io_fds);
+    if (child->smb_server == NULL || child->io == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc failed.\n");
+        ret = ENOMEM;
+        goto fail;
+    }
+    child->io->write_to_child_fd = -1;
+    child->io->read_from_child_fd = -1;
+    talloc_set_destructor((void *) child->io, child_io_destructor);
+
+    extra_args = talloc_array(child, const char *, 2);
+    if (extra_args == NULL) {
+        ret = ENOMEM;
+        goto fail;
+    }
 
     extra_args[c] = talloc_asprintf(extra_args, "--chain-id=%lu",
                                     sss_chain_id_get());
@@ -4946,7 +4899,7 @@ gpo_fork_child(struct tevent_req *req)
     pid = fork();
 
     if (pid == 0) { /* child */
-        exec_child_ex(state,
+        exec_child_ex(child,
                       pipefd_to_child, pipefd_from_child,
                       GPO_CHILD, GPO_CHILD_LOG_FILE, extra_args, false,
                       STDIN_FILENO, AD_GPO_CHILD_OUT_FILENO);
@@ -4954,15 +4907,19 @@ gpo_fork_child(struct tevent_req *req)
         /* We should never get here */
         DEBUG(SSSDBG_CRIT_FAILURE, "BUG: Could not exec gpo_child:\n");
     } else if (pid > 0) { /* parent */
-        state->child_pid = pid;
-        state->io->read_from_child_fd = pipefd_from_child[0];
+        child->pid = pid;
+        child->io->read_from_child_fd = pipefd_from_child[0];
         PIPE_FD_CLOSE(pipefd_from_child[1]);
-        state->io->write_to_child_fd = pipefd_to_child[1];
+        child->io->write_to_child_fd = pipefd_to_child[1];
         PIPE_FD_CLOSE(pipefd_to_child[0]);
-        sss_fd_nonblocking(state->io->read_from_child_fd);
-        sss_fd_nonblocking(state->io->write_to_child_fd);
-
-        ret = child_handler_setup(state->ev, pid, NULL, NULL, NULL);
+        /* the fds are owned by child->io now */
+        pipefd_from_child[0] = -1;
+        pipefd_to_child[1] = -1;
+        sss_fd_nonblocking(child->io->read_from_child_fd);
+        sss_fd_nonblocking(child->io->write_to_child_fd);
+
+        ret = child_handler_setup(ev, pid, gpo_child_exited, child,
+                                  &child->child_ctx);
         if (ret != EOK) {
             DEBUG(SSSDBG_CRIT_FAILURE,
                   "Could not set up child signal handler\n");
@@ -4975,14 +4932,582 @@ gpo_fork_child(struct tevent_req *req)
         goto fail;
     }
 
+    talloc_free(extra_args);
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Started gpo_child [%d] for %s\n",
+          child->pid, child->smb_server);
+
+    DLIST_ADD(access_ctx->gpo_children, child);
+    talloc_set_destructor(child, gpo_child_destructor);
+
+    *_child = child;
     return EOK;
 
 fail:
     PIPE_CLOSE(pipefd_from_child);
     PIPE_CLOSE(pipefd_to_child);
+    talloc_free(child);
     return ret;
 }
 
+static errno_t gpo_child_get(struct ad_access_ctx *access_ctx,
+                             struct tevent_context *ev,
+                             const char *smb_server,
+                             struct ad_gpo_child **_child)
+{
+    struct ad_gpo_child *child;
+
+    DLIST_FOR_EACH(child, access_ctx->gpo_children) {
+        if (strcasecmp(child->smb_server, smb_server) == 0) {
+            *_child = child;
+            return EOK;
+        }
+    }
+
+    return gpo_child_spawn(access_ctx, ev, smb_server, _child);
+}
+
+static void gpo_child_exchange_timeout(struct tevent_context *ev,
+                                       struct tevent_timer *te,
+                                       struct timeval tv,
+                                       void *pvt);
+static void gpo_child_exchange_written(struct tevent_req *subreq);
+static void gpo_child_exchange_read(struct tevent_req *subreq);
+
+static errno_t gpo_child_exchange_start(struct gpo_child_exchange_state *state)
+{
+    struct tevent_req *subreq;
+    struct timeval tv;
+
+    subreq = write_pipe_safe_send(state, state->ev, state->io_buf->data,
+                                  state->io_buf->size,
+                                  state->child->io->write_to_child_fd);
+    if (subreq == NULL) {
+        return ENOMEM;
+    }
+    tevent_req_set_callback(subreq, gpo_child_exchange_written, state->req);
+
+    tv = tevent_timeval_current_ofs(GPO_CHILD_EXCHANGE_TIMEOUT, 0);
+    state->timeout = tevent_add_timer(state->ev, state, tv,
+                                      gpo_child_exchange_timeout, state->req);
+    if (state->timeout == NULL) {
+        talloc_free(subreq);
+        return ENOMEM;
+    }
+
+    state->subreq = subreq;
+    state->running = true;
+    return EOK;
+}
+
+/* Starts the next waiting request or lets an idle child time out. */
+static void gpo_child_next(struct ad_gpo_child *child)
+{
+    struct gpo_child_exchange_state *state;
+    struct timeval tv;
+    errno_t ret;
+
+    talloc_zfree(child->idle_timer);
+
+    while ((state = child->queue) != NULL) {
+        ret = gpo_child_exchange_start(state);
+        if (ret == EOK) {
+            return;
+        }
+
+        DLIST_REMOVE(child->queue, state);
+        state->child = NULL;
+        tevent_req_defer_callback(state->req, state->ev);
+        tevent_req_error(state->req, ret);
+    }
+
+    if (child->closing) {
+        return;
+    }
+
+    tv = tevent_timeval_current_ofs(GPO_CHILD_IDLE_TIMEOUT, 0);
+    child->idle_timer = tevent_add_timer(child->ev, child, tv,
+                                         gpo_child_idle_timeout, child);
+    if (child->idle_timer == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot set up idle timer.\n");
+        gpo_child_close(child);
+    }
+}
+
+static int
+gpo_child_exchange_state_destructor(struct gpo_child_exchange_state *state)
+{
+    struct ad_gpo_child *child = state->child;
+
+    if (child == NULL) {
+        return 0;
+    }
+
+    DLIST_REMOVE(child->queue, state);
+    state->child = NULL;
+
+    if (state->running) {
+        /* the caller went away in the middle of an exchange, the child's
+         * answer can't be told apart from the next one anymore */
+        talloc_zfree(state->subreq);
+        gpo_child_release(child, ECANCELED);
+    }
+
+    return 0;
+}
+
+static errno_t gpo_child_exchange_dispatch(struct gpo_child_exchange_state *state)
+{
+    struct ad_gpo_child *child;
+    errno_t ret;
+
+    ret = gpo_child_get(state->access_ctx, state->ev, state->smb_server,
+                        &child);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to start gpo_child for %s "
+              "[%d]: %s\n", state->smb_server, ret, sss_strerror(ret));
+        return ret;
+    }
+
+    state->child = child;
+    DLIST_ADD_END(child->queue, state, struct gpo_child_exchange_state *);
+
+    if (child->queue == state) {
+        gpo_child_next(child);
+    }
+
+    return EOK;
+}
+
+/*
+ * Sends a request to the gpo_child for smb_server and returns its answer.
+ * A new child is started if there is none for the server yet.
+ */
+static struct tevent_req *
+gpo_child_exchange_send(TALLOC_CTX *mem_ctx,
+                        struct tevent_context *ev,
+                        struct ad_access_ctx *access_ctx,
+                        const char *smb_server,
+                        struct io_buffer *io_buf)
+{
+    struct tevent_req *req;
+    struct gpo_child_exchange_state *state;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct gpo_child_exchange_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->req = req;
+    state->access_ctx = access_ctx;
+    state->smb_server = smb_server;
+    state->io_buf = io_buf;
+    talloc_set_destructor(state, gpo_child_exchange_state_destructor);
+
+    ret = gpo_child_exchange_dispatch(state);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void gpo_child_exchange_timeout(struct tevent_context *ev,
+                                       struct tevent_timer *te,
+                                       struct timeval tv,
+                                       void *pvt)
+{
+    struct tevent_req *req = talloc_get_type(pvt, struct tevent_req);
+    struct gpo_child_exchange_state *state;
+
+    state = tevent_req_data(req, struct gpo_child_exchange_state);
+    state->timeout = NULL;
+
+    DEBUG(SSSDBG_CRIT_FAILURE,
+          "gpo_child [%d] for %s did not answer in time, terminating it\n",
+          state->child->pid, state->smb_server);
+
+    gpo_child_release(state->child, ETIMEDOUT);
+}
+
+static void gpo_child_exchange_written(struct tevent_req *subreq)
+{
+    struct tevent_req *req;
+    struct gpo_child_exchange_state *state;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct gpo_child_exchange_state);
+
+    ret = write_pipe_safe_recv(subreq);
+    talloc_zfree(subreq);
+    state->subreq = NULL;
+    if (ret != EOK) {
+        gpo_child_release(state->child, ret);
+        return;
+    }
+
+    subreq = read_pipe_safe_send(state, state->ev,
+                                 state->child->io->read_from_child_fd);
+    if (subreq == NULL) {
+        gpo_child_release(state->child, ENOMEM);
+        return;
+    }
+    tevent_req_set_callback(subreq, gpo_child_exchange_read, req);
+    state->subreq = subreq;
+}
+
+static void gpo_child_exchange_read(struct tevent_req *subreq)
+{
+    struct tevent_req *req;
+    struct gpo_child_exchange_state *state;
+    struct ad_gpo_child *child;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct gpo_child_exchange_state);
+
+    ret = read_pipe_safe_recv(subreq, state, &state->buf, &state->len);
+    talloc_zfree(subreq);
+    state->subreq = NULL;
+    if (ret != EOK) {
+        gpo_child_release(state->child, ret);
+        return;
+    }
+
+    child = state->child;
+    DLIST_REMOVE(child->queue, state);
+    state->child = NULL;
+    state->running = false;
+    talloc_zfree(state->timeout);
+
+    gpo_child_next(child);
+
+    tevent_req_done(req);
+}
+
+static errno_t gpo_child_exchange_recv(struct tevent_req *req,
+                                       TALLOC_CTX *mem_ctx,
+                                       uint8_t **_buf,
+                                       ssize_t *_len)
+{
+    struct gpo_child_exchange_state *state;
+
+    state = tevent_req_data(req, struct gpo_child_exchange_state);
+
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    *_buf = talloc_steal(mem_ctx, state->buf);
+    *_len = state->len;
+
+    return EOK;
+}
+
+/* == ad_gpo_process_cse_send/recv helpers ================================= */
+static errno_t
+create_cse_send_buffer(TALLOC_CTX *mem_ctx,
+                       const char *smb_server,
+                       struct gp_gpo **gpos,
+                       int num_gpos,
+                       const char *smb_cse_suffix,
+                       struct io_buffer **io_buf)
+{
+    struct io_buffer *buf;
+    size_t rp;
+    int smb_server_length;
+    int smb_share_length;
+    int smb_path_length;
+    int smb_cse_suffix_length;
+    int i;
+
+    smb_server_length = strlen(smb_server);
+    smb_cse_suffix_length = strlen(smb_cse_suffix);
+
+    buf = talloc(mem_ctx, struct io_buffer);
+    if (buf == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc failed.\n");
+        return ENOMEM;
+    }
+
+    buf->size = 2 * sizeof(uint32_t) + smb_server_length;
+    for (i = 0; i < num_gpos; i++) {
+        buf->size += 4 * sizeof(uint32_t);
+        buf->size += strlen(gpos[i]->smb_share) + strlen(gpos[i]->smb_path) +
+            smb_cse_suffix_length;
+    }
+
+    DEBUG(SSSDBG_TRACE_ALL, "buffer size: %zu\n", buf->size);
+
+    buf->data = talloc_size(buf, buf->size);
+    if (buf->data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_size failed.\n");
+        talloc_free(buf);
+        return ENOMEM;
+    }
+
+    rp = 0;
+    /* num_gpos */
+    SAFEALIGN_SET_UINT32(&buf->data[rp], num_gpos, &rp);
+
+    /* smb_server */
+    SAFEALIGN_SET_UINT32(&buf->data[rp], smb_server_length, &rp);
+    safealign_memcpy(&buf->data[rp], smb_server, smb_server_length, &rp);
+
+    for (i = 0; i < num_gpos; i++) {
+        smb_share_length = strlen(gpos[i]->smb_share);
+        smb_path_length = strlen(gpos[i]->smb_path);
+
+        /* cached_gpt_version */
+        SAFEALIGN_SET_UINT32(&buf->data[rp], gpos[i]->cached_gpt_version, &rp);
+
+        /* smb_share */
+        SAFEALIGN_SET_UINT32(&buf->data[rp], smb_share_length, &rp);
+        safealign_memcpy(&buf->data[rp], gpos[i]->smb_share, smb_share_length,
+                         &rp);
+
+        /* smb_path */
+        SAFEALIGN_SET_UINT32(&buf->data[rp], smb_path_length, &rp);
+        safealign_memcpy(&buf->data[rp], gpos[i]->smb_path, smb_path_length,
+                         &rp);
+
+        /* smb_cse_suffix */
+        SAFEALIGN_SET_UINT32(&buf->data[rp], smb_cse_suffix_length, &rp);
+        safealign_memcpy(&buf->data[rp], smb_cse_suffix, smb_cse_suffix_length,
+                         &rp);
+    }
+
+    *io_buf = buf;
+    return EOK;
+}
+
+struct gpo_child_result {
+    uint32_t sysvol_gpt_version;
+    uint32_t policy_updated;
+    uint32_t result;
+};
+
+static errno_t
+ad_gpo_parse_gpo_child_response(uint8_t *buf,
+                                ssize_t size,
+                                int num_gpos,
+                                struct gpo_child_result *results)
+{
+    size_t p = 0;
+    uint32_t num_results;
+    int i;
+
+    /* num_gpos */
+    SAFEALIGN_COPY_UINT32_CHECK(&num_results, buf + p, size, &p);
+    if (num_results != (uint32_t) num_gpos) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Expected results for %d GPOs, got %u\n",
+              num_gpos, num_results);
+        return EINVAL;
+    }
+
+    for (i = 0; i < num_gpos; i++) {
+        /* sysvol_gpt_version */
+        SAFEALIGN_COPY_UINT32_CHECK(&results[i].sysvol_gpt_version, buf + p,
+                                    size, &p);
+
+        /* policy file was updated */
+        SAFEALIGN_COPY_UINT32_CHECK(&results[i].policy_updated, buf + p,
+                                    size, &p);
+
+        /* operation result code */
+        SAFEALIGN_COPY_UINT32_CHECK(&results[i].result, buf + p, size, &p);
+    }
+
+    if (p != size) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected data after the last result.\n");
+        return EINVAL;
+    }
+
+    return EOK;
+}
+
+/* == ad_gpo_process_cse_send/recv implementation ========================== */
+
+struct ad_gpo_process_cse_state {
+    struct tevent_context *ev;
+    struct sss_domain_info *domain;
+    int gpo_timeout_option;
+    struct gp_gpo **gpos;
+    int num_gpos;
+    uint8_t *buf;
+    ssize_t len;
+};
+
+static void gpo_cse_done(struct tevent_req *subreq);
+
+/*
+ * This cse-specific function (GP_EXT_GUID_SECURITY) sends the input smb uri
+ * components and cached_gpt_versions of a batch of GPOs stored on smb_server
+ * to the gpo child, which, in turn, will download the GPT.INI files and
+ * policy files (as needed) and store them in the GPO_CACHE directory.
+ */
+struct tevent_req *
+ad_gpo_process_cse_send(TALLOC_CTX *mem_ctx,
+                        struct tevent_context *ev,
+                        struct ad_access_ctx *access_ctx,
+                        struct sss_domain_info *domain,
+                        const char *smb_server,
+                        struct gp_gpo **gpos,
+                        int num_gpos,
+                        const char *smb_cse_suffix,
+                        int gpo_timeout_option)
+{
+    struct tevent_req *req;
+    struct tevent_req *subreq;
+    struct ad_gpo_process_cse_state *state;
+    struct io_buffer *buf = NULL;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct ad_gpo_process_cse_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_req_create() failed\n");
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->buf = NULL;
+    state->len = 0;
+    state->domain = domain;
+    state->gpo_timeout_option = gpo_timeout_option;
+    state->gpos = gpos;
+    state->num_gpos = num_gpos;
+
+    /* prepare the data to pass to child */
+    ret = create_cse_send_buffer(state, smb_server, gpos, num_gpos,
+                                 smb_cse_suffix, &buf);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "create_cse_send_buffer failed.\n");
+        goto immediately;
+    }
+
+    subreq = gpo_child_exchange_send(state, ev, access_ctx, smb_server, buf);
+    if (subreq == NULL) {
+        ret = ENOMEM;
+        goto immediately;
+    }
+    tevent_req_set_callback(subreq, gpo_cse_done, req);
+
+    return req;
+
+immediately:
+
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+static void gpo_cse_done(struct tevent_req *subreq)
+{
+    struct tevent_req *req;
+    struct ad_gpo_process_cse_state *state;
+    struct gpo_child_result *results;
+    struct gp_gpo *gpo;
+    const char *gpo_cache_path;
+    errno_t child_error = EOK;
+    time_t now;
+    int i;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct ad_gpo_process_cse_state);
+    int ret;
+
+    ret = gpo_child_exchange_recv(subreq, state, &state->buf, &state->len);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    results = talloc_zero_array(state, struct gpo_child_result,
+                                state->num_gpos);
+    if (results == NULL) {
+        tevent_req_error(req, ENOMEM);
+        return;
+    }
+
+    ret = ad_gpo_parse_gpo_child_response(state->buf, state->len,
+                                          state->num_gpos, results);
+    if (ret != EOK) {
+        if (ret == EINVAL) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "ad_gpo_parse_gpo_child_response failed: [%d][%s]. "
+                  "Broken GPO data received from AD. Check AD child logs for "
+                  "more information.\n",
+                  ret, sss_strerror(ret));
+        } else {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "ad_gpo_parse_gpo_child_response failed: [%d][%s]\n",
+                  ret, sss_strerror(ret));
+        }
+
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    now = time(NULL);
+    for (i = 0; i < state->num_gpos; i++) {
+        gpo = state->gpos[i];
+
+        if (results[i].result != 0) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Error in gpo_child for GPO %s: [%d][%s]\n",
+                  gpo->gpo_guid, results[i].result,
+                  strerror(results[i].result));
+            if (child_error == EOK) {
+                child_error = results[i].result;
+            }
+            continue;
+        }
+
+        DEBUG(SSSDBG_TRACE_FUNC, "GPO %s: sysvol_gpt_version: %d, "
+              "policy file %s\n", gpo->gpo_guid,
+              results[i].sysvol_gpt_version,
+              results[i].policy_updated ? "updated" : "unchanged");
+
+        gpo_cache_path = talloc_asprintf(state, "%s%s", GPO_CACHE_PATH,
+                                         gpo->smb_path);
+        if (gpo_cache_path == NULL) {
+            tevent_req_error(req, ENOMEM);
+            return;
+        }
+
+        ret = sysdb_gpo_store_gpo(state->domain, gpo->gpo_dpname,
+                                  gpo->gpo_guid, gpo_cache_path,
+                                  results[i].sysvol_gpt_version,
+                                  state->gpo_timeout_option, now);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Unable to store gpo cache entry: [%d](%s}\n",
+                  ret, sss_strerror(ret));
+            tevent_req_error(req, ret);
+            return;
+        }
+    }
+
+    if (child_error != EOK) {
+        tevent_req_error(req, child_error);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+int ad_gpo_process_cse_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+    return EOK;
+}
+
 struct ad_gpo_get_sd_referral_state {
     struct tevent_context *ev;
     struct ad_access_ctx *access_ctx;
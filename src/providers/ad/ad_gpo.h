@@ -63,4 +63,35 @@ ad_gpo_access_send(TALLOC_CTX *mem_ctx,
 
 errno_t ad_gpo_access_recv(struct tevent_req *req);
 
+/* Batch requests and replies exchanged with gpo_child, see
+ * ad_gpo_child_utils.c for the wire format. */
+struct gpo_child_input_gpo {
+    int cached_gpt_version;
+    const char *smb_share;
+    const char *smb_path;
+    const char *smb_cse_suffix;
+};
+
+struct gpo_child_input {
+    const char *smb_server;
+    uint32_t num_gpos;
+    struct gpo_child_input_gpo *gpos;
+};
+
+struct gpo_child_output {
+    int sysvol_gpt_version;
+    bool policy_updated;
+    int result;
+};
+
+struct response;
+
+errno_t ad_gpo_child_unpack_request(uint8_t *buf,
+                                    size_t size,
+                                    struct gpo_child_input *ibuf);
+
+errno_t ad_gpo_child_pack_response(struct response *r,
+                                   struct gpo_child_output *out,
+                                   uint32_t num_gpos);
+
 #endif /* AD_GPO_H_ */
@@ -42,117 +42,13 @@
 
 errno_t ad_gpo_parse_ini_file(const char *smb_path, int *_gpt_version);
 
-struct input_buffer {
-    int cached_gpt_version;
-    const char *smb_server;
-    const char *smb_share;
-    const char *smb_path;
-    const char *smb_cse_suffix;
-};
-
-static errno_t
-unpack_buffer(uint8_t *buf,
-              size_t size,
-              struct input_buffer *ibuf)
-{
-    size_t p = 0;
-    uint32_t len;
-    uint32_t cached_gpt_version;
-
-    /* cached_gpt_version */
-    SAFEALIGN_COPY_UINT32_CHECK(&cached_gpt_version, buf + p, size, &p);
-    DEBUG(SSSDBG_TRACE_FUNC, "cached_gpt_version: %d\n", cached_gpt_version);
-    ibuf->cached_gpt_version = cached_gpt_version;
-
-    /* smb_server */
-    SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
-    DEBUG(SSSDBG_TRACE_ALL, "smb_server length: %d\n", len);
-    if (len == 0) {
-        return EINVAL;
-    } else {
-        if (len > size - p) return EINVAL;
-        ibuf->smb_server = talloc_strndup(ibuf, (char *)(buf + p), len);
-        if (ibuf->smb_server == NULL) return ENOMEM;
-        DEBUG(SSSDBG_TRACE_ALL, "smb_server: %s\n", ibuf->smb_server);
-        p += len;
-    }
-
-    /* smb_share */
-    SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
-    DEBUG(SSSDBG_TRACE_ALL, "smb_share length: %d\n", len);
-    if (len == 0) {
-        return EINVAL;
-    } else {
-        if (len > size - p) return EINVAL;
-        ibuf->smb_share = talloc_strndup(ibuf, (char *)(buf + p), len);
-        if (ibuf->smb_share == NULL) return ENOMEM;
-        DEBUG(SSSDBG_TRACE_ALL, "smb_share: %s\n", ibuf->smb_share);
-        p += len;
-    }
-
-    /* smb_path */
-    SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
-    DEBUG(SSSDBG_TRACE_ALL, "smb_path length: %d\n", len);
-    if (len == 0) {
-        return EINVAL;
-    } else {
-        if (len > size - p) return EINVAL;
-        ibuf->smb_path = talloc_strndup(ibuf, (char *)(buf + p), len);
-        if (ibuf->smb_path == NULL) return ENOMEM;
-        DEBUG(SSSDBG_TRACE_ALL, "smb_path: %s\n", ibuf->smb_path);
-        p += len;
-    }
-
-    /* smb_cse_suffix */
-    SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
-    DEBUG(SSSDBG_TRACE_ALL, "smb_cse_suffix length: %d\n", len);
-    if (len == 0) {
-        return EINVAL;
-    } else {
-        if (len > size - p) return EINVAL;
-        ibuf->smb_cse_suffix = talloc_strndup(ibuf, (char *)(buf + p), len);
-        if (ibuf->smb_cse_suffix == NULL) return ENOMEM;
-        DEBUG(SSSDBG_TRACE_ALL, "smb_cse_suffix: %s\n", ibuf->smb_cse_suffix);
-        p += len;
-    }
-
-    return EOK;
-}
-
-
-static errno_t
-pack_buffer(struct response *r,
-            int sysvol_gpt_version,
-            int result)
-{
-    size_t p = 0;
-
-    /* A buffer with the following structure must be created:
-     *   uint32_t sysvol_gpt_version (required)
-     *   uint32_t status of the request (required)
-     */
-    r->size = 2 * sizeof(uint32_t);
-
-    r->buf = talloc_array(r, uint8_t, r->size);
-    if(r->buf == NULL) {
-        return ENOMEM;
-    }
-
-    DEBUG(SSSDBG_TRACE_FUNC, "result [%d]\n", result);
-
-    /* sysvol_gpt_version */
-    SAFEALIGN_SET_UINT32(&r->buf[p], sysvol_gpt_version, &p);
-
-    /* result */
-    SAFEALIGN_SET_UINT32(&r->buf[p], result, &p);
-
-    return EOK;
-}
+/* Upper bound for a single batch request read from the backend */
+#define GPO_CHILD_MAX_REQUEST_SIZE (1024 * 1024)
 
 static errno_t
 prepare_response(TALLOC_CTX *mem_ctx,
-                 int sysvol_gpt_version,
-                 int result,
+                 struct gpo_child_output *out,
+                 uint32_t num_gpos,
                  struct response **rsp)
 {
     int ret;
@@ -166,9 +62,9 @@ prepare_response(TALLOC_CTX *mem_ctx,
     r->buf = NULL;
     r->size = 0;
 
-    ret = pack_buffer(r, sysvol_gpt_version, result);
+    ret = ad_gpo_child_pack_response(r, out, num_gpos);
     if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "pack_buffer failed\n");
+        DEBUG(SSSDBG_CRIT_FAILURE, "ad_gpo_child_pack_response failed\n");
         return ret;
     }
 
@@ -559,6 +455,7 @@ copy_smb_file_to_gpo_cache(SMBCCTX *smbc_ctx,
  *   - it doesn't retrieve the policy file
  *   - in this case, the backend will use the existing policy file in GPO_CACHE
  * - it returns the sysvol_gpt_version in the _sysvol_gpt_version output param
+ *   and whether the policy file in GPO_CACHE changed in _policy_updated
  *
  * Note that if the cached_gpt_version sent by the backend is -1 (to indicate
  * that no gpt_version has been set in the cache for the corresponding gpo_guid),
@@ -570,16 +467,18 @@ copy_smb_file_to_gpo_cache(SMBCCTX *smbc_ctx,
  * - backend will read the policy file from the GPO_CACHE
  */
 static errno_t
-perform_smb_operations(int cached_gpt_version,
+perform_smb_operations(SMBCCTX *smbc_ctx,
+                       int cached_gpt_version,
                        const char *smb_server,
                        const char *smb_share,
                        const char *smb_path,
                        const char *smb_cse_suffix,
-                       int *_sysvol_gpt_version)
+                       int *_sysvol_gpt_version,
+                       bool *_policy_updated)
 {
-    SMBCCTX *smbc_ctx;
     int ret;
     int sysvol_gpt_version = -1;
+    bool policy_updated = false;
     char *ini_filename = NULL;
     TALLOC_CTX *tmp_ctx = NULL;
 
@@ -588,25 +487,6 @@ perform_smb_operations(int cached_gpt_version,
         return ENOMEM;
     }
 
-    smbc_ctx = smbc_new_context();
-    if (smbc_ctx == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Could not allocate new smbc context\n");
-        ret = ENOMEM;
-        goto done;
-    }
-
-    smbc_setOptionDebugToStderr(smbc_ctx, true);
-    smbc_setFunctionAuthDataWithContext(smbc_ctx, sssd_krb_get_auth_data_fn);
-    smbc_setOptionUseKerberos(smbc_ctx, true);
-    smbc_setOptionFallbackAfterKerberos(smbc_ctx, false);
-
-    /* Initialize the context using the previously specified options */
-    if (smbc_init_context(smbc_ctx) == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Could not initialize smbc context\n");
-        ret = ENOMEM;
-        goto done;
-    }
-
     /* download ini file */
     ret = copy_smb_file_to_gpo_cache(smbc_ctx, smb_server, smb_share, smb_path,
                                      GPT_INI, false);
@@ -633,6 +513,13 @@ perform_smb_operations(int cached_gpt_version,
 
     DEBUG(SSSDBG_TRACE_FUNC, "sysvol_gpt_version: %d\n", sysvol_gpt_version);
 
+    if (sysvol_gpt_version < 0) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "get sysvol_gpt_version failed. [%d].\n", sysvol_gpt_version);
+        ret = EINVAL;
+        goto done;
+    }
+
     if (sysvol_gpt_version > cached_gpt_version) {
         /* download policy file */
         ret = copy_smb_file_to_gpo_cache(smbc_ctx, smb_server, smb_share,
@@ -643,17 +530,179 @@ perform_smb_operations(int cached_gpt_version,
                   ret, strerror(ret));
             goto done;
         }
+        policy_updated = true;
         ret = EOK;
     }
 
     *_sysvol_gpt_version = sysvol_gpt_version;
+    *_policy_updated = policy_updated;
 
  done:
     talloc_free(tmp_ctx);
-    smbc_free_context(smbc_ctx, 0);
     return ret;
 }
 
+static SMBCCTX *
+smb_context_new(void)
+{
+    SMBCCTX *smbc_ctx;
+
+    smbc_ctx = smbc_new_context();
+    if (smbc_ctx == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not allocate new smbc context\n");
+        return NULL;
+    }
+
+    smbc_setOptionDebugToStderr(smbc_ctx, true);
+    smbc_setFunctionAuthDataWithContext(smbc_ctx, sssd_krb_get_auth_data_fn);
+    smbc_setOptionUseKerberos(smbc_ctx, true);
+    smbc_setOptionFallbackAfterKerberos(smbc_ctx, false);
+
+    /* Initialize the context using the previously specified options */
+    if (smbc_init_context(smbc_ctx) == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not initialize smbc context\n");
+        smbc_free_context(smbc_ctx, 1);
+        return NULL;
+    }
+
+    return smbc_ctx;
+}
+
+/*
+ * Returns true if the error indicates that the SMB session itself is unusable,
+ * i.e. the connection to the DC was lost or the authentication was rejected,
+ * as opposed to an error specific to a single file like ENOENT.
+ */
+static bool
+smb_session_error(errno_t ret)
+{
+    switch (ret) {
+    case ECONNREFUSED:
+    case ECONNRESET:
+    case ECONNABORTED:
+    case ENOTCONN:
+    case EPIPE:
+    case ETIMEDOUT:
+    case EHOSTUNREACH:
+    case ENETUNREACH:
+    case ENETDOWN:
+    case EACCES:
+    case EPERM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Processes every GPO of a batch request. The smbc context, and with it the
+ * authenticated SMB session to the domain controller, is kept in *_smbc_ctx
+ * across requests. A session that was reused from an earlier request may
+ * have gone stale in the meantime (e.g. the DC dropped an idle connection or
+ * the Kerberos ticket it was set up with expired), so a GPO failing with a
+ * connection or authentication error is retried once with a fresh context
+ * before its error is reported. Other errors keep the session.
+ */
+static void
+process_batch(SMBCCTX **_smbc_ctx,
+              struct gpo_child_input *ibuf,
+              struct gpo_child_output *out)
+{
+    struct gpo_child_input_gpo *gpo;
+    bool fresh;
+    uint32_t i;
+    errno_t ret;
+
+    for (i = 0; i < ibuf->num_gpos; i++) {
+        gpo = &ibuf->gpos[i];
+        fresh = false;
+
+        do {
+            if (*_smbc_ctx == NULL) {
+                *_smbc_ctx = smb_context_new();
+                if (*_smbc_ctx == NULL) {
+                    ret = ENOMEM;
+                    break;
+                }
+                fresh = true;
+            }
+
+            ret = perform_smb_operations(*_smbc_ctx,
+                                         gpo->cached_gpt_version,
+                                         ibuf->smb_server,
+                                         gpo->smb_share,
+                                         gpo->smb_path,
+                                         gpo->smb_cse_suffix,
+                                         &out[i].sysvol_gpt_version,
+                                         &out[i].policy_updated);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "perform_smb_operations failed.[%d][%s].\n",
+                      ret, strerror(ret));
+                if (!smb_session_error(ret)) {
+                    break;
+                }
+                smbc_free_context(*_smbc_ctx, 1);
+                *_smbc_ctx = NULL;
+            }
+        } while (ret != EOK && !fresh);
+
+        out[i].result = ret;
+    }
+}
+
+/*
+ * Reads one length-prefixed request from the backend. ENOENT is returned
+ * if the backend closed the pipe, which tells the child to exit.
+ */
+static errno_t
+read_request(TALLOC_CTX *mem_ctx, uint8_t **_buf, size_t *_len)
+{
+    uint32_t ulen;
+    ssize_t len;
+    uint8_t *buf;
+    errno_t ret;
+
+    errno = 0;
+    len = sss_atomic_read_s(STDIN_FILENO, &ulen, sizeof(uint32_t));
+    if (len == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "read failed [%d][%s].\n", ret, strerror(ret));
+        return ret;
+    } else if (len == 0) {
+        return ENOENT;
+    } else if (len != sizeof(uint32_t)) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Short read of request header.\n");
+        return EIO;
+    }
+
+    if (ulen == 0 || ulen > GPO_CHILD_MAX_REQUEST_SIZE) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Invalid request size [%u].\n", ulen);
+        return EINVAL;
+    }
+
+    buf = talloc_size(mem_ctx, ulen);
+    if (buf == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_size failed.\n");
+        return ENOMEM;
+    }
+
+    errno = 0;
+    len = sss_atomic_read_s(STDIN_FILENO, buf, ulen);
+    if (len == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE, "read failed [%d][%s].\n", ret, strerror(ret));
+        return ret;
+    } else if (len != ulen) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Expected %u bytes, read %zd\n", ulen, len);
+        return EIO;
+    }
+
+    *_buf = buf;
+    *_len = ulen;
+    return EOK;
+}
+
 int
 main(int argc, const char *argv[])
 {
@@ -664,12 +713,13 @@ main(int argc, const char *argv[])
     long chain_id = 0;
     const char *opt_logger = NULL;
     errno_t ret;
-    int sysvol_gpt_version = -1;
-    int result;
     TALLOC_CTX *main_ctx = NULL;
+    TALLOC_CTX *req_ctx = NULL;
+    SMBCCTX *smbc_ctx = NULL;
     uint8_t *buf = NULL;
-    ssize_t len = 0;
-    struct input_buffer *ibuf = NULL;
+    size_t len = 0;
+    struct gpo_child_input *ibuf = NULL;
+    struct gpo_child_output *out = NULL;
     struct response *resp = NULL;
     ssize_t written;
 
@@ -734,89 +784,90 @@ main(int argc, const char *argv[])
     }
     talloc_steal(main_ctx, debug_prg_name);
 
-    buf = talloc_size(main_ctx, sizeof(uint8_t)*IN_BUF_SIZE);
-    if (buf == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_size failed.\n");
-        goto fail;
-    }
+    DEBUG(SSSDBG_TRACE_FUNC, "context initialized\n");
 
-    ibuf = talloc_zero(main_ctx, struct input_buffer);
-    if (ibuf == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
-        goto fail;
-    }
+    /* The backend keeps the child around for the domain controller and sends
+     * one batch request after another until it closes the pipe. */
+    while (true) {
+        talloc_zfree(req_ctx);
+        req_ctx = talloc_new(main_ctx);
+        if (req_ctx == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_new failed.\n");
+            goto fail;
+        }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "context initialized\n");
+        ret = read_request(req_ctx, &buf, &len);
+        if (ret == ENOENT) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Backend closed the pipe.\n");
+            break;
+        } else if (ret != EOK) {
+            goto fail;
+        }
 
-    errno = 0;
-    len = sss_atomic_read_s(STDIN_FILENO, buf, IN_BUF_SIZE);
-    if (len == -1) {
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE, "read failed [%d][%s].\n", ret, strerror(ret));
-        goto fail;
-    }
+        ibuf = talloc_zero(req_ctx, struct gpo_child_input);
+        if (ibuf == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
+            goto fail;
+        }
 
-    close(STDIN_FILENO);
+        ret = ad_gpo_child_unpack_request(buf, len, ibuf);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "ad_gpo_child_unpack_request failed.[%d][%s].\n", ret, strerror(ret));
+            goto fail;
+        }
 
-    ret = unpack_buffer(buf, len, ibuf);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "unpack_buffer failed.[%d][%s].\n", ret, strerror(ret));
-        goto fail;
-    }
+        out = talloc_zero_array(req_ctx, struct gpo_child_output, ibuf->num_gpos);
+        if (out == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero_array failed.\n");
+            goto fail;
+        }
 
-    DEBUG(SSSDBG_TRACE_FUNC, "performing smb operations\n");
+        DEBUG(SSSDBG_TRACE_FUNC, "performing smb operations\n");
 
-    result = perform_smb_operations(ibuf->cached_gpt_version,
-                                    ibuf->smb_server,
-                                    ibuf->smb_share,
-                                    ibuf->smb_path,
-                                    ibuf->smb_cse_suffix,
-                                    &sysvol_gpt_version);
-    if (result != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "perform_smb_operations failed.[%d][%s].\n",
-              result, strerror(result));
-        goto fail;
-    }
+        process_batch(&smbc_ctx, ibuf, out);
 
-    if (sysvol_gpt_version < 0) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "get sysvol_gpt_version failed. [%d].\n",
-              sysvol_gpt_version);
-        goto fail;
-    }
+        ret = prepare_response(req_ctx, out, ibuf->num_gpos, &resp);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "prepare_response failed. [%d][%s].\n",
+                        ret, strerror(ret));
+            goto fail;
+        }
 
-    ret = prepare_response(main_ctx, sysvol_gpt_version, result, &resp);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "prepare_response failed. [%d][%s].\n",
-                    ret, strerror(ret));
-        goto fail;
-    }
+        errno = 0;
 
-    errno = 0;
+        written = sss_atomic_write_safe_s(AD_GPO_CHILD_OUT_FILENO,
+                                          resp->buf, resp->size);
+        if (written == -1) {
+            ret = errno;
+            DEBUG(SSSDBG_CRIT_FAILURE, "write failed [%d][%s].\n", ret,
+                        strerror(ret));
+            goto fail;
+        }
 
-    written = sss_atomic_write_s(AD_GPO_CHILD_OUT_FILENO, resp->buf, resp->size);
-    if (written == -1) {
-        ret = errno;
-        DEBUG(SSSDBG_CRIT_FAILURE, "write failed [%d][%s].\n", ret,
-                    strerror(ret));
-        goto fail;
-    }
+        if (written != resp->size) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Expected to write %zu bytes, wrote %zu\n",
+                  resp->size, written);
+            goto fail;
+        }
 
-    if (written != resp->size) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "Expected to write %zu bytes, wrote %zu\n",
-              resp->size, written);
-        goto fail;
+        DEBUG(SSSDBG_TRACE_FUNC, "batch of %u GPOs processed\n",
+              ibuf->num_gpos);
     }
 
     DEBUG(SSSDBG_TRACE_FUNC, "gpo_child completed successfully\n");
+    if (smbc_ctx != NULL) {
+        smbc_free_context(smbc_ctx, 1);
+    }
     close(AD_GPO_CHILD_OUT_FILENO);
     talloc_free(main_ctx);
     return EXIT_SUCCESS;
 
 fail:
     DEBUG(SSSDBG_CRIT_FAILURE, "gpo_child failed!\n");
+    if (smbc_ctx != NULL) {
+        smbc_free_context(smbc_ctx, 1);
+    }
     close(AD_GPO_CHILD_OUT_FILENO);
     talloc_free(main_ctx);
     return EXIT_FAILURE;
@@ -31,6 +31,8 @@
 #include "util/util_errors.h"
 #include "util/debug.h"
 #include "util/atomic_io.h"
+#include "util/child_common.h"
+#include "providers/ad/ad_gpo.h"
 
 #define INI_GENERAL_SECTION "General"
 #define GPT_INI_VERSION "Version"
@@ -240,3 +242,149 @@ errno_t ad_gpo_parse_ini_file(const char *ini_filename, int *_gpt_version)
     talloc_free(tmp_ctx);
     return ret;
 }
+
+static errno_t
+unpack_string(TALLOC_CTX *mem_ctx,
+              uint8_t *buf,
+              size_t size,
+              size_t *_p,
+              const char *name,
+              const char **_str)
+{
+    size_t p = *_p;
+    uint32_t len;
+    const char *str;
+
+    SAFEALIGN_COPY_UINT32_CHECK(&len, buf + p, size, &p);
+    DEBUG(SSSDBG_TRACE_ALL, "%s length: %d\n", name, len);
+    if (len == 0 || len > size - p) {
+        return EINVAL;
+    }
+
+    str = talloc_strndup(mem_ctx, (char *)(buf + p), len);
+    if (str == NULL) {
+        return ENOMEM;
+    }
+    DEBUG(SSSDBG_TRACE_ALL, "%s: %s\n", name, str);
+    p += len;
+
+    *_str = str;
+    *_p = p;
+    return EOK;
+}
+
+/*
+ * A batch request has the following structure:
+ *   uint32_t num_gpos
+ *   uint32_t smb_server length, smb_server
+ *   num_gpos times:
+ *     uint32_t cached_gpt_version
+ *     uint32_t smb_share length, smb_share
+ *     uint32_t smb_path length, smb_path
+ *     uint32_t smb_cse_suffix length, smb_cse_suffix
+ */
+errno_t
+ad_gpo_child_unpack_request(uint8_t *buf,
+                            size_t size,
+                            struct gpo_child_input *ibuf)
+{
+    size_t p = 0;
+    uint32_t num_gpos;
+    uint32_t cached_gpt_version;
+    struct gpo_child_input_gpo *gpo;
+    uint32_t i;
+    errno_t ret;
+
+    /* num_gpos */
+    SAFEALIGN_COPY_UINT32_CHECK(&num_gpos, buf + p, size, &p);
+    DEBUG(SSSDBG_TRACE_FUNC, "num_gpos: %u\n", num_gpos);
+    /* every GPO takes at least four length/version fields */
+    if (num_gpos == 0 || num_gpos > size / (4 * sizeof(uint32_t))) {
+        return EINVAL;
+    }
+
+    ret = unpack_string(ibuf, buf, size, &p, "smb_server", &ibuf->smb_server);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ibuf->gpos = talloc_zero_array(ibuf, struct gpo_child_input_gpo, num_gpos);
+    if (ibuf->gpos == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < num_gpos; i++) {
+        gpo = &ibuf->gpos[i];
+
+        /* cached_gpt_version */
+        SAFEALIGN_COPY_UINT32_CHECK(&cached_gpt_version, buf + p, size, &p);
+        DEBUG(SSSDBG_TRACE_FUNC, "cached_gpt_version: %d\n",
+              cached_gpt_version);
+        gpo->cached_gpt_version = cached_gpt_version;
+
+        ret = unpack_string(ibuf, buf, size, &p, "smb_share", &gpo->smb_share);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        ret = unpack_string(ibuf, buf, size, &p, "smb_path", &gpo->smb_path);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        ret = unpack_string(ibuf, buf, size, &p, "smb_cse_suffix",
+                            &gpo->smb_cse_suffix);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    if (p != size) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unexpected data after the last GPO.\n");
+        return EINVAL;
+    }
+
+    ibuf->num_gpos = num_gpos;
+    return EOK;
+}
+
+errno_t
+ad_gpo_child_pack_response(struct response *r,
+                           struct gpo_child_output *out,
+                           uint32_t num_gpos)
+{
+    size_t p = 0;
+    uint32_t i;
+
+    /* A buffer with the following structure must be created:
+     *   uint32_t num_gpos (required)
+     *   num_gpos times:
+     *     uint32_t sysvol_gpt_version (required)
+     *     uint32_t policy file was updated (required)
+     *     uint32_t status of the request (required)
+     */
+    r->size = sizeof(uint32_t) + num_gpos * 3 * sizeof(uint32_t);
+
+    r->buf = talloc_array(r, uint8_t, r->size);
+    if(r->buf == NULL) {
+        return ENOMEM;
+    }
+
+    /* num_gpos */
+    SAFEALIGN_SET_UINT32(&r->buf[p], num_gpos, &p);
+
+    for (i = 0; i < num_gpos; i++) {
+        DEBUG(SSSDBG_TRACE_FUNC, "gpo [%u] result [%d]\n", i, out[i].result);
+
+        /* sysvol_gpt_version */
+        SAFEALIGN_SET_UINT32(&r->buf[p], out[i].sysvol_gpt_version, &p);
+
+        /* policy_updated */
+        SAFEALIGN_SET_UINT32(&r->buf[p], out[i].policy_updated ? 1 : 0, &p);
+
+        /* result */
+        SAFEALIGN_SET_UINT32(&r->buf[p], out[i].result, &p);
+    }
+
+    return EOK;
+}
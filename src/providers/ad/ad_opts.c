@@ -169,6 +169,9 @@ struct dp_option ad_def_ldap_opts[] = {
     { "ldap_library_debug_level", DP_OPT_NUMBER, NULL_NUMBER, NULL_NUMBER},
     { "ldap_use_ppolicy", DP_OPT_BOOL, BOOL_TRUE, BOOL_TRUE },
     { "ldap_ppolicy_pwd_change_threshold", DP_OPT_NUMBER, { .number = 0 }, NULL_NUMBER },
+    { "ldap_enumeration_max_searches", DP_OPT_NUMBER, { .number = 2 }, NULL_NUMBER },
+    { "ldap_access_filter_local", DP_OPT_BOOL, BOOL_FALSE, BOOL_FALSE },
+    { "ldap_pwdlockout_cache_timeout", DP_OPT_NUMBER, { .number = 300 }, NULL_NUMBER },
     DP_OPTION_TERMINATOR
 };
 
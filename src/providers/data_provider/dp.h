@@ -193,6 +193,11 @@ void dp_sbus_reset_groups_memcache(struct data_provider *provider);
 void dp_sbus_reset_initgr_memcache(struct data_provider *provider);
 void dp_sbus_invalidate_group_memcache(struct data_provider *provider,
                                        gid_t gid);
+void dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                      uid_t uid);
+void dp_sbus_invalidate_initgr_memcache(struct data_provider *provider,
+                                        const char *fq_name,
+                                        const char *domain);
 
 /*
  * A dummy handler for DPM_ACCT_DOMAIN_HANDLER.
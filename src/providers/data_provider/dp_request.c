@@ -28,6 +28,7 @@
 #include "util/util.h"
 #include "util/probes.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 
 struct dp_req {
     struct data_provider *provider;
@@ -41,6 +42,7 @@ struct dp_req {
     const char *name;
     uint32_t num;
     uint64_t start_time;
+    struct sss_trace_span *span;
 
     struct tevent_req *req;
     struct tevent_req *handler_req;
@@ -124,6 +126,10 @@ static errno_t dp_attach_req(struct dp_req *dp_req,
         return ENOMEM;
     }
 
+    dp_req->span = sss_trace_span_begin(dp_req, SSS_TRACE_DP_REQUEST,
+                                        "%s", dp_req->name);
+    sss_trace_span_link(dp_req->span, sender_name, cli_id);
+
     /* Attach this request to active request list. */
     DLIST_ADD(provider->requests.active, dp_req);
     provider->requests.num_active++;
@@ -370,6 +376,11 @@ struct tevent_req *dp_req_send(TALLOC_CTX *mem_ctx,
     return req;
 
 immediately:
+    if (state->dp_req != NULL) {
+        sss_trace_span_end(state->dp_req->span, ret);
+        state->dp_req->span = NULL;
+    }
+
     if (ret == EOK) {
         tevent_req_done(req);
     } else {
@@ -398,6 +409,9 @@ static void dp_req_done(struct tevent_req *subreq)
     PROBE(DP_REQ_DONE, state->dp_req->name, state->dp_req->target,
           state->dp_req->method, ret, sss_strerror(ret));
 
+    sss_trace_span_end(state->dp_req->span, ret);
+    state->dp_req->span = NULL;
+
     DP_REQ_DEBUG(SSSDBG_TRACE_FUNC, state->dp_req->name,
                  "Request handler finished [%d]: %s", ret, sss_strerror(ret));
     DP_REQ_DEBUG(SSSDBG_PERF_STAT, state->dp_req->name,
@@ -143,3 +143,38 @@ void dp_sbus_invalidate_group_memcache(struct data_provider *provider,
     sbus_emit_nss_memcache_InvalidateGroupById(provider->sbus_conn, SSS_BUS_PATH, (uint32_t)gid);
     return;
 }
+
+void dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                      uid_t uid)
+{
+    if (provider == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No provider pointer\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Ordering NSS responder to invalidate the user %"PRIu32" \n",
+          uid);
+
+    sbus_emit_nss_memcache_InvalidateUserById(provider->sbus_conn, SSS_BUS_PATH, (uint32_t)uid);
+    return;
+}
+
+void dp_sbus_invalidate_initgr_memcache(struct data_provider *provider,
+                                        const char *fq_name,
+                                        const char *domain)
+{
+    if (provider == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "No provider pointer\n");
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Ordering NSS responder to invalidate the initgroups of %s\n",
+          fq_name);
+
+    sbus_emit_nss_memcache_InvalidateInitgroupsByName(provider->sbus_conn,
+                                                      SSS_BUS_PATH,
+                                                      fq_name, domain);
+    return;
+}
@@ -39,6 +39,8 @@
 #include <security/pam_modules.h>
 
 #include "util/util.h"
+#include "util/sss_talloc_report.h"
+#include "util/sss_loop_stats.h"
 #include "util/sss_utf8.h"
 #include "confdb/confdb.h"
 #include "db/sysdb.h"
@@ -576,7 +578,10 @@ be_register_monitor_iface(struct sbus_connection *conn, struct be_ctx *be_ctx)
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_service, goOffline, data_provider_go_offline, be_ctx),
             SBUS_SYNC(METHOD, sssd_service, resetOffline, data_provider_reset_offline, be_ctx),
-            SBUS_SYNC(METHOD, sssd_service, rotateLogs, data_provider_logrotate, be_ctx)
+            SBUS_SYNC(METHOD, sssd_service, rotateLogs, data_provider_logrotate, be_ctx),
+            SBUS_SYNC(METHOD, sssd_service, tallocReport, generic_talloc_report, NULL),
+            SBUS_SYNC(METHOD, sssd_service, tallocSampling, generic_talloc_sampling, be_ctx->ev),
+            SBUS_SYNC(METHOD, sssd_service, loopStats, generic_loop_stats, NULL)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(
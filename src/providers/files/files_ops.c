@@ -432,6 +432,9 @@ static errno_t refresh_override_attrs(struct files_id_ctx *id_ctx,
             continue;
         }
 
+        sysdb_lookup_cache_invalidate(id_ctx->domain->sysdb, msg->dn,
+                                      msg->num_elements, msg->elements);
+
         ret = ldb_modify(ldb_ctx, msg);
         if (ret != LDB_SUCCESS) {
             DEBUG(SSSDBG_CRIT_FAILURE,
@@ -703,6 +706,831 @@ done:
     return ret;
 }
 
+/* Entries parsed from the files during the last complete refresh, sorted by
+ * name. A name listed more than once keeps only its last entry, the same
+ * one that ends up in the cache when the entries are saved one by one. */
+struct files_snapshot {
+    struct passwd **users;
+    size_t num_users;
+    struct group **groups;
+    size_t num_groups;
+};
+
+/* When more entries of one type change, the whole memory cache of the type
+ * is invalidated instead of sending the entries one by one */
+#define SF_MAX_INVALIDATIONS 256
+
+/* Cache entries affected by an incremental update */
+struct sf_changes {
+    /* Set if a name or an ID that might be in the negative cache appeared */
+    bool new_users;
+    bool new_groups;
+
+    /* Set if any entry was written */
+    bool users_written;
+    bool groups_written;
+
+    uid_t *uids;
+    size_t num_uids;
+    bool all_uids;
+
+    gid_t *gids;
+    size_t num_gids;
+    bool all_gids;
+
+    /* Fully qualified names of users with changed initgroups */
+    const char **initgr_names;
+    size_t num_initgr_names;
+    bool all_initgr_names;
+};
+
+static errno_t sf_snapshot_add_users(struct files_snapshot *snapshot,
+                                     struct passwd **users)
+{
+    struct passwd **list;
+    size_t n;
+    size_t i;
+
+    for (n = 0; users[n] != NULL; n++);
+
+    list = talloc_realloc(snapshot, snapshot->users, struct passwd *,
+                          snapshot->num_users + n + 1);
+    if (list == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < n; i++) {
+        list[snapshot->num_users + i] = talloc_steal(snapshot, users[i]);
+    }
+    snapshot->num_users += n;
+    list[snapshot->num_users] = NULL;
+    snapshot->users = list;
+
+    return EOK;
+}
+
+static errno_t sf_snapshot_add_groups(struct files_snapshot *snapshot,
+                                      struct group **groups)
+{
+    struct group **list;
+    size_t n;
+    size_t i;
+
+    for (n = 0; groups[n] != NULL; n++);
+
+    list = talloc_realloc(snapshot, snapshot->groups, struct group *,
+                          snapshot->num_groups + n + 1);
+    if (list == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < n; i++) {
+        list[snapshot->num_groups + i] = talloc_steal(snapshot, groups[i]);
+    }
+    snapshot->num_groups += n;
+    list[snapshot->num_groups] = NULL;
+    snapshot->groups = list;
+
+    return EOK;
+}
+
+static void sf_snapshot_clear_groups(struct files_snapshot *snapshot)
+{
+    size_t i;
+
+    for (i = 0; i < snapshot->num_groups; i++) {
+        talloc_free(snapshot->groups[i]);
+    }
+    talloc_zfree(snapshot->groups);
+    snapshot->num_groups = 0;
+}
+
+struct sf_sort_entry {
+    const char *name;
+    size_t seq;
+    void *entry;
+};
+
+static int sf_sort_entry_cmp(const void *a, const void *b)
+{
+    const struct sf_sort_entry *ea = a;
+    const struct sf_sort_entry *eb = b;
+    int ret;
+
+    ret = strcmp(ea->name, eb->name);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return ea->seq < eb->seq ? -1 : ea->seq > eb->seq;
+}
+
+/* Sorts the entries by name and frees all but the last entry of each name,
+ * returns the number of entries kept */
+static size_t sf_sort_entries(struct sf_sort_entry *sorted, size_t num)
+{
+    size_t kept = 0;
+    size_t i;
+
+    qsort(sorted, num, sizeof(struct sf_sort_entry), sf_sort_entry_cmp);
+
+    for (i = 0; i < num; i++) {
+        if (i + 1 < num && strcmp(sorted[i].name, sorted[i + 1].name) == 0) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "%s is listed more than once, using the last entry\n",
+                  sorted[i].name);
+            talloc_free(sorted[i].entry);
+            continue;
+        }
+        sorted[kept++] = sorted[i];
+    }
+
+    return kept;
+}
+
+static errno_t sf_snapshot_finalize(struct files_snapshot *snapshot)
+{
+    struct sf_sort_entry *sorted;
+    size_t num;
+    size_t i;
+
+    sorted = talloc_array(NULL, struct sf_sort_entry,
+                          MAX(snapshot->num_users, snapshot->num_groups));
+    if (sorted == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < snapshot->num_users; i++) {
+        sorted[i].name = snapshot->users[i]->pw_name;
+        sorted[i].seq = i;
+        sorted[i].entry = snapshot->users[i];
+    }
+    num = sf_sort_entries(sorted, snapshot->num_users);
+    for (i = 0; i < num; i++) {
+        snapshot->users[i] = sorted[i].entry;
+    }
+    snapshot->num_users = num;
+    if (snapshot->users != NULL) {
+        snapshot->users[num] = NULL;
+    }
+
+    for (i = 0; i < snapshot->num_groups; i++) {
+        sorted[i].name = snapshot->groups[i]->gr_name;
+        sorted[i].seq = i;
+        sorted[i].entry = snapshot->groups[i];
+    }
+    num = sf_sort_entries(sorted, snapshot->num_groups);
+    for (i = 0; i < num; i++) {
+        snapshot->groups[i] = sorted[i].entry;
+    }
+    snapshot->num_groups = num;
+    if (snapshot->groups != NULL) {
+        snapshot->groups[num] = NULL;
+    }
+
+    talloc_free(sorted);
+    return EOK;
+}
+
+/* Reads the files of the types in @flags, the entries of the other type are
+ * moved over from @old */
+static errno_t sf_snapshot_read(TALLOC_CTX *mem_ctx,
+                                struct files_id_ctx *id_ctx,
+                                uint8_t flags,
+                                struct files_snapshot *old,
+                                struct files_snapshot **_snapshot)
+{
+    struct files_snapshot *snapshot;
+    struct passwd **users;
+    struct group **groups;
+    size_t i;
+    errno_t ret;
+
+    snapshot = talloc_zero(mem_ctx, struct files_snapshot);
+    if (snapshot == NULL) {
+        return ENOMEM;
+    }
+
+    if (flags & SF_UPDATE_PASSWD) {
+        for (i = 0; id_ctx->passwd_files[i] != NULL; i++) {
+            ret = enum_files_users(snapshot, id_ctx->passwd_files[i], &users);
+            if (ret == ENOENT) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "The file %s does not exist (yet), skipping\n",
+                      id_ctx->passwd_files[i]);
+                continue;
+            } else if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE, "Cannot enumerate users from %s\n",
+                      id_ctx->passwd_files[i]);
+                goto done;
+            }
+
+            ret = sf_snapshot_add_users(snapshot, users);
+            talloc_free(users);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+    } else {
+        for (i = 0; i < old->num_users; i++) {
+            talloc_steal(snapshot, old->users[i]);
+        }
+        snapshot->users = talloc_steal(snapshot, old->users);
+        snapshot->num_users = old->num_users;
+    }
+
+    if (flags & SF_UPDATE_GROUP) {
+        for (i = 0; id_ctx->group_files[i] != NULL; i++) {
+            ret = enum_files_groups(snapshot, id_ctx->group_files[i], &groups);
+            if (ret == ENOENT) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "The file %s does not exist (yet), skipping\n",
+                      id_ctx->group_files[i]);
+                continue;
+            } else if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE, "Cannot enumerate groups from %s\n",
+                      id_ctx->group_files[i]);
+                goto done;
+            }
+
+            ret = sf_snapshot_add_groups(snapshot, groups);
+            talloc_free(groups);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+    } else {
+        for (i = 0; i < old->num_groups; i++) {
+            talloc_steal(snapshot, old->groups[i]);
+        }
+        snapshot->groups = talloc_steal(snapshot, old->groups);
+        snapshot->num_groups = old->num_groups;
+    }
+
+    ret = sf_snapshot_finalize(snapshot);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_snapshot = snapshot;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(snapshot);
+    }
+    return ret;
+}
+
+static bool sf_str_equal(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    return strcmp(a, b) == 0;
+}
+
+static bool sf_user_equal(struct passwd *a, struct passwd *b)
+{
+    return a->pw_uid == b->pw_uid
+            && a->pw_gid == b->pw_gid
+            && sf_str_equal(a->pw_name, b->pw_name)
+            && sf_str_equal(a->pw_passwd, b->pw_passwd)
+            && sf_str_equal(a->pw_gecos, b->pw_gecos)
+            && sf_str_equal(a->pw_dir, b->pw_dir)
+            && sf_str_equal(a->pw_shell, b->pw_shell);
+}
+
+static bool sf_group_equal(struct group *a, struct group *b)
+{
+    size_t i;
+
+    if (a->gr_gid != b->gr_gid
+            || !sf_str_equal(a->gr_name, b->gr_name)
+            || !sf_str_equal(a->gr_passwd, b->gr_passwd)) {
+        return false;
+    }
+
+    if (a->gr_mem == NULL || b->gr_mem == NULL) {
+        return (a->gr_mem == NULL || a->gr_mem[0] == NULL)
+                && (b->gr_mem == NULL || b->gr_mem[0] == NULL);
+    }
+
+    for (i = 0; a->gr_mem[i] != NULL && b->gr_mem[i] != NULL; i++) {
+        if (strcmp(a->gr_mem[i], b->gr_mem[i]) != 0) {
+            return false;
+        }
+    }
+
+    return a->gr_mem[i] == b->gr_mem[i];
+}
+
+static int sf_name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+static void sf_changes_add_uid(struct sf_changes *changes, uid_t uid)
+{
+    if (changes->all_uids) {
+        return;
+    }
+
+    if (changes->num_uids == SF_MAX_INVALIDATIONS) {
+        changes->all_uids = true;
+        return;
+    }
+
+    changes->uids[changes->num_uids++] = uid;
+}
+
+static void sf_changes_add_gid(struct sf_changes *changes, gid_t gid)
+{
+    if (changes->all_gids) {
+        return;
+    }
+
+    if (changes->num_gids == SF_MAX_INVALIDATIONS) {
+        changes->all_gids = true;
+        return;
+    }
+
+    changes->gids[changes->num_gids++] = gid;
+}
+
+static errno_t sf_changes_add_initgr(struct sf_changes *changes,
+                                     struct sss_domain_info *dom,
+                                     const char *name)
+{
+    char *fqname;
+
+    if (changes->all_initgr_names) {
+        return EOK;
+    }
+
+    if (changes->num_initgr_names == SF_MAX_INVALIDATIONS) {
+        changes->all_initgr_names = true;
+        return EOK;
+    }
+
+    fqname = sss_create_internal_fqname(changes, name, dom->name);
+    if (fqname == NULL) {
+        return ENOMEM;
+    }
+
+    changes->initgr_names[changes->num_initgr_names++] = fqname;
+    return EOK;
+}
+
+static errno_t sf_changes_add_members(struct sf_changes *changes,
+                                      struct sss_domain_info *dom,
+                                      char **members)
+{
+    size_t i;
+    errno_t ret;
+
+    for (i = 0; members != NULL && members[i] != NULL; i++) {
+        ret = sf_changes_add_initgr(changes, dom, members[i]);
+        if (ret != EOK) {
+            return ret;
+        }
+    }
+
+    return EOK;
+}
+
+static size_t sf_sorted_members(char **members, const char ***_sorted)
+{
+    const char **sorted;
+    size_t n;
+
+    for (n = 0; members != NULL && members[n] != NULL; n++);
+
+    sorted = talloc_array(NULL, const char *, n + 1);
+    if (sorted == NULL) {
+        return (size_t) -1;
+    }
+
+    if (n > 0) {
+        memcpy(sorted, members, n * sizeof(char *));
+        qsort(sorted, n, sizeof(char *), sf_name_cmp);
+    }
+
+    *_sorted = sorted;
+    return n;
+}
+
+/* Records the users that were added to or removed from a group */
+static errno_t sf_changes_add_member_diff(struct sf_changes *changes,
+                                          struct sss_domain_info *dom,
+                                          char **old_members,
+                                          char **new_members)
+{
+    const char **old_sorted = NULL;
+    const char **new_sorted = NULL;
+    size_t num_old;
+    size_t num_new;
+    size_t o = 0;
+    size_t n = 0;
+    int cmp;
+    errno_t ret;
+
+    num_old = sf_sorted_members(old_members, &old_sorted);
+    num_new = sf_sorted_members(new_members, &new_sorted);
+    if (num_old == (size_t) -1 || num_new == (size_t) -1) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    while (o < num_old || n < num_new) {
+        if (o == num_old) {
+            cmp = 1;
+        } else if (n == num_new) {
+            cmp = -1;
+        } else {
+            cmp = strcmp(old_sorted[o], new_sorted[n]);
+        }
+
+        ret = EOK;
+        if (cmp < 0) {
+            ret = sf_changes_add_initgr(changes, dom, old_sorted[o++]);
+        } else if (cmp > 0) {
+            ret = sf_changes_add_initgr(changes, dom, new_sorted[n++]);
+        } else {
+            o++;
+            n++;
+        }
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(old_sorted);
+    talloc_free(new_sorted);
+    return ret;
+}
+
+static errno_t delete_file_entry(struct files_id_ctx *id_ctx,
+                                 enum sysdb_member_type type,
+                                 const char *name)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_dn *dn;
+    char *fqname;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    fqname = sss_create_internal_fqname(tmp_ctx, name, id_ctx->domain->name);
+    if (fqname == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    if (type == SYSDB_MEMBER_USER) {
+        dn = sysdb_user_dn(tmp_ctx, id_ctx->domain, fqname);
+    } else {
+        dn = sysdb_group_dn(tmp_ctx, id_ctx->domain, fqname);
+    }
+    if (dn == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* Overrides are kept and linked again by refresh_override_attrs() the
+     * same way as after a full refresh */
+    ret = sysdb_delete_entry(id_ctx->domain->sysdb, dn, true);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to delete %s [%d]: %s\n",
+              fqname, ret, sss_strerror(ret));
+        goto done;
+    }
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Applies the differences between the users of @old and @new, the names of
+ * all added, changed and removed users are returned sorted in @_touched */
+static errno_t sf_apply_users(TALLOC_CTX *mem_ctx,
+                              struct files_id_ctx *id_ctx,
+                              struct files_snapshot *old,
+                              struct files_snapshot *new,
+                              struct sf_changes *changes,
+                              const char ***_touched,
+                              size_t *_num_touched)
+{
+    const char **touched;
+    size_t num_touched = 0;
+    struct passwd *old_pw;
+    struct passwd *new_pw;
+    size_t o = 0;
+    size_t n = 0;
+    int cmp;
+    errno_t ret;
+
+    touched = talloc_array(mem_ctx, const char *,
+                           old->num_users + new->num_users + 1);
+    if (touched == NULL) {
+        return ENOMEM;
+    }
+
+    while (o < old->num_users || n < new->num_users) {
+        old_pw = o < old->num_users ? old->users[o] : NULL;
+        new_pw = n < new->num_users ? new->users[n] : NULL;
+
+        if (old_pw == NULL) {
+            cmp = 1;
+        } else if (new_pw == NULL) {
+            cmp = -1;
+        } else {
+            cmp = strcmp(old_pw->pw_name, new_pw->pw_name);
+        }
+
+        if (cmp == 0 && sf_user_equal(old_pw, new_pw)) {
+            o++;
+            n++;
+            continue;
+        }
+
+        if (cmp <= 0) {
+            DEBUG(SSSDBG_TRACE_FUNC, "User %s was %s\n", old_pw->pw_name,
+                  cmp == 0 ? "changed" : "removed");
+
+            ret = delete_file_entry(id_ctx, SYSDB_MEMBER_USER,
+                                    old_pw->pw_name);
+            if (ret != EOK) {
+                goto done;
+            }
+
+            sf_changes_add_uid(changes, old_pw->pw_uid);
+            ret = sf_changes_add_initgr(changes, id_ctx->domain,
+                                        old_pw->pw_name);
+            if (ret != EOK) {
+                goto done;
+            }
+
+            touched[num_touched++] = old_pw->pw_name;
+            o++;
+        }
+
+        if (cmp >= 0) {
+            if (cmp > 0) {
+                DEBUG(SSSDBG_TRACE_FUNC, "User %s was added\n",
+                      new_pw->pw_name);
+                touched[num_touched++] = new_pw->pw_name;
+            }
+
+            if (cmp > 0 || old_pw->pw_uid != new_pw->pw_uid) {
+                changes->new_users = true;
+            }
+
+            ret = save_file_user(id_ctx, new_pw);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "Cannot save user %s: [%d]: %s\n",
+                      new_pw->pw_name, ret, sss_strerror(ret));
+            }
+            n++;
+        }
+
+        changes->users_written = true;
+    }
+
+    qsort(touched, num_touched, sizeof(char *), sf_name_cmp);
+    touched[num_touched] = NULL;
+
+    *_touched = touched;
+    *_num_touched = num_touched;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(touched);
+    }
+    return ret;
+}
+
+static bool sf_has_touched_member(struct group *grp,
+                                  const char **touched,
+                                  size_t num_touched)
+{
+    size_t i;
+
+    if (num_touched == 0) {
+        return false;
+    }
+
+    for (i = 0; grp->gr_mem != NULL && grp->gr_mem[i] != NULL; i++) {
+        if (bsearch(&grp->gr_mem[i], touched, num_touched, sizeof(char *),
+                    sf_name_cmp) != NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Applies the differences between the groups of @old and @new. Groups with
+ * a member in @touched are saved again as well, deleting or replacing a user
+ * entry drops its memberships and the group decides if the user becomes
+ * a member or a ghost. */
+static errno_t sf_apply_groups(struct files_id_ctx *id_ctx,
+                               struct files_snapshot *old,
+                               struct files_snapshot *new,
+                               const char **touched,
+                               size_t num_touched,
+                               struct sf_changes *changes)
+{
+    TALLOC_CTX *tmp_ctx;
+    const char **cached_users = NULL;
+    struct group *old_grp;
+    struct group *new_grp;
+    size_t o = 0;
+    size_t n = 0;
+    int cmp;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    while (o < old->num_groups || n < new->num_groups) {
+        old_grp = o < old->num_groups ? old->groups[o] : NULL;
+        new_grp = n < new->num_groups ? new->groups[n] : NULL;
+
+        if (old_grp == NULL) {
+            cmp = 1;
+        } else if (new_grp == NULL) {
+            cmp = -1;
+        } else {
+            cmp = strcmp(old_grp->gr_name, new_grp->gr_name);
+        }
+
+        if (cmp == 0 && sf_group_equal(old_grp, new_grp)) {
+            o++;
+            n++;
+
+            if (!sf_has_touched_member(new_grp, touched, num_touched)) {
+                continue;
+            }
+
+            /* The output does not change, only the links to the users */
+            DEBUG(SSSDBG_TRACE_FUNC, "Group %s has changed members\n",
+                  new_grp->gr_name);
+        } else if (cmp < 0) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Group %s was removed\n",
+                  old_grp->gr_name);
+            sf_changes_add_gid(changes, old_grp->gr_gid);
+            ret = sf_changes_add_members(changes, id_ctx->domain,
+                                         old_grp->gr_mem);
+            if (ret != EOK) {
+                goto done;
+            }
+            o++;
+            new_grp = NULL;
+        } else if (cmp > 0) {
+            DEBUG(SSSDBG_TRACE_FUNC, "Group %s was added\n",
+                  new_grp->gr_name);
+            changes->new_groups = true;
+            ret = sf_changes_add_members(changes, id_ctx->domain,
+                                         new_grp->gr_mem);
+            if (ret != EOK) {
+                goto done;
+            }
+            n++;
+            old_grp = NULL;
+        } else {
+            DEBUG(SSSDBG_TRACE_FUNC, "Group %s was changed\n",
+                  new_grp->gr_name);
+            sf_changes_add_gid(changes, old_grp->gr_gid);
+            if (old_grp->gr_gid != new_grp->gr_gid) {
+                changes->new_groups = true;
+                ret = sf_changes_add_members(changes, id_ctx->domain,
+                                             old_grp->gr_mem);
+                if (ret == EOK) {
+                    ret = sf_changes_add_members(changes, id_ctx->domain,
+                                                 new_grp->gr_mem);
+                }
+            } else {
+                ret = sf_changes_add_member_diff(changes, id_ctx->domain,
+                                                 old_grp->gr_mem,
+                                                 new_grp->gr_mem);
+            }
+            if (ret != EOK) {
+                goto done;
+            }
+            o++;
+            n++;
+        }
+
+        changes->groups_written = true;
+
+        if (old_grp != NULL) {
+            ret = delete_file_entry(id_ctx, SYSDB_MEMBER_GROUP,
+                                    old_grp->gr_name);
+            if (ret != EOK) {
+                goto done;
+            }
+        }
+
+        if (new_grp != NULL) {
+            if (cached_users == NULL) {
+                /* Users are already updated at this point */
+                cached_users = get_cached_user_names(tmp_ctx, id_ctx->domain);
+                if (cached_users == NULL) {
+                    ret = ENOMEM;
+                    goto done;
+                }
+            }
+
+            ret = save_file_group(id_ctx, new_grp, cached_users);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_MINOR_FAILURE,
+                      "Cannot save group %s\n", new_grp->gr_name);
+            }
+        }
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static void sf_changes_notify(struct files_id_ctx *id_ctx,
+                              struct sf_changes *changes)
+{
+    struct data_provider *provider = id_ctx->be->provider;
+    size_t i;
+
+    if (changes->new_users) {
+        dp_sbus_reset_users_ncache(provider, id_ctx->domain);
+    }
+
+    if (changes->new_groups) {
+        dp_sbus_reset_groups_ncache(provider, id_ctx->domain);
+    }
+
+    if (changes->all_uids) {
+        dp_sbus_reset_users_memcache(provider);
+    } else {
+        for (i = 0; i < changes->num_uids; i++) {
+            dp_sbus_invalidate_user_memcache(provider, changes->uids[i]);
+        }
+    }
+
+    if (changes->all_gids) {
+        dp_sbus_reset_groups_memcache(provider);
+    } else {
+        for (i = 0; i < changes->num_gids; i++) {
+            dp_sbus_invalidate_group_memcache(provider, changes->gids[i]);
+        }
+    }
+
+    if (changes->all_initgr_names) {
+        dp_sbus_reset_initgr_memcache(provider);
+    } else {
+        for (i = 0; i < changes->num_initgr_names; i++) {
+            dp_sbus_invalidate_initgr_memcache(provider,
+                                               changes->initgr_names[i],
+                                               id_ctx->domain->name);
+        }
+    }
+}
+
+static struct sf_changes *sf_changes_new(TALLOC_CTX *mem_ctx)
+{
+    struct sf_changes *changes;
+
+    changes = talloc_zero(mem_ctx, struct sf_changes);
+    if (changes == NULL) {
+        return NULL;
+    }
+
+    changes->uids = talloc_array(changes, uid_t, SF_MAX_INVALIDATIONS);
+    changes->gids = talloc_array(changes, gid_t, SF_MAX_INVALIDATIONS);
+    changes->initgr_names = talloc_array(changes, const char *,
+                                         SF_MAX_INVALIDATIONS);
+    if (changes->uids == NULL || changes->gids == NULL
+            || changes->initgr_names == NULL) {
+        talloc_free(changes);
+        return NULL;
+    }
+
+    return changes;
+}
+
 enum update_steps {
     WAIT_TO_START_USERS,
     DELETE_USERS,
@@ -712,6 +1540,7 @@ enum update_steps {
     DELETE_GROUPS,
     READ_GROUPS,
     SAVE_GROUPS,
+    UPDATE_DIFF,
     UPDATE_FINISH,
     UPDATE_DONE,
 };
@@ -866,6 +1695,8 @@ struct sf_enum_files_state {
     size_t file_idx;
     struct passwd **users;
     struct group **groups;
+    /* Built while all the entries are saved again */
+    struct files_snapshot *snapshot;
     uint32_t delay;
     uint32_t initial_delay;
 };
@@ -879,6 +1710,120 @@ static int clear_refresh_ctx(void *ptr)
     return 0;
 }
 
+static void sf_reset_caches(struct files_id_ctx *id_ctx, uint8_t flags)
+{
+    dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
+
+    if (flags & SF_UPDATE_PASSWD) {
+        dp_sbus_reset_users_ncache(id_ctx->be->provider, id_ctx->domain);
+        dp_sbus_reset_users_memcache(id_ctx->be->provider);
+    }
+
+    if (flags & SF_UPDATE_GROUP) {
+        dp_sbus_reset_groups_ncache(id_ctx->be->provider, id_ctx->domain);
+        dp_sbus_reset_groups_memcache(id_ctx->be->provider);
+    }
+
+    dp_sbus_reset_initgr_memcache(id_ctx->be->provider);
+}
+
+/* Compares the files with the snapshot of the last refresh and writes only
+ * the entries that differ in a single transaction. The caches were already
+ * reset when the change was noticed, the entries of the changed users and
+ * groups are invalidated again in case a responder cached them meanwhile. */
+static errno_t sf_update_diff(struct sf_enum_files_state *state)
+{
+    struct files_id_ctx *id_ctx = state->id_ctx;
+    struct files_snapshot *old = id_ctx->snapshot;
+    struct files_snapshot *new;
+    struct sf_changes *changes;
+    const char **touched = NULL;
+    size_t num_touched = 0;
+    TALLOC_CTX *tmp_ctx;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    changes = sf_changes_new(tmp_ctx);
+    if (changes == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sf_snapshot_read(tmp_ctx, id_ctx, state->flags, old, &new);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_transaction_start(id_ctx->domain->sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    state->in_transaction = true;
+
+    if (state->flags & SF_UPDATE_PASSWD) {
+        ret = sf_apply_users(tmp_ctx, id_ctx, old, new, changes,
+                             &touched, &num_touched);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sf_apply_groups(id_ctx, old, new, touched, num_touched, changes);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (changes->users_written) {
+        ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_USER);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Failed to refresh override attributes, "
+                  "override values might not be available.\n");
+        }
+    }
+
+    if (changes->groups_written) {
+        ret = refresh_override_attrs(id_ctx, SYSDB_MEMBER_GROUP);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Failed to refresh override attributes, "
+                  "override values might not be available.\n");
+        }
+    }
+
+    if (changes->users_written || changes->groups_written) {
+        ret = dp_add_sr_attribute(id_ctx->be);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Failed to add session recording attribute, ignored.\n");
+        }
+    }
+
+    ret = sysdb_transaction_commit(id_ctx->domain->sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    state->in_transaction = false;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Files updated, %zu users and %zu groups\n",
+          new->num_users, new->num_groups);
+
+    sf_changes_notify(id_ctx, changes);
+
+    talloc_free(id_ctx->snapshot);
+    id_ctx->snapshot = talloc_steal(id_ctx, new);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 static void sf_enum_files_steps(struct tevent_context *ev,
                                 struct tevent_timer *te,
                                 struct timeval tv,
@@ -998,13 +1943,15 @@ static void sf_enum_files_steps(struct tevent_context *ev,
             DEBUG(SSSDBG_OP_FAILURE,
                   "gettimeofday failed [%d][%s], starting user refresh now.\n",
                   ret, sss_strerror(ret));
-            state->current_step = DELETE_USERS;
+            state->current_step = id_ctx->snapshot != NULL ? UPDATE_DIFF
+                                                           : DELETE_USERS;
             delay = 0;
         } else {
             timersub(&state->id_ctx->refresh_ctx->start_passwd_refresh, &now,
                      &diff);
             if (diff.tv_sec < 0) {
-                state->current_step = DELETE_USERS;
+                state->current_step = id_ctx->snapshot != NULL ? UPDATE_DIFF
+                                                               : DELETE_USERS;
                 delay = 0;
             } else {
                 delay = diff.tv_sec*1000000 + diff.tv_usec;
@@ -1026,6 +1973,12 @@ static void sf_enum_files_steps(struct tevent_context *ev,
         if (ret != EOK) {
             goto done;
         }
+
+        /* Only a refresh of both files has all the entries for a snapshot */
+        talloc_zfree(state->snapshot);
+        if (state->flags & SF_UPDATE_GROUP) {
+            state->snapshot = talloc_zero(state, struct files_snapshot);
+        }
         state->file_idx = 0;
         state->current_step = READ_USERS;
         break;
@@ -1038,6 +1991,11 @@ static void sf_enum_files_steps(struct tevent_context *ev,
             filename = id_ctx->passwd_files[state->file_idx++];
             ret = enum_files_users(state, filename, &state->users);
             if (ret == EOK) {
+                if (state->snapshot != NULL
+                        && sf_snapshot_add_users(state->snapshot,
+                                                 state->users) != EOK) {
+                    talloc_zfree(state->snapshot);
+                }
                 state->current_step = SAVE_USERS;
             } else if (ret == ENOENT) {
                 DEBUG(SSSDBG_MINOR_FAILURE,
@@ -1093,13 +2051,15 @@ static void sf_enum_files_steps(struct tevent_context *ev,
             DEBUG(SSSDBG_OP_FAILURE,
                   "gettimeofday failed [%d][%s], starting user refresh now.\n",
                   ret, sss_strerror(ret));
-            state->current_step = DELETE_GROUPS;
+            state->current_step = id_ctx->snapshot != NULL ? UPDATE_DIFF
+                                                           : DELETE_GROUPS;
             delay = 0;
         } else {
             timersub(&state->id_ctx->refresh_ctx->start_passwd_refresh, &now,
                      &diff);
             if (diff.tv_sec < 0) {
-                state->current_step = DELETE_GROUPS;
+                state->current_step = id_ctx->snapshot != NULL ? UPDATE_DIFF
+                                                               : DELETE_GROUPS;
                 delay = 0;
             } else {
                 delay = diff.tv_sec*1000000 + diff.tv_usec;
@@ -1120,6 +2080,10 @@ static void sf_enum_files_steps(struct tevent_context *ev,
         if (ret != EOK) {
             goto done;
         }
+
+        if (state->snapshot != NULL) {
+            sf_snapshot_clear_groups(state->snapshot);
+        }
         state->file_idx = 0;
         state->current_step = READ_GROUPS;
         break;
@@ -1132,6 +2096,11 @@ static void sf_enum_files_steps(struct tevent_context *ev,
             filename = id_ctx->group_files[state->file_idx++];
             ret = enum_files_groups(state, filename, &state->groups);
             if (ret == EOK) {
+                if (state->snapshot != NULL
+                        && sf_snapshot_add_groups(state->snapshot,
+                                                  state->groups) != EOK) {
+                    talloc_zfree(state->snapshot);
+                }
                 state->current_step = SAVE_GROUPS;
             } else if (ret == ENOENT) {
                 DEBUG(SSSDBG_MINOR_FAILURE,
@@ -1187,8 +2156,53 @@ static void sf_enum_files_steps(struct tevent_context *ev,
         }
         state->in_transaction = false;
 
+        if (state->snapshot != NULL) {
+            ret = sf_snapshot_finalize(state->snapshot);
+            if (ret == EOK) {
+                talloc_free(id_ctx->snapshot);
+                id_ctx->snapshot = talloc_steal(id_ctx, state->snapshot);
+                state->snapshot = NULL;
+            } else {
+                DEBUG(SSSDBG_MINOR_FAILURE, "Cannot store the snapshot of "
+                      "the files, the next update will reload all entries.\n");
+            }
+        }
+
         state->current_step = UPDATE_DONE;
 
+        break;
+    case UPDATE_DIFF:
+        DEBUG(SSSDBG_TRACE_ALL, "Step UPDATE_DIFF.\n");
+        if (state->flags & SF_UPDATE_PASSWD) {
+            id_ctx->refresh_ctx->updating_passwd = REFRESH_ACTIVE;
+        }
+        id_ctx->refresh_ctx->updating_groups = REFRESH_ACTIVE;
+
+        ret = sf_update_diff(state);
+        if (ret == EOK) {
+            state->current_step = UPDATE_DONE;
+            break;
+        }
+
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Incremental update failed [%d]: %s, reloading all entries\n",
+              ret, sss_strerror(ret));
+        if (state->in_transaction) {
+            tret = sysdb_transaction_cancel(id_ctx->domain->sysdb);
+            if (tret != EOK) {
+                DEBUG(SSSDBG_CRIT_FAILURE,
+                      "Cannot cancel transaction: %d\n", tret);
+                ret = tret;
+                goto done;
+            }
+            state->in_transaction = false;
+        }
+
+        talloc_zfree(id_ctx->snapshot);
+        state->flags |= SF_UPDATE_BOTH;
+        sf_reset_caches(id_ctx, state->flags);
+        state->current_step = DELETE_USERS;
+        delay = 0;
         break;
     default:
         DEBUG(SSSDBG_CRIT_FAILURE, "Undefined update step [%u].\n",
@@ -1269,11 +2283,9 @@ static int sf_passwd_cb(const char *filename, uint32_t flags, void *pvt)
     }
 
     DEBUG(SSSDBG_TRACE_FUNC, "passwd notification\n");
-    dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
-
-    dp_sbus_reset_users_ncache(id_ctx->be->provider, id_ctx->domain);
-    dp_sbus_reset_users_memcache(id_ctx->be->provider);
-    dp_sbus_reset_initgr_memcache(id_ctx->be->provider);
+    /* Even if only a diff is written later, the responders must not answer
+     * from the negative or memory cache until the update is done. */
+    sf_reset_caches(id_ctx, SF_UPDATE_PASSWD);
 
     /* Using SF_UDPATE_BOTH here the case when someone edits /etc/group, adds a group member and
      * only then edits passwd and adds the user. The reverse is not needed,
@@ -1333,11 +2345,7 @@ static int sf_group_cb(const char *filename, uint32_t flags, void *pvt)
     }
 
     DEBUG(SSSDBG_TRACE_FUNC, "group notification\n");
-    dp_sbus_domain_inconsistent(id_ctx->be->provider, id_ctx->domain);
-
-    dp_sbus_reset_groups_ncache(id_ctx->be->provider, id_ctx->domain);
-    dp_sbus_reset_groups_memcache(id_ctx->be->provider);
-    dp_sbus_reset_initgr_memcache(id_ctx->be->provider);
+    sf_reset_caches(id_ctx, SF_UPDATE_GROUP);
 
     req = sf_enum_files_send(id_ctx, SF_UPDATE_GROUP);
     if (req == NULL) {
@@ -51,6 +51,10 @@ struct files_id_ctx {
 
     struct files_refresh_ctx *refresh_ctx;
 
+    /* Entries of the last complete refresh, used to apply only the
+     * differences when the files change */
+    struct files_snapshot *snapshot;
+
     struct tevent_req *users_req;
     struct tevent_req *groups_req;
     struct tevent_req *initgroups_req;
@@ -23,12 +23,17 @@
 #include "providers/ipa/ipa_deskprofile_rules_util.h"
 #include "providers/ipa/ipa_deskprofile_private.h"
 #include "providers/ipa/ipa_rules_common.h"
+#include "shared/murmurhash3.h"
 #include <ctype.h>
 #include <fcntl.h>
 
 #define DESKPROFILE_GLOBAL_POLICY_MIN_VALUE 1
 #define DESKPROFILE_GLOBAL_POLICY_MAX_VALUE 24
 
+#define DESKPROFILE_MANIFEST_SUFFIX ".manifest"
+#define DESKPROFILE_MANIFEST_MAX_SIZE (1024 * 1024)
+#define DESKPROFILE_MANIFEST_HASH_SEED 0xdeadbeef
+
 enum deskprofile_name {
     RULES_DIR = 0,
     DOMAIN,
@@ -673,14 +678,15 @@ done:
 }
 
 
-errno_t
-ipa_deskprofile_rules_save_rule_to_disk(
-                                    TALLOC_CTX *mem_ctx,
+static errno_t
+ipa_deskprofile_rules_get_rule_file(TALLOC_CTX *mem_ctx,
                                     uint16_t priority,
                                     struct sysdb_attrs *rule,
                                     struct sss_domain_info *domain,
                                     const char *hostname,
-                                    const char *username /* fully-qualified */)
+                                    const char *username /* fully-qualified */,
+                                    char **_filename_path,
+                                    const char **_data)
 {
     TALLOC_CTX *tmp_ctx;
     const char *rule_name;
@@ -699,7 +705,6 @@ ipa_deskprofile_rules_save_rule_to_disk(
     char *filename_path = NULL;
     const char *extension = "json";
     uint32_t prio;
-    int fd = -1;
     errno_t ret;
 
     tmp_ctx = talloc_new(mem_ctx);
@@ -840,7 +845,7 @@ ipa_deskprofile_rules_save_rule_to_disk(
         }
     }
 
-    ret = ipa_deskprofile_get_normalized_rule_name(mem_ctx, rule_name,
+    ret = ipa_deskprofile_get_normalized_rule_name(tmp_ctx, rule_name,
                                                    &normalized_rule_name);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
@@ -869,23 +874,248 @@ ipa_deskprofile_rules_save_rule_to_disk(
         goto done;
     }
 
-    fd = open(filename_path, O_WRONLY | O_CREAT | O_TRUNC, 0400);
+    *_filename_path = talloc_steal(mem_ctx, filename_path);
+    /* data belongs to the rule, which outlives this call */
+    *_data = data;
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* The manifest records, for every rule file currently present in the user's
+ * directory, the hash and the size of its content. It lives next to the
+ * user's directory (as ".<shortname>.manifest") so that the Desktop Profile
+ * client never sees it among the rules. */
+struct deskprofile_manifest_entry {
+    char *name;
+    uint32_t hash;
+    size_t size;
+    bool keep;
+};
+
+static errno_t
+deskprofile_manifest_path(TALLOC_CTX *mem_ctx,
+                          const char *user_dir,
+                          char **_manifest_path)
+{
+    const char *shortname;
+    char *manifest_path;
+
+    shortname = strrchr(user_dir, '/');
+    if (shortname == NULL || shortname[1] == '\0') {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unexpected user directory \"%s\"\n", user_dir);
+        return EINVAL;
+    }
+
+    manifest_path = talloc_asprintf(mem_ctx, "%.*s/.%s"DESKPROFILE_MANIFEST_SUFFIX,
+                                    (int)(shortname - user_dir), user_dir,
+                                    shortname + 1);
+    if (manifest_path == NULL) {
+        return ENOMEM;
+    }
+
+    *_manifest_path = manifest_path;
+    return EOK;
+}
+
+static struct deskprofile_manifest_entry *
+deskprofile_manifest_find(struct deskprofile_manifest_entry *entries,
+                          size_t count,
+                          const char *name)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns ENOENT if there is no manifest and EINVAL if it can't be parsed. */
+static errno_t
+deskprofile_manifest_read(TALLOC_CTX *mem_ctx,
+                          const char *manifest_path,
+                          struct deskprofile_manifest_entry **_entries,
+                          size_t *_count)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct deskprofile_manifest_entry *entries;
+    struct stat st;
+    char *buf;
+    char *line;
+    char *saveptr;
+    char *endptr;
+    size_t count;
+    ssize_t len;
+    int fd = -1;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    fd = open(manifest_path, O_RDONLY | O_CLOEXEC);
     if (fd == -1) {
         ret = errno;
+        goto done;
+    }
+
+    ret = fstat(fd, &st);
+    if (ret == -1) {
+        ret = errno;
+        goto done;
+    }
+
+    if (st.st_size > DESKPROFILE_MANIFEST_MAX_SIZE) {
+        ret = EINVAL;
+        goto done;
+    }
+
+    buf = talloc_size(tmp_ctx, st.st_size + 1);
+    if (buf == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    errno = 0;
+    len = sss_atomic_read_s(fd, buf, st.st_size);
+    if (len == -1) {
+        ret = errno;
+        goto done;
+    } else if (len != st.st_size) {
+        ret = EINVAL;
+        goto done;
+    }
+    buf[len] = '\0';
+
+    /* Each line is "<hash> <size> <file name>" */
+    count = 0;
+    for (ssize_t i = 0; i < len; i++) {
+        if (buf[i] == '\n') {
+            count++;
+        }
+    }
+
+    entries = talloc_zero_array(tmp_ctx, struct deskprofile_manifest_entry,
+                                count + 1);
+    if (entries == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    count = 0;
+    for (line = strtok_r(buf, "\n", &saveptr);
+         line != NULL;
+         line = strtok_r(NULL, "\n", &saveptr)) {
+        errno = 0;
+        entries[count].hash = strtoul(line, &endptr, 16);
+        if (errno != 0 || endptr == line || *endptr != ' ') {
+            ret = EINVAL;
+            goto done;
+        }
+
+        line = endptr + 1;
+        entries[count].size = strtoull(line, &endptr, 10);
+        if (errno != 0 || endptr == line || *endptr != ' ') {
+            ret = EINVAL;
+            goto done;
+        }
+
+        line = endptr + 1;
+        if (*line == '\0' || *line == '.' || strchr(line, '/') != NULL) {
+            ret = EINVAL;
+            goto done;
+        }
+
+        entries[count].name = talloc_strdup(entries, line);
+        if (entries[count].name == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+        count++;
+    }
+
+    *_entries = talloc_steal(mem_ctx, entries);
+    *_count = count;
+    ret = EOK;
+
+done:
+    if (fd != -1) {
+        close(fd);
+    }
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Writes the content to a temporary file in the same directory and renames
+ * it over path, so nobody ever sees a partially written file. */
+static errno_t
+deskprofile_write_file(const char *path,
+                       const char *content,
+                       size_t size,
+                       mode_t mode)
+{
+    TALLOC_CTX *tmp_ctx;
+    char *tmp_name;
+    ssize_t written;
+    int fd = -1;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    tmp_name = talloc_asprintf(tmp_ctx, "%s.XXXXXX", path);
+    if (tmp_name == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    /* The temporary file is unlinked when tmp_ctx is freed unless it has
+     * been renamed by then. */
+    fd = sss_unique_file(tmp_ctx, tmp_name, &ret);
+    if (fd == -1) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to create the Desktop Profile rule file \"%s\" "
-              "[%d]: %s\n",
-              filename_path, ret, sss_strerror(ret));
+              "sss_unique_file() failed [%d]: %s\n", ret, sss_strerror(ret));
         goto done;
     }
 
-    ret = dprintf(fd, "%s", data);
-    if (ret < 0) {
+    errno = 0;
+    written = sss_atomic_write_s(fd, discard_const(content), size);
+    if (written == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to write \"%s\" [%d]: %s\n",
+              tmp_name, ret, sss_strerror(ret));
+        goto done;
+    } else if ((size_t)written != size) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Wrote [%zd] bytes to \"%s\", expected [%zu]\n",
+              written, tmp_name, size);
         ret = EIO;
+        goto done;
+    }
+
+    ret = fchmod(fd, mode);
+    if (ret == -1) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "fchmod() failed [%d]: %s\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    ret = rename(tmp_name, path);
+    if (ret == -1) {
+        ret = errno;
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "Failed to write the content of the Desktop Profile rule for "
-              "the \"%s\" file.\n",
-              filename_path);
+              "Failed to rename \"%s\" to \"%s\" [%d]: %s\n",
+              tmp_name, path, ret, sss_strerror(ret));
         goto done;
     }
 
@@ -899,9 +1129,217 @@ done:
     return ret;
 }
 
+static errno_t
+deskprofile_manifest_write(const char *manifest_path,
+                           struct deskprofile_manifest_entry *entries,
+                           size_t count)
+{
+    TALLOC_CTX *tmp_ctx;
+    char *content;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    content = talloc_strdup(tmp_ctx, "");
+    if (content == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        content = talloc_asprintf_append(content, "%08x %zu %s\n",
+                                         entries[i].hash, entries[i].size,
+                                         entries[i].name);
+        if (content == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    ret = deskprofile_write_file(manifest_path, content, strlen(content),
+                                 S_IRUSR | S_IWUSR);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+errno_t
+ipa_deskprofile_rules_save_rules_to_disk(
+                                    TALLOC_CTX *mem_ctx,
+                                    uint16_t priority,
+                                    struct sysdb_attrs **rules,
+                                    size_t rule_count,
+                                    struct sss_domain_info *domain,
+                                    const char *hostname,
+                                    const char *username, /* fully-qualified */
+                                    const char *user_dir)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct deskprofile_manifest_entry *old_entries = NULL;
+    struct deskprofile_manifest_entry *new_entries;
+    struct deskprofile_manifest_entry *entry;
+    char *manifest_path;
+    char *filename_path;
+    const char *filename;
+    const char *data;
+    struct stat st;
+    size_t old_count = 0;
+    size_t new_count = 0;
+    size_t num_written = 0;
+    size_t num_removed = 0;
+    size_t size;
+    uint32_t hash;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(mem_ctx);
+    if (tmp_ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ret = deskprofile_manifest_path(tmp_ctx, user_dir, &manifest_path);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = deskprofile_manifest_read(tmp_ctx, manifest_path,
+                                    &old_entries, &old_count);
+    if (ret != EOK) {
+        if (ret != ENOENT) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Cannot use the manifest \"%s\" [%d]: %s, rewriting all "
+                  "the Desktop Profile rules\n",
+                  manifest_path, ret, sss_strerror(ret));
+        }
+
+        /* Without a manifest there's no telling which files are up to date,
+         * so start from an empty directory. */
+        ret = ipa_deskprofile_rules_remove_user_dir(user_dir);
+        if (ret != EOK) {
+            goto done;
+        }
+        old_entries = NULL;
+        old_count = 0;
+    }
+
+    ret = ipa_deskprofile_rules_create_user_dir(username);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot create the user directory [%d]: %s\n",
+              ret, sss_strerror(ret));
+        goto done;
+    }
+
+    new_entries = talloc_zero_array(tmp_ctx, struct deskprofile_manifest_entry,
+                                    rule_count + 1);
+    if (new_entries == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (size_t i = 0; i < rule_count; i++) {
+        ret = ipa_deskprofile_rules_get_rule_file(tmp_ctx, priority, rules[i],
+                                                  domain, hostname, username,
+                                                  &filename_path, &data);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Failed to save a Desktop Profile Rule to disk [%d]: %s\n",
+                  ret, sss_strerror(ret));
+            continue;
+        }
+
+        filename = strrchr(filename_path, '/') + 1;
+        size = strlen(data);
+        hash = murmurhash3(data, size, DESKPROFILE_MANIFEST_HASH_SEED);
+
+        /* Files which are not kept are unlinked below */
+        entry = deskprofile_manifest_find(old_entries, old_count, filename);
+        if (entry != NULL && entry->hash == hash && entry->size == size
+                && stat(filename_path, &st) == 0 && (size_t)st.st_size == size) {
+            entry->keep = true;
+        } else {
+            ret = deskprofile_write_file(filename_path, data, size, S_IRUSR);
+            if (ret != EOK) {
+                DEBUG(SSSDBG_OP_FAILURE,
+                      "Failed to save a Desktop Profile Rule to disk "
+                      "[%d]: %s\n", ret, sss_strerror(ret));
+                continue;
+            }
+
+            if (entry != NULL) {
+                entry->keep = true;
+            }
+            num_written++;
+        }
+
+        /* Two rules may map to the same file, the last one wins */
+        entry = deskprofile_manifest_find(new_entries, new_count, filename);
+        if (entry == NULL) {
+            entry = &new_entries[new_count];
+            new_count++;
+
+            entry->name = talloc_strdup(new_entries, filename);
+            if (entry->name == NULL) {
+                ret = ENOMEM;
+                goto done;
+            }
+        }
+        entry->hash = hash;
+        entry->size = size;
+    }
+
+    for (size_t i = 0; i < old_count; i++) {
+        if (old_entries[i].keep) {
+            continue;
+        }
+
+        filename_path = talloc_asprintf(tmp_ctx, "%s/%s",
+                                        user_dir, old_entries[i].name);
+        if (filename_path == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        ret = unlink(filename_path);
+        if (ret == -1 && errno != ENOENT) {
+            ret = errno;
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Cannot remove the stale Desktop Profile rule \"%s\" "
+                  "[%d]: %s\n", filename_path, ret, sss_strerror(ret));
+            continue;
+        }
+        num_removed++;
+    }
+
+    ret = deskprofile_manifest_write(manifest_path, new_entries, new_count);
+    if (ret != EOK) {
+        /* The rules themselves are in place, just make sure the next
+         * session rewrites them instead of trusting an outdated manifest. */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot write the manifest \"%s\" [%d]: %s\n",
+              manifest_path, ret, sss_strerror(ret));
+        unlink(manifest_path);
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Desktop Profile rules for \"%s\": %zu written, %zu unchanged, "
+          "%zu removed\n", username, num_written,
+          new_count - num_written, num_removed);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
 errno_t
 ipa_deskprofile_rules_remove_user_dir(const char *user_dir)
 {
+    char *manifest_path = NULL;
     errno_t ret;
 
     ret = sss_remove_subtree(user_dir);
@@ -920,9 +1358,24 @@ ipa_deskprofile_rules_remove_user_dir(const char *user_dir)
         goto done;
     }
 
+    ret = deskprofile_manifest_path(NULL, user_dir, &manifest_path);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = unlink(manifest_path);
+    if (ret == -1 && errno != ENOENT) {
+        ret = errno;
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Cannot remove \"%s\" [%d]: %s\n",
+              manifest_path, ret, sss_strerror(ret));
+        goto done;
+    }
+
     ret = EOK;
 
 done:
+    talloc_free(manifest_path);
     return ret;
 }
 
@@ -46,14 +46,18 @@ ipa_deskprofile_get_filename_path(TALLOC_CTX *mem_ctx,
 
 errno_t
 ipa_deskprofile_rules_create_user_dir(const char *username /* fully-qualified */);
+/* Brings the user's directory in line with the rules, only writing the rule
+ * files whose content changed and removing the ones no longer applicable. */
 errno_t
-ipa_deskprofile_rules_save_rule_to_disk(
+ipa_deskprofile_rules_save_rules_to_disk(
                                     TALLOC_CTX *mem_ctx,
                                     uint16_t priority,
-                                    struct sysdb_attrs *rule,
+                                    struct sysdb_attrs **rules,
+                                    size_t rule_count,
                                     struct sss_domain_info *domain,
                                     const char *hostname,
-                                    const char *username /* fully-qualified */);
+                                    const char *username, /* fully-qualified */
+                                    const char *user_dir);
 errno_t
 ipa_deskprofile_rules_remove_user_dir(const char *user_dir);
 
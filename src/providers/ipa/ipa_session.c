@@ -501,10 +501,10 @@ ipa_pam_session_handler_send(TALLOC_CTX *mem_ctx,
     state->be_ctx = params->be_ctx;
     state->session_ctx = session_ctx;
 
-    /* Get all the user info that will be needed in order the delete the
-     * user's deskprofile directory from the disk, create the user's directory,
-     * save the fetched rules to the disk and notify the deskprofile client
-     * that this operation is done. */
+    /* Get all the user info that will be needed in order to update the
+     * user's deskprofile directory on the disk (or to delete it when no
+     * rules apply) and notify the deskprofile client that this operation
+     * is done. */
     ret = ipa_pam_session_handler_get_deskprofile_user_info(
                                                         state,
                                                         params->domain,
@@ -521,17 +521,6 @@ ipa_pam_session_handler_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    /* As no proper merging mechanism has been implemented yet ...
-     * let's just remove the user directory stored in the disk as it's
-     * going to be created again in case there's any rule fetched. */
-    ret = ipa_deskprofile_rules_remove_user_dir(state->user_dir);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE,
-              "ipa_deskprofile_rules_remove_user_dir() failed.\n");
-        state->pd->pam_status = PAM_SESSION_ERR;
-        goto done;
-    }
-
     subreq = ipa_fetch_deskprofile_send(state, state->ev, state->be_ctx,
                                         state->session_ctx, pd->user);
     if (subreq == NULL) {
@@ -570,13 +559,13 @@ ipa_pam_session_handler_done(struct tevent_req *subreq)
             state->session_ctx->last_request = time(NULL);
         }
         state->pd->pam_status = PAM_SUCCESS;
-        goto done;
+        goto remove_user_dir;
     } else if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Unable to fetch Desktop Profile rules [%d]: %s\n",
               ret, sss_strerror(ret));
         state->pd->pam_status = PAM_SYSTEM_ERR;
-        goto done;
+        goto remove_user_dir;
     }
 
     state->session_ctx->last_request = time(NULL);
@@ -589,9 +578,24 @@ ipa_pam_session_handler_done(struct tevent_req *subreq)
                                                          hostname,
                                                          state->uid);
 
-    if (ret == EOK || ret == ENOENT) {
+    if (ret == ENOENT) {
         state->pd->pam_status = PAM_SUCCESS;
-    } else {
+        goto remove_user_dir;
+    } else if (ret != EOK) {
+        state->pd->pam_status = PAM_SESSION_ERR;
+        goto done;
+    }
+
+    state->pd->pam_status = PAM_SUCCESS;
+    goto done;
+
+remove_user_dir:
+    /* No rules apply to the user (or they couldn't be fetched), make sure
+     * none of the previously saved ones are left behind. */
+    ret = ipa_deskprofile_rules_remove_user_dir(state->user_dir);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "ipa_deskprofile_rules_remove_user_dir() failed.\n");
         state->pd->pam_status = PAM_SESSION_ERR;
     }
 
@@ -753,31 +757,22 @@ ipa_pam_session_handler_save_deskprofile_rules(
         goto done;
     }
 
-    /* Create the user directory where the rules are going to be stored */
-    ret = ipa_deskprofile_rules_create_user_dir(username);
+    /* Save the rules to the disk, only touching the files that changed */
+    ret = ipa_deskprofile_rules_save_rules_to_disk(tmp_ctx,
+                                                   priority,
+                                                   rules,
+                                                   rule_count,
+                                                   domain,
+                                                   hostname,
+                                                   username,
+                                                   user_dir);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE,
-              "Cannot create the user directory [%d]: %s\n",
+              "Cannot save the Desktop Profile rules [%d]: %s\n",
               ret, sss_strerror(ret));
         goto done;
     }
 
-    /* Save the rules to the disk */
-    for (size_t i = 0; i < rule_count; i++) {
-        ret = ipa_deskprofile_rules_save_rule_to_disk(tmp_ctx,
-                                                      priority,
-                                                      rules[i],
-                                                      domain,
-                                                      hostname,
-                                                      username);
-        if (ret != EOK) {
-            DEBUG(SSSDBG_OP_FAILURE,
-                  "Failed to save a Desktop Profile Rule to disk [%d]: %s\n",
-                  ret, sss_strerror(ret));
-            continue;
-        }
-    }
-
     /* Notify FleetCommander that our side is done */
     ret = ipa_pam_session_handler_notify_deskprofile_client(be_ctx,
                                                             be_ctx->ev,
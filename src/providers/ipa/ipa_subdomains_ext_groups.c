@@ -34,6 +34,12 @@
 
 #define IPA_EXT_GROUPS_FILTER "objectClass=ipaexternalgroup"
 
+/* Maximal number of groups missing in the cache which are looked up on the
+ * server at the same time */
+#ifndef IPA_EXT_GROUPS_LOOKUP_CHUNK
+#define IPA_EXT_GROUPS_LOOKUP_CHUNK 10
+#endif /* IPA_EXT_GROUPS_LOOKUP_CHUNK */
+
 struct ipa_ext_groups {
     time_t next_update;
     hash_table_t *ext_groups;
@@ -316,7 +322,9 @@ static errno_t add_ad_user_to_cached_groups(struct ldb_dn *user_dn,
     size_t msgs_count;
     struct ldb_message **msgs;
     TALLOC_CTX *tmp_ctx;
+    bool in_transaction = false;
     int ret;
+    int sret;
 
     *missing_groups = false;
 
@@ -326,6 +334,14 @@ static errno_t add_ad_user_to_cached_groups(struct ldb_dn *user_dn,
         return ENOMEM;
     }
 
+    /* all new memberships of the user are written at once */
+    ret = sysdb_transaction_start(user_dom->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sysdb_transaction_start failed.\n");
+        goto done;
+    }
+    in_transaction = true;
+
     for (c = 0; groups[c] != NULL; c++) {
         if (groups[c][0] == '\0') {
             continue;
@@ -380,8 +396,21 @@ static errno_t add_ad_user_to_cached_groups(struct ldb_dn *user_dn,
         groups[c][0] = '\0';
     }
 
+    ret = sysdb_transaction_commit(user_dom->sysdb);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "sysdb_transaction_commit failed.\n");
+        goto done;
+    }
+    in_transaction = false;
+
     ret = EOK;
 done:
+    if (in_transaction) {
+        sret = sysdb_transaction_cancel(user_dom->sysdb);
+        if (sret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE, "sysdb_transaction_cancel failed.\n");
+        }
+    }
     talloc_free(tmp_ctx);
 
     return ret;
@@ -700,6 +729,8 @@ struct add_ad_membership_state {
     char **groups;
     int dp_error;
     size_t iter;
+    size_t pending;
+    errno_t lookup_ret;
     struct sdap_domain *group_sdom;
 };
 
@@ -734,6 +765,8 @@ static struct tevent_req *ipa_add_ad_memberships_send(TALLOC_CTX *mem_ctx,
     state->groups = groups;
     state->dp_error = -1;
     state->iter = 0;
+    state->pending = 0;
+    state->lookup_ret = EOK;
     state->group_sdom = sdap_domain_get(sdap_id_ctx->opts, group_dom);
     if (state->group_sdom == NULL) {
         ret = EIO;
@@ -813,17 +846,58 @@ static void ipa_add_ad_memberships_connect_done(struct tevent_req *subreq)
     ipa_add_ad_memberships_get_next(req);
 }
 
+static errno_t ipa_ext_group_dn_to_fqname(TALLOC_CTX *mem_ctx,
+                                          struct sss_domain_info *group_dom,
+                                          const char *group_dn_str,
+                                          const char **_fq_name)
+{
+    struct ldb_dn *group_dn;
+    const struct ldb_val *val;
+    const char *fq_name;
+    char *tmp_str;
+
+    group_dn = ldb_dn_new(mem_ctx, sysdb_ctx_get_ldb(group_dom->sysdb),
+                          group_dn_str);
+    if (group_dn == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "ldb_dn_new failed.\n");
+        return ENOMEM;
+    }
+
+    val = ldb_dn_get_rdn_val(group_dn);
+    if (val == NULL || val->data == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "Invalid group DN [%s].\n", group_dn_str);
+        return EINVAL;
+    }
+
+    fq_name = (const char *) val->data;
+    if (strchr(fq_name, '@') == NULL) {
+        tmp_str = sss_create_internal_fqname(mem_ctx, fq_name,
+                                             group_dom->name);
+        /* keep using val->data if sss_create_internal_fqname() fails */
+        if (tmp_str != NULL) {
+            fq_name = tmp_str;
+        }
+    }
+
+    *_fq_name = fq_name;
+    return EOK;
+}
+
+/*
+ * The groups which are not in the cache yet are looked up in chunks of at
+ * most IPA_EXT_GROUPS_LOOKUP_CHUNK concurrent single group lookups, the next
+ * chunk is started when all lookups of the current one have finished. Every
+ * lookup resolves nested groups and removes the group from the cache if it
+ * does not exist on the server anymore.
+ */
 static void ipa_add_ad_memberships_get_next(struct tevent_req *req)
 {
     struct add_ad_membership_state *state = tevent_req_data(req,
                                                 struct add_ad_membership_state);
     struct tevent_req *subreq;
-    struct ldb_dn *group_dn;
     int ret;
-    const struct ldb_val *val;
     bool missing_groups;
     const char *fq_name;
-    char *tmp_str;
 
     while (state->groups[state->iter] != NULL
             && state->groups[state->iter][0] == '\0') {
@@ -850,50 +924,50 @@ static void ipa_add_ad_memberships_get_next(struct tevent_req *req)
         return;
     }
 
-    group_dn = ldb_dn_new(state, sysdb_ctx_get_ldb(state->group_dom->sysdb),
-                          state->groups[state->iter]);
-    if (group_dn == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE, "ldb_dn_new failed.\n");
-        ret = ENOMEM;
-        goto fail;
-    }
-
-    val = ldb_dn_get_rdn_val(group_dn);
-    if (val == NULL || val->data == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Invalid group DN [%s].\n", state->groups[state->iter]);
-        ret = EINVAL;
-        goto fail;
-    }
+    for (; state->groups[state->iter] != NULL
+                && state->pending < IPA_EXT_GROUPS_LOOKUP_CHUNK;
+           state->iter++) {
+        if (state->groups[state->iter][0] == '\0') {
+            continue;
+        }
 
-    fq_name = (const char *) val->data;
-    if (strchr(fq_name, '@') == NULL) {
-        tmp_str = sss_create_internal_fqname(state, fq_name,
-                                             state->group_dom->name);
-        /* keep using val->data if sss_create_internal_fqname() fails */
-        if (tmp_str != NULL) {
-            fq_name = tmp_str;
+        ret = ipa_ext_group_dn_to_fqname(state, state->group_dom,
+                                         state->groups[state->iter],
+                                         &fq_name);
+        if (ret != EOK) {
+            goto fail;
         }
-    }
 
 /* TODO: here is would be useful for have a filter type like BE_FILTER_DN to
  * directly fetch the group with the corresponding DN. */
-    subreq = groups_get_send(state, state->ev,
+        subreq = groups_get_send(state, state->ev,
                                  state->sdap_id_ctx, state->group_sdom,
                                  state->sdap_id_ctx->conn,
                                  fq_name,
                                  BE_FILTER_NAME,
-                                 false, false, false);
-    if (subreq == NULL) {
-        DEBUG(SSSDBG_OP_FAILURE, "groups_get_send failed.\n");
-        ret = ENOMEM;
-        goto fail;
+                                 true, false, false);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_OP_FAILURE, "groups_get_send failed.\n");
+            ret = ENOMEM;
+            goto fail;
+        }
+
+        tevent_req_set_callback(subreq, ipa_add_ad_memberships_get_group_done,
+                                req);
+        state->pending++;
     }
 
-    tevent_req_set_callback(subreq, ipa_add_ad_memberships_get_group_done, req);
+    DEBUG(SSSDBG_TRACE_FUNC, "Looking up %zu groups missing in the cache.\n",
+          state->pending);
     return;
 
 fail:
+    if (state->pending > 0) {
+        /* reported once the running lookups have finished */
+        state->lookup_ret = ret;
+        return;
+    }
+
     tevent_req_error(req, ret);
 }
 
@@ -903,19 +977,32 @@ static void ipa_add_ad_memberships_get_group_done(struct tevent_req *subreq)
                                                       struct tevent_req);
     struct add_ad_membership_state *state = tevent_req_data(req,
                                                 struct add_ad_membership_state);
+    int dp_error;
     int ret;
 
-    ret = groups_get_recv(subreq, &state->dp_error, NULL);
+    ret = groups_get_recv(subreq, &dp_error, NULL);
     talloc_zfree(subreq);
+    state->pending--;
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "Failed to read group [%s] from LDAP [%d](%s)\n",
-              state->groups[state->iter], ret, strerror(ret));
+        DEBUG(SSSDBG_OP_FAILURE, "Failed to read group from LDAP [%d](%s)\n",
+              ret, strerror(ret));
+        if (state->lookup_ret == EOK) {
+            state->lookup_ret = ret;
+            state->dp_error = dp_error;
+        }
+    } else if (state->lookup_ret == EOK) {
+        state->dp_error = dp_error;
+    }
 
-        tevent_req_error(req, ret);
+    if (state->pending > 0) {
+        return;
+    }
+
+    if (state->lookup_ret != EOK) {
+        tevent_req_error(req, state->lookup_ret);
         return;
     }
 
-    state->iter++;
     ipa_add_ad_memberships_get_next(req);
 }
 
@@ -38,6 +38,7 @@
 #include "util/child_common.h"
 #include "util/find_uid.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 #include "util/sss_ptr_hash.h"
 #include "src/util/util_errors.h"
 #include "providers/backend.h"
@@ -4137,6 +4138,7 @@ int main(int argc, const char *argv[])
     int sss_creds_password = 0;
     long dummy_long = 0;
     char *caps = NULL;
+    struct sss_trace_span *span = NULL;
 
     struct poptOption long_options[] = {
         POPT_AUTOHELP
@@ -4233,6 +4235,8 @@ int main(int argc, const char *argv[])
 
     DEBUG_INIT(debug_level, opt_logger);
 
+    span = sss_trace_span_begin(NULL, SSS_TRACE_CHILD, "krb5_child");
+
     DEBUG(SSSDBG_CONF_SETTINGS,
          "Starting under uid=%"SPRIuid" (euid=%"SPRIuid") : "
          "gid=%"SPRIgid" (egid=%"SPRIgid")\n",
@@ -4364,6 +4368,7 @@ int main(int argc, const char *argv[])
     }
 
 done:
+    sss_trace_span_end(span, ret);
     if (ret == EOK) {
         DEBUG(SSSDBG_TRACE_FUNC, "krb5_child completed successfully\n");
         ret = 0;
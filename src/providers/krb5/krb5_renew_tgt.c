@@ -29,6 +29,16 @@
 #include "providers/krb5/krb5_utils.h"
 #include "providers/krb5/krb5_ccache.h"
 
+/* At most this many renewals run at the same time, renewals that are due
+ * wait for a free slot. */
+#define RENEW_MAX_RUNNING 10
+/* Each renewal is started with a random delay of up to this many
+ * microseconds, so that tickets acquired at the same time, e.g. by logins
+ * to a terminal server after a reboot, are not renewed in a burst. */
+#define RENEW_JITTER_USEC 500000
+
+#define RENEW_NOT_QUEUED ((size_t) -1)
+
 struct renew_tgt_ctx {
     hash_table_t *tgt_table;
     struct be_ctx *be_ctx;
@@ -36,17 +46,37 @@ struct renew_tgt_ctx {
     struct krb5_ctx *krb5_ctx;
     time_t timer_interval;
     struct tevent_timer *te;
+    time_t te_deadline;
+    /* No renewal is started before this time */
+    time_t not_before;
+
+    /* Min-heap of the renewal items ordered by start_renew_at. Items which
+     * are currently renewed are not in the heap. */
+    struct renew_data **heap;
+    size_t heap_count;
+    size_t heap_size;
+
+    size_t running;
+    bool destroying;
 };
 
+struct auth_data;
+
 struct renew_data {
+    struct renew_tgt_ctx *renew_tgt_ctx;
+    const char *upn;
     const char *ccfile;
     time_t start_time;
     time_t lifetime;
     time_t start_renew_at;
     struct pam_data *pd;
+    size_t heap_idx;
+    /* The running renewal of this item, if any */
+    struct auth_data *auth_data;
 };
 
 struct auth_data {
+    struct renew_tgt_ctx *renew_tgt_ctx;
     struct be_ctx *be_ctx;
     struct krb5_ctx *krb5_ctx;
     struct pam_data *pd;
@@ -55,6 +85,178 @@ struct auth_data {
     hash_key_t key;
 };
 
+static void renew_heap_swap(struct renew_data **heap, size_t a, size_t b)
+{
+    struct renew_data *tmp;
+
+    tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+
+    heap[a]->heap_idx = a;
+    heap[b]->heap_idx = b;
+}
+
+static void renew_heap_sift_up(struct renew_tgt_ctx *renew_tgt_ctx, size_t idx)
+{
+    struct renew_data **heap = renew_tgt_ctx->heap;
+    size_t parent;
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (heap[parent]->start_renew_at <= heap[idx]->start_renew_at) {
+            break;
+        }
+
+        renew_heap_swap(heap, parent, idx);
+        idx = parent;
+    }
+}
+
+static void renew_heap_sift_down(struct renew_tgt_ctx *renew_tgt_ctx,
+                                 size_t idx)
+{
+    struct renew_data **heap = renew_tgt_ctx->heap;
+    size_t count = renew_tgt_ctx->heap_count;
+    size_t child;
+    size_t min;
+
+    while (true) {
+        min = idx;
+        child = 2 * idx + 1;
+
+        if (child < count
+                && heap[child]->start_renew_at < heap[min]->start_renew_at) {
+            min = child;
+        }
+
+        if (child + 1 < count
+                && heap[child + 1]->start_renew_at < heap[min]->start_renew_at) {
+            min = child + 1;
+        }
+
+        if (min == idx) {
+            break;
+        }
+
+        renew_heap_swap(heap, min, idx);
+        idx = min;
+    }
+}
+
+static errno_t renew_heap_push(struct renew_tgt_ctx *renew_tgt_ctx,
+                               struct renew_data *renew_data)
+{
+    struct renew_data **heap;
+    size_t size;
+
+    if (renew_tgt_ctx->heap_count == renew_tgt_ctx->heap_size) {
+        size = renew_tgt_ctx->heap_size == 0 ? 64
+                                             : renew_tgt_ctx->heap_size * 2;
+        heap = talloc_realloc(renew_tgt_ctx, renew_tgt_ctx->heap,
+                              struct renew_data *, size);
+        if (heap == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "talloc_realloc failed.\n");
+            return ENOMEM;
+        }
+
+        renew_tgt_ctx->heap = heap;
+        renew_tgt_ctx->heap_size = size;
+    }
+
+    renew_data->heap_idx = renew_tgt_ctx->heap_count;
+    renew_tgt_ctx->heap[renew_tgt_ctx->heap_count++] = renew_data;
+    renew_heap_sift_up(renew_tgt_ctx, renew_data->heap_idx);
+
+    return EOK;
+}
+
+static void renew_heap_remove(struct renew_tgt_ctx *renew_tgt_ctx,
+                              struct renew_data *renew_data)
+{
+    size_t idx = renew_data->heap_idx;
+    size_t last;
+
+    if (idx == RENEW_NOT_QUEUED) {
+        return;
+    }
+
+    last = --renew_tgt_ctx->heap_count;
+    if (idx != last) {
+        renew_tgt_ctx->heap[idx] = renew_tgt_ctx->heap[last];
+        renew_tgt_ctx->heap[idx]->heap_idx = idx;
+        renew_heap_sift_down(renew_tgt_ctx, idx);
+        renew_heap_sift_up(renew_tgt_ctx, idx);
+    }
+
+    renew_data->heap_idx = RENEW_NOT_QUEUED;
+}
+
+static int renew_tgt_ctx_destructor(struct renew_tgt_ctx *renew_tgt_ctx)
+{
+    /* The heap and the items are freed in any order now */
+    renew_tgt_ctx->destroying = true;
+
+    return 0;
+}
+
+static int renew_data_destructor(struct renew_data *renew_data)
+{
+    if (renew_data->renew_tgt_ctx->destroying) {
+        return 0;
+    }
+
+    renew_heap_remove(renew_data->renew_tgt_ctx, renew_data);
+
+    if (renew_data->auth_data != NULL) {
+        renew_data->auth_data->renew_data = NULL;
+    }
+
+    return 0;
+}
+
+static int auth_data_destructor(struct auth_data *auth_data)
+{
+    if (auth_data->renew_tgt_ctx->destroying) {
+        return 0;
+    }
+
+    auth_data->renew_tgt_ctx->running--;
+
+    if (auth_data->renew_data != NULL) {
+        auth_data->renew_data->auth_data = NULL;
+    }
+
+    return 0;
+}
+
+static void renew_schedule(struct renew_tgt_ctx *renew_tgt_ctx);
+
+/* Puts the item back to the heap after a renewal which can be retried
+ * failed, the next attempt is made after the renewal interval. */
+static void renew_give_back(struct auth_data *auth_data)
+{
+    struct renew_data *renew_data = auth_data->renew_data;
+    int ret;
+
+    if (renew_data == NULL) {
+        /* The item was replaced in the meantime */
+        return;
+    }
+
+    DEBUG(SSSDBG_FUNC_DATA, "Giving back pam data.\n");
+    renew_data->pd = talloc_steal(renew_data, auth_data->pd);
+    renew_data->start_renew_at = time(NULL)
+                                    + auth_data->renew_tgt_ctx->timer_interval;
+
+    ret = renew_heap_push(auth_data->renew_tgt_ctx, renew_data);
+    if (ret != EOK) {
+        ret = hash_delete(auth_data->table, &auth_data->key);
+        if (ret != HASH_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
+        }
+    }
+}
 
 static void renew_tgt_done(struct tevent_req *req);
 static void renew_tgt(struct tevent_context *ev, struct tevent_timer *te,
@@ -62,6 +264,7 @@ static void renew_tgt(struct tevent_context *ev, struct tevent_timer *te,
 {
     struct auth_data *auth_data = talloc_get_type(private_data,
                                                   struct auth_data);
+    struct renew_tgt_ctx *renew_tgt_ctx = auth_data->renew_tgt_ctx;
     struct tevent_req *req;
 
     req = krb5_auth_queue_send(auth_data, ev, auth_data->be_ctx, auth_data->pd,
@@ -70,9 +273,9 @@ static void renew_tgt(struct tevent_context *ev, struct tevent_timer *te,
         DEBUG(SSSDBG_CRIT_FAILURE, "krb5_auth_send failed.\n");
 /* Give back the pam data to the renewal item to be able to retry at the next
  * time the renewals re run. */
-        auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
-                                                 auth_data->pd);
+        renew_give_back(auth_data);
         talloc_free(auth_data);
+        renew_schedule(renew_tgt_ctx);
         return;
     }
 
@@ -83,6 +286,7 @@ static void renew_tgt_done(struct tevent_req *req)
 {
     struct auth_data *auth_data = tevent_req_callback_data(req,
                                                            struct auth_data);
+    struct renew_tgt_ctx *renew_tgt_ctx = auth_data->renew_tgt_ctx;
     int ret;
     int pam_status = PAM_SYSTEM_ERR;
     int dp_err;
@@ -92,11 +296,7 @@ static void renew_tgt_done(struct tevent_req *req)
     talloc_free(req);
     if (ret) {
         DEBUG(SSSDBG_CRIT_FAILURE, "krb5_auth request failed.\n");
-        if (auth_data->renew_data != NULL) {
-            DEBUG(SSSDBG_FUNC_DATA, "Giving back pam data.\n");
-            auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
-                                                     auth_data->pd);
-        }
+        renew_give_back(auth_data);
     } else {
         switch (pam_status) {
             case PAM_SUCCESS:
@@ -131,11 +331,7 @@ static void renew_tgt_done(struct tevent_req *req)
                       "Cannot renewed TGT for user [%s] while offline, "
                           "will retry later.\n",
                           auth_data->pd->user);
-                if (auth_data->renew_data != NULL) {
-                    DEBUG(SSSDBG_FUNC_DATA, "Giving back pam data.\n");
-                    auth_data->renew_data->pd = talloc_steal(auth_data->renew_data,
-                                                             auth_data->pd);
-                }
+                renew_give_back(auth_data);
                 break;
             default:
                 DEBUG(SSSDBG_CRIT_FAILURE,
@@ -149,40 +345,41 @@ static void renew_tgt_done(struct tevent_req *req)
     }
 
     talloc_zfree(auth_data);
+
+    renew_schedule(renew_tgt_ctx);
 }
 
-static errno_t renew_all_tgts(struct renew_tgt_ctx *renew_tgt_ctx)
+static errno_t renew_start(struct renew_tgt_ctx *renew_tgt_ctx,
+                           struct renew_data *renew_data)
 {
-    int ret;
-    hash_entry_t *entries;
-    unsigned long count;
-    size_t c;
-    time_t now;
     struct auth_data *auth_data;
-    struct renew_data *renew_data;
-    struct tevent_timer *te = NULL;
-    int sent_for_renewal = 0;
+    struct tevent_timer *te;
+    uint32_t delay;
 
-    ret = hash_entries(renew_tgt_ctx->tgt_table, &count, &entries);
-    if (ret != HASH_SUCCESS) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "hash_entries failed.\n");
+    auth_data = talloc_zero(renew_tgt_ctx, struct auth_data);
+    if (auth_data == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
         return ENOMEM;
     }
 
-    now = time(NULL);
+    auth_data->key.type = HASH_KEY_STRING;
+    auth_data->key.str = talloc_strdup(auth_data, renew_data->upn);
+    if (auth_data->key.str == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
+        talloc_free(auth_data);
+        return ENOMEM;
+    }
+
+    delay = sss_rand() % RENEW_JITTER_USEC;
+    te = tevent_add_timer(renew_tgt_ctx->ev, auth_data,
+                          tevent_timeval_current_ofs(0, delay),
+                          renew_tgt, auth_data);
+    if (te == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
+        talloc_free(auth_data);
+        return ENOMEM;
+    }
 
-    for (c = 0; c < count; c++) {
-        renew_data = talloc_get_type(entries[c].value.ptr, struct renew_data);
-        DEBUG(SSSDBG_TRACE_ALL,
-              "Checking [%s] for renewal at [%.24s].\n", renew_data->ccfile,
-                  ctime(&renew_data->start_renew_at));
-        /* If renew_data->pd == NULL a renewal request for this data is
-         * currently running so we skip it. */
-        if (renew_data->start_renew_at < now && renew_data->pd != NULL) {
-            auth_data = talloc_zero(renew_tgt_ctx, struct auth_data);
-            if (auth_data == NULL) {
-                DEBUG(SSSDBG_CRIT_FAILURE, "talloc_zero failed.\n");
-            } else {
 /* We need to steal the pam_data here, because a successful renewal of the
  * ticket might add a new renewal item to the list with the same key (upn).
  * This would delete renew_data and all its children. But we cannot be sure
@@ -192,46 +389,101 @@ static errno_t renew_all_tgts(struct renew_tgt_ctx *renew_tgt_ctx)
  * renewal process is finished. In the case of an error during renewal we
  * might want to steal the pam_data back to renew_data before freeing
  * auth_data to allow a new renewal attempt. */
-                auth_data->pd = talloc_move(auth_data, &renew_data->pd);
-                auth_data->krb5_ctx = renew_tgt_ctx->krb5_ctx;
-                auth_data->be_ctx = renew_tgt_ctx->be_ctx;
-                auth_data->table = renew_tgt_ctx->tgt_table;
-                auth_data->renew_data = renew_data;
-                auth_data->key.type = entries[c].key.type;
-                auth_data->key.str = talloc_strdup(auth_data,
-                                                   entries[c].key.str);
-                if (auth_data->key.str == NULL) {
-                    DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
-                } else {
-                    te = tevent_add_timer(renew_tgt_ctx->ev, auth_data,
-                                          tevent_timeval_current_ofs(0, 100000*sent_for_renewal),
-                                          renew_tgt, auth_data);
-                    if (te == NULL) {
-                        DEBUG(SSSDBG_CRIT_FAILURE,
-                              "tevent_add_timer failed.\n");
-                    } else {
-                        sent_for_renewal++;
-                    }
-                }
-            }
+    auth_data->pd = talloc_move(auth_data, &renew_data->pd);
+    auth_data->renew_tgt_ctx = renew_tgt_ctx;
+    auth_data->krb5_ctx = renew_tgt_ctx->krb5_ctx;
+    auth_data->be_ctx = renew_tgt_ctx->be_ctx;
+    auth_data->table = renew_tgt_ctx->tgt_table;
+    auth_data->renew_data = renew_data;
+    renew_data->auth_data = auth_data;
 
-            if (auth_data == NULL || te == NULL) {
-                DEBUG(SSSDBG_CRIT_FAILURE,
-                      "Failed to renew TGT in [%s].\n", renew_data->ccfile);
-                ret = hash_delete(renew_tgt_ctx->tgt_table, &entries[c].key);
-                if (ret != HASH_SUCCESS) {
-                    DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
-                }
+    renew_tgt_ctx->running++;
+    talloc_set_destructor(auth_data, auth_data_destructor);
+
+    DEBUG(SSSDBG_TRACE_ALL, "Renewing [%s] in [%"PRIu32"] us.\n",
+          renew_data->ccfile, delay);
+
+    return EOK;
+}
+
+static void renew_tgt_timer_handler(struct tevent_context *ev,
+                                    struct tevent_timer *te,
+                                    struct timeval current_time, void *data);
+
+/* Starts the renewals which are due as long as there are free slots and arms
+ * the timer for the next deadline. A finished renewal calls this again. */
+static void renew_schedule(struct renew_tgt_ctx *renew_tgt_ctx)
+{
+    struct renew_data *renew_data;
+    hash_key_t key;
+    time_t deadline;
+    time_t now;
+    int ret;
+
+    if (be_is_offline(renew_tgt_ctx->be_ctx)) {
+        DEBUG(SSSDBG_CONF_SETTINGS, "Offline, disable renew timer.\n");
+        return;
+    }
+
+    now = time(NULL);
+
+    while (renew_tgt_ctx->heap_count > 0
+            && renew_tgt_ctx->running < RENEW_MAX_RUNNING
+            && renew_tgt_ctx->not_before <= now) {
+        renew_data = renew_tgt_ctx->heap[0];
+        if (renew_data->start_renew_at > now) {
+            break;
+        }
+
+        renew_heap_remove(renew_tgt_ctx, renew_data);
+
+        ret = renew_start(renew_tgt_ctx, renew_data);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Failed to renew TGT in [%s].\n", renew_data->ccfile);
+            /* The key must outlive renew_data which is freed by
+             * hash_delete() */
+            key.type = HASH_KEY_STRING;
+            key.str = discard_const_p(char, talloc_steal(renew_tgt_ctx,
+                                                         renew_data->upn));
+            ret = hash_delete(renew_tgt_ctx->tgt_table, &key);
+            if (ret != HASH_SUCCESS) {
+                DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
             }
+            talloc_free(key.str);
         }
     }
 
-    talloc_free(entries);
+    if (renew_tgt_ctx->heap_count == 0
+            || renew_tgt_ctx->running >= RENEW_MAX_RUNNING) {
+        talloc_zfree(renew_tgt_ctx->te);
+        return;
+    }
 
-    return EOK;
-}
+    /* Never sleep longer than krb5_renew_interval, an earlier timer which is
+     * already armed is kept, it just reschedules when it fires. */
+    deadline = MAX(renew_tgt_ctx->heap[0]->start_renew_at,
+                   renew_tgt_ctx->not_before);
+    deadline = MIN(deadline, now + renew_tgt_ctx->timer_interval);
+    if (renew_tgt_ctx->te != NULL && renew_tgt_ctx->te_deadline <= deadline) {
+        return;
+    }
+
+    DEBUG(SSSDBG_TRACE_LIBS, "Adding new renew timer for [%.24s].\n",
+          ctime(&deadline));
 
-static void renew_handler(struct renew_tgt_ctx *renew_tgt_ctx);
+    talloc_zfree(renew_tgt_ctx->te);
+    renew_tgt_ctx->te = tevent_add_timer(renew_tgt_ctx->ev, renew_tgt_ctx,
+                                         tevent_timeval_set(deadline, 0),
+                                         renew_tgt_timer_handler,
+                                         renew_tgt_ctx);
+    if (renew_tgt_ctx->te == NULL) {
+        /* The next added or finished renewal tries again */
+        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
+        return;
+    }
+    renew_tgt_ctx->te_deadline = deadline;
+}
 
 static void renew_tgt_offline_callback(void *private_data)
 {
@@ -246,7 +498,7 @@ static void renew_tgt_online_callback(void *private_data)
     struct renew_tgt_ctx *renew_tgt_ctx = talloc_get_type(private_data,
                                                           struct renew_tgt_ctx);
 
-    renew_handler(renew_tgt_ctx);
+    renew_schedule(renew_tgt_ctx);
 }
 
 static void renew_tgt_timer_handler(struct tevent_context *ev,
@@ -259,47 +511,7 @@ static void renew_tgt_timer_handler(struct tevent_context *ev,
     /* forget the timer event, it will be freed by the tevent timer loop */
     renew_tgt_ctx->te = NULL;
 
-    renew_handler(renew_tgt_ctx);
-}
-
-static void renew_handler(struct renew_tgt_ctx *renew_tgt_ctx)
-{
-    struct timeval next;
-    int ret;
-
-    if (be_is_offline(renew_tgt_ctx->be_ctx)) {
-        DEBUG(SSSDBG_CONF_SETTINGS, "Offline, disable renew timer.\n");
-        return;
-    }
-
-    ret = renew_all_tgts(renew_tgt_ctx);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "renew_all_tgts failed. "
-                  "Disabling automatic TGT renewal\n");
-        sss_log(SSS_LOG_ERR, "Disabling automatic TGT renewal.");
-        talloc_zfree(renew_tgt_ctx);
-        return;
-    }
-
-    if (renew_tgt_ctx->te != NULL) {
-        DEBUG(SSSDBG_TRACE_LIBS,
-              "There is an active renewal timer, doing nothing.\n");
-        return;
-    }
-
-    DEBUG(SSSDBG_TRACE_LIBS, "Adding new renew timer.\n");
-
-    next = sss_tevent_timeval_current_ofs_time_t(renew_tgt_ctx->timer_interval);
-    renew_tgt_ctx->te = tevent_add_timer(renew_tgt_ctx->ev, renew_tgt_ctx,
-                                         next, renew_tgt_timer_handler,
-                                         renew_tgt_ctx);
-    if (renew_tgt_ctx->te == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
-        sss_log(SSS_LOG_ERR, "Disabling automatic TGT renewal.");
-        talloc_zfree(renew_tgt_ctx);
-    }
-
-    return;
+    renew_schedule(renew_tgt_ctx);
 }
 
 static void renew_del_cb(hash_entry_t *entry, hash_destroy_enum type, void *pvt)
@@ -452,7 +664,6 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
                        struct tevent_context *ev, time_t renew_intv)
 {
     int ret;
-    struct timeval next;
 
     krb5_ctx->renew_tgt_ctx = talloc_zero(krb5_ctx, struct renew_tgt_ctx);
     if (krb5_ctx->renew_tgt_ctx == NULL) {
@@ -460,6 +671,8 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
         return ENOMEM;
     }
 
+    talloc_set_destructor(krb5_ctx->renew_tgt_ctx, renew_tgt_ctx_destructor);
+
     ret = sss_hash_create_ex(krb5_ctx->renew_tgt_ctx, 0,
                              &krb5_ctx->renew_tgt_ctx->tgt_table, 0, 0, 0, 0,
                              renew_del_cb, NULL);
@@ -472,6 +685,8 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
     krb5_ctx->renew_tgt_ctx->krb5_ctx = krb5_ctx;
     krb5_ctx->renew_tgt_ctx->ev = ev;
     krb5_ctx->renew_tgt_ctx->timer_interval = renew_intv;
+    /* Tickets found in the cache are renewed one interval after startup */
+    krb5_ctx->renew_tgt_ctx->not_before = time(NULL) + renew_intv;
 
     ret = check_ccache_files(krb5_ctx->renew_tgt_ctx);
     if (ret != EOK) {
@@ -479,16 +694,6 @@ errno_t init_renew_tgt(struct krb5_ctx *krb5_ctx, struct be_ctx *be_ctx,
               "Failed to read ccache files, continuing ...\n");
     }
 
-    next = sss_tevent_timeval_current_ofs_time_t(krb5_ctx->renew_tgt_ctx->timer_interval);
-    krb5_ctx->renew_tgt_ctx->te = tevent_add_timer(ev, krb5_ctx->renew_tgt_ctx,
-                                                   next, renew_tgt_timer_handler,
-                                                   krb5_ctx->renew_tgt_ctx);
-    if (krb5_ctx->renew_tgt_ctx->te == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "tevent_add_timer failed.\n");
-        ret = ENOMEM;
-        goto fail;
-    }
-
     DEBUG(SSSDBG_TRACE_LIBS,
           "Adding offline callback to remove renewal timer.\n");
     ret = be_add_offline_cb(krb5_ctx->renew_tgt_ctx, be_ctx,
@@ -553,6 +758,16 @@ errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
         ret = ENOMEM;
         goto done;
     }
+    renew_data->renew_tgt_ctx = krb5_ctx->renew_tgt_ctx;
+    renew_data->heap_idx = RENEW_NOT_QUEUED;
+    talloc_set_destructor(renew_data, renew_data_destructor);
+
+    renew_data->upn = talloc_strdup(renew_data, upn);
+    if (renew_data->upn == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "talloc_strdup failed.\n");
+        ret = ENOMEM;
+        goto done;
+    }
 
     if (ccfile[0] == '/') {
         renew_data->ccfile = talloc_asprintf(renew_data, "FILE:%s", ccfile);
@@ -596,11 +811,24 @@ errno_t add_tgt_to_renew_table(struct krb5_ctx *krb5_ctx, const char *ccfile,
         goto done;
     }
 
+    ret = renew_heap_push(krb5_ctx->renew_tgt_ctx, renew_data);
+    if (ret != EOK) {
+        /* frees renew_data */
+        renew_data = NULL;
+        if (hash_delete(krb5_ctx->renew_tgt_ctx->tgt_table,
+                        &key) != HASH_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "hash_delete failed.\n");
+        }
+        goto done;
+    }
+
     DEBUG(SSSDBG_TRACE_LIBS,
           "Added [%s] for renewal at [%s].\n", renew_data->ccfile,
           (renew_data->start_renew_at > time(NULL)) ?
               ctime(&renew_data->start_renew_at) : "immediately");
 
+    renew_schedule(krb5_ctx->renew_tgt_ctx);
+
     ret = EOK;
 
 done:
@@ -33,6 +33,7 @@
 #include "util/util.h"
 #include "util/sss_krb5.h"
 #include "util/child_common.h"
+#include "util/sss_trace.h"
 #include "providers/backend.h"
 #include "providers/ldap/ldap_common.h"
 #include "providers/krb5/krb5_common.h"
@@ -973,7 +974,7 @@ static errno_t handle_get_tgt(TALLOC_CTX *mem_ctx,
 
 int main(int argc, const char *argv[])
 {
-    int ret;
+    int ret = EOK;
     int opt;
     int dumpable = 1;
     int debug_fd = -1;
@@ -986,6 +987,7 @@ int main(int argc, const char *argv[])
     struct response *resp = NULL;
     ssize_t written;
     char *caps = NULL;
+    struct sss_trace_span *span = NULL;
 
     struct poptOption long_options[] = {
         POPT_AUTOHELP
@@ -1034,6 +1036,8 @@ int main(int argc, const char *argv[])
 
     DEBUG_INIT(debug_level, opt_logger);
 
+    span = sss_trace_span_begin(NULL, SSS_TRACE_CHILD, "ldap_child");
+
     BlockSignals(false, SIGTERM);
     CatchSignal(SIGTERM, sig_term_handler);
 
@@ -1123,11 +1127,13 @@ int main(int argc, const char *argv[])
     DEBUG(SSSDBG_TRACE_FUNC, "ldap_child completed successfully\n");
     close(STDOUT_FILENO);
     talloc_free(main_ctx);
+    sss_trace_span_end(span, EOK);
     _exit(0);
 
 fail:
     DEBUG(SSSDBG_CRIT_FAILURE, "ldap_child failed!\n");
     close(STDOUT_FILENO);
     talloc_free(main_ctx);
+    sss_trace_span_end(span, ret == EOK ? ERR_INTERNAL : ret);
     _exit(-1);
 }
@@ -399,6 +399,30 @@ int sdap_get_map(TALLOC_CTX *memctx,
 
 /* =Parse-msg============================================================= */
 
+#define SDAP_PARSE_ARENA_SIZE (64 * 1024)
+#define SDAP_PARSE_ARENA_ENTRIES 32
+
+TALLOC_CTX *sdap_parse_arena_get(TALLOC_CTX *owner,
+                                 struct sdap_parse_arena *arena)
+{
+    if (arena->pool == NULL || arena->entries >= SDAP_PARSE_ARENA_ENTRIES) {
+        /* The memory of the previous pool is released once all entries
+         * parsed into it are freed. */
+        talloc_free(arena->pool);
+        arena->entries = 0;
+
+        arena->pool = talloc_pool(owner, SDAP_PARSE_ARENA_SIZE);
+        if (arena->pool == NULL) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "talloc_pool failed, "
+                  "parsing without an arena\n");
+            return owner;
+        }
+    }
+
+    arena->entries++;
+    return arena->pool;
+}
+
 static bool objectclass_matched(struct sdap_attr_map *map,
                                 const char *objcl, int len);
 int sdap_parse_entry(TALLOC_CTX *memctx,
@@ -410,7 +434,13 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
     struct sysdb_attrs *attrs;
     BerElement *ber = NULL;
     struct berval **vals;
-    struct ldb_val v;
+    struct berval dn;
+    struct ldb_val dn_val;
+    struct berval attr;
+    BerVarray bvals = NULL;
+    struct ldb_val *v;
+    size_t num_v;
+    size_t num_attrs = 0;
     char *str;
     int lerrno;
     int i, ret, ai;
@@ -430,25 +460,30 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
               sss_ldap_err2string(ret));
     }
 
-    attrs = sysdb_new_attrs(tmp_ctx);
+    /* allocated directly on memctx, which may be a talloc pool */
+    attrs = sysdb_new_attrs(memctx);
     if (!attrs) {
         ret = ENOMEM;
         goto done;
     }
 
-    str = ldap_get_dn(sh->ldap, sm->msg);
-    if (!str) {
-        ldap_get_option(sh->ldap, LDAP_OPT_RESULT_CODE, &lerrno);
-        DEBUG(SSSDBG_CRIT_FAILURE, "ldap_get_dn failed: %d(%s)\n",
-              lerrno, sss_ldap_err2string(lerrno));
+    /* The DN, the attribute names and the values returned by
+     * ldap_get_dn_ber() and ldap_get_attribute_ber() point into the BER
+     * buffer of the message, they are copied only once into attrs. */
+    ret = ldap_get_dn_ber(sh->ldap, sm->msg, &ber, &dn);
+    if (ret != LDAP_SUCCESS || dn.bv_val == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "ldap_get_dn_ber failed: %d(%s)\n",
+              ret, sss_ldap_err2string(ret));
         ret = EIO;
         goto done;
     }
 
-    DEBUG(SSSDBG_TRACE_LIBS, "OriginalDN: [%s].\n", str);
-    PROBE(SDAP_PARSE_ENTRY, "OriginalDN", str, strlen(str));
-    ret = sysdb_attrs_add_string(attrs, SYSDB_ORIG_DN, str);
-    ldap_memfree(str);
+    DEBUG(SSSDBG_TRACE_LIBS, "OriginalDN: [%.*s].\n",
+          (int) dn.bv_len, dn.bv_val);
+    PROBE(SDAP_PARSE_ENTRY, "OriginalDN", dn.bv_val, dn.bv_len);
+    dn_val.data = (uint8_t *) dn.bv_val;
+    dn_val.length = dn.bv_len;
+    ret = sysdb_attrs_add_val(attrs, SYSDB_ORIG_DN, &dn_val);
     if (ret) goto done;
 
     if (map) {
@@ -476,20 +511,27 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
         ldap_value_free_len(vals);
     }
 
-    str = ldap_first_attribute(sh->ldap, sm->msg, &ber);
-    if (!str) {
-        ldap_get_option(sh->ldap, LDAP_OPT_RESULT_CODE, &lerrno);
-        DEBUG(lerrno == LDAP_SUCCESS
-              ? SSSDBG_TRACE_LIBS
-              : SSSDBG_MINOR_FAILURE,
-              "Entry has no attributes [%d(%s)]!?\n",
-               lerrno, sss_ldap_err2string(lerrno));
-        if (map) {
-            ret = EINVAL;
+    while (true) {
+        ret = ldap_get_attribute_ber(sh->ldap, sm->msg, ber, &attr, &bvals);
+        if (ret != LDAP_SUCCESS) {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "ldap_get_attribute_ber() failed: %d(%s)\n",
+                  ret, sss_ldap_err2string(ret));
+            ret = EIO;
             goto done;
         }
-    }
-    while (str) {
+
+        if (attr.bv_val == NULL) {
+            break;
+        }
+        num_attrs++;
+
+        str = talloc_strndup(tmp_ctx, attr.bv_val, attr.bv_len);
+        if (!str) {
+            ret = ENOMEM;
+            goto done;
+        }
+
         base64 = false;
 
         ret = sdap_parse_range(tmp_ctx, str, &base_attr, &range_offset,
@@ -539,104 +581,95 @@ int sdap_parse_entry(TALLOC_CTX *memctx,
         }
 
         if (store) {
-            vals = ldap_get_values_len(sh->ldap, sm->msg, str);
-            if (!vals) {
-                ldap_get_option(sh->ldap, LDAP_OPT_RESULT_CODE, &lerrno);
-                if (lerrno != LDAP_SUCCESS) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "ldap_get_values_len() failed: %d(%s)\n",
-                          lerrno, sss_ldap_err2string(lerrno));
-                    ret = EIO;
-                    goto done;
-                }
-
+            for (num_v = 0; bvals && bvals[num_v].bv_val; num_v++);
+            if (num_v == 0) {
                 DEBUG(SSSDBG_TRACE_LIBS,
                       "Attribute [%s] has no values, skipping.\n", str);
-
             } else {
-                if (!vals[0]) {
-                    DEBUG(SSSDBG_CRIT_FAILURE,
-                          "Missing value after ldap_get_values() ??\n");
-                    ldap_value_free_len(vals);
-                    ret = EINVAL;
+                v = talloc_array(tmp_ctx, struct ldb_val, num_v);
+                if (!v) {
+                    ret = ENOMEM;
                     goto done;
                 }
-                for (i = 0; vals[i]; i++) {
-                    if (vals[i]->bv_len == 0) {
+
+                num_v = 0;
+                for (i = 0; bvals[i].bv_val; i++) {
+                    if (bvals[i].bv_len == 0) {
                         DEBUG(SSSDBG_TRACE_LIBS,
                               "Value of attribute [%s] is empty. "
                                "Skipping this value.\n", str);
                         continue;
                     }
                     if (base64) {
-                        v.data = (uint8_t *) sss_base64_encode(attrs,
-                                 (uint8_t *) vals[i]->bv_val, vals[i]->bv_len);
-                        if (!v.data) {
-                            ldap_value_free_len(vals);
+                        v[num_v].data = (uint8_t *) sss_base64_encode(v,
+                                 (uint8_t *) bvals[i].bv_val, bvals[i].bv_len);
+                        if (!v[num_v].data) {
                             ret = ENOMEM;
                             goto done;
                         }
-                        v.length = strlen((const char *)v.data);
+                        v[num_v].length = strlen((const char *)v[num_v].data);
                     } else {
-                        v.data = (uint8_t *)vals[i]->bv_val;
-                        v.length = vals[i]->bv_len;
+                        v[num_v].data = (uint8_t *)bvals[i].bv_val;
+                        v[num_v].length = bvals[i].bv_len;
                     }
-                    PROBE(SDAP_PARSE_ENTRY, str, v.data, v.length);
-
-                    if (map) {
-                        /* The same LDAP attr might be used for more sysdb
-                         * attrs in case there is a map. Find all that match
-                         * and copy the value
-                         */
-                        for (ai = base_attr_idx; ai < attrs_num; ai++) {
-                            /* check if this attr is valid with the chosen
-                             * schema */
-                            if (!map[ai].name) continue;
-
-                            /* check if it is an attr we are interested in */
-                            if (strcasecmp(base_attr, map[ai].name) == 0) {
-                                ret = sysdb_attrs_add_val(attrs,
-                                                          map[ai].sys_name,
-                                                          &v);
-                                if (ret) {
-                                    ldap_value_free_len(vals);
-                                    goto done;
-                                }
+                    PROBE(SDAP_PARSE_ENTRY, str, v[num_v].data,
+                          v[num_v].length);
+                    num_v++;
+                }
+
+                if (map) {
+                    /* The same LDAP attr might be used for more sysdb
+                     * attrs in case there is a map. Find all that match
+                     * and copy the values
+                     */
+                    for (ai = base_attr_idx; ai < attrs_num; ai++) {
+                        /* check if this attr is valid with the chosen
+                         * schema */
+                        if (!map[ai].name) continue;
+
+                        /* check if it is an attr we are interested in */
+                        if (strcasecmp(base_attr, map[ai].name) == 0) {
+                            ret = sysdb_attrs_add_vals(attrs,
+                                                       map[ai].sys_name,
+                                                       v, num_v);
+                            if (ret) {
+                                goto done;
                             }
                         }
-                    } else {
-                        /* No map, just store the attribute */
-                        ret = sysdb_attrs_add_val(attrs, name, &v);
-                        if (ret) {
-                            ldap_value_free_len(vals);
-                            goto done;
-                        }
+                    }
+                } else {
+                    /* No map, just store the attribute */
+                    ret = sysdb_attrs_add_vals(attrs, name, v, num_v);
+                    if (ret) {
+                        goto done;
                     }
                 }
-                ldap_value_free_len(vals);
+                talloc_free(v);
             }
         }
 
-        ldap_memfree(str);
-        str = ldap_next_attribute(sh->ldap, sm->msg, ber);
+        talloc_free(str);
+        ber_memfree(bvals);
+        bvals = NULL;
     }
-    ber_free(ber, 0);
-    ber = NULL;
 
-    ldap_get_option(sh->ldap, LDAP_OPT_RESULT_CODE, &lerrno);
-    if (lerrno) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "ldap_get_option() failed: %d(%s)\n",
-              lerrno, sss_ldap_err2string(lerrno));
-        ret = EIO;
-        goto done;
+    if (num_attrs == 0) {
+        DEBUG(SSSDBG_TRACE_LIBS, "Entry has no attributes!?\n");
+        if (map) {
+            ret = EINVAL;
+            goto done;
+        }
     }
 
     PROBE(SDAP_PARSE_ENTRY_DONE);
-    *_attrs = talloc_steal(memctx, attrs);
+    *_attrs = attrs;
+    attrs = NULL;
     ret = EOK;
 
 done:
+    ber_memfree(bvals);
     if (ber) ber_free(ber, 0);
+    talloc_free(attrs);
     talloc_free(tmp_ctx);
     return ret;
 }
@@ -239,6 +239,9 @@ enum sdap_basic_opt {
     SDAP_LIBRARY_DEBUG_LEVEL,
     SDAP_USE_PPOLICY,
     SDAP_PPOLICY_PWD_CHANGE_THRESHOLD,
+    SDAP_ENUM_MAX_SEARCHES,
+    SDAP_ACCESS_FILTER_LOCAL,
+    SDAP_PWDLOCKOUT_CACHE_TIMEOUT,
 
     SDAP_OPTS_BASIC /* opts counter */
 };
@@ -647,6 +650,25 @@ int sdap_get_map(TALLOC_CTX *memctx,
                  int num_entries,
                  struct sdap_attr_map **_map);
 
+/* Parsing large search results creates many small allocations per entry.
+ * The parse arena hands out talloc pools which a batch of entries is parsed
+ * into, the entries can still be stolen or freed like any other talloc
+ * context. A zeroed structure is a valid empty arena.
+ *
+ * Stealing an entry does not move its memory out of the pool. A 64KB pool
+ * is released only when the last entry parsed into it is freed, so a single
+ * entry kept for a long time keeps the whole pool alive. It is therefore
+ * used only by the wildcard and enumeration lookups of users and groups,
+ * which save the entries to the cache and free them within the request.
+ * Callers which keep entries beyond the request must not use it. */
+struct sdap_parse_arena {
+    TALLOC_CTX *pool;
+    size_t entries;
+};
+
+TALLOC_CTX *sdap_parse_arena_get(TALLOC_CTX *owner,
+                                 struct sdap_parse_arena *arena);
+
 int sdap_parse_entry(TALLOC_CTX *memctx,
                      struct sdap_handle *sh, struct sdap_msg *sm,
                      struct sdap_attr_map *map, int attrs_num,
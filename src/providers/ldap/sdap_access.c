@@ -32,6 +32,7 @@
 
 #include "util/util.h"
 #include "util/strtonum.h"
+#include "util/sss_ptr_hash.h"
 #include "db/sysdb.h"
 #include "providers/ldap/ldap_common.h"
 #include "providers/ldap/sdap.h"
@@ -45,12 +46,6 @@
 #define PERMANENTLY_LOCKED_ACCOUNT "000001010000Z"
 #define MALFORMED_FILTER "Malformed access control filter [%s]\n"
 
-enum sdap_pwpolicy_mode {
-    PWP_LOCKOUT_ONLY,
-    PWP_LOCKOUT_EXPIRE,
-    PWP_SENTINEL,
-};
-
 static errno_t perform_pwexpire_policy(TALLOC_CTX *mem_ctx,
                                        struct sss_domain_info *domain,
                                        struct pam_data *pd,
@@ -75,6 +70,7 @@ sdap_access_ppolicy_send(TALLOC_CTX *mem_ctx,
                          struct sdap_id_conn_ctx *conn,
                          const char *username,
                          struct ldb_message *user_entry,
+                         struct sysdb_attrs *user_attrs,
                          enum sdap_pwpolicy_mode pwpol_mod);
 
 static struct tevent_req *sdap_access_filter_send(TALLOC_CTX *mem_ctx,
@@ -88,8 +84,24 @@ static struct tevent_req *sdap_access_filter_send(TALLOC_CTX *mem_ctx,
 
 static errno_t sdap_access_filter_recv(struct tevent_req *req);
 
+static errno_t sdap_access_filter_decide(struct sss_domain_info *domain,
+                                         const char *username,
+                                         bool found);
+
 static errno_t sdap_access_ppolicy_recv(struct tevent_req *req);
 
+static struct tevent_req *
+sdap_access_prefetch_send(TALLOC_CTX *mem_ctx,
+                          struct tevent_context *ev,
+                          struct sdap_access_ctx *access_ctx,
+                          struct sdap_id_conn_ctx *conn,
+                          const char *username,
+                          struct ldb_message *user_entry);
+
+static errno_t sdap_access_prefetch_recv(struct tevent_req *req,
+                                         TALLOC_CTX *mem_ctx,
+                                         struct sdap_access_prefetch **_pf);
+
 static errno_t sdap_account_expired(struct sdap_access_ctx *access_ctx,
                                     struct pam_data *pd,
                                     struct ldb_message *user_entry);
@@ -114,10 +126,15 @@ struct sdap_access_req_ctx {
     struct be_ctx *be_ctx;
     struct sss_domain_info *domain;
     struct ldb_message *user_entry;
+    /* result of the combined user entry search, NULL if the rules
+     * search for the entry on their own */
+    struct sdap_access_prefetch *prefetch;
     size_t current_rule;
     enum sdap_access_control_type ac_type;
 };
 
+static bool sdap_access_want_prefetch(struct sdap_access_req_ctx *state);
+static void sdap_access_prefetch_done(struct tevent_req *subreq);
 static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
                                            struct tevent_req *req);
 static void sdap_access_done(struct tevent_req *subreq);
@@ -134,6 +151,7 @@ sdap_access_send(TALLOC_CTX *mem_ctx,
     errno_t ret;
     struct sdap_access_req_ctx *state;
     struct tevent_req *req;
+    struct tevent_req *subreq;
     struct ldb_result *res;
     const char *attrs[] = { "*", NULL };
 
@@ -188,6 +206,18 @@ sdap_access_send(TALLOC_CTX *mem_ctx,
 
     state->user_entry = res->msgs[0];
 
+    if (sdap_access_want_prefetch(state)) {
+        subreq = sdap_access_prefetch_send(state, ev, access_ctx, conn,
+                                           pd->user, state->user_entry);
+        if (subreq == NULL) {
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, sdap_access_prefetch_done, req);
+        return req;
+    }
+
     ret = sdap_access_check_next_rule(state, req);
     if (ret == EAGAIN) {
         return req;
@@ -203,12 +233,89 @@ done:
     return req;
 }
 
+/* The filter and ppolicy rules both search for the user entry, if both are
+ * configured a single search answers both of them. */
+static bool sdap_access_want_prefetch(struct sdap_access_req_ctx *state)
+{
+    struct sdap_access_ctx *access_ctx = state->access_ctx;
+    bool has_filter = false;
+    bool has_ppolicy = false;
+    bool allowed;
+    errno_t ret;
+    size_t i;
+
+    for (i = 0; access_ctx->access_rule[i] != LDAP_ACCESS_EMPTY; i++) {
+        switch (access_ctx->access_rule[i]) {
+        case LDAP_ACCESS_FILTER:
+            has_filter = true;
+            break;
+        case LDAP_ACCESS_LOCKOUT:
+        case LDAP_ACCESS_PPOLICY:
+            has_ppolicy = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!has_filter || !has_ppolicy
+            || access_ctx->filter == NULL || *access_ctx->filter == '\0'
+            || be_is_offline(state->be_ctx)) {
+        return false;
+    }
+
+    /* no need to ask the server about the filter at all */
+    ret = sdap_access_local_filter_eval(access_ctx->local_filter,
+                                        sysdb_ctx_get_ldb(state->domain->sysdb),
+                                        state->user_entry, &allowed);
+    if (ret == EOK) {
+        return false;
+    }
+
+    return true;
+}
+
+static void sdap_access_prefetch_done(struct tevent_req *subreq)
+{
+    errno_t ret;
+    struct tevent_req *req;
+    struct sdap_access_req_ctx *state;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_access_req_ctx);
+
+    ret = sdap_access_prefetch_recv(subreq, state, &state->prefetch);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Combined user entry search failed [%d]: %s, "
+              "the rules will search on their own\n",
+              ret, sss_strerror(ret));
+        state->prefetch = NULL;
+    }
+
+    ret = sdap_access_check_next_rule(state, req);
+    switch (ret) {
+    case EAGAIN:
+        return;
+    case EOK:
+        tevent_req_done(req);
+        return;
+    default:
+        tevent_req_error(req, ret);
+        return;
+    }
+}
+
 static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
                                            struct tevent_req *req)
 {
     struct tevent_req *subreq;
+    struct sysdb_attrs *user_attrs;
     int ret = EOK;
 
+    user_attrs = state->prefetch != NULL ? state->prefetch->user_attrs : NULL;
+
     while (ret == EOK) {
         switch (state->access_ctx->access_rule[state->current_rule]) {
         case LDAP_ACCESS_EMPTY:
@@ -228,6 +335,7 @@ static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
                                               state->conn,
                                               state->pd->user,
                                               state->user_entry,
+                                              user_attrs,
                                               PWP_LOCKOUT_ONLY);
             if (subreq == NULL) {
                 DEBUG(SSSDBG_CRIT_FAILURE,
@@ -247,6 +355,7 @@ static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
                                               state->conn,
                                               state->pd->user,
                                               state->user_entry,
+                                              user_attrs,
                                               PWP_LOCKOUT_EXPIRE);
             if (subreq == NULL) {
                 DEBUG(SSSDBG_CRIT_FAILURE,
@@ -260,6 +369,13 @@ static errno_t sdap_access_check_next_rule(struct sdap_access_req_ctx *state,
             return EAGAIN;
 
         case LDAP_ACCESS_FILTER:
+            if (state->prefetch != NULL) {
+                ret = sdap_access_filter_decide(state->domain,
+                                                state->pd->user,
+                                                state->prefetch->filter_match);
+                break;
+            }
+
             subreq = sdap_access_filter_send(state, state->ev, state->be_ctx,
                                              state->domain,
                                              state->access_ctx,
@@ -819,6 +935,412 @@ done:
     return ret;
 }
 
+/* ==Local-access-filter-evaluation===================================== */
+enum sdap_access_local_match {
+    SDAP_ACCESS_MATCH_CASE_IGNORE,
+    SDAP_ACCESS_MATCH_INTEGER,
+    SDAP_ACCESS_MATCH_DN,
+};
+
+/* Attributes that are cached with the values the server returned, so a
+ * filter on them gives the same answer locally as on the server. */
+static const struct sdap_access_local_attr {
+    int map_idx;
+    const char *sysdb_attr;
+    enum sdap_access_local_match match;
+} sdap_access_local_attrs[] = {
+    { SDAP_AT_USER_UID, SYSDB_UIDNUM, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_USER_GID, SYSDB_GIDNUM, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_USER_MEMBEROF, SYSDB_ORIG_MEMBEROF, SDAP_ACCESS_MATCH_DN },
+    { SDAP_AT_SP_LSTCHG, SYSDB_SHADOWPW_LASTCHANGE, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_MIN, SYSDB_SHADOWPW_MIN, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_MAX, SYSDB_SHADOWPW_MAX, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_WARN, SYSDB_SHADOWPW_WARNING, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_INACT, SYSDB_SHADOWPW_INACTIVE, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_EXPIRE, SYSDB_SHADOWPW_EXPIRE, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_SP_FLAG, SYSDB_SHADOWPW_FLAG, SDAP_ACCESS_MATCH_INTEGER },
+    { SDAP_AT_AUTH_SVC, SYSDB_AUTHORIZED_SERVICE, SDAP_ACCESS_MATCH_CASE_IGNORE },
+    { SDAP_AT_AUTHORIZED_HOST, SYSDB_AUTHORIZED_HOST, SDAP_ACCESS_MATCH_CASE_IGNORE },
+    { SDAP_AT_AUTHORIZED_RHOST, SYSDB_AUTHORIZED_RHOST, SDAP_ACCESS_MATCH_CASE_IGNORE },
+    { -1, NULL, 0 }
+};
+
+struct sdap_access_local_filter {
+    /* parsed filter with attribute names translated to sysdb names */
+    struct ldb_parse_tree *tree;
+};
+
+static errno_t sdap_access_local_parse_int(const char *str, int64_t *_num)
+{
+    char *endptr;
+    long long num;
+
+    errno = 0;
+    num = strtoll(str, &endptr, 10);
+    if (errno != 0 || endptr == str || *endptr != '\0') {
+        return EINVAL;
+    }
+
+    *_num = num;
+    return EOK;
+}
+
+static const struct sdap_access_local_attr *
+sdap_access_local_attr_by_sysdb(const char *sysdb_attr)
+{
+    size_t i;
+
+    for (i = 0; sdap_access_local_attrs[i].sysdb_attr != NULL; i++) {
+        if (strcmp(sdap_access_local_attrs[i].sysdb_attr, sysdb_attr) == 0) {
+            return &sdap_access_local_attrs[i];
+        }
+    }
+
+    return NULL;
+}
+
+static errno_t sdap_access_local_translate_attr(struct sdap_attr_map *user_map,
+                                                const char **_attr,
+                                                enum sdap_access_local_match *_m)
+{
+    const char *ldap_name;
+    size_t i;
+
+    for (i = 0; sdap_access_local_attrs[i].sysdb_attr != NULL; i++) {
+        ldap_name = user_map[sdap_access_local_attrs[i].map_idx].name;
+        if (ldap_name != NULL && strcasecmp(ldap_name, *_attr) == 0) {
+            *_attr = sdap_access_local_attrs[i].sysdb_attr;
+            *_m = sdap_access_local_attrs[i].match;
+            return EOK;
+        }
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Attribute [%s] is not cached verbatim\n", *_attr);
+    return ENOTSUP;
+}
+
+static errno_t sdap_access_local_translate(struct sdap_attr_map *user_map,
+                                           struct ldb_parse_tree *tree)
+{
+    enum sdap_access_local_match match;
+    const char *value;
+    int64_t num;
+    errno_t ret;
+    unsigned int i;
+
+    switch (tree->operation) {
+    case LDB_OP_AND:
+    case LDB_OP_OR:
+        for (i = 0; i < tree->u.list.num_elements; i++) {
+            ret = sdap_access_local_translate(user_map,
+                                              tree->u.list.elements[i]);
+            if (ret != EOK) {
+                return ret;
+            }
+        }
+        return EOK;
+    case LDB_OP_NOT:
+        return sdap_access_local_translate(user_map, tree->u.isnot.child);
+    case LDB_OP_PRESENT:
+        return sdap_access_local_translate_attr(user_map,
+                                                &tree->u.present.attr, &match);
+    case LDB_OP_EQUALITY:
+    case LDB_OP_GREATER:
+    case LDB_OP_LESS:
+        ret = sdap_access_local_translate_attr(user_map,
+                                               &tree->u.comparison.attr,
+                                               &match);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        value = (const char *) tree->u.comparison.value.data;
+        if (match == SDAP_ACCESS_MATCH_INTEGER) {
+            if (sdap_access_local_parse_int(value, &num) != EOK) {
+                return ENOTSUP;
+            }
+        } else if (tree->operation != LDB_OP_EQUALITY) {
+            /* ordering is only well defined for integers */
+            return ENOTSUP;
+        }
+        return EOK;
+    default:
+        DEBUG(SSSDBG_TRACE_FUNC,
+              "Filter operation %d cannot be evaluated locally\n",
+              tree->operation);
+        return ENOTSUP;
+    }
+}
+
+errno_t sdap_access_local_filter_compile(TALLOC_CTX *mem_ctx,
+                                         struct sdap_attr_map *user_map,
+                                         const char *filter,
+                                         struct sdap_access_local_filter **_lf)
+{
+    struct sdap_access_local_filter *lf;
+    errno_t ret;
+
+    lf = talloc_zero(mem_ctx, struct sdap_access_local_filter);
+    if (lf == NULL) {
+        return ENOMEM;
+    }
+
+    lf->tree = ldb_parse_tree(lf, filter);
+    if (lf->tree == NULL) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot parse filter [%s]\n", filter);
+        ret = ENOTSUP;
+        goto done;
+    }
+
+    ret = sdap_access_local_translate(user_map, lf->tree);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_lf = lf;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(lf);
+    }
+    return ret;
+}
+
+/* Returns EAGAIN where the server would consider the assertion
+ * undefined, e.g. for a malformed cached value. */
+static errno_t sdap_access_local_value_cmp(struct ldb_context *ldb,
+                                           enum sdap_access_local_match match,
+                                           enum ldb_parse_op op,
+                                           const char *cached,
+                                           const char *wanted,
+                                           bool *_match)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_dn *cached_dn;
+    struct ldb_dn *wanted_dn;
+    int64_t cached_num;
+    int64_t wanted_num;
+    errno_t ret;
+
+    switch (match) {
+    case SDAP_ACCESS_MATCH_INTEGER:
+        if (sdap_access_local_parse_int(cached, &cached_num) != EOK
+                || sdap_access_local_parse_int(wanted, &wanted_num) != EOK) {
+            return EAGAIN;
+        }
+        if (op == LDB_OP_GREATER) {
+            *_match = (cached_num >= wanted_num);
+        } else if (op == LDB_OP_LESS) {
+            *_match = (cached_num <= wanted_num);
+        } else {
+            *_match = (cached_num == wanted_num);
+        }
+        return EOK;
+    case SDAP_ACCESS_MATCH_DN:
+        tmp_ctx = talloc_new(NULL);
+        if (tmp_ctx == NULL) {
+            return ENOMEM;
+        }
+        cached_dn = ldb_dn_new(tmp_ctx, ldb, cached);
+        wanted_dn = ldb_dn_new(tmp_ctx, ldb, wanted);
+        if (ldb_dn_validate(cached_dn) && ldb_dn_validate(wanted_dn)) {
+            *_match = (ldb_dn_compare(cached_dn, wanted_dn) == 0);
+            ret = EOK;
+        } else {
+            ret = EAGAIN;
+        }
+        talloc_free(tmp_ctx);
+        return ret;
+    case SDAP_ACCESS_MATCH_CASE_IGNORE:
+        *_match = (strcasecmp(cached, wanted) == 0);
+        return EOK;
+    }
+
+    return EAGAIN;
+}
+
+static errno_t sdap_access_local_match(struct ldb_context *ldb,
+                                       struct ldb_parse_tree *tree,
+                                       struct ldb_message *msg,
+                                       bool *_match)
+{
+    const struct sdap_access_local_attr *la;
+    struct ldb_message_element *el;
+    const char *attr;
+    bool match;
+    errno_t ret;
+    unsigned int i;
+
+    switch (tree->operation) {
+    case LDB_OP_AND:
+    case LDB_OP_OR:
+        /* empty AND is true, empty OR is false */
+        *_match = (tree->operation == LDB_OP_AND);
+        for (i = 0; i < tree->u.list.num_elements; i++) {
+            ret = sdap_access_local_match(ldb, tree->u.list.elements[i],
+                                          msg, &match);
+            if (ret != EOK) {
+                return ret;
+            }
+
+            if (match != *_match) {
+                *_match = match;
+                break;
+            }
+        }
+        return EOK;
+    case LDB_OP_NOT:
+        ret = sdap_access_local_match(ldb, tree->u.isnot.child, msg, &match);
+        if (ret != EOK) {
+            return ret;
+        }
+        *_match = !match;
+        return EOK;
+    case LDB_OP_PRESENT:
+        attr = tree->u.present.attr;
+        break;
+    case LDB_OP_EQUALITY:
+    case LDB_OP_GREATER:
+    case LDB_OP_LESS:
+        attr = tree->u.comparison.attr;
+        break;
+    default:
+        return ENOTSUP;
+    }
+
+    /* A missing attribute may mean that the server does not provide it
+     * at all (e.g. no memberOf overlay), so only the server can tell. */
+    el = ldb_msg_find_element(msg, attr);
+    if (el == NULL || el->num_values == 0) {
+        return EAGAIN;
+    }
+
+    if (tree->operation == LDB_OP_PRESENT) {
+        *_match = true;
+        return EOK;
+    }
+
+    la = sdap_access_local_attr_by_sysdb(attr);
+    if (la == NULL) {
+        return ENOTSUP;
+    }
+
+    *_match = false;
+    for (i = 0; i < el->num_values; i++) {
+        ret = sdap_access_local_value_cmp(ldb, la->match, tree->operation,
+                                (const char *) el->values[i].data,
+                                (const char *) tree->u.comparison.value.data,
+                                &match);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        if (match) {
+            *_match = true;
+            break;
+        }
+    }
+
+    return EOK;
+}
+
+errno_t sdap_access_local_filter_eval(struct sdap_access_local_filter *lf,
+                                      struct ldb_context *ldb,
+                                      struct ldb_message *user_entry,
+                                      bool *_allowed)
+{
+    uint64_t expire;
+
+    if (lf == NULL) {
+        return EAGAIN;
+    }
+
+    expire = ldb_msg_find_attr_as_uint64(user_entry, SYSDB_CACHE_EXPIRE, 0);
+    if (expire <= (uint64_t) time(NULL)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached entry is expired\n");
+        return EAGAIN;
+    }
+
+    return sdap_access_local_match(ldb, lf->tree, user_entry, _allowed);
+}
+
+/* Base-scoped filter matching the user entry only if it also matches
+ * the access filter */
+static errno_t sdap_access_user_filter(TALLOC_CTX *mem_ctx,
+                                       struct sdap_options *opts,
+                                       const char *access_filter,
+                                       const char *username,
+                                       const char **_filter)
+{
+    char *clean_username;
+    const char *filter;
+    char *name;
+    errno_t ret;
+
+    ret = sss_parse_internal_fqname(mem_ctx, username, &name, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Could not parse [%s] into name and "
+              "domain components, access might fail\n", username);
+        name = discard_const(username);
+    }
+
+    ret = sss_filter_sanitize(mem_ctx, name, &clean_username);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    filter = talloc_asprintf(mem_ctx,
+                             "(&(%s=%s)(objectclass=%s)%s)",
+                             opts->user_map[SDAP_AT_USER_NAME].name,
+                             clean_username,
+                             opts->user_map[SDAP_OC_USER].name,
+                             access_filter);
+    talloc_free(clean_username);
+    if (filter == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Could not construct access filter\n");
+        return ENOMEM;
+    }
+
+    *_filter = filter;
+    return EOK;
+}
+
+/* Stores the result of the access filter check for offline use */
+static errno_t sdap_access_filter_decide(struct sss_domain_info *domain,
+                                         const char *username,
+                                         bool found)
+{
+    errno_t ret;
+    errno_t tret;
+
+    if (found) {
+        /* Save "allow" to the cache for future offline access checks. */
+        DEBUG(SSSDBG_TRACE_FUNC, "Access granted by online lookup\n");
+        ret = EOK;
+    }
+    else {
+        /* Save "disallow" to the cache for future offline
+         * access checks.
+         */
+        DEBUG(SSSDBG_TRACE_FUNC, "Access denied by online lookup\n");
+        ret = ERR_ACCESS_DENIED;
+    }
+
+    tret = sdap_save_user_cache_bool(domain, username,
+                                     SYSDB_LDAP_ACCESS_FILTER, found);
+    if (tret != EOK) {
+        /* Failing to save to the cache is non-fatal.
+         * Just return the result.
+         */
+        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to set user access attribute\n");
+    }
+
+    return ret;
+}
+
 struct sdap_access_filter_req_ctx {
     const char *username;
     const char *filter;
@@ -851,9 +1373,9 @@ static struct tevent_req *sdap_access_filter_send(TALLOC_CTX *mem_ctx,
 {
     struct sdap_access_filter_req_ctx *state;
     struct tevent_req *req;
-    char *clean_username;
     errno_t ret = ERR_INTERNAL;
-    char *name;
+    errno_t tret;
+    bool allowed;
 
     req = tevent_req_create(mem_ctx, &state, struct sdap_access_filter_req_ctx);
     if (req == NULL) {
@@ -889,39 +1411,37 @@ static struct tevent_req *sdap_access_filter_send(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
-    ret = sdap_get_basedn_user_entry(user_entry, state->username,
-                                     &state->basedn);
-    if (ret != EOK) {
-        goto done;
-    }
+    ret = sdap_access_local_filter_eval(access_ctx->local_filter,
+                                        sysdb_ctx_get_ldb(domain->sysdb),
+                                        user_entry, &allowed);
+    if (ret == EOK) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Access %s by the cached entry\n",
+              allowed ? "granted" : "denied");
 
-    /* Construct the filter */
-    ret = sss_parse_internal_fqname(state, username, &name, NULL);
-    if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Could not parse [%s] into name and "
-              "domain components, access might fail\n", username);
-        name = discard_const(username);
+        tret = sdap_save_user_cache_bool(domain, username,
+                                         SYSDB_LDAP_ACCESS_FILTER, allowed);
+        if (tret != EOK) {
+            /* Failing to save to the cache is non-fatal. */
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "Failed to set user access attribute\n");
+        }
+
+        ret = allowed ? EOK : ERR_ACCESS_DENIED;
+        goto done;
     }
 
-    ret = sss_filter_sanitize(state, name, &clean_username);
+    ret = sdap_get_basedn_user_entry(user_entry, state->username,
+                                     &state->basedn);
     if (ret != EOK) {
         goto done;
     }
 
-    state->filter = talloc_asprintf(
-        state,
-        "(&(%s=%s)(objectclass=%s)%s)",
-        state->opts->user_map[SDAP_AT_USER_NAME].name,
-        clean_username,
-        state->opts->user_map[SDAP_OC_USER].name,
-        state->access_ctx->filter);
-    if (state->filter == NULL) {
-        DEBUG(SSSDBG_FATAL_FAILURE, "Could not construct access filter\n");
-        ret = ENOMEM;
+    ret = sdap_access_user_filter(state, state->opts,
+                                  state->access_ctx->filter, username,
+                                  &state->filter);
+    if (ret != EOK) {
         goto done;
     }
-    talloc_zfree(clean_username);
 
     DEBUG(SSSDBG_TRACE_FUNC, "Checking filter against LDAP\n");
 
@@ -1030,108 +1550,291 @@ static void sdap_access_filter_connect_done(struct tevent_req *subreq)
     tevent_req_set_callback(subreq, sdap_access_filter_done, req);
 }
 
-static void sdap_access_filter_done(struct tevent_req *subreq)
+static void sdap_access_filter_done(struct tevent_req *subreq)
+{
+    int ret, tret, dp_error;
+    size_t num_results;
+    bool found = false;
+    struct sysdb_attrs **results;
+    struct tevent_req *req =
+            tevent_req_callback_data(subreq, struct tevent_req);
+    struct sdap_access_filter_req_ctx *state =
+            tevent_req_data(req, struct sdap_access_filter_req_ctx);
+
+    ret = sdap_get_generic_recv(subreq, state,
+                                &num_results, &results);
+    talloc_zfree(subreq);
+
+    ret = sdap_id_op_done(state->sdap_op, ret, &dp_error);
+    if (ret != EOK) {
+        if (dp_error == DP_ERR_OK) {
+            /* retry */
+            tret = sdap_access_filter_retry(req);
+            if (tret == EOK) {
+                return;
+            }
+        } else if (dp_error == DP_ERR_OFFLINE) {
+            ret = sdap_access_decide_offline(state->cached_access);
+        } else if (ret == ERR_INVALID_FILTER) {
+            sss_log(SSS_LOG_ERR, MALFORMED_FILTER, state->filter);
+            DEBUG(SSSDBG_CRIT_FAILURE, MALFORMED_FILTER, state->filter);
+            ret = ERR_ACCESS_DENIED;
+        } else {
+            DEBUG(SSSDBG_CRIT_FAILURE,
+                  "sdap_get_generic_send() returned error [%d][%s]\n",
+                      ret, sss_strerror(ret));
+        }
+
+        goto done;
+    }
+
+    /* Check the number of responses we got
+     * If it's exactly 1, we passed the check
+     * If it's < 1, we failed the check
+     * Anything else is an error
+     */
+    if (num_results < 1) {
+        DEBUG(SSSDBG_CONF_SETTINGS,
+              "User [%s] was not found with the specified filter. "
+                  "Denying access.\n", state->username);
+        found = false;
+    }
+    else if (results == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "num_results > 0, but results is NULL\n");
+        ret = ERR_INTERNAL;
+        goto done;
+    }
+    else if (num_results > 1) {
+        /* It should not be possible to get more than one reply
+         * here, since we're doing a base-scoped search
+         */
+        DEBUG(SSSDBG_CRIT_FAILURE, "Received multiple replies\n");
+        ret = ERR_INTERNAL;
+        goto done;
+    }
+    else { /* Ok, we got a single reply */
+        found = true;
+    }
+
+    ret = sdap_access_filter_decide(state->domain, state->username, found);
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    }
+    else {
+        tevent_req_error(req, ret);
+    }
+}
+
+static errno_t sdap_access_filter_recv(struct tevent_req *req)
+{
+    TEVENT_REQ_RETURN_ON_ERROR(req);
+
+    return EOK;
+}
+
+/* ==Combined-user-entry-search========================================== */
+struct sdap_access_prefetch_state {
+    struct tevent_context *ev;
+    struct sdap_options *opts;
+    struct sdap_id_op *sdap_op;
+    const char *basedn;
+    const char *filter;
+    struct sdap_access_prefetch *prefetch;
+};
+
+static errno_t sdap_access_prefetch_retry(struct tevent_req *req);
+static void sdap_access_prefetch_connect_done(struct tevent_req *subreq);
+static void sdap_access_prefetch_search_done(struct tevent_req *subreq);
+
+static struct tevent_req *
+sdap_access_prefetch_send(TALLOC_CTX *mem_ctx,
+                          struct tevent_context *ev,
+                          struct sdap_access_ctx *access_ctx,
+                          struct sdap_id_conn_ctx *conn,
+                          const char *username,
+                          struct ldb_message *user_entry)
+{
+    struct sdap_access_prefetch_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state,
+                            struct sdap_access_prefetch_state);
+    if (req == NULL) {
+        return NULL;
+    }
+
+    state->ev = ev;
+    state->opts = access_ctx->id_ctx->opts;
+
+    state->prefetch = talloc_zero(state, struct sdap_access_prefetch);
+    if (state->prefetch == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sdap_get_basedn_user_entry(user_entry, username, &state->basedn);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sdap_access_user_filter(state, state->opts, access_ctx->filter,
+                                  username, &state->filter);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Checking filter and ppolicy attributes of [%s] in one search\n",
+          username);
+
+    state->sdap_op = sdap_id_op_create(state, conn->conn_cache);
+    if (state->sdap_op == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE, "sdap_id_op_create failed\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sdap_access_prefetch_retry(req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    return req;
+
+done:
+    tevent_req_error(req, ret);
+    tevent_req_post(req, ev);
+    return req;
+}
+
+static errno_t sdap_access_prefetch_retry(struct tevent_req *req)
+{
+    struct sdap_access_prefetch_state *state;
+    struct tevent_req *subreq;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct sdap_access_prefetch_state);
+
+    subreq = sdap_id_op_connect_send(state->sdap_op, state, &ret);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sdap_id_op_connect_send failed: %d (%s)\n",
+              ret, sss_strerror(ret));
+        return ret;
+    }
+
+    tevent_req_set_callback(subreq, sdap_access_prefetch_connect_done, req);
+    return EOK;
+}
+
+static void sdap_access_prefetch_connect_done(struct tevent_req *subreq)
+{
+    const char *attrs[] = { SYSDB_LDAP_ACCESS_LOCKED_TIME,
+                            SYSDB_LDAP_ACESS_LOCKOUT_DURATION,
+                            NULL };
+    struct sdap_access_prefetch_state *state;
+    struct tevent_req *req;
+    int ret, dp_error;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_access_prefetch_state);
+
+    ret = sdap_id_op_connect_recv(subreq, &dp_error);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    subreq = sdap_get_generic_send(state,
+                                   state->ev,
+                                   state->opts,
+                                   sdap_id_op_handle(state->sdap_op),
+                                   state->basedn,
+                                   LDAP_SCOPE_BASE,
+                                   state->filter, attrs,
+                                   NULL, 0,
+                                   dp_opt_get_int(state->opts->basic,
+                                                  SDAP_SEARCH_TIMEOUT),
+                                   false);
+    if (subreq == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Could not start LDAP communication\n");
+        tevent_req_error(req, EIO);
+        return;
+    }
+
+    tevent_req_set_callback(subreq, sdap_access_prefetch_search_done, req);
+}
+
+static void sdap_access_prefetch_search_done(struct tevent_req *subreq)
 {
-    int ret, tret, dp_error;
-    size_t num_results;
-    bool found = false;
+    struct sdap_access_prefetch_state *state;
     struct sysdb_attrs **results;
-    struct tevent_req *req =
-            tevent_req_callback_data(subreq, struct tevent_req);
-    struct sdap_access_filter_req_ctx *state =
-            tevent_req_data(req, struct sdap_access_filter_req_ctx);
+    struct tevent_req *req;
+    size_t num_results;
+    int ret, dp_error;
 
-    ret = sdap_get_generic_recv(subreq, state,
-                                &num_results, &results);
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct sdap_access_prefetch_state);
+
+    ret = sdap_get_generic_recv(subreq, state, &num_results, &results);
     talloc_zfree(subreq);
 
     ret = sdap_id_op_done(state->sdap_op, ret, &dp_error);
     if (ret != EOK) {
-        if (dp_error == DP_ERR_OK) {
-            /* retry */
-            tret = sdap_access_filter_retry(req);
-            if (tret == EOK) {
-                return;
-            }
-        } else if (dp_error == DP_ERR_OFFLINE) {
-            ret = sdap_access_decide_offline(state->cached_access);
-        } else if (ret == ERR_INVALID_FILTER) {
-            sss_log(SSS_LOG_ERR, MALFORMED_FILTER, state->filter);
-            DEBUG(SSSDBG_CRIT_FAILURE, MALFORMED_FILTER, state->filter);
-            ret = ERR_ACCESS_DENIED;
-        } else {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "sdap_get_generic_send() returned error [%d][%s]\n",
-                      ret, sss_strerror(ret));
+        if (dp_error == DP_ERR_OK && sdap_access_prefetch_retry(req) == EOK) {
+            return;
         }
 
-        goto done;
+        tevent_req_error(req, ret);
+        return;
     }
 
-    /* Check the number of responses we got
-     * If it's exactly 1, we passed the check
-     * If it's < 1, we failed the check
-     * Anything else is an error
-     */
-    if (num_results < 1) {
-        DEBUG(SSSDBG_CONF_SETTINGS,
-              "User [%s] was not found with the specified filter. "
-                  "Denying access.\n", state->username);
-        found = false;
-    }
-    else if (results == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "num_results > 0, but results is NULL\n");
-        ret = ERR_INTERNAL;
-        goto done;
-    }
-    else if (num_results > 1) {
-        /* It should not be possible to get more than one reply
-         * here, since we're doing a base-scoped search
-         */
-        DEBUG(SSSDBG_CRIT_FAILURE, "Received multiple replies\n");
-        ret = ERR_INTERNAL;
-        goto done;
-    }
-    else { /* Ok, we got a single reply */
-        found = true;
+    ret = sdap_access_prefetch_parse(state->prefetch, num_results, results);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
     }
 
-    if (found) {
-        /* Save "allow" to the cache for future offline access checks. */
-        DEBUG(SSSDBG_TRACE_FUNC, "Access granted by online lookup\n");
-        ret = EOK;
-    }
-    else {
-        /* Save "disallow" to the cache for future offline
-         * access checks.
-         */
-        DEBUG(SSSDBG_TRACE_FUNC, "Access denied by online lookup\n");
-        ret = ERR_ACCESS_DENIED;
-    }
+    tevent_req_done(req);
+}
 
-    tret = sdap_save_user_cache_bool(state->domain, state->username,
-                                     SYSDB_LDAP_ACCESS_FILTER, found);
-    if (tret != EOK) {
-        /* Failing to save to the cache is non-fatal.
-         * Just return the result.
-         */
-        DEBUG(SSSDBG_CRIT_FAILURE, "Failed to set user access attribute\n");
-        goto done;
+/* Interprets the reply of the combined search, an entry is only returned
+ * if the user matches the access filter. */
+errno_t sdap_access_prefetch_parse(struct sdap_access_prefetch *pf,
+                                   size_t num_results,
+                                   struct sysdb_attrs **results)
+{
+    if (num_results > 1 || (num_results == 1 && results == NULL)) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unexpected reply to a base-scoped search\n");
+        return ERR_INTERNAL;
     }
 
-done:
-    if (ret == EOK) {
-        tevent_req_done(req);
-    }
-    else {
-        tevent_req_error(req, ret);
+    pf->filter_match = (num_results == 1);
+    pf->user_attrs = NULL;
+    if (pf->filter_match) {
+        pf->user_attrs = talloc_steal(pf, results[0]);
     }
+
+    return EOK;
 }
 
-static errno_t sdap_access_filter_recv(struct tevent_req *req)
+static errno_t sdap_access_prefetch_recv(struct tevent_req *req,
+                                         TALLOC_CTX *mem_ctx,
+                                         struct sdap_access_prefetch **_pf)
 {
+    struct sdap_access_prefetch_state *state;
+
+    state = tevent_req_data(req, struct sdap_access_prefetch_state);
+
     TEVENT_REQ_RETURN_ON_ERROR(req);
 
+    *_pf = talloc_steal(mem_ctx, state->prefetch);
+
     return EOK;
 }
 
@@ -1412,6 +2115,13 @@ errno_t sdap_access_rhost(struct ldb_message *user_entry, char *pam_rhost)
 }
 
 static void sdap_access_ppolicy_get_lockout_done(struct tevent_req *subreq);
+static errno_t sdap_access_ppolicy_lockout_known(struct tevent_req *req,
+                                                 bool pwdLockout);
+static void sdap_access_ppolicy_lockout_finish(struct tevent_req *req,
+                                               errno_t ret);
+static errno_t
+sdap_access_ppolicy_decide(struct sdap_access_ppolicy_req_ctx *state,
+                           struct sysdb_attrs *user_attrs);
 static int sdap_access_ppolicy_retry(struct tevent_req *req);
 static errno_t sdap_access_ppolicy_step(struct tevent_req *req);
 static void sdap_access_ppolicy_step_done(struct tevent_req *subreq);
@@ -1433,6 +2143,8 @@ struct sdap_access_ppolicy_req_ctx {
     const char **ppolicy_dns;
     unsigned int ppolicy_dns_index;
     enum sdap_pwpolicy_mode pwpol_mode;
+    /* ppolicy attributes of the user, if already fetched */
+    struct sysdb_attrs *user_attrs;
 };
 
 static struct tevent_req *
@@ -1444,6 +2156,7 @@ sdap_access_ppolicy_send(TALLOC_CTX *mem_ctx,
                          struct sdap_id_conn_ctx *conn,
                          const char *username,
                          struct ldb_message *user_entry,
+                         struct sysdb_attrs *user_attrs,
                          enum sdap_pwpolicy_mode pwpol_mode)
 {
     struct sdap_access_ppolicy_req_ctx *state;
@@ -1465,6 +2178,7 @@ sdap_access_ppolicy_send(TALLOC_CTX *mem_ctx,
     state->domain = domain;
     state->ppolicy_dns_index = 0;
     state->pwpol_mode = pwpol_mode;
+    state->user_attrs = user_attrs;
 
     DEBUG(SSSDBG_TRACE_FUNC,
           "Performing access ppolicy check for user [%s]\n", username);
@@ -1531,6 +2245,85 @@ static int sdap_access_ppolicy_retry(struct tevent_req *req)
     return EOK;
 }
 
+/* The value of pwdLockout is read from the password policy entry and not
+ * from the user, it is cached once for every list of policy DNs to try, keyed
+ * by the first of them. Bound for the number of cached values, the whole
+ * cache is dropped when it is reached. */
+#define SDAP_ACCESS_PPOLICY_CACHE_MAX 1024
+
+struct sdap_access_ppolicy_cache_entry {
+    bool pwd_lockout;
+    time_t expire;
+};
+
+bool sdap_access_ppolicy_cache_get(hash_table_t *cache,
+                                   const char *policy_dn,
+                                   time_t now,
+                                   bool *_pwd_lockout)
+{
+    struct sdap_access_ppolicy_cache_entry *entry;
+
+    if (cache == NULL || policy_dn == NULL) {
+        return false;
+    }
+
+    entry = sss_ptr_hash_lookup(cache, policy_dn,
+                                struct sdap_access_ppolicy_cache_entry);
+    if (entry == NULL) {
+        return false;
+    }
+
+    if (entry->expire <= now) {
+        sss_ptr_hash_delete(cache, policy_dn, true);
+        return false;
+    }
+
+    *_pwd_lockout = entry->pwd_lockout;
+    return true;
+}
+
+errno_t sdap_access_ppolicy_cache_set(hash_table_t *cache,
+                                      const char *policy_dn,
+                                      bool pwd_lockout,
+                                      time_t expire)
+{
+    struct sdap_access_ppolicy_cache_entry *entry;
+    errno_t ret;
+
+    if (cache == NULL || policy_dn == NULL) {
+        return EINVAL;
+    }
+
+    entry = sss_ptr_hash_lookup(cache, policy_dn,
+                                struct sdap_access_ppolicy_cache_entry);
+    if (entry != NULL) {
+        entry->pwd_lockout = pwd_lockout;
+        entry->expire = expire;
+        return EOK;
+    }
+
+    if (hash_count(cache) >= SDAP_ACCESS_PPOLICY_CACHE_MAX) {
+        sss_ptr_hash_delete_all(cache, true);
+    }
+
+    entry = talloc_zero(cache, struct sdap_access_ppolicy_cache_entry);
+    if (entry == NULL) {
+        return ENOMEM;
+    }
+
+    entry->pwd_lockout = pwd_lockout;
+    entry->expire = expire;
+
+    ret = sss_ptr_hash_add(cache, policy_dn, entry,
+                           struct sdap_access_ppolicy_cache_entry);
+    if (ret != EOK) {
+        talloc_free(entry);
+        return ret;
+    }
+
+    return EOK;
+}
+
 static const char**
 get_default_ppolicy_dns(TALLOC_CTX *mem_ctx, struct sdap_domain *sdom)
 {
@@ -1560,6 +2353,7 @@ static void sdap_access_ppolicy_connect_done(struct tevent_req *subreq)
     struct sdap_access_ppolicy_req_ctx *state;
     int ret, dp_error;
     const char *ppolicy_dn;
+    bool pwdLockout;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
     state = tevent_req_data(req, struct sdap_access_ppolicy_req_ctx);
@@ -1607,6 +2401,16 @@ static void sdap_access_ppolicy_connect_done(struct tevent_req *subreq)
         }
     }
 
+    if (sdap_access_ppolicy_cache_get(state->access_ctx->ppolicy_cache,
+                                      state->ppolicy_dns[0], time(NULL),
+                                      &pwdLockout)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Using cached [%s] value [%s]\n",
+              SYSDB_LDAP_ACCESS_LOCKOUT, pwdLockout ? "TRUE" : "FALSE");
+        ret = sdap_access_ppolicy_lockout_known(req, pwdLockout);
+        sdap_access_ppolicy_lockout_finish(req, ret);
+        return;
+    }
+
     /* Connection to LDAP succeeded
      * Send 'pwdLockout' request
      */
@@ -1674,7 +2478,9 @@ done:
 
 static void sdap_access_ppolicy_get_lockout_done(struct tevent_req *subreq)
 {
-    int ret, tret, dp_error;
+    int ret;
+    errno_t tret;
+    int timeout;
     size_t num_results;
     bool pwdLockout = false;
     struct sysdb_attrs **results;
@@ -1738,10 +2544,42 @@ static void sdap_access_ppolicy_get_lockout_done(struct tevent_req *subreq)
         }
     }
 
+    timeout = dp_opt_get_int(state->opts->basic,
+                             SDAP_PWDLOCKOUT_CACHE_TIMEOUT);
+    if (timeout > 0) {
+        tret = sdap_access_ppolicy_cache_set(state->access_ctx->ppolicy_cache,
+                                             state->ppolicy_dns[0], pwdLockout,
+                                             time(NULL) + timeout);
+        if (tret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE, "Failed to cache [%s] of [%s]\n",
+                  SYSDB_LDAP_ACCESS_LOCKOUT, state->ppolicy_dns[0]);
+        }
+    }
+
+    ret = sdap_access_ppolicy_lockout_known(req, pwdLockout);
+
+done:
+    sdap_access_ppolicy_lockout_finish(req, ret);
+}
+
+static errno_t sdap_access_ppolicy_lockout_known(struct tevent_req *req,
+                                                 bool pwdLockout)
+{
+    struct sdap_access_ppolicy_req_ctx *state;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct sdap_access_ppolicy_req_ctx);
+
     if (pwdLockout) {
         DEBUG(SSSDBG_TRACE_FUNC,
               "Password policy is enabled on LDAP server.\n");
 
+        if (state->user_attrs != NULL) {
+            /* the user entry was already read together with the access
+             * filter check */
+            return sdap_access_ppolicy_decide(state, state->user_attrs);
+        }
+
         /* ppolicy is enabled => find out if account is locked */
         ret = sdap_access_ppolicy_step(req);
         if (ret != EOK && ret != EAGAIN) {
@@ -1749,42 +2587,52 @@ static void sdap_access_ppolicy_get_lockout_done(struct tevent_req *subreq)
                   "sdap_access_ppolicy_step failed: [%d][%s].\n",
                   ret, sss_strerror(ret));
         }
-        goto done;
-    } else {
-        DEBUG(SSSDBG_TRACE_FUNC,
-              "Password policy is disabled on LDAP server "
-              "- storing 'access granted' in sysdb.\n");
-        tret = sdap_save_user_cache_bool(state->domain, state->username,
-                                         SYSDB_LDAP_ACCESS_CACHED_LOCKOUT,
-                                         true);
-        if (tret != EOK) {
-            /* Failing to save to the cache is non-fatal.
-             * Just return the result.
-             */
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "Failed to set user locked attribute\n");
-            goto done;
-        }
+        return ret;
+    }
 
-        ret = EOK;
-        goto done;
+    DEBUG(SSSDBG_TRACE_FUNC,
+          "Password policy is disabled on LDAP server "
+          "- storing 'access granted' in sysdb.\n");
+    ret = sdap_save_user_cache_bool(state->domain, state->username,
+                                    SYSDB_LDAP_ACCESS_CACHED_LOCKOUT,
+                                    true);
+    if (ret != EOK) {
+        /* Failing to save to the cache is non-fatal.
+         * Just return the result.
+         */
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Failed to set user locked attribute\n");
     }
 
-done:
-    if (ret != EAGAIN) {
-        /* release connection */
-        tret = sdap_id_op_done(state->sdap_op, ret, &dp_error);
-        if (tret != EOK) {
-            DEBUG(SSSDBG_CRIT_FAILURE,
-                  "sdap_get_generic_send() returned error [%d][%s]\n",
-                  ret, sss_strerror(ret));
-        }
+    return EOK;
+}
 
-        if (ret == EOK) {
-            tevent_req_done(req);
-        } else {
-            tevent_req_error(req, ret);
-        }
+static void sdap_access_ppolicy_lockout_finish(struct tevent_req *req,
+                                               errno_t ret)
+{
+    struct sdap_access_ppolicy_req_ctx *state;
+    int tret, dp_error;
+
+    if (ret == EAGAIN) {
+        return;
+    }
+
+    state = tevent_req_data(req, struct sdap_access_ppolicy_req_ctx);
+
+    /* release connection, a denied access is not a connection failure */
+    tret = sdap_id_op_done(state->sdap_op,
+                           ret == ERR_ACCESS_DENIED ? EOK : ret,
+                           &dp_error);
+    if (tret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "sdap_get_generic_send() returned error [%d][%s]\n",
+              ret, sss_strerror(ret));
+    }
+
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else {
+        tevent_req_error(req, ret);
     }
 }
 
@@ -1913,9 +2761,6 @@ static void sdap_access_ppolicy_step_done(struct tevent_req *subreq)
 {
     int ret, tret, dp_error;
     size_t num_results;
-    bool locked = false;
-    const char *pwdAccountLockedTime;
-    const char *pwdAccountLockedDurationTime;
     struct sysdb_attrs **results;
     struct tevent_req *req;
     struct sdap_access_ppolicy_req_ctx *state;
@@ -1954,33 +2799,58 @@ static void sdap_access_ppolicy_step_done(struct tevent_req *subreq)
         DEBUG(SSSDBG_CONF_SETTINGS,
               "User [%s] was not found with the specified filter. "
               "Denying access.\n", state->username);
+        ret = sdap_access_ppolicy_decide(state, NULL);
     } else if (results == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "num_results > 0, but results is NULL\n");
         ret = ERR_INTERNAL;
-        goto done;
     } else if (num_results > 1) {
         /* It should not be possible to get more than one reply
          * here, since we're doing a base-scoped search
          */
         DEBUG(SSSDBG_CRIT_FAILURE, "Received multiple replies\n");
         ret = ERR_INTERNAL;
-        goto done;
     } else { /* Ok, we got a single reply */
-        ret = sysdb_attrs_get_string(results[0], SYSDB_LDAP_ACESS_LOCKOUT_DURATION,
+        ret = sdap_access_ppolicy_decide(state, results[0]);
+    }
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else {
+        tevent_req_error(req, ret);
+    }
+}
+
+/* Checks the ppolicy attributes of the user entry, user_attrs is NULL if the
+ * entry was not found. The account is considered locked if the attributes
+ * cannot be interpreted. */
+bool sdap_access_ppolicy_locked(struct sysdb_attrs *user_attrs,
+                                enum sdap_pwpolicy_mode pwpol_mode,
+                                const char *username)
+{
+    errno_t ret;
+    bool locked = false;
+    const char *pwdAccountLockedTime;
+    const char *pwdAccountLockedDurationTime;
+
+    if (user_attrs != NULL) {
+        ret = sysdb_attrs_get_string(user_attrs,
+                                     SYSDB_LDAP_ACESS_LOCKOUT_DURATION,
                                      &pwdAccountLockedDurationTime);
         if (ret != EOK) {
             /* This attribute might not be set even if account is locked */
             pwdAccountLockedDurationTime = NULL;
         }
 
-        ret = sysdb_attrs_get_string(results[0], SYSDB_LDAP_ACCESS_LOCKED_TIME,
+        ret = sysdb_attrs_get_string(user_attrs,
+                                     SYSDB_LDAP_ACCESS_LOCKED_TIME,
                                      &pwdAccountLockedTime);
         if (ret == EOK) {
 
             ret = is_account_locked(pwdAccountLockedTime,
                                     pwdAccountLockedDurationTime,
-                                    state->pwpol_mode,
-                                    state->username,
+                                    pwpol_mode,
+                                    username,
                                     &locked);
             if (ret != EOK) {
                 if (ret == ERR_TIMESPEC_NOT_SUPPORTED) {
@@ -2006,6 +2876,20 @@ static void sdap_access_ppolicy_step_done(struct tevent_req *subreq)
         }
     }
 
+    return locked;
+}
+
+/* Decides the ppolicy check from the ppolicy attributes of the user entry,
+ * user_attrs is NULL if the entry was not found. */
+static errno_t
+sdap_access_ppolicy_decide(struct sdap_access_ppolicy_req_ctx *state,
+                           struct sysdb_attrs *user_attrs)
+{
+    errno_t ret, tret;
+    bool locked;
+
+    locked = sdap_access_ppolicy_locked(user_attrs, state->pwpol_mode,
+                                        state->username);
     if (locked) {
         DEBUG(SSSDBG_TRACE_FUNC,
               "Access denied by online lookup - account is locked.\n");
@@ -2029,15 +2913,9 @@ static void sdap_access_ppolicy_step_done(struct tevent_req *subreq)
          * Just return the result.
          */
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to set user locked attribute\n");
-        goto done;
     }
 
-done:
-    if (ret == EOK) {
-        tevent_req_done(req);
-    } else {
-        tevent_req_error(req, ret);
-    }
+    return ret;
 }
 
 static errno_t sdap_access_ppolicy_recv(struct tevent_req *req)
@@ -2306,6 +3184,21 @@ static errno_t set_sdap_access_rules(TALLOC_CTX *mem_ctx,
               "All domain users will be denied access.\n");
     }
 
+    if (filter != NULL
+            && dp_opt_get_bool(opts, SDAP_ACCESS_FILTER_LOCAL)) {
+        ret = sdap_access_local_filter_compile(access_ctx,
+                                            access_ctx->id_ctx->opts->user_map,
+                                            filter, &access_ctx->local_filter);
+        if (ret == ENOTSUP) {
+            DEBUG(SSSDBG_CONF_SETTINGS, "Access filter [%s] cannot be "
+                  "evaluated locally, it will be checked on the server\n",
+                  filter);
+            ret = EOK;
+        } else if (ret != EOK) {
+            goto done;
+        }
+    }
+
 done:
     if (ret == EOK) {
         access_ctx->filter = filter;
@@ -2395,6 +3288,15 @@ errno_t sdap_set_access_rules(TALLOC_CTX *mem_ctx,
               "Invalid sdap_access_type [%i].\n", access_ctx->type);
         break;
     }
+    if (ret != EOK) {
+        goto done;
+    }
+
+    access_ctx->ppolicy_cache = sss_ptr_hash_create(access_ctx, NULL, NULL);
+    if (access_ctx->ppolicy_cache == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
 
 done:
     talloc_free(order_list);
@@ -77,10 +77,33 @@ enum sdap_access_type {
     SDAP_TYPE_IPA
 };
 
+struct sdap_access_local_filter;
+
+enum sdap_pwpolicy_mode {
+    PWP_LOCKOUT_ONLY,
+    PWP_LOCKOUT_EXPIRE,
+    PWP_SENTINEL,
+};
+
+/* Filled by a single base search of the user entry which combines the
+ * access filter with the ppolicy attributes */
+struct sdap_access_prefetch {
+    bool filter_match;
+    /* ppolicy attributes of the user, NULL if !filter_match */
+    struct sysdb_attrs *user_attrs;
+};
+
 struct sdap_access_ctx {
     enum sdap_access_type type;
     struct sdap_id_ctx *id_ctx;
     const char *filter;
+    /* filter compiled for evaluation against the cache, NULL if the
+     * filter must always be checked on the server */
+    struct sdap_access_local_filter *local_filter;
+    /* pwdLockout value of the password policy which applies to a user,
+     * keyed by the DN of the user entry. It rarely changes, so it is not
+     * searched for on every access check. NULL if nothing is cached. */
+    hash_table_t *ppolicy_cache;
     int access_rule[LDAP_ACCESS_LAST + 1];
 };
 
@@ -105,6 +128,41 @@ sdap_access_send(TALLOC_CTX *mem_ctx,
                  struct pam_data *pd);
 errno_t sdap_access_recv(struct tevent_req *req);
 
+/* Compile the access filter for evaluation against cached user entries.
+ * Returns ENOTSUP if the filter uses an operator or an attribute that
+ * cannot be evaluated locally. */
+errno_t sdap_access_local_filter_compile(TALLOC_CTX *mem_ctx,
+                                         struct sdap_attr_map *user_map,
+                                         const char *filter,
+                                         struct sdap_access_local_filter **_lf);
+
+/* Evaluate a compiled filter against a cached user entry. Returns EAGAIN
+ * if the entry does not contain enough data and the server must be asked. */
+errno_t sdap_access_local_filter_eval(struct sdap_access_local_filter *lf,
+                                      struct ldb_context *ldb,
+                                      struct ldb_message *user_entry,
+                                      bool *_allowed);
+
+errno_t sdap_access_prefetch_parse(struct sdap_access_prefetch *pf,
+                                   size_t num_results,
+                                   struct sysdb_attrs **results);
+
+bool sdap_access_ppolicy_locked(struct sysdb_attrs *user_attrs,
+                                enum sdap_pwpolicy_mode pwpol_mode,
+                                const char *username);
+
+/* Returns true and the cached pwdLockout value if it was stored for
+ * policy_dn and did not expire before now. */
+bool sdap_access_ppolicy_cache_get(hash_table_t *cache,
+                                   const char *policy_dn,
+                                   time_t now,
+                                   bool *_pwd_lockout);
+
+errno_t sdap_access_ppolicy_cache_set(hash_table_t *cache,
+                                      const char *policy_dn,
+                                      bool pwd_lockout,
+                                      time_t expire);
+
 /* Set the access rules based on ldap_access_order */
 errno_t sdap_set_access_rules(TALLOC_CTX *mem_ctx,
                               struct sdap_access_ctx *access_ctx,
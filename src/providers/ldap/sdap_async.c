@@ -25,6 +25,7 @@
 #include "util/strtonum.h"
 #include "util/probes.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 #include "providers/ldap/sdap_async_private.h"
 
 #define REPLY_REALLOC_INCREMENT 10
@@ -37,6 +38,7 @@ struct sdap_op {
     int msgid;
     char *stat_info;
     uint64_t start_time;
+    struct sss_trace_span *span;
     int timeout;
     bool done;
 
@@ -112,6 +114,9 @@ static void sdap_call_op_callback(struct sdap_op *op, struct sdap_msg *reply,
                                          op->msgid, info, op->timeout);
         }
 
+        sss_trace_span_end(op->span, error);
+        op->span = NULL;
+
         /* Avoid multiple outputs for the same operation if multiple results
          * are returned */
         op->start_time = 0;
@@ -524,6 +529,8 @@ int sdap_op_add(TALLOC_CTX *memctx, struct tevent_context *ev,
     op->data = data;
     op->ev = ev;
     op->chain_id = sss_chain_id_get();
+    op->span = sss_trace_span_begin(op, SSS_TRACE_SPAN, "ldap #%d %s", msgid,
+                                    stat_info == NULL ? "-" : stat_info);
 
     DEBUG(SSSDBG_TRACE_INTERNAL,
           "New operation %d timeout %d\n", op->msgid, timeout);
@@ -1273,6 +1280,8 @@ struct sdap_reply {
     size_t reply_max;
     size_t reply_count;
     struct sysdb_attrs **reply;
+
+    struct sdap_parse_arena arena;
 };
 
 static errno_t add_to_reply(TALLOC_CTX *mem_ctx,
@@ -2007,6 +2016,7 @@ static void generic_ext_search_handler(struct tevent_req *subreq,
 struct sdap_get_and_parse_generic_state {
     struct sdap_attr_map *map;
     int map_num_attrs;
+    bool use_arena;
 
     struct sdap_reply sreply;
     struct sdap_options *opts;
@@ -2032,7 +2042,8 @@ struct tevent_req *sdap_get_and_parse_generic_send(TALLOC_CTX *memctx,
                                                    LDAPControl **clientctrls,
                                                    int sizelimit,
                                                    int timeout,
-                                                   bool allow_paging)
+                                                   bool allow_paging,
+                                                   bool use_arena)
 {
     struct tevent_req *req = NULL;
     struct tevent_req *subreq = NULL;
@@ -2045,6 +2056,7 @@ struct tevent_req *sdap_get_and_parse_generic_send(TALLOC_CTX *memctx,
 
     state->map = map;
     state->map_num_attrs = map_num_attrs;
+    state->use_arena = use_arena;
     state->opts = opts;
 
     if (allow_paging) {
@@ -2075,13 +2087,20 @@ static errno_t sdap_get_and_parse_generic_parse_entry(struct sdap_handle *sh,
 {
     errno_t ret;
     struct sysdb_attrs *attrs;
+    TALLOC_CTX *parse_ctx;
     struct sdap_get_and_parse_generic_state *state =
                 talloc_get_type(pvt, struct sdap_get_and_parse_generic_state);
 
     bool disable_range_rtrvl = dp_opt_get_bool(state->opts->basic,
                                                SDAP_DISABLE_RANGE_RETRIEVAL);
 
-    ret = sdap_parse_entry(state, sh, msg,
+    if (state->use_arena) {
+        parse_ctx = sdap_parse_arena_get(state, &state->sreply.arena);
+    } else {
+        parse_ctx = state;
+    }
+
+    ret = sdap_parse_entry(parse_ctx, sh, msg,
                            state->map, state->map_num_attrs,
                            &attrs, disable_range_rtrvl);
     if (ret != EOK) {
@@ -2160,7 +2179,7 @@ struct tevent_req *sdap_get_generic_send(TALLOC_CTX *memctx,
                                              scope, filter, attrs,
                                              map, map_num_attrs,
                                              false, NULL, NULL, 0, timeout,
-                                             allow_paging);
+                                             allow_paging, false);
     if (subreq == NULL) {
         talloc_zfree(req);
         return NULL;
@@ -223,7 +223,10 @@ int sdap_cli_connect_recv(struct tevent_req *req,
                           struct sdap_handle **gsh,
                           struct sdap_server_opts **srv_opts);
 
-/* Exposes all options of generic send while allowing to parse by map */
+/* Exposes all options of generic send while allowing to parse by map.
+ * With use_arena the entries are parsed into a struct sdap_parse_arena,
+ * which is only suitable if the caller does not keep them beyond the
+ * request, see sdap.h. */
 struct tevent_req *sdap_get_and_parse_generic_send(TALLOC_CTX *memctx,
                                                    struct tevent_context *ev,
                                                    struct sdap_options *opts,
@@ -239,7 +242,8 @@ struct tevent_req *sdap_get_and_parse_generic_send(TALLOC_CTX *memctx,
                                                    LDAPControl **clientctrls,
                                                    int sizelimit,
                                                    int timeout,
-                                                   bool allow_paging);
+                                                   bool allow_paging,
+                                                   bool use_arena);
 int sdap_get_and_parse_generic_recv(struct tevent_req *req,
                                     TALLOC_CTX *mem_ctx,
                                     size_t *reply_count,
@@ -49,31 +49,100 @@ static struct tevent_req *enum_groups_send(TALLOC_CTX *memctx,
 static errno_t enum_groups_recv(struct tevent_req *req);
 
 /* ==Enumeration-Request-with-connections=================================== */
+
+/* Users, groups and services are downloaded as separate steps, each on its
+ * own sdap_id_op. Up to SDAP_ENUM_MAX_SEARCHES steps run at the same time.
+ * Groups always wait for users, because group members are resolved against
+ * the users already stored in the cache during enumeration. */
+enum sdap_dom_enum_type {
+    SDAP_DOM_ENUM_USERS,
+    SDAP_DOM_ENUM_GROUPS,
+    SDAP_DOM_ENUM_SERVICES,
+
+    SDAP_DOM_ENUM_SENTINEL
+};
+
+typedef struct tevent_req *
+(*sdap_dom_enum_step_send_fn)(TALLOC_CTX *memctx,
+                              struct tevent_context *ev,
+                              struct sdap_id_ctx *ctx,
+                              struct sdap_domain *sdom,
+                              struct sdap_id_op *op,
+                              bool purge);
+
+typedef errno_t (*sdap_dom_enum_step_recv_fn)(struct tevent_req *req);
+
+static struct tevent_req *enum_svcs_send(TALLOC_CTX *memctx,
+                                         struct tevent_context *ev,
+                                         struct sdap_id_ctx *ctx,
+                                         struct sdap_domain *sdom,
+                                         struct sdap_id_op *op,
+                                         bool purge)
+{
+    return enum_services_send(memctx, ev, ctx, op, purge);
+}
+
+static const struct sdap_dom_enum_step_def {
+    const char *name;
+    const char *cursor;
+    sdap_dom_enum_step_send_fn send_fn;
+    sdap_dom_enum_step_recv_fn recv_fn;
+    enum sdap_dom_enum_type after;
+} sdap_dom_enum_steps[SDAP_DOM_ENUM_SENTINEL] = {
+    { "User", SYSDB_ENUM_USER_CURSOR,
+      enum_users_send, enum_users_recv, SDAP_DOM_ENUM_SENTINEL },
+    { "Group", SYSDB_ENUM_GROUP_CURSOR,
+      enum_groups_send, enum_groups_recv, SDAP_DOM_ENUM_USERS },
+    { "Service", SYSDB_ENUM_SERVICE_CURSOR,
+      enum_svcs_send, enum_services_recv, SDAP_DOM_ENUM_SENTINEL },
+};
+
+struct sdap_dom_enum_step {
+    struct tevent_req *req;
+    enum sdap_dom_enum_type type;
+    struct sdap_id_conn_ctx *conn;
+    struct sdap_id_op *op;
+    bool started;
+    bool finished;
+};
+
 struct sdap_dom_enum_ex_state {
     struct tevent_context *ev;
     struct sdap_id_ctx *ctx;
     struct sdap_domain *sdom;
 
-    struct sdap_id_conn_ctx *user_conn;
-    struct sdap_id_conn_ctx *group_conn;
-    struct sdap_id_conn_ctx *svc_conn;
-    struct sdap_id_op *user_op;
-    struct sdap_id_op *group_op;
-    struct sdap_id_op *svc_op;
+    struct sdap_dom_enum_step steps[SDAP_DOM_ENUM_SENTINEL];
+    int running;
+    int max_running;
 
     bool purge;
+    bool resume;
 };
 
-static errno_t sdap_dom_enum_ex_retry(struct tevent_req *req,
-                                      struct sdap_id_op *op,
-                                      tevent_req_fn tcb);
-static bool sdap_dom_enum_ex_connected(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_get_users(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_users_done(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_get_groups(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_groups_done(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_get_svcs(struct tevent_req *subreq);
-static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq);
+static errno_t sdap_dom_enum_ex_schedule(struct tevent_req *req,
+                                         bool *_all_done);
+static errno_t sdap_dom_enum_ex_retry(struct sdap_dom_enum_step *step);
+static void sdap_dom_enum_ex_step_connected(struct tevent_req *subreq);
+static void sdap_dom_enum_ex_step_done(struct tevent_req *subreq);
+static void sdap_dom_enum_ex_finish(struct tevent_req *req);
+
+static bool sdap_dom_enum_ex_has_cursor(struct sss_domain_info *dom)
+{
+    char *usn;
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < SDAP_DOM_ENUM_SENTINEL; i++) {
+        ret = sysdb_get_enum_cursor(NULL, dom, sdap_dom_enum_steps[i].cursor,
+                                    NULL, &usn);
+        if (ret == EOK) {
+            talloc_free(usn);
+            return true;
+        }
+    }
+
+    return false;
+}
 
 struct tevent_req *
 sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
@@ -86,7 +155,9 @@ sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
 {
     struct tevent_req *req;
     struct sdap_dom_enum_ex_state *state;
+    bool all_done;
     int t;
+    int i;
     errno_t ret;
 
     req = tevent_req_create(memctx, &state, struct sdap_dom_enum_ex_state);
@@ -95,9 +166,24 @@ sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
     state->ev = ev;
     state->ctx = ctx;
     state->sdom = sdom;
-    state->user_conn = user_conn;
-    state->group_conn = group_conn;
-    state->svc_conn = svc_conn;
+
+    state->steps[SDAP_DOM_ENUM_USERS].conn = user_conn;
+    state->steps[SDAP_DOM_ENUM_GROUPS].conn = group_conn;
+    state->steps[SDAP_DOM_ENUM_SERVICES].conn = svc_conn;
+    for (i = 0; i < SDAP_DOM_ENUM_SENTINEL; i++) {
+        state->steps[i].req = req;
+        state->steps[i].type = i;
+    }
+
+    state->max_running = dp_opt_get_int(ctx->opts->basic,
+                                        SDAP_ENUM_MAX_SEARCHES);
+    if (state->max_running < 1) {
+        state->max_running = 1;
+    }
+
+    /* The first enumeration after a restart continues from the cursors
+     * saved by the previous run instead of downloading everything again */
+    state->resume = (ctx->last_enum.tv_sec == 0);
     ctx->last_enum = tevent_timeval_current();
 
     t = dp_opt_get_int(ctx->opts->basic, SDAP_PURGE_CACHE_TIMEOUT);
@@ -105,17 +191,17 @@ sdap_dom_enum_ex_send(TALLOC_CTX *memctx,
         state->purge = true;
     }
 
-    state->user_op = sdap_id_op_create(state, user_conn->conn_cache);
-    if (state->user_op == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for users\n");
-        ret = EIO;
-        goto fail;
+    if (state->resume && state->purge
+            && sdap_dom_enum_ex_has_cursor(sdom->dom)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Resuming enumeration of [%s], "
+              "postponing the cache cleanup\n", sdom->dom->name);
+        state->purge = false;
+        ctx->last_purge = ctx->last_enum;
     }
 
-    ret = sdap_dom_enum_ex_retry(req, state->user_op,
-                                 sdap_dom_enum_ex_get_users);
+    ret = sdap_dom_enum_ex_schedule(req, &all_done);
     if (ret != EOK) {
-        DEBUG(SSSDBG_OP_FAILURE, "sdap_dom_enum_ex_retry failed\n");
+        DEBUG(SSSDBG_OP_FAILURE, "sdap_dom_enum_ex_schedule failed\n");
         goto fail;
     }
 
@@ -127,160 +213,201 @@ fail:
     return req;
 }
 
-static errno_t sdap_dom_enum_ex_retry(struct tevent_req *req,
-                                      struct sdap_id_op *op,
-                                      tevent_req_fn tcb)
+/* Starts every step whose dependency is satisfied, as long as the search
+ * budget allows. */
+static errno_t sdap_dom_enum_ex_schedule(struct tevent_req *req,
+                                         bool *_all_done)
 {
     struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
                                                 struct sdap_dom_enum_ex_state);
+    struct sdap_dom_enum_step *step;
+    enum sdap_dom_enum_type after;
+    bool all_done = true;
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < SDAP_DOM_ENUM_SENTINEL; i++) {
+        step = &state->steps[i];
+        if (!step->finished) {
+            all_done = false;
+        }
+
+        if (step->started || state->running >= state->max_running) {
+            continue;
+        }
+
+        after = sdap_dom_enum_steps[i].after;
+        if (after != SDAP_DOM_ENUM_SENTINEL && !state->steps[after].finished) {
+            continue;
+        }
+
+        step->op = sdap_id_op_create(state, step->conn->conn_cache);
+        if (step->op == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for %s\n",
+                  sdap_dom_enum_steps[i].name);
+            return EIO;
+        }
+
+        ret = sdap_dom_enum_ex_retry(step);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        step->started = true;
+        state->running++;
+    }
+
+    *_all_done = all_done;
+    return EOK;
+}
+
+static errno_t sdap_dom_enum_ex_retry(struct sdap_dom_enum_step *step)
+{
+    struct sdap_dom_enum_ex_state *state = tevent_req_data(step->req,
+                                                struct sdap_dom_enum_ex_state);
     struct tevent_req *subreq;
     errno_t ret;
 
-    subreq = sdap_id_op_connect_send(op, state, &ret);
+    subreq = sdap_id_op_connect_send(step->op, state, &ret);
     if (subreq == NULL) {
         DEBUG(SSSDBG_OP_FAILURE,
               "sdap_id_op_connect_send failed: %d\n", ret);
         return ret;
     }
 
-    tevent_req_set_callback(subreq, tcb, req);
+    tevent_req_set_callback(subreq, sdap_dom_enum_ex_step_connected, step);
     return EOK;
 }
 
-static bool sdap_dom_enum_ex_connected(struct tevent_req *subreq)
+static char **sdap_dom_enum_usn(struct sdap_server_opts *srv_opts,
+                                enum sdap_dom_enum_type type)
 {
-    errno_t ret;
-    int dp_error;
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-
-    ret = sdap_id_op_connect_recv(subreq, &dp_error);
-    talloc_zfree(subreq);
-    if (ret != EOK) {
-        if (dp_error == DP_ERR_OFFLINE) {
-            DEBUG(SSSDBG_TRACE_FUNC,
-                  "Backend is marked offline, retry later!\n");
-            tevent_req_done(req);
-        } else {
-            DEBUG(SSSDBG_MINOR_FAILURE,
-                  "Domain enumeration failed to connect to " \
-                   "LDAP server: (%d)[%s]\n", ret, strerror(ret));
-            tevent_req_error(req, ret);
-        }
-        return false;
-    }
-
-    return true;
+    switch (type) {
+    case SDAP_DOM_ENUM_USERS:
+        return &srv_opts->max_user_value;
+    case SDAP_DOM_ENUM_GROUPS:
+        return &srv_opts->max_group_value;
+    case SDAP_DOM_ENUM_SERVICES:
+        return &srv_opts->max_service_value;
+    case SDAP_DOM_ENUM_SENTINEL:
+        break;
+    }
+
+    return NULL;
 }
 
-static void sdap_dom_enum_ex_get_users(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_load_cursor(struct sdap_dom_enum_ex_state *state,
+                                         enum sdap_dom_enum_type type)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
-                                                struct sdap_dom_enum_ex_state);
+    struct sdap_server_opts *srv_opts = state->ctx->srv_opts;
+    char **usn;
+    errno_t ret;
 
-    if (sdap_dom_enum_ex_connected(subreq) == false) {
+    if (!state->resume || state->purge || srv_opts == NULL
+            || srv_opts->server_id == NULL) {
         return;
     }
 
-    subreq = enum_users_send(state, state->ev,
-                             state->ctx, state->sdom,
-                             state->user_op, state->purge);
-    if (subreq == NULL) {
-        tevent_req_error(req, ENOMEM);
+    usn = sdap_dom_enum_usn(srv_opts, type);
+    if (usn == NULL || *usn != NULL) {
         return;
     }
-    tevent_req_set_callback(subreq, sdap_dom_enum_ex_users_done, req);
+
+    ret = sysdb_get_enum_cursor(state->ctx, state->sdom->dom,
+                                sdap_dom_enum_steps[type].cursor,
+                                srv_opts->server_id, usn);
+    if (ret == EOK) {
+        DEBUG(SSSDBG_TRACE_FUNC, "%s enumeration resumes from USN [%s]\n",
+              sdap_dom_enum_steps[type].name, *usn);
+    } else if (ret != ENOENT) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot read the enumeration cursor [%d]: %s\n",
+              ret, sss_strerror(ret));
+    }
 }
 
-static void sdap_dom_enum_ex_users_done(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_save_cursor(struct sdap_dom_enum_ex_state *state,
+                                         enum sdap_dom_enum_type type)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
-                                                struct sdap_dom_enum_ex_state);
+    struct sdap_server_opts *srv_opts = state->ctx->srv_opts;
+    char **usn;
     errno_t ret;
-    int dp_error;
 
-    ret = enum_users_recv(subreq);
-    talloc_zfree(subreq);
-    ret = sdap_id_op_done(state->user_op, ret, &dp_error);
-    if (dp_error == DP_ERR_OK && ret != EOK) {
-        /* retry */
-        ret = sdap_dom_enum_ex_retry(req, state->user_op,
-                                     sdap_dom_enum_ex_get_users);
-        if (ret != EOK) {
-            tevent_req_error(req, ret);
-            return;
-        }
-        return;
-    } else if (dp_error == DP_ERR_OFFLINE) {
-        DEBUG(SSSDBG_TRACE_FUNC, "Backend is offline, retrying later\n");
-        tevent_req_done(req);
-        return;
-    } else if (ret != EOK && ret != ENOENT) {
-        /* Non-recoverable error */
-        DEBUG(SSSDBG_OP_FAILURE,
-              "User enumeration failed: %d: %s\n", ret, sss_strerror(ret));
-        tevent_req_error(req, ret);
+    if (srv_opts == NULL || srv_opts->server_id == NULL) {
         return;
     }
 
-    state->group_op = sdap_id_op_create(state, state->group_conn->conn_cache);
-    if (state->group_op == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for groups\n");
-        tevent_req_error(req, EIO);
+    usn = sdap_dom_enum_usn(srv_opts, type);
+    if (usn == NULL || *usn == NULL) {
         return;
     }
 
-    ret = sdap_dom_enum_ex_retry(req, state->group_op,
-                                 sdap_dom_enum_ex_get_groups);
+    ret = sysdb_set_enum_cursor(state->sdom->dom,
+                                sdap_dom_enum_steps[type].cursor,
+                                srv_opts->server_id, *usn);
     if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
+        /* Not fatal, the next restart downloads this class again */
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Cannot save the enumeration cursor [%d]: %s\n",
+              ret, sss_strerror(ret));
     }
-
-    /* Continues to sdap_dom_enum_ex_get_groups */
 }
 
-static void sdap_dom_enum_ex_get_groups(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_step_connected(struct tevent_req *subreq)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
+    struct sdap_dom_enum_step *step = tevent_req_callback_data(subreq,
+                                                struct sdap_dom_enum_step);
+    struct tevent_req *req = step->req;
     struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
                                                 struct sdap_dom_enum_ex_state);
+    errno_t ret;
+    int dp_error;
 
-    if (sdap_dom_enum_ex_connected(subreq) == false) {
+    ret = sdap_id_op_connect_recv(subreq, &dp_error);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        if (dp_error == DP_ERR_OFFLINE) {
+            DEBUG(SSSDBG_TRACE_FUNC,
+                  "Backend is marked offline, retry later!\n");
+            tevent_req_done(req);
+        } else {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Domain enumeration failed to connect to " \
+                   "LDAP server: (%d)[%s]\n", ret, strerror(ret));
+            tevent_req_error(req, ret);
+        }
         return;
     }
 
-    subreq = enum_groups_send(state, state->ev, state->ctx,
-                              state->sdom,
-                              state->group_op, state->purge);
+    sdap_dom_enum_ex_load_cursor(state, step->type);
+
+    subreq = sdap_dom_enum_steps[step->type].send_fn(state, state->ev,
+                                                     state->ctx, state->sdom,
+                                                     step->op, state->purge);
     if (subreq == NULL) {
         tevent_req_error(req, ENOMEM);
         return;
     }
-    tevent_req_set_callback(subreq, sdap_dom_enum_ex_groups_done, req);
+    tevent_req_set_callback(subreq, sdap_dom_enum_ex_step_done, step);
 }
 
-static void sdap_dom_enum_ex_groups_done(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_step_done(struct tevent_req *subreq)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
+    struct sdap_dom_enum_step *step = tevent_req_callback_data(subreq,
+                                                struct sdap_dom_enum_step);
+    struct tevent_req *req = step->req;
     struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
                                                 struct sdap_dom_enum_ex_state);
-    int ret;
+    bool all_done;
+    errno_t ret;
     int dp_error;
 
-    ret = enum_groups_recv(subreq);
+    ret = sdap_dom_enum_steps[step->type].recv_fn(subreq);
     talloc_zfree(subreq);
-    ret = sdap_id_op_done(state->group_op, ret, &dp_error);
+    ret = sdap_id_op_done(step->op, ret, &dp_error);
     if (dp_error == DP_ERR_OK && ret != EOK) {
         /* retry */
-        ret = sdap_dom_enum_ex_retry(req, state->group_op,
-                                     sdap_dom_enum_ex_get_groups);
+        ret = sdap_dom_enum_ex_retry(step);
         if (ret != EOK) {
             tevent_req_error(req, ret);
             return;
@@ -292,80 +419,33 @@ static void sdap_dom_enum_ex_groups_done(struct tevent_req *subreq)
         return;
     } else if (ret != EOK && ret != ENOENT) {
         /* Non-recoverable error */
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Group enumeration failed: %d: %s\n", ret, sss_strerror(ret));
+        DEBUG(SSSDBG_OP_FAILURE, "%s enumeration failed: %d: %s\n",
+              sdap_dom_enum_steps[step->type].name, ret, sss_strerror(ret));
         tevent_req_error(req, ret);
         return;
     }
 
+    sdap_dom_enum_ex_save_cursor(state, step->type);
 
-    state->svc_op = sdap_id_op_create(state, state->svc_conn->conn_cache);
-    if (state->svc_op == NULL) {
-        DEBUG(SSSDBG_CRIT_FAILURE, "sdap_id_op_create failed for svcs\n");
-        tevent_req_error(req, EIO);
-        return;
-    }
+    step->finished = true;
+    state->running--;
 
-    ret = sdap_dom_enum_ex_retry(req, state->svc_op,
-                                 sdap_dom_enum_ex_get_svcs);
+    ret = sdap_dom_enum_ex_schedule(req, &all_done);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
-}
-
-static void sdap_dom_enum_ex_get_svcs(struct tevent_req *subreq)
-{
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
-    struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
-                                                struct sdap_dom_enum_ex_state);
-
-    if (sdap_dom_enum_ex_connected(subreq) == false) {
-        return;
-    }
 
-    subreq = enum_services_send(state, state->ev, state->ctx,
-                                state->svc_op, state->purge);
-    if (!subreq) {
-        tevent_req_error(req, ENOMEM);
-        return;
+    if (all_done) {
+        sdap_dom_enum_ex_finish(req);
     }
-    tevent_req_set_callback(subreq, sdap_dom_enum_ex_svcs_done, req);
 }
 
-static void sdap_dom_enum_ex_svcs_done(struct tevent_req *subreq)
+static void sdap_dom_enum_ex_finish(struct tevent_req *req)
 {
-    struct tevent_req *req = tevent_req_callback_data(subreq,
-                                                      struct tevent_req);
     struct sdap_dom_enum_ex_state *state = tevent_req_data(req,
                                                 struct sdap_dom_enum_ex_state);
-    int ret;
-    int dp_error;
-
-    ret = enum_services_recv(subreq);
-    talloc_zfree(subreq);
-    ret = sdap_id_op_done(state->svc_op, ret, &dp_error);
-    if (dp_error == DP_ERR_OK && ret != EOK) {
-        /* retry */
-        ret = sdap_dom_enum_ex_retry(req, state->user_op,
-                                     sdap_dom_enum_ex_get_svcs);
-        if (ret != EOK) {
-            tevent_req_error(req, ret);
-            return;
-        }
-        return;
-    } else if (dp_error == DP_ERR_OFFLINE) {
-        DEBUG(SSSDBG_TRACE_FUNC, "Backend is offline, retrying later\n");
-        tevent_req_done(req);
-        return;
-    } else if (ret != EOK && ret != ENOENT) {
-        /* Non-recoverable error */
-        DEBUG(SSSDBG_OP_FAILURE,
-              "Service enumeration failed: %d: %s\n", ret, sss_strerror(ret));
-        tevent_req_error(req, ret);
-        return;
-    }
+    errno_t ret;
 
     /* Ok, we've completed an enumeration. Save this to the
      * sysdb so we can postpone starting up the enumeration
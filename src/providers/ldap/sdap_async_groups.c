@@ -1910,6 +1910,8 @@ static errno_t sdap_get_groups_next_base(struct tevent_req *req)
         break;
     }
 
+    /* The many entries of wildcard and enumeration lookups are saved and
+     * freed within the request, so they can be parsed into an arena */
     subreq = sdap_get_and_parse_generic_send(
             state, state->ev, state->opts,
             state->ldap_sh != NULL ? state->ldap_sh : state->sh,
@@ -1918,7 +1920,7 @@ static errno_t sdap_get_groups_next_base(struct tevent_req *req)
             state->filter, state->attrs,
             state->opts->group_map, SDAP_OPTS_GROUP,
             0, NULL, NULL, sizelimit, state->timeout,
-            need_paging);
+            need_paging, need_paging);
     if (!subreq) {
         return ENOMEM;
     }
@@ -1983,6 +1983,11 @@ done:
 
 static bool rfc2307bis_group_memberships_build(hash_entry_t *item, void *user_data);
 
+static int membership_name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
 static errno_t
 save_rfc2307bis_group_memberships(struct sdap_initgr_rfc2307bis_state *state)
 {
@@ -1991,8 +1996,8 @@ save_rfc2307bis_group_memberships(struct sdap_initgr_rfc2307bis_state *state)
     TALLOC_CTX *tmp_ctx;
     struct rfc2307bis_group_memberships_state *membership_state;
     struct membership_diff *iter;
-    struct membership_diff *iter_start;
-    struct membership_diff *iter_tmp;
+    const char **names;
+    size_t num_names;
     bool in_transaction = false;
     int num_added;
     int i;
@@ -2022,6 +2027,24 @@ save_rfc2307bis_group_memberships(struct sdap_initgr_rfc2307bis_state *state)
         goto done;
     }
 
+    /* Sorted names of the groups within the nesting limit */
+    num_names = 0;
+    DLIST_FOR_EACH(iter, membership_state->memberships) {
+        num_names++;
+    }
+
+    names = talloc_array(tmp_ctx, const char *, num_names + 1);
+    if (names == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    num_names = 0;
+    DLIST_FOR_EACH(iter, membership_state->memberships) {
+        names[num_names++] = iter->name;
+    }
+    qsort(names, num_names, sizeof(const char *), membership_name_cmp);
+
     ret = sysdb_transaction_start(state->sysdb);
     if (ret != EOK) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Failed to start transaction\n");
@@ -2029,8 +2052,6 @@ save_rfc2307bis_group_memberships(struct sdap_initgr_rfc2307bis_state *state)
     }
     in_transaction = true;
 
-    iter_start = membership_state->memberships;
-
     DLIST_FOR_EACH(iter, membership_state->memberships) {
         /* Create a copy of iter->add array but do not include groups outside
          * nesting limit. This array must be NULL terminated.
@@ -2044,12 +2065,10 @@ save_rfc2307bis_group_memberships(struct sdap_initgr_rfc2307bis_state *state)
 
         num_added = 0;
         for (i = 0; i < grp_count; i++) {
-            DLIST_FOR_EACH(iter_tmp, iter_start) {
-                if (!strcmp(iter_tmp->name,iter->add[i])) {
-                    add[num_added] = iter->add[i];
-                    num_added++;
-                    break;
-                }
+            if (bsearch(&iter->add[i], names, num_names, sizeof(const char *),
+                        membership_name_cmp) != NULL) {
+                add[num_added] = iter->add[i];
+                num_added++;
             }
         }
 
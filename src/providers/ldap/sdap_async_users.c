@@ -881,6 +881,8 @@ static errno_t sdap_search_user_next_base(struct tevent_req *req)
         break;
     }
 
+    /* The many entries of wildcard and enumeration lookups are saved and
+     * freed within the request, so they can be parsed into an arena */
     subreq = sdap_get_and_parse_generic_send(
             state, state->ev, state->opts, state->sh,
             state->search_bases[state->base_iter]->basedn,
@@ -888,7 +890,7 @@ static errno_t sdap_search_user_next_base(struct tevent_req *req)
             state->filter, state->attrs,
             state->opts->user_map, state->opts->user_map_cnt,
             0, NULL, NULL, sizelimit, state->timeout,
-            need_paging);
+            need_paging, need_paging);
     if (subreq == NULL) {
         return ENOMEM;
     }
@@ -173,15 +173,11 @@ static int do_getnamebysid(PyObject *py_result, PyObject *py_sid)
     return ret;
 }
 
-static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
-                         PyObject *py_id)
+static int py_to_id(PyObject *py_id, uint32_t *_id)
 {
     long id;
     const char *id_str;
     char *endptr;
-    char *sid = NULL;
-    int ret;
-    enum sss_id_type id_type;
 
 #ifndef IS_PY3K
     if (PyInt_Check(py_id)) {
@@ -206,15 +202,33 @@ static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
         return EINVAL;
     }
 
+    *_id = (uint32_t) id;
+
+    return 0;
+}
+
+static int do_getsidbyid(enum lookup_type type, PyObject *py_result,
+                         PyObject *py_id)
+{
+    uint32_t id;
+    char *sid = NULL;
+    int ret;
+    enum sss_id_type id_type;
+
+    ret = py_to_id(py_id, &id);
+    if (ret != 0) {
+        return ret;
+    }
+
     switch (type) {
     case SIDBYID:
-        ret = sss_nss_getsidbyid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbyid(id, &sid, &id_type);
         break;
     case SIDBYUID:
-        ret = sss_nss_getsidbyuid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbyuid(id, &sid, &id_type);
         break;
     case SIDBYGID:
-        ret = sss_nss_getsidbygid((uint32_t) id, &sid, &id_type);
+        ret = sss_nss_getsidbygid(id, &sid, &id_type);
         break;
     default:
         return EINVAL;
@@ -355,6 +369,171 @@ static int do_lookup(enum lookup_type type, PyObject *py_result,
     return ENOSYS;
 }
 
+/* Looks up all valid elements of the list or tuple py_values with a single
+ * call of the batch API of libsss_nss_idmap. Elements which cannot be
+ * converted or which were not found are skipped. Returns ENOSYS if there is
+ * no batch call for the given type. */
+static int do_lookup_list(enum lookup_type type, PyObject *py_result,
+                          PyObject *py_values)
+{
+    Py_ssize_t len, i;
+    size_t num = 0;
+    size_t c;
+    PyObject *py_value;
+    PyObject **py_keys = NULL;
+    const char **strs = NULL;
+    uint32_t *ids = NULL;
+    char **str_results = NULL;
+    uint32_t *id_results = NULL;
+    enum sss_id_type *types = NULL;
+    int *rets = NULL;
+    bool by_id;
+    int ret;
+
+    switch (type) {
+    case SIDBYID:
+    case SIDBYUID:
+    case SIDBYGID:
+        by_id = true;
+        break;
+    case SIDBYNAME:
+    case SIDBYUSERNAME:
+    case SIDBYGROUPNAME:
+    case NAMEBYSID:
+    case IDBYSID:
+        by_id = false;
+        break;
+    default:
+        return ENOSYS;
+    }
+
+    len = PySequence_Size(py_values);
+    if (len <= 0) {
+        return 0;
+    }
+
+    py_keys = calloc(len, sizeof(PyObject *));
+    strs = calloc(len, sizeof(char *));
+    ids = calloc(len, sizeof(uint32_t));
+    str_results = calloc(len, sizeof(char *));
+    id_results = calloc(len, sizeof(uint32_t));
+    types = calloc(len, sizeof(enum sss_id_type));
+    rets = calloc(len, sizeof(int));
+    if (py_keys == NULL || strs == NULL || ids == NULL || str_results == NULL
+            || id_results == NULL || types == NULL || rets == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < len; i++) {
+        py_value = PySequence_GetItem(py_values, i);
+        if (py_value == NULL) {
+            continue;
+        }
+
+        if (by_id && (PyBytes_Check(py_value) || PyUnicode_Check(py_value)
+                        || PYNUMBER_CHECK(py_value))) {
+            ret = py_to_id(py_value, &ids[num]);
+        } else if (!by_id && (PyBytes_Check(py_value)
+                                || PyUnicode_Check(py_value))) {
+            strs[num] = py_string_or_unicode_as_string(py_value);
+            ret = (strs[num] == NULL) ? EINVAL : 0;
+        } else {
+            ret = EINVAL;
+        }
+
+        if (ret != 0) {
+            /* Skip this value */
+            PyErr_Clear();
+            Py_DECREF(py_value);
+            continue;
+        }
+
+        py_keys[num] = py_value;
+        num++;
+    }
+
+    switch (type) {
+    case SIDBYNAME:
+        ret = sss_nss_getsidbyname_list(strs, num, str_results, types, rets);
+        break;
+    case SIDBYUSERNAME:
+        ret = sss_nss_getsidbyusername_list(strs, num, str_results, types,
+                                            rets);
+        break;
+    case SIDBYGROUPNAME:
+        ret = sss_nss_getsidbygroupname_list(strs, num, str_results, types,
+                                             rets);
+        break;
+    case SIDBYID:
+        ret = sss_nss_getsidbyid_list(ids, num, str_results, types, rets);
+        break;
+    case SIDBYUID:
+        ret = sss_nss_getsidbyuid_list(ids, num, str_results, types, rets);
+        break;
+    case SIDBYGID:
+        ret = sss_nss_getsidbygid_list(ids, num, str_results, types, rets);
+        break;
+    case NAMEBYSID:
+        ret = sss_nss_getnamebysid_list(strs, num, str_results, types, rets);
+        break;
+    case IDBYSID:
+        ret = sss_nss_getidbysid_list(strs, num, id_results, types, rets);
+        break;
+    default:
+        ret = ENOSYS;
+    }
+    if (ret != 0) {
+        goto done;
+    }
+
+    for (c = 0; c < num; c++) {
+        if (rets[c] != 0) {
+            continue;
+        }
+
+        if (type == IDBYSID) {
+            ret = add_dict(py_result, py_keys[c],
+                           PyUnicode_FromString(SSS_ID_KEY),
+                           PYNUMBER_FROMLONG(id_results[c]),
+                           PYNUMBER_FROMLONG(types[c]));
+        } else {
+            ret = add_dict(py_result, py_keys[c],
+                           PyUnicode_FromString(type == NAMEBYSID
+                                                    ? SSS_NAME_KEY
+                                                    : SSS_SID_KEY),
+                           PyUnicode_FromString(str_results[c]),
+                           PYNUMBER_FROMLONG(types[c]));
+        }
+        if (ret != 0) {
+            goto done;
+        }
+    }
+
+    ret = 0;
+
+done:
+    if (py_keys != NULL) {
+        for (c = 0; c < num; c++) {
+            Py_XDECREF(py_keys[c]);
+        }
+    }
+    if (str_results != NULL) {
+        for (c = 0; c < num; c++) {
+            free(str_results[c]);
+        }
+    }
+    free(py_keys);
+    free(strs);
+    free(ids);
+    free(str_results);
+    free(id_results);
+    free(types);
+    free(rets);
+
+    return ret;
+}
+
 static PyObject *check_args(enum lookup_type type, PyObject *args)
 {
     PyObject *obj, *py_value;
@@ -387,6 +566,18 @@ static PyObject *check_args(enum lookup_type type, PyObject *args)
     }
 
     if (PyList_Check(obj) || PyTuple_Check(obj)) {
+        ret = do_lookup_list(type, py_result, obj);
+        if (ret != ENOSYS) {
+            if (ret == ENOMEM) {
+                PyErr_Format(PyExc_MemoryError,
+                             "Unable to look up the list of values\n");
+                Py_XDECREF(py_result);
+                return NULL;
+            }
+            Py_XDECREF(py_result);
+            return py_result;
+        }
+
         len = PySequence_Size(obj);
         for(i=0; i < len; i++) {
             py_value = PySequence_GetItem(obj, i);
@@ -23,6 +23,8 @@
 #include <popt.h>
 
 #include "util/util.h"
+#include "util/sss_talloc_report.h"
+#include "util/sss_loop_stats.h"
 #include "confdb/confdb.h"
 #include "responder/common/responder.h"
 #include "providers/data_provider.h"
@@ -76,7 +78,10 @@ autofs_register_service_iface(struct autofs_ctx *autofs_ctx,
         sssd_service,
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx),
-            SBUS_SYNC(METHOD, sssd_service, clearEnumCache, autofs_clean_hash_table, autofs_ctx)
+            SBUS_SYNC(METHOD, sssd_service, clearEnumCache, autofs_clean_hash_table, autofs_ctx),
+            SBUS_SYNC(METHOD, sssd_service, tallocReport, generic_talloc_report, NULL),
+            SBUS_SYNC(METHOD, sssd_service, tallocSampling, generic_talloc_sampling, rctx->ev),
+            SBUS_SYNC(METHOD, sssd_service, loopStats, generic_loop_stats, NULL)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(
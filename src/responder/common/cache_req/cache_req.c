@@ -25,6 +25,7 @@
 
 #include "util/util.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 #include "responder/common/responder.h"
 #include "responder/common/cache_req/cache_req_private.h"
 #include "responder/common/cache_req/cache_req_plugin.h"
@@ -702,9 +703,28 @@ struct cache_req_search_domains_state {
     bool check_next;
     bool dp_success;
     bool first_iteration;
+
+    /* parallel lookup in all candidate domains */
+    struct cache_req_domain_lane *lanes;
+    size_t num_lanes;
+    size_t next_lane;
+};
+
+/* A lookup in one domain that runs concurrently with the others. It has
+ * its own copy of the request so that the per-domain data does not clash. */
+struct cache_req_domain_lane {
+    struct tevent_req *req;
+    struct cache_req *cr;
+    struct ldb_result *result;
+    errno_t ret;
+    bool dp_success;
+    bool finished;
 };
 
 static errno_t cache_req_search_domains_next(struct tevent_req *req);
+static errno_t cache_req_search_domains_parallel(struct tevent_req *req,
+                                                 bool *_started);
+static void cache_req_search_domains_lane_done(struct tevent_req *subreq);
 static errno_t cache_req_handle_result(struct tevent_req *req,
                                        struct ldb_result *result);
 
@@ -787,22 +807,60 @@ cache_req_search_domains_send(TALLOC_CTX *mem_ctx,
     return req;
 }
 
+static bool
+cache_req_search_domains_skip(struct cache_req_search_domains_state *state,
+                              struct cache_req_domain *cr_domain)
+{
+    struct cache_req *cr = state->cr;
+
+    /* As the cr_domain list is a flatten version of the domains
+     * list, we have to ensure to only go through the subdomains in
+     * case it's specified in the plugin to do so.
+     */
+    if (cr->plugin->get_next_domain_flags == 0
+            && IS_SUBDOMAIN(cr_domain->domain)) {
+        return true;
+    }
+
+    /* Check if this domain is valid for this request. */
+    if (!cache_req_validate_domain(cr, cr_domain->domain)) {
+        return true;
+    }
+
+    /* If not specified otherwise, we skip domains that require fully
+     * qualified names on domain less search. We do not descend into
+     * subdomains here since those are implicitly qualified.
+     */
+    if (state->check_next && !cr->plugin->allow_missing_fqn
+            && cr_domain->fqnames) {
+        return true;
+    }
+
+    return false;
+}
+
 static errno_t cache_req_search_domains_next(struct tevent_req *req)
 {
     struct cache_req_search_domains_state *state;
     struct tevent_req *subreq;
     struct cache_req *cr;
     struct sss_domain_info *domain;
-    uint32_t next_domain_flag;
-    bool is_domain_valid;
-    bool allow_no_fqn;
+    bool started;
     errno_t ret;
 
     state = tevent_req_data(req, struct cache_req_search_domains_state);
     cr = state->cr;
 
-    next_domain_flag = cr->plugin->get_next_domain_flags;
-    allow_no_fqn = cr->plugin->allow_missing_fqn;
+    if (state->lanes == NULL && state->cr_domain == state->req_domains) {
+        ret = cache_req_search_domains_parallel(req, &started);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        if (started) {
+            return EAGAIN;
+        }
+    }
 
     while (state->cr_domain != NULL) {
         domain = state->cr_domain->domain;
@@ -811,27 +869,7 @@ static errno_t cache_req_search_domains_next(struct tevent_req *req)
             break;
         }
 
-        /* As the cr_domain list is a flatten version of the domains
-         * list, we have to ensure to only go through the subdomains in
-         * case it's specified in the plugin to do so.
-         */
-        if (next_domain_flag == 0 && IS_SUBDOMAIN(domain)) {
-            state->cr_domain = state->cr_domain->next;
-            continue;
-        }
-
-        /* Check if this domain is valid for this request. */
-        is_domain_valid = cache_req_validate_domain(cr, domain);
-        if (!is_domain_valid) {
-            state->cr_domain = state->cr_domain->next;
-            continue;
-        }
-
-        /* If not specified otherwise, we skip domains that require fully
-         * qualified names on domain less search. We do not descend into
-         * subdomains here since those are implicitly qualified.
-         */
-        if (state->check_next && !allow_no_fqn && state->cr_domain->fqnames) {
+        if (cache_req_search_domains_skip(state, state->cr_domain)) {
             state->cr_domain = state->cr_domain->next;
             continue;
         }
@@ -1058,6 +1096,188 @@ done:
     return;
 }
 
+static errno_t cache_req_search_domains_parallel(struct tevent_req *req,
+                                                 bool *_started)
+{
+    struct cache_req_search_domains_state *state;
+    struct cache_req_domain_lane *lane;
+    struct cache_req_domain *cr_domain;
+    struct tevent_req *subreq;
+    struct cache_req *cr;
+    size_t count = 0;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+    cr = state->cr;
+    *_started = false;
+
+    /* Only lookups without a domain name that would contact the data
+     * provider benefit from it. The domain locator decides about the
+     * domain by itself, so it is left to the sequential walk. */
+    if (!cr->rctx->parallel_domain_lookup || !state->check_next
+            || !cache_req_dp_contacted(state)) {
+        return EOK;
+    }
+
+    for (cr_domain = state->cr_domain;
+         cr_domain != NULL && cr_domain->domain != NULL;
+         cr_domain = cr_domain->next) {
+        if (cache_req_search_domains_skip(state, cr_domain)) {
+            continue;
+        }
+
+        if (cr_domain->locate_domain) {
+            return EOK;
+        }
+
+        count++;
+    }
+
+    if (count < 2) {
+        return EOK;
+    }
+
+    state->lanes = talloc_zero_array(state, struct cache_req_domain_lane,
+                                     count);
+    if (state->lanes == NULL) {
+        return ENOMEM;
+    }
+
+    CACHE_REQ_DEBUG(SSSDBG_TRACE_FUNC, cr,
+                    "Searching %zu domains in parallel\n", count);
+
+    for (cr_domain = state->cr_domain;
+         cr_domain != NULL && cr_domain->domain != NULL;
+         cr_domain = cr_domain->next) {
+        if (cache_req_search_domains_skip(state, cr_domain)) {
+            continue;
+        }
+
+        lane = &state->lanes[state->num_lanes];
+        lane->req = req;
+
+        lane->cr = talloc_memdup(state->lanes, cr, sizeof(struct cache_req));
+        if (lane->cr == NULL) {
+            return ENOMEM;
+        }
+        lane->cr->debugobj = NULL;
+
+        lane->cr->data = cache_req_data_fork(lane->cr, cr->data);
+        if (lane->cr->data == NULL) {
+            return ENOMEM;
+        }
+
+        ret = cache_req_set_domain(lane->cr, cr_domain->domain);
+        if (ret != EOK) {
+            return ret;
+        }
+
+        subreq = cache_req_search_send(state, state->ev, lane->cr,
+                                       state->first_iteration, false);
+        if (subreq == NULL) {
+            return ENOMEM;
+        }
+        tevent_req_set_callback(subreq, cache_req_search_domains_lane_done,
+                                lane);
+
+        state->num_lanes++;
+    }
+
+    *_started = true;
+    return EOK;
+}
+
+/* Results are consumed strictly in the domain resolution order, so the
+ * answer is the same as if the domains were searched one by one. A lane
+ * that finishes early waits until all preceding domains are done. */
+static errno_t
+cache_req_search_domains_consume_lanes(struct tevent_req *req)
+{
+    struct cache_req_search_domains_state *state;
+    struct cache_req_domain_lane *lane;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+
+    while (state->next_lane < state->num_lanes) {
+        lane = &state->lanes[state->next_lane];
+        if (!lane->finished) {
+            return EAGAIN;
+        }
+        state->next_lane++;
+
+        state->dp_success = !lane->dp_success ? false : state->dp_success;
+
+        switch (lane->ret) {
+        case EOK:
+            ret = cache_req_set_domain(state->cr, lane->cr->domain);
+            if (ret != EOK) {
+                return ret;
+            }
+            state->selected_domain = lane->cr->domain;
+
+            ret = cache_req_handle_result(req, lane->result);
+            if (ret != EAGAIN) {
+                return ret;
+            }
+            break;
+        case ERR_ID_OUTSIDE_RANGE:
+        case ENOENT:
+            break;
+        default:
+            return lane->ret;
+        }
+    }
+
+    /* All domains were searched, let the common code decide about
+     * the final result. */
+    state->cr_domain = NULL;
+    return cache_req_search_domains_next(req);
+}
+
+static void cache_req_search_domains_lane_done(struct tevent_req *subreq)
+{
+    struct cache_req_search_domains_state *state;
+    struct cache_req_domain_lane *lane;
+    struct tevent_req *req;
+    errno_t ret;
+
+    lane = tevent_req_callback_data(subreq, struct cache_req_domain_lane);
+    req = lane->req;
+    state = tevent_req_data(req, struct cache_req_search_domains_state);
+
+    lane->ret = cache_req_search_recv(state->lanes, subreq, &lane->result,
+                                      &lane->dp_success);
+    talloc_zfree(subreq);
+    lane->finished = true;
+
+    ret = cache_req_search_domains_consume_lanes(req);
+    if (ret == ENOENT && state->results != NULL) {
+        /* We have at least one result. */
+        ret = EOK;
+    }
+
+    switch (ret) {
+    case EOK:
+        tevent_req_done(req);
+        break;
+    case EAGAIN:
+        break;
+    default:
+        if (ret == ENOENT
+            && !state->dp_success
+            && state->cr->data->propogate_offline_status) {
+            /* Not found and data provider request failed so we were
+             * unable to fetch the data. */
+            ret = ERR_OFFLINE;
+        }
+        tevent_req_error(req, ret);
+        break;
+    }
+
+    return;
+}
+
 static errno_t
 cache_req_search_domains_recv(TALLOC_CTX *mem_ctx,
                               struct tevent_req *req,
@@ -1091,8 +1311,45 @@ struct cache_req_state {
     struct cache_req_result **results;
     size_t num_results;
     bool first_iteration;
+
+    struct sss_trace_span *span;
 };
 
+static void cache_req_trace_cleanup(struct tevent_req *req,
+                                    enum tevent_req_state req_state)
+{
+    struct cache_req_state *state;
+    enum tevent_req_state is_state;
+    uint64_t err;
+    errno_t ret;
+
+    state = tevent_req_data(req, struct cache_req_state);
+    if (state->span == NULL) {
+        return;
+    }
+
+    switch (req_state) {
+    case TEVENT_REQ_DONE:
+        ret = EOK;
+        break;
+    case TEVENT_REQ_TIMED_OUT:
+        ret = ETIMEDOUT;
+        break;
+    case TEVENT_REQ_NO_MEMORY:
+        ret = ENOMEM;
+        break;
+    case TEVENT_REQ_USER_ERROR:
+        ret = tevent_req_is_error(req, &is_state, &err) ? err : EIO;
+        break;
+    default:
+        ret = ECANCELED;
+        break;
+    }
+
+    sss_trace_span_end(state->span, ret);
+    state->span = NULL;
+}
+
 static errno_t cache_req_process_input(TALLOC_CTX *mem_ctx,
                                        struct tevent_req *req,
                                        struct cache_req *cr,
@@ -1153,6 +1410,12 @@ struct tevent_req *cache_req_send(TALLOC_CTX *mem_ctx,
     SSS_REQ_TRACE_CID_CR(SSSDBG_TRACE_FUNC, cr, "New request [CID #%lu] '%s'\n",
                          sss_chain_id_get(), cr->reqname);
 
+    state->span = sss_trace_span_begin(state, SSS_TRACE_SPAN, "cache_req %s",
+                                       cr->reqname);
+    if (state->span != NULL) {
+        tevent_req_set_cleanup_fn(req, cache_req_trace_cleanup);
+    }
+
     ret = cache_req_is_well_known_object(state, cr, &result);
     if (ret == EOK) {
         ret = cache_req_add_result(state, result, &state->results,
@@ -506,6 +506,27 @@ cache_req_data_set_hybrid_lookup(struct cache_req_data *data,
     data->hybrid_lookup = hybrid_lookup;
 }
 
+struct cache_req_data *
+cache_req_data_fork(TALLOC_CTX *mem_ctx,
+                    struct cache_req_data *data)
+{
+    struct cache_req_data *fork;
+
+    fork = talloc_memdup(mem_ctx, data, sizeof(struct cache_req_data));
+    if (fork == NULL) {
+        return NULL;
+    }
+
+    /* The per-domain strings are owned and freed by whoever prepares
+     * the data, so they must not be shared with the original. */
+    fork->name.lookup = NULL;
+    fork->svc.protocol.lookup = NULL;
+    if (data->svc.name == &data->name) {
+        fork->svc.name = &fork->name;
+    }
+
+    return fork;
+}
 
 enum cache_req_type
 cache_req_data_get_type(struct cache_req_data *data)
@@ -148,6 +148,12 @@ cache_req_steal_data_and_send(TALLOC_CTX *mem_ctx,
 void cache_req_search_ncache_add_to_domain(struct cache_req *cr,
                                            struct sss_domain_info *domain);
 
+/* Shallow copy of the input data that can be prepared for another domain
+ * without touching the original. */
+struct cache_req_data *
+cache_req_data_fork(TALLOC_CTX *mem_ctx,
+                    struct cache_req_data *data);
+
 errno_t
 cache_req_add_result(TALLOC_CTX *mem_ctx,
                      struct cache_req_result *new_result,
@@ -68,6 +68,11 @@ struct cli_protocol_version {
 struct cli_protocol {
     struct cli_request *creq;
     struct cli_protocol_version *cli_protocol_version;
+
+    /* bytes of the next pipelined request read together with the
+     * current one */
+    uint8_t *pending;
+    size_t pending_len;
 };
 
 struct resp_ctx {
@@ -123,6 +128,7 @@ struct resp_ctx {
     bool shutting_down;
     bool socket_activated;
     bool cache_first;
+    bool parallel_domain_lookup;
     bool enumeration_warn_logged;
 };
 
@@ -198,6 +204,11 @@ int sss_cmd_send_empty(struct cli_ctx *cctx);
 int sss_cmd_send_error(struct cli_ctx *cctx, int err);
 void sss_cmd_done(struct cli_ctx *cctx, void *freectx);
 int sss_cmd_get_version(struct cli_ctx *cctx);
+
+/* Validate the protocol version the client sent in the request header.
+ * Returns EPROTONOSUPPORT if the version is not supported by this
+ * responder. */
+int sss_cmd_check_inline_version(struct cli_ctx *cctx);
 int sss_cmd_execute(struct cli_ctx *cctx,
                     enum sss_cli_command cmd,
                     struct sss_cmd_table *sss_cmds);
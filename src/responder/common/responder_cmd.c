@@ -101,9 +101,41 @@ void sss_cmd_done(struct cli_ctx *cctx, void *freectx)
     talloc_free(freectx);
 }
 
+static struct cli_protocol_version *sss_cmd_protocol_versions(void)
+{
+    static struct cli_protocol_version *cli_protocol_version = NULL;
+
+    if (cli_protocol_version == NULL) {
+        cli_protocol_version = register_cli_protocol_version();
+    }
+
+    return cli_protocol_version;
+}
+
+static struct cli_protocol_version *
+sss_cmd_find_protocol_version(uint32_t client_version)
+{
+    struct cli_protocol_version *cli_protocol_version;
+    int i;
+
+    cli_protocol_version = sss_cmd_protocol_versions();
+    if (cli_protocol_version == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; cli_protocol_version[i].version > 0; i++) {
+        if (cli_protocol_version[i].version == client_version) {
+            return &cli_protocol_version[i];
+        }
+    }
+
+    return NULL;
+}
+
 int sss_cmd_get_version(struct cli_ctx *cctx)
 {
     struct cli_protocol *pctx;
+    struct cli_protocol_version *cli_protocol_version;
     uint8_t *req_body;
     size_t req_blen;
     uint8_t *body;
@@ -111,18 +143,13 @@ int sss_cmd_get_version(struct cli_ctx *cctx)
     int ret;
     uint32_t client_version;
     uint32_t protocol_version;
-    int i;
-    static struct cli_protocol_version *cli_protocol_version = NULL;
 
     pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
     if (!pctx) return EINVAL;
 
     pctx->cli_protocol_version = NULL;
 
-    if (cli_protocol_version == NULL) {
-        cli_protocol_version = register_cli_protocol_version();
-    }
-
+    cli_protocol_version = sss_cmd_protocol_versions();
     if (cli_protocol_version != NULL) {
         pctx->cli_protocol_version = &cli_protocol_version[0];
 
@@ -132,13 +159,10 @@ int sss_cmd_get_version(struct cli_ctx *cctx)
             DEBUG(SSSDBG_FUNC_DATA,
                   "Received client version [%d].\n", client_version);
 
-            i=0;
-            while(cli_protocol_version[i].version>0) {
-                if (cli_protocol_version[i].version == client_version) {
-                    pctx->cli_protocol_version = &cli_protocol_version[i];
-                    break;
-                }
-                i++;
+            cli_protocol_version =
+                            sss_cmd_find_protocol_version(client_version);
+            if (cli_protocol_version != NULL) {
+                pctx->cli_protocol_version = cli_protocol_version;
             }
         }
     }
@@ -162,6 +186,46 @@ int sss_cmd_get_version(struct cli_ctx *cctx)
     return EOK;
 }
 
+int sss_cmd_check_inline_version(struct cli_ctx *cctx)
+{
+    struct cli_protocol *pctx;
+    struct cli_protocol_version *cli_protocol_version;
+    uint32_t client_version;
+
+    pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+    if (!pctx) return EINVAL;
+
+    if (sss_packet_get_cmd(pctx->creq->in) == SSS_GET_VERSION) {
+        /* The version is negotiated explicitly by sss_cmd_get_version() */
+        return EOK;
+    }
+
+    client_version = sss_packet_get_version(pctx->creq->in);
+    if (client_version == 0) {
+        /* Older client, it has already used SSS_GET_VERSION */
+        return EOK;
+    }
+
+    if (pctx->cli_protocol_version != NULL
+            && pctx->cli_protocol_version->version == client_version) {
+        return EOK;
+    }
+
+    cli_protocol_version = sss_cmd_find_protocol_version(client_version);
+    if (cli_protocol_version == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Client protocol version [%u] is not supported.\n",
+              client_version);
+        return EPROTONOSUPPORT;
+    }
+
+    DEBUG(SSSDBG_FUNC_DATA,
+          "Accepted inline client version [%u].\n", client_version);
+    pctx->cli_protocol_version = cli_protocol_version;
+
+    return EOK;
+}
+
 int sss_cmd_execute(struct cli_ctx *cctx,
                     enum sss_cli_command cmd,
                     struct sss_cmd_table *sss_cmds)
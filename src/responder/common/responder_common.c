@@ -281,6 +281,8 @@ done:
     return ret;
 }
 
+static void client_recv(struct cli_ctx *cctx);
+
 static void client_send(struct cli_ctx *cctx)
 {
     struct cli_protocol *pctx;
@@ -288,6 +290,13 @@ static void client_send(struct cli_ctx *cctx)
 
     pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
 
+    /* Let the client know the version was accepted so it can skip the
+     * SSS_GET_VERSION round trip on its next connections */
+    if (pctx->creq->out != NULL && pctx->cli_protocol_version != NULL) {
+        sss_packet_set_version(pctx->creq->out,
+                               pctx->cli_protocol_version->version);
+    }
+
     ret = sss_packet_send(pctx->creq->out, cctx->cfd);
     if (ret == EAGAIN) {
         /* not all data was sent, loop again */
@@ -303,6 +312,12 @@ static void client_send(struct cli_ctx *cctx)
     TEVENT_FD_NOT_WRITEABLE(cctx->cfde);
     TEVENT_FD_READABLE(cctx->cfde);
     talloc_zfree(pctx->creq);
+
+    /* the next request was already read, there might be no further
+     * event on the socket for it */
+    if (pctx->pending != NULL) {
+        client_recv(cctx);
+    }
     return;
 }
 
@@ -310,8 +325,23 @@ static int client_cmd_execute(struct cli_ctx *cctx, struct sss_cmd_table *sss_cm
 {
     struct cli_protocol *pctx;
     enum sss_cli_command cmd;
+    int ret;
 
     pctx = talloc_get_type(cctx->protocol_ctx, struct cli_protocol);
+
+    ret = sss_cmd_check_inline_version(cctx);
+    if (ret == EPROTONOSUPPORT) {
+        /* Reject the request but keep the client informed */
+        ret = sss_cmd_send_error(cctx, EPROTONOSUPPORT);
+        if (ret != EOK) {
+            return ret;
+        }
+        sss_cmd_done(cctx, NULL);
+        return EOK;
+    } else if (ret != EOK) {
+        return ret;
+    }
+
     cmd = sss_packet_get_cmd(pctx->creq->in);
     return sss_cmd_execute(cctx, cmd, sss_cmds);
 }
@@ -344,11 +374,27 @@ static void client_recv(struct cli_ctx *cctx)
         }
     }
 
-    ret = sss_packet_recv(pctx->creq->in, cctx->cfd);
+    if (pctx->pending != NULL) {
+        ret = sss_packet_prefill(pctx->creq->in,
+                                 pctx->pending, pctx->pending_len);
+        talloc_zfree(pctx->pending);
+        pctx->pending_len = 0;
+    } else {
+        ret = sss_packet_recv(pctx->creq->in, cctx->cfd);
+    }
     switch (ret) {
     case EOK:
         /* do not read anymore */
         TEVENT_FD_NOT_READABLE(cctx->cfde);
+        /* keep what the client already sent for its next request */
+        ret = sss_packet_take_surplus(pctx, pctx->creq->in,
+                                      &pctx->pending, &pctx->pending_len);
+        if (ret != EOK) {
+            DEBUG(SSSDBG_FATAL_FAILURE,
+                  "Failed to store pipelined request, aborting client!\n");
+            talloc_free(cctx);
+            return;
+        }
         /* execute command */
         ret = client_cmd_execute(cctx, cctx->rctx->sss_cmds);
         if (ret != EOK) {
@@ -1116,6 +1162,16 @@ int sss_process_init(TALLOC_CTX *mem_ctx,
               ret, sss_strerror(ret));
     }
 
+    ret = confdb_get_bool(rctx->cdb, rctx->confdb_service_path,
+                          CONFDB_RESPONDER_PARALLEL_DOMAIN_LOOKUP,
+                          false, &rctx->parallel_domain_lookup);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Cannot get \"parallel_domain_lookup\" option, domains will "
+              "be searched one by one [%d]: %s.\n",
+              ret, sss_strerror(ret));
+    }
+
     ret = confdb_get_int(rctx->cdb, rctx->confdb_service_path,
                          CONFDB_RESPONDER_GET_DOMAINS_TIMEOUT,
                          GET_DOMAINS_DEFAULT_TIMEOUT, &rctx->domains_timeout);
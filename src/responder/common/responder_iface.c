@@ -16,6 +16,8 @@
 */
 
 #include "util/util.h"
+#include "util/sss_talloc_report.h"
+#include "util/sss_loop_stats.h"
 #include "sss_iface/sss_iface_async.h"
 #include "responder/common/negcache.h"
 #include "responder/common/responder.h"
@@ -131,7 +133,10 @@ sss_resp_register_service_iface(struct resp_ctx *rctx)
     SBUS_INTERFACE(iface_svc,
         sssd_service,
         SBUS_METHODS(
-            SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx)
+            SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx),
+            SBUS_SYNC(METHOD, sssd_service, tallocReport, generic_talloc_report, NULL),
+            SBUS_SYNC(METHOD, sssd_service, tallocSampling, generic_talloc_sampling, rctx->ev),
+            SBUS_SYNC(METHOD, sssd_service, loopStats, generic_loop_stats, NULL)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(
@@ -40,7 +40,7 @@ struct sss_packet {
     * 0-3      packet length (uint32_t)
     * 4-7      command type (uint32_t)
     * 8-11     status (uint32_t)
-    * 12-15    reserved
+    * 12-15    client protocol version (uint32_t, 0 if not provided)
     * 16+      packet body */
     uint8_t *buffer;
 
@@ -52,6 +52,7 @@ struct sss_packet {
 #define SSS_PACKET_LEN_OFFSET 0
 #define SSS_PACKET_CMD_OFFSET sizeof(uint32_t)
 #define SSS_PACKET_ERR_OFFSET (2*(sizeof(uint32_t)))
+#define SSS_PACKET_VERSION_OFFSET (3*(sizeof(uint32_t)))
 #define SSS_PACKET_BODY_OFFSET (4*(sizeof(uint32_t)))
 
 static void sss_packet_set_len(struct sss_packet *packet, uint32_t len);
@@ -174,42 +175,13 @@ int sss_packet_set_size(struct sss_packet *packet, size_t size)
     return 0;
 }
 
-int sss_packet_recv(struct sss_packet *packet, int fd)
+/* Validates the header of the data received so far and grows the buffer if
+ * needed. Returns EAGAIN until the whole packet is available. */
+static int sss_packet_check_complete(struct sss_packet *packet, int fd)
 {
-    size_t rb;
-    size_t len;
-    void *buf;
     size_t new_len;
     int ret;
 
-    buf = (uint8_t *)packet->buffer + packet->iop;
-    if (packet->iop >= SSS_PACKET_CMD_OFFSET) {
-        len = sss_packet_get_len(packet) - packet->iop;
-    } else {
-        len = packet->memsize - packet->iop;
-    }
-
-    /* check for wrapping */
-    if (len > (packet->memsize - packet->iop)) {
-        return EINVAL;
-    }
-
-    errno = 0;
-    rb = recv(fd, buf, len, 0);
-
-    if (rb == -1) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
-            return EAGAIN;
-        } else {
-            return errno;
-        }
-    }
-
-    if (rb == 0) {
-        return ENODATA;
-    }
-
-    packet->iop += rb;
     if (packet->iop < SSS_PACKET_CMD_OFFSET) {
         return EAGAIN;
     }
@@ -258,6 +230,86 @@ int sss_packet_recv(struct sss_packet *packet, int fd)
     return EOK;
 }
 
+int sss_packet_recv(struct sss_packet *packet, int fd)
+{
+    size_t rb;
+    size_t len;
+    void *buf;
+
+    buf = (uint8_t *)packet->buffer + packet->iop;
+    if (packet->iop >= SSS_PACKET_CMD_OFFSET) {
+        len = sss_packet_get_len(packet) - packet->iop;
+    } else {
+        len = packet->memsize - packet->iop;
+    }
+
+    /* check for wrapping */
+    if (len > (packet->memsize - packet->iop)) {
+        return EINVAL;
+    }
+
+    errno = 0;
+    rb = recv(fd, buf, len, 0);
+
+    if (rb == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return EAGAIN;
+        } else {
+            return errno;
+        }
+    }
+
+    if (rb == 0) {
+        return ENODATA;
+    }
+
+    packet->iop += rb;
+
+    return sss_packet_check_complete(packet, fd);
+}
+
+/* The first recv() of a packet may already contain the beginning of the next
+ * request if the client pipelines its requests. Hand these bytes over to the
+ * caller so that they can be fed to the next packet with
+ * sss_packet_prefill(). */
+int sss_packet_take_surplus(TALLOC_CTX *mem_ctx, struct sss_packet *packet,
+                            uint8_t **_buf, size_t *_len)
+{
+    size_t len;
+    uint8_t *buf;
+
+    len = sss_packet_get_len(packet);
+    if (packet->iop <= len) {
+        *_buf = NULL;
+        *_len = 0;
+        return EOK;
+    }
+
+    buf = talloc_memdup(mem_ctx, packet->buffer + len, packet->iop - len);
+    if (buf == NULL) {
+        return ENOMEM;
+    }
+
+    *_len = packet->iop - len;
+    *_buf = buf;
+    packet->iop = len;
+
+    return EOK;
+}
+
+int sss_packet_prefill(struct sss_packet *packet,
+                       const uint8_t *buf, size_t len)
+{
+    if (len > packet->memsize) {
+        return EINVAL;
+    }
+
+    memcpy(packet->buffer, buf, len);
+    packet->iop = len;
+
+    return sss_packet_check_complete(packet, -1);
+}
+
 int sss_packet_send(struct sss_packet *packet, int fd)
 {
     size_t rb;
@@ -313,6 +365,21 @@ uint32_t sss_packet_get_status(struct sss_packet *packet)
     return status;
 }
 
+uint32_t sss_packet_get_version(struct sss_packet *packet)
+{
+    uint32_t version;
+
+    SAFEALIGN_COPY_UINT32(&version, packet->buffer + SSS_PACKET_VERSION_OFFSET,
+                          NULL);
+    return version;
+}
+
+void sss_packet_set_version(struct sss_packet *packet, uint32_t version)
+{
+    SAFEALIGN_SETMEM_UINT32(packet->buffer + SSS_PACKET_VERSION_OFFSET,
+                            version, NULL);
+}
+
 void sss_packet_get_body(struct sss_packet *packet, uint8_t **body, size_t *blen)
 {
     *body = packet->buffer + SSS_PACKET_BODY_OFFSET;
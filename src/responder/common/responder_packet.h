@@ -37,9 +37,15 @@ int sss_packet_grow(struct sss_packet *packet, size_t size);
 int sss_packet_shrink(struct sss_packet *packet, size_t size);
 int sss_packet_set_size(struct sss_packet *packet, size_t size);
 int sss_packet_recv(struct sss_packet *packet, int fd);
+int sss_packet_take_surplus(TALLOC_CTX *mem_ctx, struct sss_packet *packet,
+                            uint8_t **_buf, size_t *_len);
+int sss_packet_prefill(struct sss_packet *packet,
+                       const uint8_t *buf, size_t len);
 int sss_packet_send(struct sss_packet *packet, int fd);
 enum sss_cli_command sss_packet_get_cmd(struct sss_packet *packet);
 uint32_t sss_packet_get_status(struct sss_packet *packet);
+uint32_t sss_packet_get_version(struct sss_packet *packet);
+void sss_packet_set_version(struct sss_packet *packet, uint32_t version);
 void sss_packet_get_body(struct sss_packet *packet, uint8_t **body, size_t *blen);
 void sss_packet_set_error(struct sss_packet *packet, int error);
 
@@ -34,6 +34,8 @@
 #include <dbus/dbus.h>
 
 #include "util/util.h"
+#include "util/sss_talloc_report.h"
+#include "util/sss_loop_stats.h"
 #include "util/strtonum.h"
 #include "confdb/confdb.h"
 #include "responder/ifp/ifp_private.h"
@@ -139,7 +141,10 @@ ifp_register_service_iface(struct ifp_ctx *ifp_ctx,
         sssd_service,
         SBUS_METHODS(
             SBUS_SYNC(METHOD, sssd_service, rotateLogs, responder_logrotate, rctx),
-            SBUS_SYNC(METHOD, sssd_service, sysbusReconnect, ifp_sysbus_reconnect, ifp_ctx)
+            SBUS_SYNC(METHOD, sssd_service, sysbusReconnect, ifp_sysbus_reconnect, ifp_ctx),
+            SBUS_SYNC(METHOD, sssd_service, tallocReport, generic_talloc_report, NULL),
+            SBUS_SYNC(METHOD, sssd_service, tallocSampling, generic_talloc_sampling, rctx->ev),
+            SBUS_SYNC(METHOD, sssd_service, loopStats, generic_loop_stats, NULL)
         ),
         SBUS_SIGNALS(SBUS_NO_SIGNALS),
         SBUS_PROPERTIES(
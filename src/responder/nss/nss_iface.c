@@ -213,6 +213,61 @@ sss_nss_memorycache_invalidate_group_by_id(TALLOC_CTX *mem_ctx,
     return EOK;
 }
 
+static errno_t
+sss_nss_memorycache_invalidate_user_by_id(TALLOC_CTX *mem_ctx,
+                                          struct sbus_request *sbus_req,
+                                          struct sss_nss_ctx *nctx,
+                                          uint32_t uid)
+{
+
+    DEBUG(SSSDBG_TRACE_LIBS,
+          "Invalidating user %u from memory cache\n", uid);
+
+    sss_mmap_cache_pw_invalidate_uid(&nctx->pwd_mc_ctx, uid);
+
+    return EOK;
+}
+
+static errno_t
+sss_nss_memorycache_invalidate_initgroups_by_name(TALLOC_CTX *mem_ctx,
+                                                  struct sbus_request *sbus_req,
+                                                  struct sss_nss_ctx *nctx,
+                                                  const char *fq_name,
+                                                  const char *domain)
+{
+    struct sss_domain_info *dom;
+    struct sized_string *delete_name;
+    errno_t ret;
+
+    DEBUG(SSSDBG_TRACE_LIBS,
+          "Invalidating initgroups of [%s@%s] from memory cache\n",
+          fq_name, domain);
+
+    dom = find_domain_by_name(nctx->rctx->domains, domain, true);
+    if (dom == NULL) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "Unknown domain (%s) requested by provider\n", domain);
+        return EOK;
+    }
+
+    ret = sized_output_name(mem_ctx, nctx->rctx, fq_name, dom, &delete_name);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE,
+              "sized_output_name failed for '%s': %d [%s]\n",
+              fq_name, ret, sss_strerror(ret));
+        return EOK;
+    }
+
+    ret = sss_mmap_cache_initgr_invalidate(&nctx->initgr_mc_ctx, delete_name);
+    if (ret != EOK && ret != ENOENT) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Internal failure in memory cache code: %d [%s]\n",
+              ret, strerror(ret));
+    }
+
+    return EOK;
+}
+
 errno_t
 sss_nss_register_backend_iface(struct sbus_connection *conn,
                                struct sss_nss_ctx *nss_ctx)
@@ -243,7 +298,11 @@ sss_nss_register_backend_iface(struct sbus_connection *conn,
         SBUS_LISTEN_SYNC(sssd_nss_MemoryCache, InvalidateAllInitgroups,
                          SSS_BUS_PATH, sss_nss_memorycache_invalidate_initgroups, nss_ctx),
         SBUS_LISTEN_SYNC(sssd_nss_MemoryCache, InvalidateGroupById,
-                         SSS_BUS_PATH, sss_nss_memorycache_invalidate_group_by_id, nss_ctx)
+                         SSS_BUS_PATH, sss_nss_memorycache_invalidate_group_by_id, nss_ctx),
+        SBUS_LISTEN_SYNC(sssd_nss_MemoryCache, InvalidateUserById,
+                         SSS_BUS_PATH, sss_nss_memorycache_invalidate_user_by_id, nss_ctx),
+        SBUS_LISTEN_SYNC(sssd_nss_MemoryCache, InvalidateInitgroupsByName,
+                         SSS_BUS_PATH, sss_nss_memorycache_invalidate_initgroups_by_name, nss_ctx)
     );
 
     ret = sbus_router_listen_map(conn, listeners);
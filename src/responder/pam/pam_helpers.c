@@ -22,6 +22,7 @@
 
 
 #include "src/responder/pam/pam_helpers.h"
+#include "util/crypto/sss_crypto.h"
 
 struct pam_initgr_table_ctx {
     hash_table_t *id_table;
@@ -160,3 +161,191 @@ errno_t pam_initgr_check_timeout(hash_table_t *id_table,
     return EOK;
 }
 
+static void pam_transaction_remove(struct tevent_context *ev,
+                                   struct tevent_timer *te,
+                                   struct timeval tv,
+                                   void *pvt);
+
+static errno_t pam_transaction_new_token(hash_table_t *table,
+                                         uint32_t *_token)
+{
+    hash_key_t key;
+    uint32_t token;
+    int ret;
+
+    key.type = HASH_KEY_ULONG;
+
+    do {
+        ret = sss_generate_csprng_buffer((uint8_t *) &token, sizeof(token));
+        if (ret != EOK) {
+            return ret;
+        }
+
+        key.ul = token;
+    } while (token == 0 || hash_has_key(table, &key));
+
+    *_token = token;
+    return EOK;
+}
+
+errno_t pam_transaction_set(struct tevent_context *ev,
+                            hash_table_t *table,
+                            long timeout,
+                            uid_t client_uid,
+                            const char *logon_name,
+                            const char *service,
+                            const char *domain,
+                            struct ldb_message *user_obj,
+                            uint32_t *_token)
+{
+    struct pam_transaction *transaction;
+    struct tevent_timer *te;
+    struct timeval tv;
+    hash_key_t key;
+    hash_value_t val;
+    errno_t ret;
+    int hret;
+
+    transaction = talloc_zero(table, struct pam_transaction);
+    if (transaction == NULL) {
+        return ENOMEM;
+    }
+
+    transaction->table = table;
+    transaction->client_uid = client_uid;
+    transaction->logon_name = talloc_strdup(transaction, logon_name);
+    transaction->service = talloc_strdup(transaction,
+                                         service == NULL ? "" : service);
+    transaction->domain = talloc_strdup(transaction, domain);
+    transaction->user_obj = ldb_msg_copy(transaction, user_obj);
+    if (transaction->logon_name == NULL || transaction->service == NULL
+            || transaction->domain == NULL || transaction->user_obj == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = pam_transaction_new_token(table, &transaction->token);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Could not generate transaction token\n");
+        goto done;
+    }
+
+    key.type = HASH_KEY_ULONG;
+    key.ul = transaction->token;
+    val.type = HASH_VALUE_PTR;
+    val.ptr = transaction;
+
+    hret = hash_enter(table, &key, &val);
+    if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not add PAM transaction for [%s]: [%s]\n",
+              logon_name, hash_error_string(hret));
+        ret = EIO;
+        goto done;
+    }
+
+    /* Create a timer event to remove the transaction */
+    tv = tevent_timeval_current_ofs(timeout, 0);
+    te = tevent_add_timer(ev, transaction, tv,
+                          pam_transaction_remove,
+                          transaction);
+    if (te == NULL) {
+        hash_delete(table, &key);
+        ret = ENOMEM;
+        goto done;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL,
+          "Started PAM transaction [%u] for [%s]\n",
+          transaction->token, logon_name);
+
+    *_token = transaction->token;
+    ret = EOK;
+
+done:
+    if (ret != EOK) {
+        talloc_free(transaction);
+    }
+    return ret;
+}
+
+static void pam_transaction_remove(struct tevent_context *ev,
+                                   struct tevent_timer *te,
+                                   struct timeval tv,
+                                   void *pvt)
+{
+    struct pam_transaction *transaction =
+            talloc_get_type(pvt, struct pam_transaction);
+
+    pam_transaction_del(transaction);
+}
+
+void pam_transaction_del(struct pam_transaction *transaction)
+{
+    int hret;
+    hash_key_t key;
+
+    key.type = HASH_KEY_ULONG;
+    key.ul = transaction->token;
+
+    hret = hash_delete(transaction->table, &key);
+    if (hret != HASH_SUCCESS
+            && hret != HASH_ERROR_KEY_NOT_FOUND) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Could not remove PAM transaction [%u]: [%s]\n",
+               transaction->token,
+               hash_error_string(hret));
+    } else {
+        DEBUG(SSSDBG_TRACE_INTERNAL,
+              "PAM transaction [%u] removed\n",
+               transaction->token);
+    }
+
+    talloc_free(transaction);
+}
+
+errno_t pam_transaction_get(hash_table_t *table,
+                            uint32_t token,
+                            uid_t client_uid,
+                            const char *logon_name,
+                            const char *service,
+                            struct pam_transaction **_transaction)
+{
+    struct pam_transaction *transaction;
+    hash_key_t key;
+    hash_value_t val;
+    int hret;
+
+    key.type = HASH_KEY_ULONG;
+    key.ul = token;
+
+    hret = hash_lookup(table, &key, &val);
+    if (hret == HASH_ERROR_KEY_NOT_FOUND) {
+        DEBUG(SSSDBG_TRACE_ALL, "PAM transaction [%u] not found.\n", token);
+        return ENOENT;
+    } else if (hret != HASH_SUCCESS) {
+        DEBUG(SSSDBG_TRACE_ALL, "Error searching PAM transaction [%u].\n",
+                                token);
+        return EIO;
+    }
+
+    transaction = talloc_get_type(val.ptr, struct pam_transaction);
+    if (transaction == NULL) {
+        return EINVAL;
+    }
+
+    /* The token only identifies the transaction, it must not give access
+     * to data resolved for a different client, user or service. */
+    if (transaction->client_uid != client_uid
+            || strcmp(transaction->logon_name, logon_name) != 0
+            || strcmp(transaction->service,
+                      service == NULL ? "" : service) != 0) {
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "PAM transaction [%u] does not match the request.\n", token);
+        return ENOENT;
+    }
+
+    DEBUG(SSSDBG_TRACE_INTERNAL, "PAM transaction [%u] found.\n", token);
+    *_transaction = transaction;
+    return EOK;
+}
@@ -39,4 +39,45 @@ errno_t pam_initgr_cache_set(struct tevent_context *ev,
 errno_t pam_initgr_check_timeout(hash_table_t *id_table,
                                  char *name);
 
+/* Data resolved by the first request of a PAM transaction which can be
+ * reused by the following steps (authenticate, acct_mgmt, ...) of the
+ * same transaction. */
+struct pam_transaction {
+    hash_table_t *table;
+    uint32_t token;
+
+    uid_t client_uid;
+    char *logon_name;
+    char *service;
+
+    char *domain;
+    struct ldb_message *user_obj;
+};
+
+/* Stores a new transaction which is removed after timeout seconds and
+ * returns its token in _token. */
+errno_t pam_transaction_set(struct tevent_context *ev,
+                            hash_table_t *table,
+                            long timeout,
+                            uid_t client_uid,
+                            const char *logon_name,
+                            const char *service,
+                            const char *domain,
+                            struct ldb_message *user_obj,
+                            uint32_t *_token);
+
+/* Returns EOK if the transaction exists and was started by the same client
+ * for the same user and service.
+ * Returns ENOENT if the transaction is not found, expired or does not match.
+ */
+errno_t pam_transaction_get(hash_table_t *table,
+                            uint32_t token,
+                            uid_t client_uid,
+                            const char *logon_name,
+                            const char *service,
+                            struct pam_transaction **_transaction);
+
+/* Removes the transaction from its table and frees it. */
+void pam_transaction_del(struct pam_transaction *transaction);
+
 #endif /* PAM_HELPERS_H_ */
@@ -244,6 +244,15 @@ static int pam_process_init(TALLOC_CTX *mem_ctx,
         goto done;
     }
 
+    /* Create table for PAM transactions */
+    ret = sss_hash_create(pctx, 0, &pctx->transaction_table);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE,
+              "Could not create PAM transaction hash table: [%s]\n",
+              strerror(ret));
+        goto done;
+    }
+
     /* Set up file descriptor limits */
     ret = confdb_get_int(pctx->rctx->cdb,
                          CONFDB_PAM_CONF_ENTRY,
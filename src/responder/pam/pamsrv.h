@@ -43,6 +43,8 @@ struct pam_ctx {
     struct resp_ctx *rctx;
     time_t id_timeout;
     hash_table_t *id_table;
+    /* PAM transactions, see pam_transaction_set() */
+    hash_table_t *transaction_table;
     size_t trusted_uids_count;
     uid_t *trusted_uids;
 
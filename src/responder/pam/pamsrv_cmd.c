@@ -376,6 +376,12 @@ static int pam_parse_in_data_v2(struct pam_data *pd,
                                            body, blen, &c);
                     if (ret != EOK) return ret;
                     break;
+                case SSS_PAM_ITEM_TRANSACTION_TOKEN:
+                    /* This is optional. */
+                    ret = extract_uint32_t(&pd->transaction_token, size,
+                                           body, blen, &c);
+                    if (ret != EOK) return ret;
+                    break;
                 default:
                     DEBUG(SSSDBG_CRIT_FAILURE,
                           "Ignoring unknown data type [%d].\n", type);
@@ -2430,12 +2436,163 @@ static void pam_check_user_search_lookup(struct tevent_req *req);
 static void pam_check_user_search_done(struct pam_auth_req *preq, int ret,
                                        struct cache_req_result *result);
 
+/* The user object stored with a transaction may only be reused as long
+ * as the cached entry it was read from still exists, is not expired and
+ * was not updated since. */
+static errno_t pam_transaction_check_cached(struct sss_domain_info *domain,
+                                            struct ldb_message *user_obj)
+{
+    const char *attrs[] = { SYSDB_NAME, SYSDB_LAST_UPDATE,
+                            SYSDB_CACHE_EXPIRE, NULL };
+    struct ldb_message *msg;
+    const char *name;
+    uint64_t expire;
+    errno_t ret;
+
+    name = ldb_msg_find_attr_as_string(user_obj, SYSDB_NAME, NULL);
+    if (name == NULL) {
+        return ENOENT;
+    }
+
+    ret = sysdb_search_user_by_name(NULL, domain, name, attrs, &msg);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_TRACE_FUNC, "User [%s] of the PAM transaction is no "
+              "longer cached.\n", name);
+        return ENOENT;
+    }
+
+    expire = ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0);
+    if (expire <= time(NULL)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached entry of user [%s] of the PAM "
+              "transaction is expired.\n", name);
+        ret = ENOENT;
+        goto done;
+    }
+
+    if (ldb_msg_find_attr_as_uint64(msg, SYSDB_LAST_UPDATE, 0)
+            != ldb_msg_find_attr_as_uint64(user_obj, SYSDB_LAST_UPDATE, 0)) {
+        DEBUG(SSSDBG_TRACE_FUNC, "Cached entry of user [%s] changed since "
+              "the PAM transaction started.\n", name);
+        ret = ENOENT;
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(msg);
+    return ret;
+}
+
+/* If the client sent a token of an earlier step of the same PAM
+ * transaction, reuse the user and domain resolved back then. */
+static errno_t pam_transaction_reuse(struct pam_auth_req *preq)
+{
+    struct pam_ctx *pctx;
+    struct pam_transaction *transaction;
+    struct sss_domain_info *domain;
+    errno_t ret;
+
+    pctx = talloc_get_type(preq->cctx->rctx->pvt_ctx, struct pam_ctx);
+
+    if (preq->pd->transaction_token == 0 || preq->pd->logon_name == NULL
+            || pctx->transaction_table == NULL) {
+        return ENOENT;
+    }
+
+    ret = pam_transaction_get(pctx->transaction_table,
+                              preq->pd->transaction_token,
+                              client_euid(preq->cctx->creds),
+                              preq->pd->logon_name,
+                              preq->pd->service,
+                              &transaction);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    domain = find_domain_by_name(preq->cctx->rctx->domains,
+                                 transaction->domain, true);
+    if (domain == NULL) {
+        pam_transaction_del(transaction);
+        return ENOENT;
+    }
+
+    ret = pam_transaction_check_cached(domain, transaction->user_obj);
+    if (ret != EOK) {
+        /* Let the regular lookup deal with a deleted, expired or
+         * refreshed user. */
+        pam_transaction_del(transaction);
+        return ret;
+    }
+
+    /* The transaction might expire while this request is running */
+    preq->user_obj = ldb_msg_copy(preq, transaction->user_obj);
+    if (preq->user_obj == NULL) {
+        return ENOMEM;
+    }
+
+    ret = pd_set_primary_name(preq->user_obj, preq->pd);
+    if (ret != EOK) {
+        talloc_zfree(preq->user_obj);
+        return ret;
+    }
+    preq->domain = domain;
+
+    DEBUG(SSSDBG_TRACE_FUNC, "Reusing user [%s] resolved earlier in the "
+          "PAM transaction.\n", preq->pd->user);
+
+    return EOK;
+}
+
+static errno_t pam_transaction_start(struct pam_auth_req *preq)
+{
+    struct pam_ctx *pctx;
+    uint32_t token;
+    errno_t ret;
+
+    pctx = talloc_get_type(preq->cctx->rctx->pvt_ctx, struct pam_ctx);
+
+    if (!(preq->pd->cli_flags & PAM_CLI_FLAGS_TRANSACTION)
+            || preq->pd->logon_name == NULL
+            || pctx->transaction_table == NULL) {
+        return EOK;
+    }
+
+    ret = pam_transaction_set(pctx->rctx->ev,
+                              pctx->transaction_table,
+                              pctx->id_timeout,
+                              client_euid(preq->cctx->creds),
+                              preq->pd->logon_name,
+                              preq->pd->service,
+                              preq->domain->name,
+                              preq->user_obj,
+                              &token);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return pam_add_response(preq->pd, SSS_PAM_TRANSACTION_TOKEN,
+                            sizeof(uint32_t), (const uint8_t *) &token);
+}
+
 /* lookup the user uid from the cache first,
  * then we'll refresh initgroups if needed */
 int pam_check_user_search(struct pam_auth_req *preq)
 {
     struct tevent_req *dpreq;
     struct cache_req_data *data;
+    errno_t ret;
+
+    ret = pam_transaction_reuse(preq);
+    if (ret == EOK) {
+        pam_dom_forwarder(preq);
+        /* The request is forwarded already, callers must not touch it
+         * anymore, just like after an asynchronous lookup. */
+        return EAGAIN;
+    } else if (ret != ENOENT) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Cannot reuse PAM transaction, "
+              "looking the user up again.\n");
+    }
 
     data = cache_req_data_name(preq,
                                CACHE_REQ_INITGROUPS,
@@ -2599,6 +2756,7 @@ static void pam_check_user_search_done(struct pam_auth_req *preq, int ret,
                                        struct cache_req_result *result)
 {
     struct pam_ctx *pctx;
+    errno_t tret;
 
     pctx = talloc_get_type(preq->cctx->rctx->pvt_ctx, struct pam_ctx);
 
@@ -2617,6 +2775,13 @@ static void pam_check_user_search_done(struct pam_auth_req *preq, int ret,
                   "Proceeding with PAM actions\n");
         }
 
+        tret = pam_transaction_start(preq);
+        if (tret != EOK) {
+            DEBUG(SSSDBG_OP_FAILURE,
+                  "Could not start PAM transaction. "
+                  "Proceeding with PAM actions\n");
+        }
+
         pam_dom_forwarder(preq);
     }
 
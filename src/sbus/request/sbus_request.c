@@ -26,6 +26,7 @@
 #include "util/util.h"
 #include "util/dlinklist.h"
 #include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
 #include "sbus/sbus_request.h"
 #include "sbus/sbus_private.h"
 
@@ -583,6 +584,7 @@ struct sbus_outgoing_request_state {
     struct sbus_connection *conn;
     DBusMessage *reply;
     uint64_t chain_id;
+    struct sss_trace_span *span;
 };
 
 static errno_t
@@ -672,6 +674,13 @@ sbus_outgoing_request_send(TALLOC_CTX *mem_ctx,
 
     tevent_req_set_callback(subreq, sbus_outgoing_request_done, req);
 
+    /* The server sets the message sender to our well known name. */
+    state->span = sss_trace_span_begin(state, SSS_TRACE_SBUS_CALL, "%s.%s",
+                                       dbus_message_get_interface(msg),
+                                       dbus_message_get_member(msg));
+    sss_trace_span_link(state->span, sbus_connection_get_name(conn),
+                        state->chain_id);
+
     ret = EAGAIN;
 
 done:
@@ -697,6 +706,9 @@ static void sbus_outgoing_request_done(struct tevent_req *subreq)
     ret = sbus_message_recv(state, subreq, &state->reply);
     talloc_zfree(subreq);
 
+    sss_trace_span_end(state->span, ret);
+    state->span = NULL;
+
     if (ret != EOK) {
         sbus_request_notify_error(state->conn->requests->outgoing,
                                   state->key, req, ret);
@@ -80,6 +80,11 @@ static int _sss_cli_sd = -1; /* the sss client socket descriptor */
 static struct stat _sss_cli_sb; /* the sss client stat buffer */
 #endif
 
+/* Set once a responder has acknowledged the protocol version sent in the
+ * request header. New connections may then skip the SSS_GET_VERSION round
+ * trip because a mismatch is reported inline by the responder. */
+static atomic_bool sss_cli_inline_version = false;
+
 void sss_cli_close_socket(void)
 {
     int sd = sss_cli_sd_get();
@@ -163,11 +168,12 @@ static void init_sssd_ids(void)
  * byte 0-3: 32bit unsigned with length (the complete packet length: 0 to X)
  * byte 4-7: 32bit unsigned with command code
  * byte 8-11: 32bit unsigned (reserved)
- * byte 12-15: 32bit unsigned (reserved)
+ * byte 12-15: 32bit unsigned with the client protocol version (0 if unknown)
  * byte 16-X: (optional) request structure associated to the command code used
  */
 static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
                                         struct sss_cli_req_data *rd,
+                                        uint32_t protocol_version,
                                         int timeout,
                                         int *errnop)
 {
@@ -177,7 +183,7 @@ static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
     header[0] = SSS_NSS_HEADER_SIZE + (rd?rd->len:0);
     header[1] = cmd;
     header[2] = 0;
-    header[3] = 0;
+    header[3] = protocol_version;
 
     datasent = 0;
 
@@ -269,14 +275,20 @@ static enum sss_status sss_cli_send_req(enum sss_cli_command cmd,
  * byte 0-3: 32bit unsigned with length (the complete packet length: 0 to X)
  * byte 4-7: 32bit unsigned with command code
  * byte 8-11: 32bit unsigned with the request status (server errno)
- * byte 12-15: 32bit unsigned (reserved)
+ * byte 12-15: 32bit unsigned with the accepted protocol version (0 if the
+ *             responder does not check the version inline)
  * byte 16-X: (optional) reply structure associated to the command code used
  */
 
-static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
-                                        int timeout,
-                                        uint8_t **_buf, int *_len,
-                                        int *errnop)
+/* If keep_on_error is set, an error reply without data section does not
+ * close the socket, so that the replies to requests which were already
+ * written can still be read. */
+static enum sss_status sss_cli_recv_rep_ex(enum sss_cli_command cmd,
+                                           uint32_t protocol_version,
+                                           int timeout,
+                                           bool keep_on_error,
+                                           uint8_t **_buf, int *_len,
+                                           int *errnop)
 {
     uint32_t header[4];
     size_t datarecv;
@@ -385,7 +397,10 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
              * been read, do checks and proceed */
             if (header[2] != 0) {
                 /* server side error */
-                sss_cli_close_socket();
+                if (!keep_on_error || pollhup
+                        || header[0] != SSS_NSS_HEADER_SIZE) {
+                    sss_cli_close_socket();
+                }
                 *errnop = header[2];
                 if (*errnop == EAGAIN) {
                     ret = SSS_STATUS_TRYAGAIN;
@@ -402,6 +417,9 @@ static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
                 ret = SSS_STATUS_UNAVAIL;
                 goto failed;
             }
+            if (protocol_version != 0 && header[3] == protocol_version) {
+                sss_cli_inline_version = true;
+            }
             if (header[0] > SSS_NSS_HEADER_SIZE) {
                 len = header[0] - SSS_NSS_HEADER_SIZE;
                 buf = malloc(len);
@@ -429,11 +447,22 @@ failed:
     return ret;
 }
 
+static enum sss_status sss_cli_recv_rep(enum sss_cli_command cmd,
+                                        uint32_t protocol_version,
+                                        int timeout,
+                                        uint8_t **_buf, int *_len,
+                                        int *errnop)
+{
+    return sss_cli_recv_rep_ex(cmd, protocol_version, timeout, false,
+                               _buf, _len, errnop);
+}
+
 /* this function will check command codes match and returned length is ok */
 /* repbuf and replen report only the data section not the header */
 static enum sss_status sss_cli_make_request_nochecks(
                                        enum sss_cli_command cmd,
                                        struct sss_cli_req_data *rd,
+                                       uint32_t protocol_version,
                                        int timeout,
                                        uint8_t **repbuf, size_t *replen,
                                        int *errnop)
@@ -443,13 +472,13 @@ static enum sss_status sss_cli_make_request_nochecks(
     int len = 0;
 
     /* send data */
-    ret = sss_cli_send_req(cmd, rd, timeout, errnop);
+    ret = sss_cli_send_req(cmd, rd, protocol_version, timeout, errnop);
     if (ret != SSS_STATUS_SUCCESS) {
         return ret;
     }
 
     /* data sent, now get reply */
-    ret = sss_cli_recv_rep(cmd, timeout, &buf, &len, errnop);
+    ret = sss_cli_recv_rep(cmd, protocol_version, timeout, &buf, &len, errnop);
     if (ret != SSS_STATUS_SUCCESS) {
         return ret;
     }
@@ -471,6 +500,28 @@ static enum sss_status sss_cli_make_request_nochecks(
     return SSS_STATUS_SUCCESS;
 }
 
+static bool sss_cli_protocol_version(const char *socket_name,
+                                     uint32_t *_version)
+{
+    if (strcmp(socket_name, SSS_NSS_SOCKET_NAME) == 0) {
+        *_version = SSS_NSS_PROTOCOL_VERSION;
+    } else if (strcmp(socket_name, SSS_PAM_SOCKET_NAME) == 0) {
+        *_version = SSS_PAM_PROTOCOL_VERSION;
+    } else if (strcmp(socket_name, SSS_SUDO_SOCKET_NAME) == 0) {
+        *_version = SSS_SUDO_PROTOCOL_VERSION;
+    } else if (strcmp(socket_name, SSS_AUTOFS_SOCKET_NAME) == 0) {
+        *_version = SSS_AUTOFS_PROTOCOL_VERSION;
+    } else if (strcmp(socket_name, SSS_SSH_SOCKET_NAME) == 0) {
+        *_version = SSS_SSH_PROTOCOL_VERSION;
+    } else if (strcmp(socket_name, SSS_PAC_SOCKET_NAME) == 0) {
+        *_version = SSS_PAC_PROTOCOL_VERSION;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
 /* GET_VERSION Reply:
  * 0-3: 32bit unsigned version number
  */
@@ -485,26 +536,26 @@ static bool sss_cli_check_version(const char *socket_name, int timeout)
     uint32_t obtained_version;
     struct sss_cli_req_data req;
 
-    if (strcmp(socket_name, SSS_NSS_SOCKET_NAME) == 0) {
-        expected_version = SSS_NSS_PROTOCOL_VERSION;
-    } else if (strcmp(socket_name, SSS_PAM_SOCKET_NAME) == 0) {
-        expected_version = SSS_PAM_PROTOCOL_VERSION;
-    } else if (strcmp(socket_name, SSS_SUDO_SOCKET_NAME) == 0) {
-        expected_version = SSS_SUDO_PROTOCOL_VERSION;
-    } else if (strcmp(socket_name, SSS_AUTOFS_SOCKET_NAME) == 0) {
-        expected_version = SSS_AUTOFS_PROTOCOL_VERSION;
-    } else if (strcmp(socket_name, SSS_SSH_SOCKET_NAME) == 0) {
-        expected_version = SSS_SSH_PROTOCOL_VERSION;
-    } else if (strcmp(socket_name, SSS_PAC_SOCKET_NAME) == 0) {
-        expected_version = SSS_PAC_PROTOCOL_VERSION;
-    } else {
+    if (!sss_cli_protocol_version(socket_name, &expected_version)) {
         return false;
     }
 
+    /* The version travels with every request. Version 0 can not be
+     * distinguished from a client which does not send it, so those
+     * responders still need the explicit handshake. The NSS protocol has
+     * never changed its version, so even responders which predate the
+     * inline check are safe to talk to without it. */
+    if (expected_version != 0
+            && (sss_cli_inline_version
+                || strcmp(socket_name, SSS_NSS_SOCKET_NAME) == 0)) {
+        return true;
+    }
+
     req.len = sizeof(expected_version);
     req.data = &expected_version;
 
-    nret = sss_cli_make_request_nochecks(SSS_GET_VERSION, &req, timeout,
+    nret = sss_cli_make_request_nochecks(SSS_GET_VERSION, &req,
+                                         expected_version, timeout,
                                          &repbuf, &replen, &errnop);
     if (nret != SSS_STATUS_SUCCESS) {
         return false;
@@ -857,6 +908,26 @@ static enum sss_status sss_cli_check_socket(int *errnop,
     return SSS_STATUS_UNAVAIL;
 }
 
+static enum nss_status sss_cli_to_nss_status(enum sss_status ret,
+                                             int *errnop)
+{
+    switch (ret) {
+    case SSS_STATUS_TRYAGAIN:
+        return NSS_STATUS_TRYAGAIN;
+    case SSS_STATUS_SUCCESS:
+        return NSS_STATUS_SUCCESS;
+    case SSS_STATUS_UNAVAIL:
+    default:
+#ifdef NONSTANDARD_SSS_NSS_BEHAVIOUR
+        *errnop = 0;
+        errno = 0;
+        return NSS_STATUS_NOTFOUND;
+#else
+        return NSS_STATUS_UNAVAIL;
+#endif
+    }
+}
+
 /* this function will check command codes match and returned length is ok */
 /* repbuf and replen report only the data section not the header */
 enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
@@ -885,8 +956,8 @@ enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
 #endif
     }
 
-    ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                        errnop);
+    ret = sss_cli_make_request_nochecks(cmd, rd, SSS_NSS_PROTOCOL_VERSION,
+                                        timeout, repbuf, replen, errnop);
     if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
         /* try reopen socket */
         ret = sss_cli_check_socket(errnop, SSS_NSS_SOCKET_NAME, timeout);
@@ -901,24 +972,131 @@ enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
         }
 
         /* and make request one more time */
-        ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                            errnop);
+        ret = sss_cli_make_request_nochecks(cmd, rd, SSS_NSS_PROTOCOL_VERSION,
+                                            timeout, repbuf, replen, errnop);
     }
-    switch (ret) {
-    case SSS_STATUS_TRYAGAIN:
-        return NSS_STATUS_TRYAGAIN;
-    case SSS_STATUS_SUCCESS:
-        return NSS_STATUS_SUCCESS;
-    case SSS_STATUS_UNAVAIL:
-    default:
-#ifdef NONSTANDARD_SSS_NSS_BEHAVIOUR
-        *errnop = 0;
-        errno = 0;
+
+    return sss_cli_to_nss_status(ret, errnop);
+}
+
+/* At most this many requests are written before the replies are read back.
+ * The responder handles one request of a connection at a time, so the
+ * window has to fit into the socket buffers in both directions, otherwise
+ * client and responder would both block in send(). */
+#define SSS_CLI_PIPELINE_WINDOW 64
+
+enum nss_status sss_nss_make_request_pipelined(enum sss_cli_command cmd,
+                                               struct sss_cli_req_data *rd,
+                                               size_t num,
+                                               int timeout,
+                                               struct sss_cli_rep_data *rep)
+{
+    enum sss_status ret = SSS_STATUS_SUCCESS;
+    enum sss_status send_ret;
+    int send_errnop;
+    char *envval;
+    size_t done;
+    size_t window;
+    size_t sent;
+    size_t c;
+    bool retried = false;
+    uint8_t *buf;
+    int len;
+    int errnop = 0;
+
+    for (c = 0; c < num; c++) {
+        rep[c].status = NSS_STATUS_UNAVAIL;
+        rep[c].errnop = 0;
+        rep[c].buf = NULL;
+        rep[c].len = 0;
+    }
+
+    /* avoid looping in the nss daemon */
+    envval = getenv("_SSS_LOOPS");
+    if (envval && strcmp(envval, "NO") == 0) {
+        for (c = 0; c < num; c++) {
+            rep[c].status = NSS_STATUS_NOTFOUND;
+        }
         return NSS_STATUS_NOTFOUND;
-#else
-        return NSS_STATUS_UNAVAIL;
-#endif
     }
+
+    done = 0;
+    while (done < num) {
+        ret = sss_cli_check_socket(&errnop, SSS_NSS_SOCKET_NAME, timeout);
+        if (ret != SSS_STATUS_SUCCESS) {
+            break;
+        }
+
+        window = num - done;
+        if (window > SSS_CLI_PIPELINE_WINDOW) {
+            window = SSS_CLI_PIPELINE_WINDOW;
+        }
+        for (sent = 0; sent < window; sent++) {
+            ret = sss_cli_send_req(cmd, &rd[done + sent],
+                                   SSS_NSS_PROTOCOL_VERSION, timeout, &errnop);
+            if (ret != SSS_STATUS_SUCCESS) {
+                break;
+            }
+        }
+        send_ret = ret;
+        send_errnop = errnop;
+        if (sent > 0) {
+            retried = false;
+        }
+
+        /* An error sent by the responder only fails the request it belongs
+         * to. If the connection is lost, the requests which were already
+         * written might have been processed and are not sent again, they
+         * fail with the error which closed the socket. */
+        for (c = 0; c < sent; c++) {
+            if (sss_cli_sd_get() != -1) {
+                ret = sss_cli_recv_rep_ex(cmd, SSS_NSS_PROTOCOL_VERSION,
+                                          timeout, true, &buf, &len, &errnop);
+                if (ret == SSS_STATUS_SUCCESS) {
+                    rep[done].status = NSS_STATUS_SUCCESS;
+                    rep[done].buf = buf;
+                    rep[done].len = len;
+                    done++;
+                    continue;
+                }
+            } else if (ret == SSS_STATUS_SUCCESS) {
+                /* the responder hung up after the previous reply */
+                ret = SSS_STATUS_UNAVAIL;
+                errnop = EPIPE;
+            }
+
+            rep[done].errnop = errnop;
+            rep[done].status = sss_cli_to_nss_status(ret, &rep[done].errnop);
+            done++;
+        }
+
+        if (sent < window) {
+            /* The request which could not be written is sent again once
+             * over a new connection, as sss_nss_make_request_timeout()
+             * does. */
+            if (send_ret == SSS_STATUS_UNAVAIL && send_errnop == EPIPE
+                    && !retried) {
+                retried = true;
+                continue;
+            }
+
+            rep[done].errnop = send_errnop;
+            rep[done].status = sss_cli_to_nss_status(send_ret,
+                                                     &rep[done].errnop);
+            done++;
+        }
+    }
+
+    if (done < num) {
+        /* the responder cannot be reached */
+        for (c = done; c < num; c++) {
+            rep[c].errnop = errnop;
+            rep[c].status = sss_cli_to_nss_status(ret, &rep[c].errnop);
+        }
+        return rep[done].status;
+    }
+
+    return NSS_STATUS_SUCCESS;
 }
 
 enum nss_status sss_nss_make_request(enum sss_cli_command cmd,
@@ -1118,8 +1296,13 @@ sss_cli_make_request_with_checks(enum sss_cli_command cmd,
                                  bool allow_custom_errors)
 {
     enum sss_status ret = SSS_STATUS_UNAVAIL;
+    uint32_t protocol_version;
     errno_t error;
 
+    if (!sss_cli_protocol_version(socket_name, &protocol_version)) {
+        protocol_version = 0;
+    }
+
     ret = sss_cli_check_socket(errnop, socket_name, timeout);
     if (ret != SSS_STATUS_SUCCESS) {
         return SSS_STATUS_UNAVAIL;
@@ -1138,8 +1321,8 @@ sss_cli_make_request_with_checks(enum sss_cli_command cmd,
         }
     }
 
-    ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                        errnop);
+    ret = sss_cli_make_request_nochecks(cmd, rd, protocol_version, timeout,
+                                        repbuf, replen, errnop);
     if (ret == SSS_STATUS_UNAVAIL && *errnop == EPIPE) {
         /* try reopen socket */
         ret = sss_cli_check_socket(errnop, socket_name, timeout);
@@ -1148,8 +1331,8 @@ sss_cli_make_request_with_checks(enum sss_cli_command cmd,
         }
 
         /* and make request one more time */
-        ret = sss_cli_make_request_nochecks(cmd, rd, timeout, repbuf, replen,
-                                            errnop);
+        ret = sss_cli_make_request_nochecks(cmd, rd, protocol_version, timeout,
+                                            repbuf, replen, errnop);
     }
 
     return ret;
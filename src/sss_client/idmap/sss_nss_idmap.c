@@ -223,29 +223,11 @@ static errno_t sss_nss_mc_get(union input inp, enum sss_cli_command cmd,
     }
 }
 
-static int sss_nss_getyyybyxxx(union input inp, enum sss_cli_command cmd,
-                               unsigned int timeout, struct output *out)
+static int sss_nss_req_data(union input *inp, enum sss_cli_command cmd,
+                            struct sss_cli_req_data *rd)
 {
     int ret;
     size_t inp_len;
-    struct sss_cli_req_data rd;
-    uint8_t *repbuf = NULL;
-    size_t replen;
-    int errnop;
-    enum nss_status nret;
-    uint32_t num_results;
-    char *str = NULL;
-    size_t data_len;
-    uint32_t c;
-    struct sss_nss_kv *kv_list;
-    char **names;
-    enum sss_id_type *types;
-    int time_left = SSS_CLI_SOCKET_TIMEOUT;
-
-    ret = sss_nss_mc_get(inp, cmd, out);
-    if (ret == EOK) {
-        return 0;
-    }
 
     switch (cmd) {
     case SSS_NSS_GETSIDBYNAME:
@@ -256,59 +238,52 @@ static int sss_nss_getyyybyxxx(union input inp, enum sss_cli_command cmd,
     case SSS_NSS_GETORIGBYNAME:
     case SSS_NSS_GETORIGBYUSERNAME:
     case SSS_NSS_GETORIGBYGROUPNAME:
-        ret = sss_strnlen(inp.str, 2048, &inp_len);
+        ret = sss_strnlen(inp->str, 2048, &inp_len);
         if (ret != EOK) {
             return EINVAL;
         }
 
-        rd.len = inp_len + 1;
-        rd.data = inp.str;
+        rd->len = inp_len + 1;
+        rd->data = inp->str;
 
         break;
     case SSS_NSS_GETNAMEBYCERT:
     case SSS_NSS_GETLISTBYCERT:
-        ret = sss_strnlen(inp.str, 10 * 1024 , &inp_len);
+        ret = sss_strnlen(inp->str, 10 * 1024 , &inp_len);
         if (ret != EOK) {
             return EINVAL;
         }
 
-        rd.len = inp_len + 1;
-        rd.data = inp.str;
+        rd->len = inp_len + 1;
+        rd->data = inp->str;
 
         break;
     case SSS_NSS_GETSIDBYID:
     case SSS_NSS_GETSIDBYUID:
     case SSS_NSS_GETSIDBYGID:
-        rd.len = sizeof(uint32_t);
-        rd.data = &inp.id;
+        rd->len = sizeof(uint32_t);
+        rd->data = &inp->id;
 
         break;
     default:
         return EINVAL;
     }
 
-    if (timeout == NO_TIMEOUT) {
-        sss_nss_lock();
-    } else {
-        ret = sss_nss_timedlock(timeout, &time_left);
-        if (ret != 0) {
-            return ret;
-        }
-    }
-
-    /* previous thread might already initialize entry in mmap cache */
-    ret = sss_nss_mc_get(inp, cmd, out);
-    if (ret == EOK) {
-        sss_nss_unlock();
-        return 0;
-    }
+    return EOK;
+}
 
-    nret = sss_nss_make_request_timeout(cmd, &rd, time_left, &repbuf, &replen,
-                                        &errnop);
-    if (nret != NSS_STATUS_SUCCESS) {
-        ret = sss_nss_status_to_errno(nret);
-        goto done;
-    }
+static int sss_nss_parse_reply(enum sss_cli_command cmd,
+                               uint8_t *repbuf, size_t replen,
+                               struct output *out)
+{
+    int ret;
+    uint32_t num_results;
+    char *str = NULL;
+    size_t data_len;
+    uint32_t c;
+    struct sss_nss_kv *kv_list;
+    char **names;
+    enum sss_id_type *types;
 
     if (replen < 8) {
         ret = EBADMSG;
@@ -402,8 +377,6 @@ static int sss_nss_getyyybyxxx(union input inp, enum sss_cli_command cmd,
     ret = EOK;
 
 done:
-    sss_nss_unlock();
-    free(repbuf);
     if (ret != EOK) {
         free(str);
     }
@@ -411,6 +384,200 @@ done:
     return ret;
 }
 
+static int sss_nss_getyyybyxxx(union input inp, enum sss_cli_command cmd,
+                               unsigned int timeout, struct output *out)
+{
+    int ret;
+    struct sss_cli_req_data rd;
+    uint8_t *repbuf = NULL;
+    size_t replen;
+    int errnop;
+    enum nss_status nret;
+    int time_left = SSS_CLI_SOCKET_TIMEOUT;
+
+    ret = sss_nss_mc_get(inp, cmd, out);
+    if (ret == EOK) {
+        return 0;
+    }
+
+    ret = sss_nss_req_data(&inp, cmd, &rd);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (timeout == NO_TIMEOUT) {
+        sss_nss_lock();
+    } else {
+        ret = sss_nss_timedlock(timeout, &time_left);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    /* previous thread might already initialize entry in mmap cache */
+    ret = sss_nss_mc_get(inp, cmd, out);
+    if (ret == EOK) {
+        sss_nss_unlock();
+        return 0;
+    }
+
+    nret = sss_nss_make_request_timeout(cmd, &rd, time_left, &repbuf, &replen,
+                                        &errnop);
+    if (nret != NSS_STATUS_SUCCESS) {
+        ret = sss_nss_status_to_errno(nret);
+        goto done;
+    }
+
+    ret = sss_nss_parse_reply(cmd, repbuf, replen, out);
+
+done:
+    sss_nss_unlock();
+    free(repbuf);
+
+    return ret;
+}
+
+static void sss_nss_free_output(enum sss_cli_command cmd, struct output *out)
+{
+    switch(cmd) {
+    case SSS_NSS_GETSIDBYID:
+    case SSS_NSS_GETSIDBYUID:
+    case SSS_NSS_GETSIDBYGID:
+    case SSS_NSS_GETSIDBYNAME:
+    case SSS_NSS_GETSIDBYUSERNAME:
+    case SSS_NSS_GETSIDBYGROUPNAME:
+    case SSS_NSS_GETNAMEBYSID:
+    case SSS_NSS_GETNAMEBYCERT:
+        free(out->d.str);
+        break;
+    case SSS_NSS_GETLISTBYCERT:
+        sss_nss_free_list(out->d.names);
+        free(out->types);
+        break;
+    case SSS_NSS_GETORIGBYNAME:
+    case SSS_NSS_GETORIGBYUSERNAME:
+    case SSS_NSS_GETORIGBYGROUPNAME:
+        sss_nss_free_kv(out->d.kv_list);
+        break;
+    default:
+        break;
+    }
+
+    memset(out, 0, sizeof(struct output));
+}
+
+/* Batch version of sss_nss_getyyybyxxx(), the result of inps[c] is returned
+ * in outs[c] and rets[c]. Entries for which the caller already stored an
+ * error in rets[c] are skipped. Entries which are not found in the memory
+ * cache are sent to the responder in a single pipelined exchange. */
+static int sss_nss_getyyybyxxx_list(union input *inps, size_t num,
+                                    enum sss_cli_command cmd,
+                                    unsigned int timeout,
+                                    struct output *outs, int *rets)
+{
+    int ret;
+    struct sss_cli_req_data *rd = NULL;
+    struct sss_cli_rep_data *rep = NULL;
+    size_t *idx = NULL;
+    size_t pending;
+    size_t c;
+    size_t p;
+    int time_left = SSS_CLI_SOCKET_TIMEOUT;
+
+    if (num == 0) {
+        return EOK;
+    }
+
+    rd = calloc(num, sizeof(struct sss_cli_req_data));
+    rep = calloc(num, sizeof(struct sss_cli_rep_data));
+    idx = calloc(num, sizeof(size_t));
+    if (rd == NULL || rep == NULL || idx == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    pending = 0;
+    for (c = 0; c < num; c++) {
+        memset(&outs[c], 0, sizeof(struct output));
+
+        if (rets[c] != EOK) {
+            continue;
+        }
+
+        rets[c] = sss_nss_req_data(&inps[c], cmd, &rd[pending]);
+        if (rets[c] != EOK) {
+            continue;
+        }
+
+        if (sss_nss_mc_get(inps[c], cmd, &outs[c]) == EOK) {
+            continue;
+        }
+
+        idx[pending] = c;
+        pending++;
+    }
+
+    if (pending == 0) {
+        ret = EOK;
+        goto done;
+    }
+
+    if (timeout == NO_TIMEOUT) {
+        sss_nss_lock();
+    } else {
+        ret = sss_nss_timedlock(timeout, &time_left);
+        if (ret != 0) {
+            /* The caller does not read the results if the whole call
+             * fails, release the entries found in the memory cache */
+            for (c = 0; c < num; c++) {
+                if (rets[c] == EOK) {
+                    sss_nss_free_output(cmd, &outs[c]);
+                    rets[c] = ret;
+                }
+            }
+            goto done;
+        }
+    }
+
+    /* previous thread might already initialize entries in mmap cache */
+    for (c = 0, p = 0; c < pending; c++) {
+        rets[idx[c]] = sss_nss_mc_get(inps[idx[c]], cmd, &outs[idx[c]]);
+        if (rets[idx[c]] != EOK) {
+            rd[p] = rd[c];
+            idx[p] = idx[c];
+            p++;
+        }
+    }
+    pending = p;
+
+    if (pending > 0) {
+        sss_nss_make_request_pipelined(cmd, rd, pending, time_left, rep);
+    }
+
+    sss_nss_unlock();
+
+    for (p = 0; p < pending; p++) {
+        c = idx[p];
+
+        if (rep[p].status != NSS_STATUS_SUCCESS) {
+            rets[c] = sss_nss_status_to_errno(rep[p].status);
+        } else {
+            rets[c] = sss_nss_parse_reply(cmd, rep[p].buf, rep[p].len,
+                                          &outs[c]);
+        }
+        free(rep[p].buf);
+    }
+
+    ret = EOK;
+
+done:
+    free(rd);
+    free(rep);
+    free(idx);
+
+    return ret;
+}
+
 static int _sss_nss_getsidbyxxxname_timeout(enum sss_cli_command cmd,
                                             const char *fq_name,
                                             unsigned int timeout,
@@ -745,3 +912,190 @@ int sss_nss_getlistbycert(const char *cert, char ***fq_name,
 {
     return sss_nss_getlistbycert_timeout(cert, NO_TIMEOUT, fq_name, type);
 }
+
+static int sss_nss_getxxx_list(enum sss_cli_command cmd,
+                               const char * const *strs, const uint32_t *ids,
+                               size_t num, unsigned int timeout,
+                               char **str_results, uint32_t *id_results,
+                               enum sss_id_type *types, int *rets)
+{
+    int ret;
+    union input *inps = NULL;
+    struct output *outs = NULL;
+    size_t c;
+
+    if ((strs == NULL && ids == NULL)
+            || (str_results == NULL && id_results == NULL)
+            || types == NULL || rets == NULL) {
+        return EINVAL;
+    }
+
+    if (num == 0) {
+        return EOK;
+    }
+
+    inps = calloc(num, sizeof(union input));
+    outs = calloc(num, sizeof(struct output));
+    if (inps == NULL || outs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (c = 0; c < num; c++) {
+        rets[c] = EOK;
+        if (strs != NULL) {
+            inps[c].str = strs[c];
+            /* an empty name or SID can never match, do not send it */
+            if (strs[c] == NULL || *strs[c] == '\0') {
+                rets[c] = EINVAL;
+            }
+        } else {
+            inps[c].id = ids[c];
+        }
+    }
+
+    ret = sss_nss_getyyybyxxx_list(inps, num, cmd, timeout, outs, rets);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    for (c = 0; c < num; c++) {
+        if (str_results != NULL) {
+            str_results[c] = (rets[c] == EOK) ? outs[c].d.str : NULL;
+        } else {
+            id_results[c] = (rets[c] == EOK) ? outs[c].d.id : 0;
+        }
+        types[c] = (rets[c] == EOK) ? outs[c].type : SSS_ID_TYPE_NOT_SPECIFIED;
+    }
+
+done:
+    free(inps);
+    free(outs);
+
+    return ret;
+}
+
+int sss_nss_getsidbyname_list_timeout(const char * const *fq_names, size_t num,
+                                      unsigned int timeout, char **sids,
+                                      enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYNAME, fq_names, NULL, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbyname_list(const char * const *fq_names, size_t num,
+                              char **sids, enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getsidbyname_list_timeout(fq_names, num, NO_TIMEOUT,
+                                             sids, types, rets);
+}
+
+int sss_nss_getsidbyusername_list_timeout(const char * const *fq_names,
+                                          size_t num, unsigned int timeout,
+                                          char **sids, enum sss_id_type *types,
+                                          int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYUSERNAME, fq_names, NULL, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbyusername_list(const char * const *fq_names, size_t num,
+                                  char **sids, enum sss_id_type *types,
+                                  int *rets)
+{
+    return sss_nss_getsidbyusername_list_timeout(fq_names, num, NO_TIMEOUT,
+                                                 sids, types, rets);
+}
+
+int sss_nss_getsidbygroupname_list_timeout(const char * const *fq_names,
+                                           size_t num, unsigned int timeout,
+                                           char **sids, enum sss_id_type *types,
+                                           int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYGROUPNAME, fq_names, NULL, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbygroupname_list(const char * const *fq_names, size_t num,
+                                   char **sids, enum sss_id_type *types,
+                                   int *rets)
+{
+    return sss_nss_getsidbygroupname_list_timeout(fq_names, num, NO_TIMEOUT,
+                                                  sids, types, rets);
+}
+
+int sss_nss_getsidbyid_list_timeout(const uint32_t *ids, size_t num,
+                                    unsigned int timeout, char **sids,
+                                    enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYID, NULL, ids, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbyid_list(const uint32_t *ids, size_t num,
+                            char **sids, enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getsidbyid_list_timeout(ids, num, NO_TIMEOUT,
+                                           sids, types, rets);
+}
+
+int sss_nss_getsidbyuid_list_timeout(const uint32_t *uids, size_t num,
+                                     unsigned int timeout, char **sids,
+                                     enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYUID, NULL, uids, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbyuid_list(const uint32_t *uids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getsidbyuid_list_timeout(uids, num, NO_TIMEOUT,
+                                            sids, types, rets);
+}
+
+int sss_nss_getsidbygid_list_timeout(const uint32_t *gids, size_t num,
+                                     unsigned int timeout, char **sids,
+                                     enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETSIDBYGID, NULL, gids, num,
+                               timeout, sids, NULL, types, rets);
+}
+
+int sss_nss_getsidbygid_list(const uint32_t *gids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getsidbygid_list_timeout(gids, num, NO_TIMEOUT,
+                                            sids, types, rets);
+}
+
+int sss_nss_getnamebysid_list_timeout(const char * const *sids, size_t num,
+                                      unsigned int timeout, char **fq_names,
+                                      enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETNAMEBYSID, sids, NULL, num,
+                               timeout, fq_names, NULL, types, rets);
+}
+
+int sss_nss_getnamebysid_list(const char * const *sids, size_t num,
+                              char **fq_names, enum sss_id_type *types,
+                              int *rets)
+{
+    return sss_nss_getnamebysid_list_timeout(sids, num, NO_TIMEOUT,
+                                             fq_names, types, rets);
+}
+
+int sss_nss_getidbysid_list_timeout(const char * const *sids, size_t num,
+                                    unsigned int timeout, uint32_t *ids,
+                                    enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getxxx_list(SSS_NSS_GETIDBYSID, sids, NULL, num,
+                               timeout, NULL, ids, types, rets);
+}
+
+int sss_nss_getidbysid_list(const char * const *sids, size_t num,
+                            uint32_t *ids, enum sss_id_type *types, int *rets)
+{
+    return sss_nss_getidbysid_list_timeout(sids, num, NO_TIMEOUT,
+                                           ids, types, rets);
+}
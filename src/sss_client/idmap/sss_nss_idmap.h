@@ -254,6 +254,146 @@ int sss_nss_getnamebycert(const char *cert, char **fq_name,
 int sss_nss_getlistbycert(const char *cert, char ***fq_name,
                           enum sss_id_type **type);
 
+/**
+ * @brief Find SIDs for a list of fully qualified names
+ *
+ * All lookups which cannot be answered from the memory cache are sent to
+ * SSSD over a single connection without waiting for the individual replies,
+ * which is considerably faster than calling sss_nss_getsidbyname() in a loop.
+ *
+ * @param[in] fq_names Array of fully qualified names of users or groups
+ * @param[in] num      Number of elements in fq_names
+ * @param[out] sids    Array of num elements, sids[i] contains the SID of
+ *                     fq_names[i] if rets[i] is 0, otherwise NULL. Each SID
+ *                     must be freed by the caller
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup,
+ *                     see #sss_nss_getsidbyname for the possible values
+ *
+ * @return
+ *  - 0 (EOK): all lookups were processed, check rets for the results
+ *  - EINVAL: invalid arguments
+ *  - ENOMEM: memory allocation failed
+ */
+int sss_nss_getsidbyname_list(const char * const *fq_names, size_t num,
+                              char **sids, enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of fully qualified user names
+ *
+ * @param[in] fq_names Array of fully qualified names of users
+ * @param[in] num      Number of elements in fq_names
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getsidbyusername_list(const char * const *fq_names, size_t num,
+                                  char **sids, enum sss_id_type *types,
+                                  int *rets);
+
+/**
+ * @brief Find SIDs for a list of fully qualified group names
+ *
+ * @param[in] fq_names Array of fully qualified names of groups
+ * @param[in] num      Number of elements in fq_names
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getsidbygroupname_list(const char * const *fq_names, size_t num,
+                                   char **sids, enum sss_id_type *types,
+                                   int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX UIDs or GIDs
+ *
+ * @param[in] ids      Array of POSIX UIDs or GIDs
+ * @param[in] num      Number of elements in ids
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getsidbyid_list(const uint32_t *ids, size_t num,
+                            char **sids, enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX UIDs
+ *
+ * @param[in] uids     Array of POSIX UIDs
+ * @param[in] num      Number of elements in uids
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getsidbyuid_list(const uint32_t *uids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX GIDs
+ *
+ * @param[in] gids     Array of POSIX GIDs
+ * @param[in] num      Number of elements in gids
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getsidbygid_list(const uint32_t *gids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Return the fully qualified names for a list of SIDs
+ *
+ * @param[in] sids      Array of string representations of SIDs
+ * @param[in] num       Number of elements in sids
+ * @param[out] fq_names Array of num elements, fq_names[i] contains the name
+ *                      of the object with SID sids[i] if rets[i] is 0,
+ *                      otherwise NULL. Each name must be freed by the caller
+ * @param[out] types    Array of num elements with the types of the objects
+ * @param[out] rets     Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getnamebysid_list(const char * const *sids, size_t num,
+                              char **fq_names, enum sss_id_type *types,
+                              int *rets);
+
+/**
+ * @brief Return the POSIX IDs for a list of SIDs
+ *
+ * @param[in] sids     Array of string representations of SIDs
+ * @param[in] num      Number of elements in sids
+ * @param[out] ids     Array of num elements, ids[i] contains the POSIX ID
+ *                     of the object with SID sids[i] if rets[i] is 0
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list
+ */
+int sss_nss_getidbysid_list(const char * const *sids, size_t num,
+                            uint32_t *ids, enum sss_id_type *types, int *rets);
+
 /**
  * @brief Free key-value list returned by sss_nss_getorigbyXYZ()
  *
@@ -640,5 +780,99 @@ int sss_nss_getnamebycert_timeout(const char *cert, unsigned int timeout,
 int sss_nss_getlistbycert_timeout(const char *cert, unsigned int timeout,
                                   char ***fq_name, enum sss_id_type **type);
 
+/**
+ * @brief Find SIDs for a list of fully qualified names with timeout
+ *
+ * @param[in] fq_names Array of fully qualified names of users or groups
+ * @param[in] num      Number of elements in fq_names
+ * @param[in] timeout  timeout in milliseconds
+ * @param[out] sids    Array of num elements with the SIDs, see
+ *                     #sss_nss_getsidbyname_list
+ * @param[out] types   Array of num elements with the types of the objects
+ * @param[out] rets    Array of num elements with the result of each lookup,
+ *                     see #sss_nss_getsidbyname_timeout
+ *
+ * @return
+ *  - 0 (EOK): all lookups were processed, check rets for the results
+ *  - EINVAL: invalid arguments
+ *  - ENOMEM: memory allocation failed
+ *  - ETIMEDOUT: request timed out but was not send to SSSD
+ */
+int sss_nss_getsidbyname_list_timeout(const char * const *fq_names, size_t num,
+                                      unsigned int timeout, char **sids,
+                                      enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of fully qualified user names with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getsidbyusername_list_timeout(const char * const *fq_names,
+                                          size_t num, unsigned int timeout,
+                                          char **sids, enum sss_id_type *types,
+                                          int *rets);
+
+/**
+ * @brief Find SIDs for a list of fully qualified group names with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getsidbygroupname_list_timeout(const char * const *fq_names,
+                                           size_t num, unsigned int timeout,
+                                           char **sids, enum sss_id_type *types,
+                                           int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX UIDs or GIDs with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getsidbyid_list_timeout(const uint32_t *ids, size_t num,
+                                    unsigned int timeout, char **sids,
+                                    enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX UIDs with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getsidbyuid_list_timeout(const uint32_t *uids, size_t num,
+                                     unsigned int timeout, char **sids,
+                                     enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Find SIDs for a list of POSIX GIDs with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getsidbygid_list_timeout(const uint32_t *gids, size_t num,
+                                     unsigned int timeout, char **sids,
+                                     enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Return the fully qualified names for a list of SIDs with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getnamebysid_list_timeout(const char * const *sids, size_t num,
+                                      unsigned int timeout, char **fq_names,
+                                      enum sss_id_type *types, int *rets);
+
+/**
+ * @brief Return the POSIX IDs for a list of SIDs with timeout
+ *
+ * @return
+ *  - see #sss_nss_getsidbyname_list_timeout
+ */
+int sss_nss_getidbysid_list_timeout(const char * const *sids, size_t num,
+                                    unsigned int timeout, uint32_t *ids,
+                                    enum sss_id_type *types, int *rets);
+
 #endif /* IPA_389DS_PLUGIN_HELPER_CALLS */
 #endif /* SSS_NSS_IDMAP_H_ */
@@ -134,6 +134,11 @@ int pack_message_v3(struct pam_items *pi, size_t *size, uint8_t **buffer)
         len += 3*sizeof(uint32_t);
     }
 
+    /* optional transaction_token */
+    if (pi->transaction_token != 0) {
+        len += 3*sizeof(uint32_t);
+    }
+
     buf = malloc(len);
     if (buf == NULL) {
         D(("malloc failed."));
@@ -179,6 +184,11 @@ int pack_message_v3(struct pam_items *pi, size_t *size, uint8_t **buffer)
     rp += add_uint32_t_item(SSS_PAM_ITEM_FLAGS, (uint32_t) pi->flags,
                             &buf[rp]);
 
+    if (pi->transaction_token != 0) {
+        rp += add_uint32_t_item(SSS_PAM_ITEM_TRANSACTION_TOKEN,
+                                pi->transaction_token, &buf[rp]);
+    }
+
     SAFEALIGN_SETMEM_UINT32(buf + rp, SSS_END_OF_PAM_REQUEST, &rp);
 
     if (rp != len) {
@@ -53,6 +53,7 @@ struct pam_items {
     pid_t cli_pid;
     pid_t child_pid;
     uint32_t flags;
+    uint32_t transaction_token;
     const char *login_name;
     char *domain_name;
     const char *requested_domains;
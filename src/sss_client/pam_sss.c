@@ -60,6 +60,7 @@
 #define PAM_SSS_AUTHOK_TYPE "pam_sss:authtok_type"
 #define PAM_SSS_AUTHOK_SIZE "pam_sss:authtok_size"
 #define PAM_SSS_AUTHOK_DATA "pam_sss:authtok_data"
+#define PAM_SSS_TRANSACTION_TOKEN "pam_sss:transaction_token"
 
 #define PW_RESET_MSG_FILENAME_TEMPLATE SSSD_CONF_DIR"/customize/%s/pam_sss_pw_reset_message.%s"
 #define PW_RESET_MSG_MAX_SIZE 4096
@@ -111,6 +112,35 @@ static void free_exp_data(pam_handle_t *pamh, void *ptr, int err)
     free(ptr);
 }
 
+static void free_transaction_token(pam_handle_t *pamh, void *ptr, int err)
+{
+    free(ptr);
+}
+
+static void save_transaction_token(pam_handle_t *pamh, struct pam_items *pi,
+                                   uint8_t *buf)
+{
+    uint32_t *token;
+    int ret;
+
+    token = malloc(sizeof(uint32_t));
+    if (token == NULL) {
+        D(("malloc failed."));
+        return;
+    }
+    memcpy(token, buf, sizeof(uint32_t));
+
+    ret = pam_set_data(pamh, PAM_SSS_TRANSACTION_TOKEN, token,
+                       free_transaction_token);
+    if (ret != PAM_SUCCESS) {
+        D(("pam_set_data failed."));
+        free(token);
+        return;
+    }
+
+    pi->transaction_token = *token;
+}
+
 static void close_fd(pam_handle_t *pamh, void *ptr, int err)
 {
 #ifdef PAM_DATA_REPLACE
@@ -1264,6 +1294,13 @@ static int eval_response(pam_handle_t *pamh, size_t buflen, uint8_t *buf,
             case SSS_CHILD_KEEP_ALIVE:
                 memcpy(&pi->child_pid, &buf[p], len);
                 break;
+            case SSS_PAM_TRANSACTION_TOKEN:
+                if (len != sizeof(uint32_t)) {
+                    D(("Transaction token has unexpected size."));
+                    break;
+                }
+                save_transaction_token(pamh, pi, &buf[p]);
+                break;
             case SSS_PAM_OAUTH2_INFO:
                 if (buf[p + (len - 1)] != '\0') {
                     D(("oauth2 info does not end with \\0."));
@@ -1382,6 +1419,7 @@ static int get_pam_items(pam_handle_t *pamh, uint32_t flags,
                          struct pam_items *pi)
 {
     int ret;
+    const uint32_t *transaction_token = NULL;
 
     pi->pam_authtok_type = SSS_AUTHTOK_TYPE_EMPTY;
     pi->pam_authtok = NULL;
@@ -1463,7 +1501,15 @@ static int get_pam_items(pam_handle_t *pamh, uint32_t flags,
 
     pi->pc = NULL;
 
-    pi->flags = flags;
+    /* Reuse the user resolved by an earlier step of this PAM transaction */
+    pi->transaction_token = 0;
+    ret = pam_get_data(pamh, PAM_SSS_TRANSACTION_TOKEN,
+                       (const void **) &transaction_token);
+    if (ret == PAM_SUCCESS && transaction_token != NULL) {
+        pi->transaction_token = *transaction_token;
+    }
+
+    pi->flags = flags | PAM_CLI_FLAGS_TRANSACTION;
 
     return PAM_SUCCESS;
 }
@@ -1487,6 +1533,7 @@ static void print_pam_items(struct pam_items *pi)
     D(("Child_PID: %d", pi->child_pid));
     D(("Requested domains: %s", pi->requested_domains));
     D(("Flags: %d", pi->flags));
+    D(("Transaction token: %u", pi->transaction_token));
 }
 
 static int send_and_receive(pam_handle_t *pamh, struct pam_items *pi,
@@ -3004,7 +3051,7 @@ static int pam_sss(enum sss_cli_command task, pam_handle_t *pamh,
                     pam_status = send_and_receive(pamh, &pi, SSS_PAM_PREAUTH,
                                                   quiet_mode);
 
-                    pi.flags = flags;
+                    pi.flags = flags | (pi.flags & PAM_CLI_FLAGS_TRANSACTION);
                     if (pam_status != PAM_SUCCESS) {
                         D(("send_and_receive returned [%d] during pre-auth",
                            pam_status));
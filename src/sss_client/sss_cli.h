@@ -413,6 +413,7 @@ enum pam_item_type {
     SSS_PAM_ITEM_CHILD_PID,
     SSS_PAM_ITEM_REQUESTED_DOMAINS,
     SSS_PAM_ITEM_FLAGS,
+    SSS_PAM_ITEM_TRANSACTION_TOKEN,
 };
 
 #define PAM_CLI_FLAGS_USE_FIRST_PASS (1 << 0)
@@ -425,6 +426,7 @@ enum pam_item_type {
 #define PAM_CLI_FLAGS_PROMPT_ALWAYS (1 << 7)
 #define PAM_CLI_FLAGS_TRY_CERT_AUTH (1 << 8)
 #define PAM_CLI_FLAGS_REQUIRE_CERT_AUTH (1 << 9)
+#define PAM_CLI_FLAGS_TRANSACTION (1 << 10)
 
 #define SSS_NSS_MAX_ENTRIES 256
 #define SSS_NSS_HEADER_SIZE (sizeof(uint32_t) * 4)
@@ -433,6 +435,14 @@ struct sss_cli_req_data {
     const void *data;
 };
 
+/* reply of a single request sent with sss_nss_make_request_pipelined() */
+struct sss_cli_rep_data {
+    enum nss_status status;
+    int errnop;
+    uint8_t *buf;
+    size_t len;
+};
+
 /* this is in milliseconds, wait up to 300 seconds */
 #define SSS_CLI_SOCKET_TIMEOUT 300000
 
@@ -554,6 +564,12 @@ enum response_type {
                                *   - user verification (string)
                                *   - key (string)
                                */
+    SSS_PAM_TRANSACTION_TOKEN, /**< Token identifying the resolved user for
+                                * the following requests of the same PAM
+                                * transaction. It should be sent back with
+                                * #SSS_PAM_ITEM_TRANSACTION_TOKEN to avoid
+                                * repeated user lookups.
+                                * @param Token as uint32_t */
 };
 
 /**
@@ -727,6 +743,16 @@ enum nss_status sss_nss_make_request_timeout(enum sss_cli_command cmd,
                                              uint8_t **repbuf, size_t *replen,
                                              int *errnop);
 
+/* Sends all num requests over the NSS socket without waiting for each reply
+ * in turn. The result of every request is stored in the matching element of
+ * rep, buffers must be freed by the caller. The return value only reports
+ * whether the responder could be reached at all. */
+enum nss_status sss_nss_make_request_pipelined(enum sss_cli_command cmd,
+                                               struct sss_cli_req_data *rd,
+                                               size_t num,
+                                               int timeout,
+                                               struct sss_cli_rep_data *rep);
+
 int sss_pam_make_request(enum sss_cli_command cmd,
                          struct sss_cli_req_data *rd,
                          uint8_t **repbuf, size_t *replen,
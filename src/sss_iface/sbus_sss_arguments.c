@@ -56,6 +56,134 @@ errno_t _sbus_sss_invoker_write_as
     return EOK;
 }
 
+errno_t _sbus_sss_invoker_read_asatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatat *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_as(mem_ctx, iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_asatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatat *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_as(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_read_asatatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatat *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_as(mem_ctx, iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_at(mem_ctx, iter, &args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_asatatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatat *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_as(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg2);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg3);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_at(iter, args->arg4);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
 errno_t _sbus_sss_invoker_read_b
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
@@ -602,6 +730,45 @@ errno_t _sbus_sss_invoker_write_usu
     return EOK;
 }
 
+errno_t _sbus_sss_invoker_read_uu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_read_u(iter, &args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_read_u(iter, &args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
+errno_t _sbus_sss_invoker_write_uu
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uu *args)
+{
+    errno_t ret;
+
+    ret = sbus_iterator_write_u(iter, args->arg0);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    ret = sbus_iterator_write_u(iter, args->arg1);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    return EOK;
+}
+
 errno_t _sbus_sss_invoker_read_uusssu
    (TALLOC_CTX *mem_ctx,
     DBusMessageIter *iter,
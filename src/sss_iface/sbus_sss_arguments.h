@@ -43,6 +43,43 @@ _sbus_sss_invoker_write_as
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_as *args);
 
+struct _sbus_sss_invoker_args_asatatat {
+    const char ** arg0;
+    uint64_t * arg1;
+    uint64_t * arg2;
+    uint64_t * arg3;
+};
+
+errno_t
+_sbus_sss_invoker_read_asatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatat *args);
+
+errno_t
+_sbus_sss_invoker_write_asatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatat *args);
+
+struct _sbus_sss_invoker_args_asatatatat {
+    const char ** arg0;
+    uint64_t * arg1;
+    uint64_t * arg2;
+    uint64_t * arg3;
+    uint64_t * arg4;
+};
+
+errno_t
+_sbus_sss_invoker_read_asatatatat
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatat *args);
+
+errno_t
+_sbus_sss_invoker_write_asatatatat
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_asatatatat *args);
+
 struct _sbus_sss_invoker_args_b {
     bool arg0;
 };
@@ -267,6 +304,22 @@ _sbus_sss_invoker_write_usu
    (DBusMessageIter *iter,
     struct _sbus_sss_invoker_args_usu *args);
 
+struct _sbus_sss_invoker_args_uu {
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+errno_t
+_sbus_sss_invoker_read_uu
+   (TALLOC_CTX *mem_ctx,
+    DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uu *args);
+
+errno_t
+_sbus_sss_invoker_write_uu
+   (DBusMessageIter *iter,
+    struct _sbus_sss_invoker_args_uu *args);
+
 struct _sbus_sss_invoker_args_uusssu {
     uint32_t arg0;
     uint32_t arg1;
@@ -2322,6 +2322,24 @@ sbus_emit_signal_s
                           path, iface, signal_name, &args);
 }
 
+static void
+sbus_emit_signal_ss
+    (struct sbus_connection *conn,
+     const char *path,
+     const char *iface,
+     const char *signal_name,
+     const char * arg0,
+     const char * arg1)
+{
+    struct _sbus_sss_invoker_args_ss args;
+
+    args.arg0 = arg0;
+    args.arg1 = arg1;
+
+    sbus_call_signal_send(conn, NULL, (sbus_invoker_writer_fn)_sbus_sss_invoker_write_ss,
+                          path, iface, signal_name, &args);
+}
+
 static void
 sbus_emit_signal_u
     (struct sbus_connection *conn,
@@ -2412,3 +2430,24 @@ sbus_emit_nss_memcache_InvalidateGroupById
     sbus_emit_signal_u(conn, object_path,
         "sssd.nss.MemoryCache", "InvalidateGroupById", arg_gid);
 }
+
+void
+sbus_emit_nss_memcache_InvalidateInitgroupsByName
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_name,
+     const char * arg_domain)
+{
+    sbus_emit_signal_ss(conn, object_path,
+        "sssd.nss.MemoryCache", "InvalidateInitgroupsByName", arg_name, arg_domain);
+}
+
+void
+sbus_emit_nss_memcache_InvalidateUserById
+    (struct sbus_connection *conn,
+     const char *object_path,
+     uint32_t arg_uid)
+{
+    sbus_emit_signal_u(conn, object_path,
+        "sssd.nss.MemoryCache", "InvalidateUserById", arg_uid);
+}
@@ -449,4 +449,17 @@ sbus_emit_nss_memcache_InvalidateGroupById
      const char *object_path,
      uint32_t arg_gid);
 
+void
+sbus_emit_nss_memcache_InvalidateInitgroupsByName
+    (struct sbus_connection *conn,
+     const char *object_path,
+     const char * arg_name,
+     const char * arg_domain);
+
+void
+sbus_emit_nss_memcache_InvalidateUserById
+    (struct sbus_connection *conn,
+     const char *object_path,
+     uint32_t arg_uid);
+
 #endif /* _SBUS_SSS_CLIENT_ASYNC_H_ */
@@ -86,6 +86,169 @@ done:
     return ret;
 }
 
+static errno_t
+sbus_method_in_u_out_asatatat
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint32_t arg0,
+     const char *** _arg0,
+     uint64_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_u in;
+    struct _sbus_sss_invoker_args_asatatat *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_asatatat);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    in.arg0 = arg0;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_sss_invoker_write_u,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_asatatat, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = talloc_steal(mem_ctx, out->arg0);
+    *_arg1 = talloc_steal(mem_ctx, out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, out->arg3);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in_u_out_asatatatat
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint32_t arg0,
+     const char *** _arg0,
+     uint64_t ** _arg1,
+     uint64_t ** _arg2,
+     uint64_t ** _arg3,
+     uint64_t ** _arg4)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_u in;
+    struct _sbus_sss_invoker_args_asatatatat *out;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    out = talloc_zero(tmp_ctx, struct _sbus_sss_invoker_args_asatatatat);
+    if (out == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for output parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    in.arg0 = arg0;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_sss_invoker_write_u,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_read_output(out, reply, (sbus_invoker_reader_fn)_sbus_sss_invoker_read_asatatatat, out);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    *_arg0 = talloc_steal(mem_ctx, out->arg0);
+    *_arg1 = talloc_steal(mem_ctx, out->arg1);
+    *_arg2 = talloc_steal(mem_ctx, out->arg2);
+    *_arg3 = talloc_steal(mem_ctx, out->arg3);
+    *_arg4 = talloc_steal(mem_ctx, out->arg4);
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
+static errno_t
+sbus_method_in_uu_out_
+    (struct sbus_sync_connection *conn,
+     const char *bus,
+     const char *path,
+     const char *iface,
+     const char *method,
+     uint32_t arg0,
+     uint32_t arg1)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct _sbus_sss_invoker_args_uu in;
+    DBusMessage *reply;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    if (tmp_ctx == NULL) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Out of memory!\n");
+        return ENOMEM;
+    }
+
+    in.arg0 = arg0;
+    in.arg1 = arg1;
+
+    ret = sbus_sync_call_method(tmp_ctx, conn, NULL,
+                                (sbus_invoker_writer_fn)_sbus_sss_invoker_write_uu,
+                                bus, path, iface, method, &in, &reply);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = EOK;
+
+done:
+    talloc_free(tmp_ctx);
+
+    return ret;
+}
+
 errno_t
 sbus_call_systemd_RestartUnit
     (TALLOC_CTX *mem_ctx,
@@ -131,6 +294,60 @@ sbus_call_systemd_StopUnit
           _arg_job);
 }
 
+errno_t
+sbus_call_service_loopStats
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_max_entries,
+     const char *** _arg_names,
+     uint64_t ** _arg_counts,
+     uint64_t ** _arg_total_usec,
+     uint64_t ** _arg_max_usec,
+     uint64_t ** _arg_histogram)
+{
+     return sbus_method_in_u_out_asatatatat(mem_ctx, conn,
+          busname, object_path, "sssd.service", "loopStats", arg_max_entries,
+          _arg_names,
+          _arg_counts,
+          _arg_total_usec,
+          _arg_max_usec,
+          _arg_histogram);
+}
+
+errno_t
+sbus_call_service_tallocReport
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_max_entries,
+     const char *** _arg_names,
+     uint64_t ** _arg_blocks,
+     uint64_t ** _arg_bytes,
+     uint64_t ** _arg_total_bytes)
+{
+     return sbus_method_in_u_out_asatatat(mem_ctx, conn,
+          busname, object_path, "sssd.service", "tallocReport", arg_max_entries,
+          _arg_names,
+          _arg_blocks,
+          _arg_bytes,
+          _arg_total_bytes);
+}
+
+errno_t
+sbus_call_service_tallocSampling
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_interval,
+     uint32_t arg_max_entries)
+{
+     return sbus_method_in_uu_out_(conn,
+          busname, object_path, "sssd.service", "tallocSampling", arg_interval, arg_max_entries);
+}
+
 static errno_t
 sbus_get_u
     (struct sbus_sync_connection *conn,
@@ -58,6 +58,39 @@ sbus_call_systemd_StopUnit
      const char * arg_mode,
      const char ** _arg_job);
 
+errno_t
+sbus_call_service_loopStats
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_max_entries,
+     const char *** _arg_names,
+     uint64_t ** _arg_counts,
+     uint64_t ** _arg_total_usec,
+     uint64_t ** _arg_max_usec,
+     uint64_t ** _arg_histogram);
+
+errno_t
+sbus_call_service_tallocReport
+    (TALLOC_CTX *mem_ctx,
+     struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_max_entries,
+     const char *** _arg_names,
+     uint64_t ** _arg_blocks,
+     uint64_t ** _arg_bytes,
+     uint64_t ** _arg_total_bytes);
+
+errno_t
+sbus_call_service_tallocSampling
+    (struct sbus_sync_connection *conn,
+     const char *busname,
+     const char *object_path,
+     uint32_t arg_interval,
+     uint32_t arg_max_entries);
+
 errno_t
 sbus_get_service_debug_level
     (struct sbus_sync_connection *conn,
@@ -801,6 +801,54 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Signal: sssd.nss.MemoryCache.InvalidateInitgroupsByName */
+#define SBUS_SIGNAL_EMITS_sssd_nss_MemoryCache_InvalidateInitgroupsByName() ({ \
+    sbus_signal("InvalidateInitgroupsByName", \
+        _sbus_sss_args_sssd_nss_MemoryCache_InvalidateInitgroupsByName, \
+        NULL); \
+})
+
+#define SBUS_SIGNAL_SYNC_sssd_nss_MemoryCache_InvalidateInitgroupsByName(path, handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), const char *, const char *); \
+    sbus_listener_sync("sssd.nss.MemoryCache", "InvalidateInitgroupsByName", (path), \
+        _sbus_sss_invoke_in_ss_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_SIGNAL_ASYNC_sssd_nss_MemoryCache_InvalidateInitgroupsByName(path, handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), const char *, const char *); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_listener_async("sssd.nss.MemoryCache", "InvalidateInitgroupsByName", (path), \
+        _sbus_sss_invoke_in_ss_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Signal: sssd.nss.MemoryCache.InvalidateUserById */
+#define SBUS_SIGNAL_EMITS_sssd_nss_MemoryCache_InvalidateUserById() ({ \
+    sbus_signal("InvalidateUserById", \
+        _sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById, \
+        NULL); \
+})
+
+#define SBUS_SIGNAL_SYNC_sssd_nss_MemoryCache_InvalidateUserById(path, handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t); \
+    sbus_listener_sync("sssd.nss.MemoryCache", "InvalidateUserById", (path), \
+        _sbus_sss_invoke_in_u_out__send, \
+        _sbus_sss_key_u_0, \
+        (handler), (data)); \
+})
+
+#define SBUS_SIGNAL_ASYNC_sssd_nss_MemoryCache_InvalidateUserById(path, handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_listener_async("sssd.nss.MemoryCache", "InvalidateUserById", (path), \
+        _sbus_sss_invoke_in_u_out__send, \
+        _sbus_sss_key_u_0, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Interface: sssd.service */
 #define SBUS_IFACE_sssd_service(methods, signals, properties) ({ \
     sbus_interface("sssd.service", NULL, \
@@ -895,6 +943,28 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.service.loopStats */
+#define SBUS_METHOD_SYNC_sssd_service_loopStats(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t, const char ***, uint64_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_sync("loopStats", \
+        &_sbus_sss_args_sssd_service_loopStats, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out_asatatatat_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_service_loopStats(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t); \
+    SBUS_CHECK_RECV((handler_recv), const char ***, uint64_t **, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_async("loopStats", \
+        &_sbus_sss_args_sssd_service_loopStats, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out_asatatatat_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Method: sssd.service.resetOffline */
 #define SBUS_METHOD_SYNC_sssd_service_resetOffline(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data)); \
@@ -961,6 +1031,50 @@
         (handler_send), (handler_recv), (data)); \
 })
 
+/* Method: sssd.service.tallocReport */
+#define SBUS_METHOD_SYNC_sssd_service_tallocReport(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t, const char ***, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_sync("tallocReport", \
+        &_sbus_sss_args_sssd_service_tallocReport, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out_asatatat_send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_service_tallocReport(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t); \
+    SBUS_CHECK_RECV((handler_recv), const char ***, uint64_t **, uint64_t **, uint64_t **); \
+    sbus_method_async("tallocReport", \
+        &_sbus_sss_args_sssd_service_tallocReport, \
+        NULL, \
+        _sbus_sss_invoke_in_u_out_asatatat_send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
+/* Method: sssd.service.tallocSampling */
+#define SBUS_METHOD_SYNC_sssd_service_tallocSampling(handler, data) ({ \
+    SBUS_CHECK_SYNC((handler), (data), uint32_t, uint32_t); \
+    sbus_method_sync("tallocSampling", \
+        &_sbus_sss_args_sssd_service_tallocSampling, \
+        NULL, \
+        _sbus_sss_invoke_in_uu_out__send, \
+        NULL, \
+        (handler), (data)); \
+})
+
+#define SBUS_METHOD_ASYNC_sssd_service_tallocSampling(handler_send, handler_recv, data) ({ \
+    SBUS_CHECK_SEND((handler_send), (data), uint32_t, uint32_t); \
+    SBUS_CHECK_RECV((handler_recv)); \
+    sbus_method_async("tallocSampling", \
+        &_sbus_sss_args_sssd_service_tallocSampling, \
+        NULL, \
+        _sbus_sss_invoke_in_uu_out__send, \
+        NULL, \
+        (handler_send), (handler_recv), (data)); \
+})
+
 /* Property: sssd.service.debug_level */
 #define SBUS_GETTER_SYNC_sssd_service_debug_level(handler, data) ({ \
     SBUS_CHECK_SYNC((handler), (data), uint32_t*); \
@@ -1806,6 +1806,179 @@ static void _sbus_sss_invoke_in_sqq_out_q_done(struct tevent_req *subreq)
     return;
 }
 
+struct _sbus_sss_invoke_in_ss_out__state {
+    struct _sbus_sss_invoker_args_ss *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char *);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *, const char *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_sss_invoke_in_ss_out__step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_sss_invoke_in_ss_out__done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_sss_invoke_in_ss_out__send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_sss_invoke_in_ss_out__state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_ss_out__state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_ss);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_sss_invoker_read_ss(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_ss_out__step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_sss_invoke_in_ss_out__step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_sss_invoke_in_ss_out__state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out__state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_ss_out__done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_sss_invoke_in_ss_out__done(struct tevent_req *subreq)
+{
+    struct _sbus_sss_invoke_in_ss_out__state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out__state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
 struct _sbus_sss_invoke_in_ss_out_o_state {
     struct _sbus_sss_invoker_args_ss *in;
     struct _sbus_sss_invoker_args_o out;
@@ -1823,18 +1996,371 @@ struct _sbus_sss_invoke_in_ss_out_o_state {
 };
 
 static void
-_sbus_sss_invoke_in_ss_out_o_step
+_sbus_sss_invoke_in_ss_out_o_step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_sss_invoke_in_ss_out_o_done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_sss_invoke_in_ss_out_o_send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_ss_out_o_state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_ss);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_sss_invoker_read_ss(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_ss_out_o_step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_sss_invoke_in_ss_out_o_step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out_o_state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, &state->out.arg0);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        ret = _sbus_sss_invoker_write_o(state->write_iterator, &state->out);
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_ss_out_o_done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_sss_invoke_in_ss_out_o_done(struct tevent_req *subreq)
+{
+    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out_o_state);
+
+    ret = state->handler.recv(state, subreq, &state->out.arg0);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    ret = _sbus_sss_invoker_write_o(state->write_iterator, &state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+struct _sbus_sss_invoke_in_ssau_out__state {
+    struct _sbus_sss_invoker_args_ssau *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char *, uint32_t *);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *, const char *, uint32_t *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_sss_invoke_in_ssau_out__step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_sss_invoke_in_ssau_out__done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_sss_invoke_in_ssau_out__send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_ssau_out__state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_ssau);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_sss_invoker_read_ssau(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_ssau_out__step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_sss_invoke_in_ssau_out__step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ssau_out__state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_ssau_out__done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_sss_invoke_in_ssau_out__done(struct tevent_req *subreq)
+{
+    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ssau_out__state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
+struct _sbus_sss_invoke_in_u_out__state {
+    struct _sbus_sss_invoker_args_u *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, uint32_t);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, uint32_t);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_sss_invoke_in_u_out__step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_sss_invoke_in_ss_out_o_done
+_sbus_sss_invoke_in_u_out__done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_sss_invoke_in_ss_out_o_send
+_sbus_sss_invoke_in_u_out__send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -1844,12 +2370,12 @@ _sbus_sss_invoke_in_ss_out_o_send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct _sbus_sss_invoke_in_u_out__state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_ss_out_o_state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_u_out__state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -1865,7 +2391,7 @@ _sbus_sss_invoke_in_ss_out_o_send
     state->read_iterator = read_iterator;
     state->write_iterator = write_iterator;
 
-    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_ss);
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_u);
     if (state->in == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Unable to allocate space for input parameters!\n");
@@ -1873,12 +2399,12 @@ _sbus_sss_invoke_in_ss_out_o_send
         goto done;
     }
 
-    ret = _sbus_sss_invoker_read_ss(state, read_iterator, state->in);
+    ret = _sbus_sss_invoker_read_u(state, read_iterator, state->in);
     if (ret != EOK) {
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_ss_out_o_step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_u_out__step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -1903,19 +2429,19 @@ done:
     return req;
 }
 
-static void _sbus_sss_invoke_in_ss_out_o_step
+static void _sbus_sss_invoke_in_u_out__step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct _sbus_sss_invoke_in_u_out__state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out_o_state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out__state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -1925,12 +2451,11 @@ static void _sbus_sss_invoke_in_ss_out_o_step
             goto done;
         }
 
-        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, &state->out.arg0);
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0);
         if (ret != EOK) {
             goto done;
         }
 
-        ret = _sbus_sss_invoker_write_o(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -1939,14 +2464,14 @@ static void _sbus_sss_invoke_in_ss_out_o_step
             goto done;
         }
 
-        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0);
         if (subreq == NULL) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
             ret = ENOMEM;
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_ss_out_o_done, req);
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_u_out__done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -1961,40 +2486,35 @@ done:
     }
 }
 
-static void _sbus_sss_invoke_in_ss_out_o_done(struct tevent_req *subreq)
+static void _sbus_sss_invoke_in_u_out__done(struct tevent_req *subreq)
 {
-    struct _sbus_sss_invoke_in_ss_out_o_state *state;
+    struct _sbus_sss_invoke_in_u_out__state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ss_out_o_state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out__state);
 
-    ret = state->handler.recv(state, subreq, &state->out.arg0);
+    ret = state->handler.recv(state, subreq);
     talloc_zfree(subreq);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
 
-    ret = _sbus_sss_invoker_write_o(state->write_iterator, &state->out);
-    if (ret != EOK) {
-        tevent_req_error(req, ret);
-        return;
-    }
-
     tevent_req_done(req);
     return;
 }
 
-struct _sbus_sss_invoke_in_ssau_out__state {
-    struct _sbus_sss_invoker_args_ssau *in;
+struct _sbus_sss_invoke_in_u_out_asatatat_state {
+    struct _sbus_sss_invoker_args_u *in;
+    struct _sbus_sss_invoker_args_asatatat out;
     struct {
         enum sbus_handler_type type;
         void *data;
-        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, const char *, const char *, uint32_t *);
-        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, const char *, const char *, uint32_t *);
-        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, uint32_t, const char ***, uint64_t **, uint64_t **, uint64_t **);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, uint32_t);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char ***, uint64_t **, uint64_t **, uint64_t **);
     } handler;
 
     struct sbus_request *sbus_req;
@@ -2003,18 +2523,18 @@ struct _sbus_sss_invoke_in_ssau_out__state {
 };
 
 static void
-_sbus_sss_invoke_in_ssau_out__step
+_sbus_sss_invoke_in_u_out_asatatat_step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_sss_invoke_in_ssau_out__done
+_sbus_sss_invoke_in_u_out_asatatat_done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_sss_invoke_in_ssau_out__send
+_sbus_sss_invoke_in_u_out_asatatat_send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -2024,12 +2544,12 @@ _sbus_sss_invoke_in_ssau_out__send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatat_state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_ssau_out__state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_u_out_asatatat_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -2045,7 +2565,7 @@ _sbus_sss_invoke_in_ssau_out__send
     state->read_iterator = read_iterator;
     state->write_iterator = write_iterator;
 
-    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_ssau);
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_u);
     if (state->in == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE,
               "Unable to allocate space for input parameters!\n");
@@ -2053,12 +2573,12 @@ _sbus_sss_invoke_in_ssau_out__send
         goto done;
     }
 
-    ret = _sbus_sss_invoker_read_ssau(state, read_iterator, state->in);
+    ret = _sbus_sss_invoker_read_u(state, read_iterator, state->in);
     if (ret != EOK) {
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_ssau_out__step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_u_out_asatatat_step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -2083,19 +2603,19 @@ done:
     return req;
 }
 
-static void _sbus_sss_invoke_in_ssau_out__step
+static void _sbus_sss_invoke_in_u_out_asatatat_step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatat_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ssau_out__state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out_asatatat_state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -2105,11 +2625,12 @@ static void _sbus_sss_invoke_in_ssau_out__step
             goto done;
         }
 
-        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2);
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, &state->out.arg0, &state->out.arg1, &state->out.arg2, &state->out.arg3);
         if (ret != EOK) {
             goto done;
         }
 
+        ret = _sbus_sss_invoker_write_asatatat(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -2118,14 +2639,14 @@ static void _sbus_sss_invoke_in_ssau_out__step
             goto done;
         }
 
-        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1, state->in->arg2);
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0);
         if (subreq == NULL) {
             DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
             ret = ENOMEM;
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_ssau_out__done, req);
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_u_out_asatatat_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -2140,34 +2661,41 @@ done:
     }
 }
 
-static void _sbus_sss_invoke_in_ssau_out__done(struct tevent_req *subreq)
+static void _sbus_sss_invoke_in_u_out_asatatat_done(struct tevent_req *subreq)
 {
-    struct _sbus_sss_invoke_in_ssau_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatat_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_ssau_out__state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out_asatatat_state);
 
-    ret = state->handler.recv(state, subreq);
+    ret = state->handler.recv(state, subreq, &state->out.arg0, &state->out.arg1, &state->out.arg2, &state->out.arg3);
     talloc_zfree(subreq);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
 
+    ret = _sbus_sss_invoker_write_asatatat(state->write_iterator, &state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
     tevent_req_done(req);
     return;
 }
 
-struct _sbus_sss_invoke_in_u_out__state {
+struct _sbus_sss_invoke_in_u_out_asatatatat_state {
     struct _sbus_sss_invoker_args_u *in;
+    struct _sbus_sss_invoker_args_asatatatat out;
     struct {
         enum sbus_handler_type type;
         void *data;
-        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, uint32_t);
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, uint32_t, const char ***, uint64_t **, uint64_t **, uint64_t **, uint64_t **);
         struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, uint32_t);
-        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *, const char ***, uint64_t **, uint64_t **, uint64_t **, uint64_t **);
     } handler;
 
     struct sbus_request *sbus_req;
@@ -2176,18 +2704,18 @@ struct _sbus_sss_invoke_in_u_out__state {
 };
 
 static void
-_sbus_sss_invoke_in_u_out__step
+_sbus_sss_invoke_in_u_out_asatatatat_step
     (struct tevent_context *ev,
      struct tevent_timer *te,
      struct timeval tv,
      void *private_data);
 
 static void
-_sbus_sss_invoke_in_u_out__done
+_sbus_sss_invoke_in_u_out_asatatatat_done
    (struct tevent_req *subreq);
 
 struct tevent_req *
-_sbus_sss_invoke_in_u_out__send
+_sbus_sss_invoke_in_u_out_asatatatat_send
    (TALLOC_CTX *mem_ctx,
     struct tevent_context *ev,
     struct sbus_request *sbus_req,
@@ -2197,12 +2725,12 @@ _sbus_sss_invoke_in_u_out__send
     DBusMessageIter *write_iterator,
     const char **_key)
 {
-    struct _sbus_sss_invoke_in_u_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatatat_state *state;
     struct tevent_req *req;
     const char *key;
     errno_t ret;
 
-    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_u_out__state);
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_u_out_asatatatat_state);
     if (req == NULL) {
         DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
         return NULL;
@@ -2231,7 +2759,7 @@ _sbus_sss_invoke_in_u_out__send
         goto done;
     }
 
-    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_u_out__step, req);
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_u_out_asatatatat_step, req);
     if (ret != EOK) {
         goto done;
     }
@@ -2256,19 +2784,19 @@ done:
     return req;
 }
 
-static void _sbus_sss_invoke_in_u_out__step
+static void _sbus_sss_invoke_in_u_out_asatatatat_step
    (struct tevent_context *ev,
     struct tevent_timer *te,
     struct timeval tv,
     void *private_data)
 {
-    struct _sbus_sss_invoke_in_u_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatatat_state *state;
     struct tevent_req *subreq;
     struct tevent_req *req;
     errno_t ret;
 
     req = talloc_get_type(private_data, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out__state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out_asatatatat_state);
 
     switch (state->handler.type) {
     case SBUS_HANDLER_SYNC:
@@ -2278,11 +2806,12 @@ static void _sbus_sss_invoke_in_u_out__step
             goto done;
         }
 
-        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0);
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, &state->out.arg0, &state->out.arg1, &state->out.arg2, &state->out.arg3, &state->out.arg4);
         if (ret != EOK) {
             goto done;
         }
 
+        ret = _sbus_sss_invoker_write_asatatatat(state->write_iterator, &state->out);
         goto done;
     case SBUS_HANDLER_ASYNC:
         if (state->handler.send == NULL || state->handler.recv == NULL) {
@@ -2298,7 +2827,7 @@ static void _sbus_sss_invoke_in_u_out__step
             goto done;
         }
 
-        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_u_out__done, req);
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_u_out_asatatatat_done, req);
         ret = EAGAIN;
         goto done;
     }
@@ -2313,22 +2842,28 @@ done:
     }
 }
 
-static void _sbus_sss_invoke_in_u_out__done(struct tevent_req *subreq)
+static void _sbus_sss_invoke_in_u_out_asatatatat_done(struct tevent_req *subreq)
 {
-    struct _sbus_sss_invoke_in_u_out__state *state;
+    struct _sbus_sss_invoke_in_u_out_asatatatat_state *state;
     struct tevent_req *req;
     errno_t ret;
 
     req = tevent_req_callback_data(subreq, struct tevent_req);
-    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out__state);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_u_out_asatatatat_state);
 
-    ret = state->handler.recv(state, subreq);
+    ret = state->handler.recv(state, subreq, &state->out.arg0, &state->out.arg1, &state->out.arg2, &state->out.arg3, &state->out.arg4);
     talloc_zfree(subreq);
     if (ret != EOK) {
         tevent_req_error(req, ret);
         return;
     }
 
+    ret = _sbus_sss_invoker_write_asatatatat(state->write_iterator, &state->out);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
     tevent_req_done(req);
     return;
 }
@@ -3033,6 +3568,179 @@ static void _sbus_sss_invoke_in_usu_out__done(struct tevent_req *subreq)
     return;
 }
 
+struct _sbus_sss_invoke_in_uu_out__state {
+    struct _sbus_sss_invoker_args_uu *in;
+    struct {
+        enum sbus_handler_type type;
+        void *data;
+        errno_t (*sync)(TALLOC_CTX *, struct sbus_request *, void *, uint32_t, uint32_t);
+        struct tevent_req * (*send)(TALLOC_CTX *, struct tevent_context *, struct sbus_request *, void *, uint32_t, uint32_t);
+        errno_t (*recv)(TALLOC_CTX *, struct tevent_req *);
+    } handler;
+
+    struct sbus_request *sbus_req;
+    DBusMessageIter *read_iterator;
+    DBusMessageIter *write_iterator;
+};
+
+static void
+_sbus_sss_invoke_in_uu_out__step
+    (struct tevent_context *ev,
+     struct tevent_timer *te,
+     struct timeval tv,
+     void *private_data);
+
+static void
+_sbus_sss_invoke_in_uu_out__done
+   (struct tevent_req *subreq);
+
+struct tevent_req *
+_sbus_sss_invoke_in_uu_out__send
+   (TALLOC_CTX *mem_ctx,
+    struct tevent_context *ev,
+    struct sbus_request *sbus_req,
+    sbus_invoker_keygen keygen,
+    const struct sbus_handler *handler,
+    DBusMessageIter *read_iterator,
+    DBusMessageIter *write_iterator,
+    const char **_key)
+{
+    struct _sbus_sss_invoke_in_uu_out__state *state;
+    struct tevent_req *req;
+    const char *key;
+    errno_t ret;
+
+    req = tevent_req_create(mem_ctx, &state, struct _sbus_sss_invoke_in_uu_out__state);
+    if (req == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create tevent request!\n");
+        return NULL;
+    }
+
+    state->handler.type = handler->type;
+    state->handler.data = handler->data;
+    state->handler.sync = handler->sync;
+    state->handler.send = handler->async_send;
+    state->handler.recv = handler->async_recv;
+
+    state->sbus_req = sbus_req;
+    state->read_iterator = read_iterator;
+    state->write_iterator = write_iterator;
+
+    state->in = talloc_zero(state, struct _sbus_sss_invoker_args_uu);
+    if (state->in == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Unable to allocate space for input parameters!\n");
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = _sbus_sss_invoker_read_uu(state, read_iterator, state->in);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_invoker_schedule(state, ev, _sbus_sss_invoke_in_uu_out__step, req);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sbus_request_key(state, keygen, sbus_req, state->in, &key);
+    if (ret != EOK) {
+        goto done;
+    }
+
+    if (_key != NULL) {
+        *_key = talloc_steal(mem_ctx, key);
+    }
+
+    ret = EAGAIN;
+
+done:
+    if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+        tevent_req_post(req, ev);
+    }
+
+    return req;
+}
+
+static void _sbus_sss_invoke_in_uu_out__step
+   (struct tevent_context *ev,
+    struct tevent_timer *te,
+    struct timeval tv,
+    void *private_data)
+{
+    struct _sbus_sss_invoke_in_uu_out__state *state;
+    struct tevent_req *subreq;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = talloc_get_type(private_data, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_uu_out__state);
+
+    switch (state->handler.type) {
+    case SBUS_HANDLER_SYNC:
+        if (state->handler.sync == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: sync handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        ret = state->handler.sync(state, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (ret != EOK) {
+            goto done;
+        }
+
+        goto done;
+    case SBUS_HANDLER_ASYNC:
+        if (state->handler.send == NULL || state->handler.recv == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Bug: async handler is not specified!\n");
+            ret = ERR_INTERNAL;
+            goto done;
+        }
+
+        subreq = state->handler.send(state, ev, state->sbus_req, state->handler.data, state->in->arg0, state->in->arg1);
+        if (subreq == NULL) {
+            DEBUG(SSSDBG_CRIT_FAILURE, "Unable to create subrequest!\n");
+            ret = ENOMEM;
+            goto done;
+        }
+
+        tevent_req_set_callback(subreq, _sbus_sss_invoke_in_uu_out__done, req);
+        ret = EAGAIN;
+        goto done;
+    }
+
+    ret = ERR_INTERNAL;
+
+done:
+    if (ret == EOK) {
+        tevent_req_done(req);
+    } else if (ret != EAGAIN) {
+        tevent_req_error(req, ret);
+    }
+}
+
+static void _sbus_sss_invoke_in_uu_out__done(struct tevent_req *subreq)
+{
+    struct _sbus_sss_invoke_in_uu_out__state *state;
+    struct tevent_req *req;
+    errno_t ret;
+
+    req = tevent_req_callback_data(subreq, struct tevent_req);
+    state = tevent_req_data(req, struct _sbus_sss_invoke_in_uu_out__state);
+
+    ret = state->handler.recv(state, subreq);
+    talloc_zfree(subreq);
+    if (ret != EOK) {
+        tevent_req_error(req, ret);
+        return;
+    }
+
+    tevent_req_done(req);
+    return;
+}
+
 struct _sbus_sss_invoke_in_uusssu_out_qus_state {
     struct _sbus_sss_invoker_args_uusssu *in;
     struct _sbus_sss_invoker_args_qus out;
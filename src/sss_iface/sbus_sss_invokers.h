@@ -49,13 +49,17 @@ _sbus_sss_declare_invoker(s, b);
 _sbus_sss_declare_invoker(s, qus);
 _sbus_sss_declare_invoker(s, s);
 _sbus_sss_declare_invoker(sqq, q);
+_sbus_sss_declare_invoker(ss, );
 _sbus_sss_declare_invoker(ss, o);
 _sbus_sss_declare_invoker(ssau, );
 _sbus_sss_declare_invoker(u, );
+_sbus_sss_declare_invoker(u, asatatat);
+_sbus_sss_declare_invoker(u, asatatatat);
 _sbus_sss_declare_invoker(usq, );
 _sbus_sss_declare_invoker(ussu, );
 _sbus_sss_declare_invoker(ussu, qus);
 _sbus_sss_declare_invoker(usu, );
+_sbus_sss_declare_invoker(uu, );
 _sbus_sss_declare_invoker(uusssu, qus);
 _sbus_sss_declare_invoker(uusu, qus);
 _sbus_sss_declare_invoker(uuusu, qus);
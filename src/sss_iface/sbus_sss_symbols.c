@@ -373,6 +373,19 @@ _sbus_sss_args_sssd_nss_MemoryCache_InvalidateGroupById[] = {
     {NULL}
 };
 
+const struct sbus_argument
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateInitgroupsByName[] = {
+    {.type = "s", .name = "name"},
+    {.type = "s", .name = "domain"},
+    {NULL}
+};
+
+const struct sbus_argument
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById[] = {
+    {.type = "u", .name = "uid"},
+    {NULL}
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_clearEnumCache = {
     .input = (const struct sbus_argument[]){
@@ -413,6 +426,22 @@ _sbus_sss_args_sssd_service_goOffline = {
     }
 };
 
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_loopStats = {
+    .input = (const struct sbus_argument[]){
+        {.type = "u", .name = "max_entries"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "as", .name = "names"},
+        {.type = "at", .name = "counts"},
+        {.type = "at", .name = "total_usec"},
+        {.type = "at", .name = "max_usec"},
+        {.type = "at", .name = "histogram"},
+        {NULL}
+    }
+};
+
 const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_resetOffline = {
     .input = (const struct sbus_argument[]){
@@ -442,3 +471,30 @@ _sbus_sss_args_sssd_service_sysbusReconnect = {
         {NULL}
     }
 };
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_tallocReport = {
+    .input = (const struct sbus_argument[]){
+        {.type = "u", .name = "max_entries"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {.type = "as", .name = "names"},
+        {.type = "at", .name = "blocks"},
+        {.type = "at", .name = "bytes"},
+        {.type = "at", .name = "total_bytes"},
+        {NULL}
+    }
+};
+
+const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_tallocSampling = {
+    .input = (const struct sbus_argument[]){
+        {.type = "u", .name = "interval"},
+        {.type = "u", .name = "max_entries"},
+        {NULL}
+    },
+    .output = (const struct sbus_argument[]){
+        {NULL}
+    }
+};
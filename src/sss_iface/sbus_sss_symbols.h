@@ -115,6 +115,12 @@ _sbus_sss_args_sssd_nss_MemoryCache_InvalidateAllUsers[];
 extern const struct sbus_argument
 _sbus_sss_args_sssd_nss_MemoryCache_InvalidateGroupById[];
 
+extern const struct sbus_argument
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateInitgroupsByName[];
+
+extern const struct sbus_argument
+_sbus_sss_args_sssd_nss_MemoryCache_InvalidateUserById[];
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_clearEnumCache;
 
@@ -127,6 +133,9 @@ _sbus_sss_args_sssd_service_clearNegcache;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_goOffline;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_loopStats;
+
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_resetOffline;
 
@@ -136,4 +145,10 @@ _sbus_sss_args_sssd_service_rotateLogs;
 extern const struct sbus_method_arguments
 _sbus_sss_args_sssd_service_sysbusReconnect;
 
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_tallocReport;
+
+extern const struct sbus_method_arguments
+_sbus_sss_args_sssd_service_tallocSampling;
+
 #endif /* _SBUS_SSS_SYMBOLS_H_ */
@@ -0,0 +1,657 @@
+/*
+    SSSD
+
+    Responder benchmark
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Drives the request processing of the NSS, PAM, SSH and sudo responders
+ * with a synthetic workload and reports throughput and latency percentiles.
+ *
+ * The responders are driven in-process through the requests the command
+ * handlers use (cache_req, sudosrv_get_rules), the data provider is replaced
+ * by the mock backend from common_mock_resp_dp.c which answers immediately
+ * and does not add anything to the cache. Each request is one of:
+ *
+ *  hit      - the user is in the cache and the entry is valid
+ *  miss     - the user is not cached, the backend is asked and the
+ *             request ends with ENOENT
+ *  negative - the user is in the negative cache
+ */
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+#include <time.h>
+#include <stdlib.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "tests/cmocka/common_mock_resp.h"
+#include "db/sysdb.h"
+#include "responder/common/negcache.h"
+#include "responder/common/cache_req/cache_req.h"
+#ifdef BUILD_SUDO
+#include "db/sysdb_sudo.h"
+#include "responder/sudo/sudosrv_private.h"
+#endif
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "responder_bench_conf.ldb"
+#define TEST_DOM_NAME "responder_bench"
+#define TEST_ID_PROVIDER "ldap"
+
+#define BENCH_TIMEOUT 3600
+#define BENCH_GROUPS 16
+#define BENCH_NEGATIVE 1024
+
+enum bench_kind {
+    BENCH_HIT,
+    BENCH_MISS,
+    BENCH_NEGATIVE_HIT,
+};
+
+struct bench_opts {
+    const char *responders;
+    int requests;
+    int concurrency;
+    int users;
+    int sudo_rules;
+    int hits;
+    int misses;
+    int negative;
+    int seed;
+};
+
+static struct bench_opts opts = {
+#ifdef BUILD_SUDO
+    .responders = "nss,pam,ssh,sudo",
+#else
+    .responders = "nss,pam,ssh",
+#endif
+    .requests = 10000,
+    .concurrency = 16,
+    .users = 1000,
+    .sudo_rules = 10,
+    .hits = 80,
+    .misses = 10,
+    .negative = 10,
+    .seed = 1,
+};
+
+struct bench_ctx;
+
+typedef struct tevent_req *
+(*bench_send_fn)(TALLOC_CTX *mem_ctx, struct bench_ctx *bctx,
+                 const char *name);
+
+typedef errno_t
+(*bench_recv_fn)(TALLOC_CTX *mem_ctx, struct tevent_req *req);
+
+struct bench_responder {
+    const char *name;
+    bench_send_fn send_fn;
+    bench_recv_fn recv_fn;
+};
+
+struct bench_ctx {
+    struct sss_test_ctx *tctx;
+    struct resp_ctx *rctx;
+#ifdef BUILD_SUDO
+    struct sudo_ctx *sudo_ctx;
+#endif
+
+    const struct bench_responder *responder;
+    uint64_t *usec;
+    int started;
+    int finished;
+    int active;
+    int num_found;
+    int num_notfound;
+    int num_failed;
+    int next_miss;
+};
+
+struct bench_request {
+    struct bench_ctx *bctx;
+    struct timespec start;
+};
+
+struct cli_protocol_version *register_cli_protocol_version(void)
+{
+    static struct cli_protocol_version version[] = {
+        { 0, NULL, NULL }
+    };
+
+    return version;
+}
+
+#ifdef BUILD_SUDO
+/* The mock backend does not know anything about sudo rules either. */
+struct tevent_req *
+sss_dp_get_sudoers_send(TALLOC_CTX *mem_ctx,
+                        struct resp_ctx *rctx,
+                        struct sss_domain_info *dom,
+                        bool fast_reply,
+                        enum sss_dp_sudo_type type,
+                        const char *name,
+                        uint32_t num_rules,
+                        struct sysdb_attrs **rules)
+{
+    return test_req_succeed_send(mem_ctx, rctx->ev);
+}
+
+errno_t
+sss_dp_get_sudoers_recv(TALLOC_CTX *mem_ctx,
+                        struct tevent_req *req,
+                        uint16_t *_dp_error,
+                        uint32_t *_error,
+                        const char **_error_message)
+{
+    *_dp_error = 0;
+    *_error = 0;
+    *_error_message = NULL;
+
+    return test_request_recv(req);
+}
+#endif /* BUILD_SUDO */
+
+/* Responder requests */
+
+static struct tevent_req *bench_nss_send(TALLOC_CTX *mem_ctx,
+                                         struct bench_ctx *bctx,
+                                         const char *name)
+{
+    return cache_req_user_by_name_send(mem_ctx, bctx->tctx->ev, bctx->rctx,
+                                       bctx->rctx->ncache, 0,
+                                       CACHE_REQ_POSIX_DOM, NULL, name);
+}
+
+static errno_t bench_nss_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req)
+{
+    struct cache_req_result *result;
+
+    return cache_req_user_by_name_recv(mem_ctx, req, &result);
+}
+
+/* The PAM responder resolves the user with initgroups before it talks
+ * to the backend. */
+static struct tevent_req *bench_pam_send(TALLOC_CTX *mem_ctx,
+                                         struct bench_ctx *bctx,
+                                         const char *name)
+{
+    return cache_req_initgr_by_name_send(mem_ctx, bctx->tctx->ev, bctx->rctx,
+                                         bctx->rctx->ncache, 0,
+                                         CACHE_REQ_POSIX_DOM, NULL, name);
+}
+
+static errno_t bench_pam_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req)
+{
+    struct cache_req_result *result;
+
+    return cache_req_initgr_by_name_recv(mem_ctx, req, &result);
+}
+
+static struct tevent_req *bench_ssh_send(TALLOC_CTX *mem_ctx,
+                                         struct bench_ctx *bctx,
+                                         const char *name)
+{
+    static const char *attrs[] = { SYSDB_NAME, SYSDB_SSH_PUBKEY,
+                                   SYSDB_USER_CERT, NULL };
+
+    return cache_req_user_by_name_attrs_send(mem_ctx, bctx->tctx->ev,
+                                             bctx->rctx, bctx->rctx->ncache,
+                                             0, NULL, name, attrs);
+}
+
+static errno_t bench_ssh_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req)
+{
+    struct cache_req_result *result;
+
+    return cache_req_user_by_name_attrs_recv(mem_ctx, req, &result);
+}
+
+#ifdef BUILD_SUDO
+static struct tevent_req *bench_sudo_send(TALLOC_CTX *mem_ctx,
+                                          struct bench_ctx *bctx,
+                                          const char *name)
+{
+    return sudosrv_get_rules_send(mem_ctx, bctx->tctx->ev, bctx->sudo_ctx,
+                                  SSS_SUDO_USER, 0, name);
+}
+
+static errno_t bench_sudo_recv(TALLOC_CTX *mem_ctx, struct tevent_req *req)
+{
+    struct sysdb_attrs **rules;
+    uint32_t num_rules;
+
+    return sudosrv_get_rules_recv(mem_ctx, req, &rules, &num_rules);
+}
+#endif /* BUILD_SUDO */
+
+static const struct bench_responder responders[] = {
+    { "nss", bench_nss_send, bench_nss_recv },
+    { "pam", bench_pam_send, bench_pam_recv },
+    { "ssh", bench_ssh_send, bench_ssh_recv },
+#ifdef BUILD_SUDO
+    { "sudo", bench_sudo_send, bench_sudo_recv },
+#endif
+    { NULL, NULL, NULL }
+};
+
+/* Workload */
+
+static enum bench_kind bench_pick_kind(void)
+{
+    int roll = random() % (opts.hits + opts.misses + opts.negative);
+
+    if (roll < opts.hits) {
+        return BENCH_HIT;
+    } else if (roll < opts.hits + opts.misses) {
+        return BENCH_MISS;
+    }
+
+    return BENCH_NEGATIVE_HIT;
+}
+
+static const char *bench_pick_name(TALLOC_CTX *mem_ctx,
+                                   struct bench_ctx *bctx)
+{
+    switch (bench_pick_kind()) {
+    case BENCH_HIT:
+        return talloc_asprintf(mem_ctx, "user%ld", random() % opts.users);
+    case BENCH_MISS:
+        /* Every miss must be a new name, otherwise it would end up in the
+         * negative cache. */
+        return talloc_asprintf(mem_ctx, "missing%d", bctx->next_miss++);
+    case BENCH_NEGATIVE_HIT:
+        return talloc_asprintf(mem_ctx, "negative%ld",
+                               random() % BENCH_NEGATIVE);
+    }
+
+    return NULL;
+}
+
+static uint64_t bench_elapsed_usec(struct timespec *start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000ULL
+           + (end.tv_nsec - start->tv_nsec) / 1000;
+}
+
+static void bench_request_done(struct tevent_req *req);
+
+static void bench_request_start(struct bench_ctx *bctx)
+{
+    struct bench_request *breq;
+    struct tevent_req *req;
+    const char *name;
+
+    breq = talloc_zero(bctx, struct bench_request);
+    assert_non_null(breq);
+    breq->bctx = bctx;
+
+    name = bench_pick_name(breq, bctx);
+    assert_non_null(name);
+
+    /* Input parsing is answered by the mock in the order of the requests. */
+    mock_parse_inp(name, NULL, ERR_OK);
+
+    clock_gettime(CLOCK_MONOTONIC, &breq->start);
+    req = bctx->responder->send_fn(breq, bctx, name);
+    assert_non_null(req);
+    tevent_req_set_callback(req, bench_request_done, breq);
+
+    bctx->started++;
+    bctx->active++;
+}
+
+static void bench_request_done(struct tevent_req *req)
+{
+    struct bench_request *breq;
+    struct bench_ctx *bctx;
+    errno_t ret;
+
+    breq = tevent_req_callback_data(req, struct bench_request);
+    bctx = breq->bctx;
+
+    ret = bctx->responder->recv_fn(breq, req);
+    bctx->usec[bctx->finished] = bench_elapsed_usec(&breq->start);
+    talloc_free(breq);
+
+    switch (ret) {
+    case EOK:
+        bctx->num_found++;
+        break;
+    case ENOENT:
+        bctx->num_notfound++;
+        break;
+    default:
+        bctx->num_failed++;
+        break;
+    }
+
+    bctx->finished++;
+    bctx->active--;
+
+    /* Keep the number of requests in flight constant. */
+    if (bctx->started < opts.requests) {
+        bench_request_start(bctx);
+    }
+}
+
+static int cmp_usec(const void *a, const void *b)
+{
+    uint64_t ua = *(const uint64_t *)a;
+    uint64_t ub = *(const uint64_t *)b;
+
+    return (ua > ub) - (ua < ub);
+}
+
+static void bench_report(struct bench_ctx *bctx, uint64_t total_usec)
+{
+    uint64_t sum = 0;
+    int num = bctx->finished;
+
+    qsort(bctx->usec, num, sizeof(uint64_t), cmp_usec);
+    for (int i = 0; i < num; i++) {
+        sum += bctx->usec[i];
+    }
+
+    printf("%s: %d requests, concurrency %d, "
+           "%d found, %d not found, %d failed\n",
+           bctx->responder->name, num, opts.concurrency,
+           bctx->num_found, bctx->num_notfound, bctx->num_failed);
+    printf("  throughput: %.0f req/s\n",
+           total_usec == 0 ? 0.0 : num * 1000000.0 / total_usec);
+    printf("  latency (usec): min %"PRIu64" avg %"PRIu64" p50 %"PRIu64
+           " p90 %"PRIu64" p99 %"PRIu64" max %"PRIu64"\n",
+           bctx->usec[0], sum / num, bctx->usec[num / 2],
+           bctx->usec[(num * 90) / 100], bctx->usec[(num * 99) / 100],
+           bctx->usec[num - 1]);
+}
+
+static void bench_run_responder(struct bench_ctx *bctx,
+                                const struct bench_responder *responder)
+{
+    struct timespec start;
+    int ret;
+
+    bctx->responder = responder;
+    bctx->started = 0;
+    bctx->finished = 0;
+    bctx->active = 0;
+    bctx->num_found = 0;
+    bctx->num_notfound = 0;
+    bctx->num_failed = 0;
+
+    bctx->usec = talloc_array(bctx, uint64_t, opts.requests);
+    assert_non_null(bctx->usec);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < opts.concurrency && i < opts.requests; i++) {
+        bench_request_start(bctx);
+    }
+
+    while (bctx->finished < opts.requests) {
+        ret = tevent_loop_once(bctx->tctx->ev);
+        assert_int_equal(ret, 0);
+    }
+
+    bench_report(bctx, bench_elapsed_usec(&start));
+    talloc_zfree(bctx->usec);
+}
+
+/* Cache content */
+
+static void bench_populate(struct bench_ctx *bctx)
+{
+    struct sss_domain_info *dom = bctx->tctx->dom;
+    struct sysdb_attrs *attrs;
+    time_t now = time(NULL);
+    char *group;
+    char *name;
+    errno_t ret;
+
+    ret = sysdb_transaction_start(dom->sysdb);
+    assert_int_equal(ret, EOK);
+
+    for (int i = 0; i < BENCH_GROUPS; i++) {
+        name = sss_create_internal_fqname(bctx, talloc_asprintf(bctx,
+                                          "group%d", i), dom->name);
+        assert_non_null(name);
+
+        ret = sysdb_store_group(dom, name, 50000 + i, NULL,
+                                BENCH_TIMEOUT, now);
+        assert_int_equal(ret, EOK);
+        talloc_free(name);
+    }
+
+    for (int i = 0; i < opts.users; i++) {
+        attrs = sysdb_new_attrs(bctx);
+        assert_non_null(attrs);
+
+        ret = sysdb_attrs_add_time_t(attrs, SYSDB_INITGR_EXPIRE,
+                                     now + BENCH_TIMEOUT);
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SSH_PUBKEY,
+                                     "ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAI"
+                                     "GNjFgSsnk6XVIYmPZDFbFgtRJnfCu1c4eVJsh"
+                                     "qpCgXv bench");
+        assert_int_equal(ret, EOK);
+
+        name = sss_create_internal_fqname(attrs, talloc_asprintf(attrs,
+                                          "user%d", i), dom->name);
+        assert_non_null(name);
+
+        ret = sysdb_store_user(dom, name, "*", 10000 + i, 50000, NULL, NULL,
+                               NULL, NULL, attrs, NULL, BENCH_TIMEOUT, now);
+        assert_int_equal(ret, EOK);
+
+        group = sss_create_internal_fqname(attrs, talloc_asprintf(attrs,
+                                           "group%d", i % BENCH_GROUPS),
+                                           dom->name);
+        assert_non_null(group);
+
+        ret = sysdb_add_group_member(dom, group, name,
+                                     SYSDB_MEMBER_USER, false);
+        assert_int_equal(ret, EOK);
+
+        talloc_free(attrs);
+    }
+
+    ret = sysdb_transaction_commit(dom->sysdb);
+    assert_int_equal(ret, EOK);
+
+#ifdef BUILD_SUDO
+    dom->sudo_timeout = BENCH_TIMEOUT;
+    for (int i = 0; i < opts.sudo_rules; i++) {
+        attrs = sysdb_new_attrs(bctx);
+        assert_non_null(attrs);
+
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_CN,
+                                     talloc_asprintf(attrs, "rule%d", i));
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_USER,
+                                     i % 2 ? "ALL" : "%group0");
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_HOST, "ALL");
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_COMMAND,
+                                     "/usr/bin/true");
+        assert_int_equal(ret, EOK);
+
+        ret = sysdb_sudo_store(dom, &attrs, 1);
+        assert_int_equal(ret, EOK);
+
+        talloc_free(attrs);
+    }
+#endif /* BUILD_SUDO */
+
+    for (int i = 0; i < BENCH_NEGATIVE; i++) {
+        name = sss_create_internal_fqname(bctx, talloc_asprintf(bctx,
+                                          "negative%d", i), dom->name);
+        assert_non_null(name);
+
+        ret = sss_ncache_set_user(bctx->rctx->ncache, true, dom, name);
+        assert_int_equal(ret, EOK);
+        talloc_free(name);
+    }
+}
+
+static int bench_setup(void **state)
+{
+    struct bench_ctx *bctx;
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    bctx = talloc_zero(NULL, struct bench_ctx);
+    assert_non_null(bctx);
+
+    bctx->tctx = create_dom_test_ctx(bctx, TESTS_PATH, TEST_CONF_DB,
+                                     TEST_DOM_NAME, TEST_ID_PROVIDER, NULL);
+    assert_non_null(bctx->tctx);
+
+    bctx->rctx = mock_rctx(bctx, bctx->tctx->ev, bctx->tctx->dom, NULL);
+    assert_non_null(bctx->rctx);
+
+#ifdef BUILD_SUDO
+    bctx->sudo_ctx = talloc_zero(bctx, struct sudo_ctx);
+    assert_non_null(bctx->sudo_ctx);
+    bctx->sudo_ctx->rctx = bctx->rctx;
+    bctx->sudo_ctx->threshold = 50;
+#endif
+
+    bench_populate(bctx);
+
+    /* The backend only confirms the lookup, it never finds anything. */
+    will_return_always(sss_dp_get_account_recv, 0);
+
+    *state = bctx;
+    return 0;
+}
+
+static int bench_teardown(void **state)
+{
+    struct bench_ctx *bctx = talloc_get_type_abort(*state, struct bench_ctx);
+
+    talloc_free(bctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    return 0;
+}
+
+static void bench_responders(void **state)
+{
+    struct bench_ctx *bctx = talloc_get_type_abort(*state, struct bench_ctx);
+    char **list;
+    int num;
+    int i;
+    errno_t ret;
+
+    ret = split_on_separator(bctx, opts.responders, ',', true, true,
+                             &list, &num);
+    assert_int_equal(ret, EOK);
+
+    for (int n = 0; n < num; n++) {
+        for (i = 0; responders[i].name != NULL; i++) {
+            if (strcmp(list[n], responders[i].name) == 0) {
+                break;
+            }
+        }
+
+        if (responders[i].name == NULL) {
+            fprintf(stderr, "Unknown responder [%s]\n", list[n]);
+            fail();
+        }
+
+        srandom(opts.seed);
+        bench_run_responder(bctx, &responders[i]);
+    }
+
+    talloc_free(list);
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        { "responders", 'r', POPT_ARG_STRING | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.responders, 0,
+          "Comma separated list of responders to benchmark "
+          "(nss, pam, ssh, sudo)", NULL },
+        { "requests", 'n', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.requests, 0, "Number of requests per responder", NULL },
+        { "concurrency", 'c', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.concurrency, 0, "Number of requests in flight", NULL },
+        { "users", 'u', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.users, 0, "Number of cached users", NULL },
+        { "sudo-rules", '\0', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.sudo_rules, 0, "Number of cached sudo rules", NULL },
+        { "hits", '\0', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.hits, 0, "Weight of cache hits", NULL },
+        { "misses", '\0', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.misses, 0, "Weight of cache misses", NULL },
+        { "negative", '\0', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.negative, 0, "Weight of negative cache hits", NULL },
+        { "seed", '\0', POPT_ARG_INT | POPT_ARGFLAG_SHOW_DEFAULT,
+          &opts.seed, 0, "Seed of the workload generator", NULL },
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(bench_responders,
+                                        bench_setup, bench_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    if (opts.requests <= 0 || opts.concurrency <= 0 || opts.users <= 0
+            || opts.hits < 0 || opts.misses < 0 || opts.negative < 0
+            || opts.hits + opts.misses + opts.negative == 0) {
+        fprintf(stderr, "Invalid workload\n");
+        return 1;
+    }
+
+    DEBUG_CLI_INIT(debug_level);
+
+    tests_set_cwd();
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -92,6 +92,37 @@ enum nss_status __wrap_sss_nss_make_request_timeout(enum sss_cli_command cmd,
     return d->nss_status;
 }
 
+enum nss_status __wrap_sss_nss_make_request_pipelined(
+                                                enum sss_cli_command cmd,
+                                                struct sss_cli_req_data *rd,
+                                                size_t num,
+                                                int timeout,
+                                                struct sss_cli_rep_data *rep)
+{
+    struct sss_nss_make_request_test_data *d;
+    size_t c;
+
+    assert_int_equal(num, sss_mock_type(size_t));
+
+    for (c = 0; c < num; c++) {
+        d = sss_mock_ptr_type(struct sss_nss_make_request_test_data *);
+
+        rep[c].status = d->nss_status;
+        rep[c].errnop = d->errnop;
+        rep[c].len = d->replen;
+        rep[c].buf = NULL;
+
+        /* the caller must be able to free the buffers. */
+        if (d->replen != 0 && d->repbuf != NULL) {
+            rep[c].buf = malloc(d->replen);
+            assert_non_null(rep[c].buf);
+            memcpy(rep[c].buf, d->repbuf, d->replen);
+        }
+    }
+
+    return NSS_STATUS_SUCCESS;
+}
+
 void test_getsidbyname(void **state)
 {
     int ret;
@@ -136,6 +167,54 @@ void test_getsidbyname(void **state)
     }
 }
 
+void test_getsidbyname_list(void **state)
+{
+    int ret;
+    size_t c;
+    const char *names[] = {"test1", "", "test2", "test3", "test4"};
+    size_t num = sizeof(names) / sizeof(names[0]);
+    char *sids[sizeof(names) / sizeof(names[0])];
+    enum sss_id_type types[sizeof(names) / sizeof(names[0])];
+    int rets[sizeof(names) / sizeof(names[0])];
+    struct sss_nss_make_request_test_data d[] = {
+        {buf1, sizeof(buf1), 0, NSS_STATUS_SUCCESS},
+        {buf3, sizeof(buf3), 0, NSS_STATUS_SUCCESS},
+        {NULL, 0, EINVAL, NSS_STATUS_UNAVAIL},
+        {buf_orig1, sizeof(buf_orig1), 0, NSS_STATUS_SUCCESS},
+    };
+    int exp_rets[] = {EOK, EINVAL, ENOENT, ENOENT, EOK};
+
+    ret = sss_nss_getsidbyname_list(NULL, num, sids, types, rets);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_nss_getsidbyname_list(names, num, sids, types, NULL);
+    assert_int_equal(ret, EINVAL);
+
+    ret = sss_nss_getsidbyname_list(names, 0, sids, types, rets);
+    assert_int_equal(ret, EOK);
+
+    /* the empty name is rejected without contacting SSSD */
+    will_return(__wrap_sss_nss_make_request_pipelined, num - 1);
+    for (c = 0; c < num - 1; c++) {
+        will_return(__wrap_sss_nss_make_request_pipelined, &d[c]);
+    }
+
+    ret = sss_nss_getsidbyname_list(names, num, sids, types, rets);
+    assert_int_equal(ret, EOK);
+
+    for (c = 0; c < num; c++) {
+        assert_int_equal(rets[c], exp_rets[c]);
+        if (rets[c] == EOK) {
+            assert_string_equal(sids[c], c == 0 ? "test" : "key");
+        } else {
+            assert_null(sids[c]);
+        }
+        free(sids[c]);
+    }
+    assert_int_equal(types[0], SSS_ID_TYPE_NOT_SPECIFIED);
+    assert_int_equal(types[4], SSS_ID_TYPE_UID);
+}
+
 void test_getorigbyname(void **state)
 {
     int ret;
@@ -184,6 +263,7 @@ int main(int argc, const char *argv[])
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_getsidbyname),
+        cmocka_unit_test(test_getsidbyname_list),
         cmocka_unit_test(test_getorigbyname),
         cmocka_unit_test(test_sss_nss_getgrouplist_timeout),
     };
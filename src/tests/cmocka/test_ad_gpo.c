@@ -427,6 +427,185 @@ void test_ad_gpo_parse_ini_file(void **state)
     assert_int_equal(version, 6);
 }
 
+/*
+ * Test the batch protocol between the backend and gpo_child
+ */
+static struct io_buffer *create_test_request(TALLOC_CTX *mem_ctx)
+{
+    struct gp_gpo **gpos;
+    struct io_buffer *buf;
+    int ret;
+    int i;
+
+    gpos = talloc_zero_array(mem_ctx, struct gp_gpo *, 3);
+    assert_non_null(gpos);
+    for (i = 0; i < 3; i++) {
+        gpos[i] = talloc_zero(gpos, struct gp_gpo);
+        assert_non_null(gpos[i]);
+        gpos[i]->smb_share = "/SysVol";
+        gpos[i]->smb_path = talloc_asprintf(gpos[i],
+                                            "/domain.test/Policies/{GPO%d}", i);
+        assert_non_null(gpos[i]->smb_path);
+    }
+    gpos[0]->cached_gpt_version = 5;
+    gpos[1]->cached_gpt_version = -1;
+    gpos[2]->cached_gpt_version = 0;
+
+    ret = create_cse_send_buffer(mem_ctx, "smb://dc1.domain.test", gpos, 3,
+                                 GP_EXT_GUID_SECURITY_SUFFIX, &buf);
+    assert_int_equal(ret, EOK);
+    talloc_free(gpos);
+
+    return buf;
+}
+
+void test_ad_gpo_child_request(void **state)
+{
+    struct gpo_child_input *ibuf;
+    struct io_buffer *buf;
+    int ret;
+
+    buf = create_test_request(test_ctx);
+
+    ibuf = talloc_zero(test_ctx, struct gpo_child_input);
+    assert_non_null(ibuf);
+    ret = ad_gpo_child_unpack_request(buf->data, buf->size, ibuf);
+    assert_int_equal(ret, EOK);
+
+    assert_string_equal(ibuf->smb_server, "smb://dc1.domain.test");
+    assert_int_equal(ibuf->num_gpos, 3);
+    assert_int_equal(ibuf->gpos[0].cached_gpt_version, 5);
+    assert_int_equal(ibuf->gpos[1].cached_gpt_version, -1);
+    assert_int_equal(ibuf->gpos[2].cached_gpt_version, 0);
+    assert_string_equal(ibuf->gpos[0].smb_share, "/SysVol");
+    assert_string_equal(ibuf->gpos[0].smb_path,
+                        "/domain.test/Policies/{GPO0}");
+    assert_string_equal(ibuf->gpos[2].smb_path,
+                        "/domain.test/Policies/{GPO2}");
+    assert_string_equal(ibuf->gpos[1].smb_cse_suffix,
+                        GP_EXT_GUID_SECURITY_SUFFIX);
+
+    talloc_free(ibuf);
+    talloc_free(buf);
+}
+
+void test_ad_gpo_child_request_truncated(void **state)
+{
+    struct gpo_child_input *ibuf;
+    struct io_buffer *buf;
+    uint8_t *data;
+    size_t size;
+    int ret;
+
+    buf = create_test_request(test_ctx);
+
+    /* every frame which ends early is rejected */
+    for (size = 0; size < buf->size; size++) {
+        data = talloc_memdup(test_ctx, buf->data, size + 1);
+        assert_non_null(data);
+        ibuf = talloc_zero(test_ctx, struct gpo_child_input);
+        assert_non_null(ibuf);
+
+        ret = ad_gpo_child_unpack_request(data, size, ibuf);
+        assert_int_equal(ret, EINVAL);
+
+        talloc_free(ibuf);
+        talloc_free(data);
+    }
+
+    /* as well as trailing data */
+    data = talloc_zero_size(test_ctx, buf->size + 1);
+    assert_non_null(data);
+    memcpy(data, buf->data, buf->size);
+    ibuf = talloc_zero(test_ctx, struct gpo_child_input);
+    assert_non_null(ibuf);
+    ret = ad_gpo_child_unpack_request(data, buf->size + 1, ibuf);
+    assert_int_equal(ret, EINVAL);
+
+    /* and an empty batch */
+    memset(data, 0, sizeof(uint32_t));
+    ret = ad_gpo_child_unpack_request(data, buf->size, ibuf);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(ibuf);
+    talloc_free(data);
+    talloc_free(buf);
+}
+
+void test_ad_gpo_child_response(void **state)
+{
+    struct gpo_child_output out[] = {
+        { 7, true, EOK },
+        { -1, false, ENOENT },
+        { 3, false, EOK },
+        { 0, false, EACCES },
+    };
+    struct gpo_child_result results[4];
+    struct response *r;
+    int ret;
+
+    r = talloc_zero(test_ctx, struct response);
+    assert_non_null(r);
+    ret = ad_gpo_child_pack_response(r, out, 4);
+    assert_int_equal(ret, EOK);
+
+    /* a failed GPO does not affect the others in the batch */
+    ret = ad_gpo_parse_gpo_child_response(r->buf, r->size, 4, results);
+    assert_int_equal(ret, EOK);
+
+    assert_int_equal(results[0].sysvol_gpt_version, 7);
+    assert_int_equal(results[0].policy_updated, 1);
+    assert_int_equal(results[0].result, EOK);
+    assert_int_equal(results[1].result, ENOENT);
+    assert_int_equal(results[2].sysvol_gpt_version, 3);
+    assert_int_equal(results[2].policy_updated, 0);
+    assert_int_equal(results[2].result, EOK);
+    assert_int_equal(results[3].result, EACCES);
+
+    /* the reply must cover exactly the GPOs which were sent */
+    ret = ad_gpo_parse_gpo_child_response(r->buf, r->size, 3, results);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(r);
+}
+
+void test_ad_gpo_child_response_truncated(void **state)
+{
+    struct gpo_child_output out[] = {
+        { 7, true, EOK },
+        { 0, false, EACCES },
+    };
+    struct gpo_child_result results[2];
+    struct response *r;
+    uint8_t *data;
+    size_t size;
+    int ret;
+
+    r = talloc_zero(test_ctx, struct response);
+    assert_non_null(r);
+    ret = ad_gpo_child_pack_response(r, out, 2);
+    assert_int_equal(ret, EOK);
+
+    for (size = 0; size < r->size; size++) {
+        data = talloc_memdup(test_ctx, r->buf, size + 1);
+        assert_non_null(data);
+
+        ret = ad_gpo_parse_gpo_child_response(data, size, 2, results);
+        assert_int_equal(ret, EINVAL);
+
+        talloc_free(data);
+    }
+
+    data = talloc_zero_size(test_ctx, r->size + 1);
+    assert_non_null(data);
+    memcpy(data, r->buf, r->size);
+    ret = ad_gpo_parse_gpo_child_response(data, r->size + 1, 2, results);
+    assert_int_equal(ret, EINVAL);
+
+    talloc_free(data);
+    talloc_free(r);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -471,6 +650,18 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_ad_gpo_parse_ini_file,
                                         ad_gpo_test_setup,
                                         ad_gpo_test_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_gpo_child_request,
+                                        ad_gpo_test_setup,
+                                        ad_gpo_test_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_gpo_child_request_truncated,
+                                        ad_gpo_test_setup,
+                                        ad_gpo_test_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_gpo_child_response,
+                                        ad_gpo_test_setup,
+                                        ad_gpo_test_teardown),
+        cmocka_unit_test_setup_teardown(test_ad_gpo_child_response_truncated,
+                                        ad_gpo_test_setup,
+                                        ad_gpo_test_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
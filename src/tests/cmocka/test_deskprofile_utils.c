@@ -23,9 +23,12 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <popt.h>
+#include <fcntl.h>
 
 #include "tests/cmocka/common_mock.h"
 #include "src/providers/ipa/ipa_deskprofile_rules_util.h"
+#include "src/providers/ipa/ipa_deskprofile_private.h"
+#include "src/providers/ipa/ipa_rules_common.h"
 
 #define RULES_DIR "/var/lib/sss/deskprofile"
 #define DOMAIN "domain.example"
@@ -125,6 +128,132 @@ void test_deskprofile_get_filename_path(void **state)
     talloc_free(tmp_ctx);
 }
 
+#define SAVE_DOMAIN "save.example"
+#define SAVE_USER_DIR IPA_DESKPROFILE_RULES_USER_DIR"/"SAVE_DOMAIN"/user"
+#define SAVE_MANIFEST IPA_DESKPROFILE_RULES_USER_DIR"/"SAVE_DOMAIN"/.user.manifest"
+#define SAVE_RULE_1 SAVE_USER_DIR"/000010_000010_000010_000010_000010_rule1.json"
+#define SAVE_RULE_2 SAVE_USER_DIR"/000020_000020_000020_000020_000020_rule2.json"
+
+static struct sysdb_attrs *
+deskprofile_test_rule(TALLOC_CTX *mem_ctx,
+                      const char *name,
+                      uint32_t prio,
+                      const char *data)
+{
+    struct sysdb_attrs *rule;
+    errno_t ret;
+
+    rule = sysdb_new_attrs(mem_ctx);
+    assert_non_null(rule);
+
+    /* Rules applying to everybody don't need any sysdb lookups */
+    ret = sysdb_attrs_add_string(rule, IPA_CN, name);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_uint32(rule, IPA_DESKPROFILE_PRIORITY, prio);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string(rule, IPA_USER_CATEGORY, "all");
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string(rule, IPA_HOST_CATEGORY, "all");
+    assert_int_equal(ret, EOK);
+    ret = sysdb_attrs_add_string(rule, IPA_DESKPROFILE_DATA, data);
+    assert_int_equal(ret, EOK);
+
+    return rule;
+}
+
+static void deskprofile_test_check_file(const char *path,
+                                        const char *data,
+                                        ino_t *_ino)
+{
+    char buf[64];
+    struct stat st;
+    ssize_t len;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    assert_int_not_equal(fd, -1);
+
+    assert_int_equal(fstat(fd, &st), 0);
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+
+    assert_true(len >= 0);
+    buf[len] = '\0';
+    assert_string_equal(buf, data);
+
+    *_ino = st.st_ino;
+}
+
+void test_deskprofile_save_rules_to_disk(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sysdb_attrs *rules[2];
+    ino_t ino1;
+    ino_t ino2;
+    ino_t ino;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    ret = mkdir(IPA_DESKPROFILE_RULES_USER_DIR, 0700);
+    assert_true(ret == 0 || errno == EEXIST);
+
+    rules[0] = deskprofile_test_rule(tmp_ctx, "rule1", 10, "{\"one\": 1}");
+    rules[1] = deskprofile_test_rule(tmp_ctx, "rule2", 20, "{\"two\": 2}");
+
+    ret = ipa_deskprofile_rules_save_rules_to_disk(tmp_ctx, 1, rules, 2, NULL,
+                                                   "host.save.example",
+                                                   "user@"SAVE_DOMAIN,
+                                                   SAVE_USER_DIR);
+    assert_int_equal(ret, EOK);
+    deskprofile_test_check_file(SAVE_RULE_1, "{\"one\": 1}", &ino1);
+    deskprofile_test_check_file(SAVE_RULE_2, "{\"two\": 2}", &ino2);
+    assert_int_equal(access(SAVE_MANIFEST, F_OK), 0);
+
+    /* Nothing changed, nothing is rewritten */
+    ret = ipa_deskprofile_rules_save_rules_to_disk(tmp_ctx, 1, rules, 2, NULL,
+                                                   "host.save.example",
+                                                   "user@"SAVE_DOMAIN,
+                                                   SAVE_USER_DIR);
+    assert_int_equal(ret, EOK);
+    deskprofile_test_check_file(SAVE_RULE_1, "{\"one\": 1}", &ino);
+    assert_int_equal(ino, ino1);
+    deskprofile_test_check_file(SAVE_RULE_2, "{\"two\": 2}", &ino);
+    assert_int_equal(ino, ino2);
+
+    /* Only the changed rule is replaced */
+    rules[1] = deskprofile_test_rule(tmp_ctx, "rule2", 20, "{\"two\": 22}");
+    ret = ipa_deskprofile_rules_save_rules_to_disk(tmp_ctx, 1, rules, 2, NULL,
+                                                   "host.save.example",
+                                                   "user@"SAVE_DOMAIN,
+                                                   SAVE_USER_DIR);
+    assert_int_equal(ret, EOK);
+    deskprofile_test_check_file(SAVE_RULE_1, "{\"one\": 1}", &ino);
+    assert_int_equal(ino, ino1);
+    deskprofile_test_check_file(SAVE_RULE_2, "{\"two\": 22}", &ino);
+
+    /* Rules which no longer apply are removed */
+    ret = ipa_deskprofile_rules_save_rules_to_disk(tmp_ctx, 1, rules, 1, NULL,
+                                                   "host.save.example",
+                                                   "user@"SAVE_DOMAIN,
+                                                   SAVE_USER_DIR);
+    assert_int_equal(ret, EOK);
+    deskprofile_test_check_file(SAVE_RULE_1, "{\"one\": 1}", &ino);
+    assert_int_equal(ino, ino1);
+    assert_int_equal(access(SAVE_RULE_2, F_OK), -1);
+
+    ret = ipa_deskprofile_rules_remove_user_dir(SAVE_USER_DIR);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(access(SAVE_USER_DIR, F_OK), -1);
+    assert_int_equal(access(SAVE_MANIFEST, F_OK), -1);
+
+    ret = sss_remove_tree(IPA_DESKPROFILE_RULES_USER_DIR);
+    assert_int_equal(ret, EOK);
+
+    talloc_free(tmp_ctx);
+}
+
 int main(int argc, const char *argv[])
 {
     poptContext pc;
@@ -138,6 +267,7 @@ int main(int argc, const char *argv[])
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_deskprofile_get_filename_path),
+        cmocka_unit_test(test_deskprofile_save_rules_to_disk),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
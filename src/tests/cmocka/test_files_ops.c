@@ -0,0 +1,729 @@
+/*
+    SSSD
+
+    Files provider - tests for the incremental update of the cache
+
+    Copyright (C) 2024 Red Hat
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+#include <stdio.h>
+
+/* In order to access opaque types */
+#include "providers/files/files_ops.c"
+
+#include "tests/cmocka/common_mock.h"
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "tests_conf.ldb"
+#define TEST_DOM_NAME "files_ops_test"
+#define TEST_ID_PROVIDER "files"
+
+#define TEST_PASSWD_FILE TESTS_PATH"/passwd"
+#define TEST_GROUP_FILE TESTS_PATH"/group"
+
+#define MAX_NOTIFIED 16
+
+#define ALICE "alice:x:1001:1001:Alice:/home/alice:/bin/bash\n"
+#define BOB "bob:x:1002:1002:Bob:/home/bob:/bin/bash\n"
+
+struct files_ops_test_ctx {
+    struct sss_test_ctx *tctx;
+    struct files_id_ctx *id_ctx;
+    bool fail_transaction_start;
+
+    /* Signals sent to the responders */
+    int inconsistent;
+    int users_ncache;
+    int groups_ncache;
+    int users_memcache;
+    int groups_memcache;
+    int initgr_memcache;
+    uid_t uids[MAX_NOTIFIED];
+    size_t num_uids;
+    gid_t gids[MAX_NOTIFIED];
+    size_t num_gids;
+    const char *initgr_names[MAX_NOTIFIED];
+    size_t num_initgr_names;
+};
+
+static struct files_ops_test_ctx *test_ctx;
+
+/* The responder signals live in the backend binary */
+void dp_sbus_domain_active(struct data_provider *provider,
+                           struct sss_domain_info *dom)
+{
+    return;
+}
+
+void dp_sbus_domain_inconsistent(struct data_provider *provider,
+                                 struct sss_domain_info *dom)
+{
+    test_ctx->inconsistent++;
+}
+
+void dp_sbus_reset_users_ncache(struct data_provider *provider,
+                                struct sss_domain_info *dom)
+{
+    test_ctx->users_ncache++;
+}
+
+void dp_sbus_reset_groups_ncache(struct data_provider *provider,
+                                 struct sss_domain_info *dom)
+{
+    test_ctx->groups_ncache++;
+}
+
+void dp_sbus_reset_users_memcache(struct data_provider *provider)
+{
+    test_ctx->users_memcache++;
+}
+
+void dp_sbus_reset_groups_memcache(struct data_provider *provider)
+{
+    test_ctx->groups_memcache++;
+}
+
+void dp_sbus_reset_initgr_memcache(struct data_provider *provider)
+{
+    test_ctx->initgr_memcache++;
+}
+
+void dp_sbus_invalidate_user_memcache(struct data_provider *provider,
+                                      uid_t uid)
+{
+    assert_true(test_ctx->num_uids < MAX_NOTIFIED);
+    test_ctx->uids[test_ctx->num_uids++] = uid;
+}
+
+void dp_sbus_invalidate_group_memcache(struct data_provider *provider,
+                                       gid_t gid)
+{
+    assert_true(test_ctx->num_gids < MAX_NOTIFIED);
+    test_ctx->gids[test_ctx->num_gids++] = gid;
+}
+
+void dp_sbus_invalidate_initgr_memcache(struct data_provider *provider,
+                                        const char *fq_name,
+                                        const char *domain)
+{
+    assert_true(test_ctx->num_initgr_names < MAX_NOTIFIED);
+    test_ctx->initgr_names[test_ctx->num_initgr_names] =
+                                        talloc_strdup(test_ctx, fq_name);
+    assert_non_null(test_ctx->initgr_names[test_ctx->num_initgr_names]);
+    test_ctx->num_initgr_names++;
+}
+
+errno_t dp_add_sr_attribute(struct be_ctx *be_ctx)
+{
+    return EOK;
+}
+
+void handle_certmap(struct tevent_req *req)
+{
+    return;
+}
+
+void files_account_info_finished(struct files_id_ctx *id_ctx,
+                                 int req_type,
+                                 errno_t ret)
+{
+    return;
+}
+
+int __real_sysdb_transaction_start(struct sysdb_ctx *sysdb);
+
+int __wrap_sysdb_transaction_start(struct sysdb_ctx *sysdb)
+{
+    if (test_ctx->fail_transaction_start) {
+        test_ctx->fail_transaction_start = false;
+        return EIO;
+    }
+
+    return __real_sysdb_transaction_start(sysdb);
+}
+
+static void write_file(const char *path, const char *content)
+{
+    FILE *f;
+
+    f = fopen(path, "w");
+    assert_non_null(f);
+    assert_int_not_equal(fputs(content, f), EOF);
+    assert_int_equal(fclose(f), 0);
+}
+
+static void reset_notified(void)
+{
+    test_ctx->inconsistent = 0;
+    test_ctx->users_ncache = 0;
+    test_ctx->groups_ncache = 0;
+    test_ctx->users_memcache = 0;
+    test_ctx->groups_memcache = 0;
+    test_ctx->initgr_memcache = 0;
+    test_ctx->num_uids = 0;
+    test_ctx->num_gids = 0;
+    test_ctx->num_initgr_names = 0;
+}
+
+static bool uid_notified(uid_t uid)
+{
+    size_t i;
+
+    for (i = 0; i < test_ctx->num_uids; i++) {
+        if (test_ctx->uids[i] == uid) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool gid_notified(gid_t gid)
+{
+    size_t i;
+
+    for (i = 0; i < test_ctx->num_gids; i++) {
+        if (test_ctx->gids[i] == gid) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool initgr_notified(const char *name)
+{
+    char *fqname;
+    bool found = false;
+    size_t i;
+
+    fqname = sss_create_internal_fqname(test_ctx, name, TEST_DOM_NAME);
+    assert_non_null(fqname);
+
+    for (i = 0; i < test_ctx->num_initgr_names; i++) {
+        if (strcmp(test_ctx->initgr_names[i], fqname) == 0) {
+            found = true;
+        }
+    }
+
+    talloc_free(fqname);
+    return found;
+}
+
+static errno_t run_diff(void)
+{
+    struct sf_enum_files_state state = { 0 };
+
+    state.id_ctx = test_ctx->id_ctx;
+    state.flags = SF_UPDATE_BOTH;
+
+    return sf_update_diff(&state);
+}
+
+/* Saves the content of the files through a diff against an empty snapshot,
+ * the same entries a full refresh would write */
+static void load_files(const char *passwd, const char *group)
+{
+    errno_t ret;
+
+    write_file(TEST_PASSWD_FILE, passwd);
+    write_file(TEST_GROUP_FILE, group);
+
+    talloc_free(test_ctx->id_ctx->snapshot);
+    test_ctx->id_ctx->snapshot = talloc_zero(test_ctx->id_ctx,
+                                             struct files_snapshot);
+    assert_non_null(test_ctx->id_ctx->snapshot);
+
+    ret = run_diff();
+    assert_int_equal(ret, EOK);
+
+    reset_notified();
+}
+
+static void update_files(const char *passwd, const char *group)
+{
+    errno_t ret;
+
+    write_file(TEST_PASSWD_FILE, passwd);
+    write_file(TEST_GROUP_FILE, group);
+
+    ret = run_diff();
+    assert_int_equal(ret, EOK);
+}
+
+static struct ldb_message *get_user(const char *name)
+{
+    const char *attrs[] = { SYSDB_NAME, SYSDB_UIDNUM, SYSDB_SHELL,
+                            SYSDB_GECOS, NULL };
+    struct ldb_message *msg = NULL;
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(test_ctx, name, TEST_DOM_NAME);
+    assert_non_null(fqname);
+
+    ret = sysdb_search_user_by_name(test_ctx, test_ctx->tctx->dom, fqname,
+                                    attrs, &msg);
+    talloc_free(fqname);
+    if (ret == ENOENT) {
+        return NULL;
+    }
+    assert_int_equal(ret, EOK);
+
+    return msg;
+}
+
+static struct ldb_message *get_group(const char *name)
+{
+    const char *attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, SYSDB_MEMBER,
+                            SYSDB_GHOST, NULL };
+    struct ldb_message *msg = NULL;
+    char *fqname;
+    errno_t ret;
+
+    fqname = sss_create_internal_fqname(test_ctx, name, TEST_DOM_NAME);
+    assert_non_null(fqname);
+
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom, fqname,
+                                     attrs, &msg);
+    talloc_free(fqname);
+    if (ret == ENOENT) {
+        return NULL;
+    }
+    assert_int_equal(ret, EOK);
+
+    return msg;
+}
+
+static bool group_has_member(struct ldb_message *grp, const char *name)
+{
+    struct ldb_message_element *el;
+    char *fqname;
+    char *dn;
+    bool found = false;
+    unsigned int i;
+
+    fqname = sss_create_internal_fqname(test_ctx, name, TEST_DOM_NAME);
+    assert_non_null(fqname);
+    dn = sysdb_user_strdn(test_ctx, TEST_DOM_NAME, fqname);
+    assert_non_null(dn);
+
+    el = ldb_msg_find_element(grp, SYSDB_MEMBER);
+    for (i = 0; el != NULL && i < el->num_values; i++) {
+        if (strcasecmp((const char *) el->values[i].data, dn) == 0) {
+            found = true;
+        }
+    }
+
+    talloc_free(fqname);
+    talloc_free(dn);
+    return found;
+}
+
+static int test_files_ops_setup(void **state)
+{
+    assert_true(leak_check_setup());
+
+    test_ctx = talloc_zero(global_talloc_context, struct files_ops_test_ctx);
+    assert_non_null(test_ctx);
+
+    test_dom_suite_setup(TESTS_PATH);
+
+    test_ctx->tctx = create_dom_test_ctx(test_ctx, TESTS_PATH, TEST_CONF_DB,
+                                         TEST_DOM_NAME, TEST_ID_PROVIDER,
+                                         NULL);
+    assert_non_null(test_ctx->tctx);
+
+    test_ctx->id_ctx = talloc_zero(test_ctx, struct files_id_ctx);
+    assert_non_null(test_ctx->id_ctx);
+    test_ctx->id_ctx->domain = test_ctx->tctx->dom;
+
+    test_ctx->id_ctx->be = talloc_zero(test_ctx->id_ctx, struct be_ctx);
+    assert_non_null(test_ctx->id_ctx->be);
+    test_ctx->id_ctx->be->ev = test_ctx->tctx->ev;
+    test_ctx->id_ctx->be->domain = test_ctx->tctx->dom;
+
+    test_ctx->id_ctx->passwd_files = talloc_zero_array(test_ctx->id_ctx,
+                                                       const char *, 2);
+    assert_non_null(test_ctx->id_ctx->passwd_files);
+    test_ctx->id_ctx->passwd_files[0] = TEST_PASSWD_FILE;
+
+    test_ctx->id_ctx->group_files = talloc_zero_array(test_ctx->id_ctx,
+                                                      const char *, 2);
+    assert_non_null(test_ctx->id_ctx->group_files);
+    test_ctx->id_ctx->group_files[0] = TEST_GROUP_FILE;
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_files_ops_teardown(void **state)
+{
+    talloc_zfree(test_ctx);
+    unlink(TEST_PASSWD_FILE);
+    unlink(TEST_GROUP_FILE);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    return 0;
+}
+
+static void test_diff_add(void **state)
+{
+    struct ldb_message *msg;
+
+    load_files(ALICE, "devs:x:2001:alice\n");
+
+    update_files(ALICE BOB,
+                 "devs:x:2001:alice\n"
+                 "ops:x:2002:bob\n");
+
+    msg = get_user("bob");
+    assert_non_null(msg);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0), 1002);
+
+    msg = get_group("ops");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "bob"));
+
+    /* New names and IDs may be in the negative cache */
+    assert_int_equal(test_ctx->users_ncache, 1);
+    assert_int_equal(test_ctx->groups_ncache, 1);
+    assert_true(initgr_notified("bob"));
+    assert_false(initgr_notified("alice"));
+    assert_false(uid_notified(1001));
+}
+
+static void test_diff_delete(void **state)
+{
+    load_files(ALICE BOB,
+               "devs:x:2001:alice,bob\n"
+               "ops:x:2002:bob\n");
+
+    update_files(ALICE, "devs:x:2001:alice\n");
+
+    assert_null(get_user("bob"));
+    assert_null(get_group("ops"));
+    assert_non_null(get_user("alice"));
+
+    assert_true(uid_notified(1002));
+    assert_true(gid_notified(2002));
+    assert_true(initgr_notified("bob"));
+    assert_false(uid_notified(1001));
+
+    /* Nothing new that could be in the negative cache */
+    assert_int_equal(test_ctx->users_ncache, 0);
+    assert_int_equal(test_ctx->groups_ncache, 0);
+}
+
+static void test_diff_modify(void **state)
+{
+    struct ldb_message *msg;
+
+    load_files(ALICE BOB, "devs:x:2001:alice,bob\n");
+
+    update_files("alice:x:1001:1001:Alice Smith:/home/alice:/bin/zsh\n" BOB,
+                 "devs:x:2001:alice,bob\n");
+
+    msg = get_user("alice");
+    assert_non_null(msg);
+    assert_string_equal(ldb_msg_find_attr_as_string(msg, SYSDB_SHELL, NULL),
+                        "/bin/zsh");
+    assert_string_equal(ldb_msg_find_attr_as_string(msg, SYSDB_GECOS, NULL),
+                        "Alice Smith");
+
+    /* Replacing the user entry must not lose its group memberships */
+    msg = get_group("devs");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "alice"));
+    assert_true(group_has_member(msg, "bob"));
+
+    assert_true(uid_notified(1001));
+    assert_false(uid_notified(1002));
+    assert_int_equal(test_ctx->users_ncache, 0);
+}
+
+static void test_diff_members(void **state)
+{
+    struct ldb_message *msg;
+
+    load_files(ALICE BOB,
+               "devs:x:2001:alice\n"
+               "ops:x:2002:alice,bob\n");
+
+    update_files(ALICE BOB,
+                 "devs:x:2001:alice,bob\n"
+                 "ops:x:2002:alice\n");
+
+    msg = get_group("devs");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "alice"));
+    assert_true(group_has_member(msg, "bob"));
+
+    msg = get_group("ops");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "alice"));
+    assert_false(group_has_member(msg, "bob"));
+
+    assert_true(gid_notified(2001));
+    assert_true(gid_notified(2002));
+    /* Only the initgroups of bob changed */
+    assert_true(initgr_notified("bob"));
+    assert_false(initgr_notified("alice"));
+    assert_int_equal(test_ctx->num_uids, 0);
+}
+
+static void test_diff_rename(void **state)
+{
+    struct ldb_message *msg;
+
+    load_files(ALICE BOB, "devs:x:2001:alice,bob\n");
+
+    update_files("alicia:x:1001:1001:Alice:/home/alice:/bin/bash\n" BOB,
+                 "devs:x:2001:alicia,bob\n");
+
+    assert_null(get_user("alice"));
+    msg = get_user("alicia");
+    assert_non_null(msg);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(msg, SYSDB_UIDNUM, 0), 1001);
+
+    msg = get_group("devs");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "alicia"));
+    assert_true(group_has_member(msg, "bob"));
+    assert_false(group_has_member(msg, "alice"));
+
+    assert_true(uid_notified(1001));
+    assert_true(initgr_notified("alice"));
+    assert_true(initgr_notified("alicia"));
+    /* The new name may be in the negative cache */
+    assert_int_equal(test_ctx->users_ncache, 1);
+}
+
+static void test_apply_users_touched(void **state)
+{
+    struct files_snapshot *old;
+    struct files_snapshot *new;
+    struct sf_changes *changes;
+    const char **touched;
+    size_t num_touched;
+    errno_t ret;
+
+    write_file(TEST_GROUP_FILE, "");
+    write_file(TEST_PASSWD_FILE,
+               ALICE BOB "carol:x:1003:1003:Carol:/home/carol:/bin/bash\n");
+    ret = sf_snapshot_read(test_ctx, test_ctx->id_ctx, SF_UPDATE_BOTH,
+                           NULL, &old);
+    assert_int_equal(ret, EOK);
+
+    write_file(TEST_PASSWD_FILE,
+               "carol:x:1003:1003:Carol:/home/carol:/bin/sh\n"
+               "dave:x:1004:1004:Dave:/home/dave:/bin/bash\n" ALICE);
+    ret = sf_snapshot_read(test_ctx, test_ctx->id_ctx, SF_UPDATE_BOTH,
+                           NULL, &new);
+    assert_int_equal(ret, EOK);
+
+    changes = sf_changes_new(test_ctx);
+    assert_non_null(changes);
+
+    ret = sysdb_transaction_start(test_ctx->tctx->sysdb);
+    assert_int_equal(ret, EOK);
+    ret = sf_apply_users(test_ctx, test_ctx->id_ctx, old, new, changes,
+                         &touched, &num_touched);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_transaction_commit(test_ctx->tctx->sysdb);
+    assert_int_equal(ret, EOK);
+
+    /* The unchanged alice is not touched, the list is sorted */
+    assert_int_equal(num_touched, 3);
+    assert_string_equal(touched[0], "bob");
+    assert_string_equal(touched[1], "carol");
+    assert_string_equal(touched[2], "dave");
+    assert_null(touched[3]);
+
+    assert_true(changes->users_written);
+    assert_true(changes->new_users);
+    assert_non_null(get_user("dave"));
+
+    talloc_free(old);
+    talloc_free(new);
+    talloc_free(changes);
+    talloc_free(touched);
+}
+
+static void test_diff_duplicate_names(void **state)
+{
+    struct ldb_message *msg;
+
+    load_files(ALICE, "devs:x:2001:alice\n");
+
+    /* The last entry wins, the same as when saving the entries one by one */
+    update_files(ALICE "alice:x:1001:1001:Alice:/home/alice:/bin/zsh\n",
+                 "devs:x:2001:alice\n");
+
+    msg = get_user("alice");
+    assert_non_null(msg);
+    assert_string_equal(ldb_msg_find_attr_as_string(msg, SYSDB_SHELL, NULL),
+                        "/bin/zsh");
+}
+
+static void sf_enum_files_test_done(struct tevent_req *req)
+{
+    errno_t ret;
+
+    ret = sf_enum_files_recv(req);
+    talloc_zfree(req);
+
+    test_ev_done(test_ctx->tctx, ret);
+}
+
+static void test_diff_fallback(void **state)
+{
+    struct tevent_req *req;
+    struct ldb_message *msg;
+    errno_t ret;
+
+    load_files(ALICE, "devs:x:2001:alice\n");
+
+    write_file(TEST_PASSWD_FILE, ALICE BOB);
+    write_file(TEST_GROUP_FILE, "devs:x:2001:alice,bob\n");
+
+    /* The incremental update fails, all entries are loaded again */
+    test_ctx->fail_transaction_start = true;
+
+    req = sf_enum_files_send(test_ctx->id_ctx,
+                             SF_UPDATE_BOTH | SF_UPDATE_IMMEDIATE);
+    assert_non_null(req);
+    tevent_req_set_callback(req, sf_enum_files_test_done, NULL);
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+    assert_false(test_ctx->fail_transaction_start);
+
+    msg = get_user("bob");
+    assert_non_null(msg);
+    msg = get_group("devs");
+    assert_non_null(msg);
+    assert_true(group_has_member(msg, "alice"));
+    assert_true(group_has_member(msg, "bob"));
+
+    /* A full reload resets all caches */
+    assert_int_equal(test_ctx->inconsistent, 1);
+    assert_int_equal(test_ctx->users_ncache, 1);
+    assert_int_equal(test_ctx->groups_ncache, 1);
+    assert_int_equal(test_ctx->users_memcache, 1);
+    assert_int_equal(test_ctx->groups_memcache, 1);
+
+    /* The snapshot is built again for the next update */
+    assert_non_null(test_ctx->id_ctx->snapshot);
+    assert_int_equal(test_ctx->id_ctx->snapshot->num_users, 2);
+    assert_int_equal(test_ctx->id_ctx->snapshot->num_groups, 1);
+}
+
+static void test_notification_resets_caches(void **state)
+{
+    int ret;
+
+    load_files(ALICE, "devs:x:2001:alice\n");
+    assert_non_null(test_ctx->id_ctx->snapshot);
+
+    /* The lookups must not be answered from the negative or the memory
+     * cache until the diff is written */
+    ret = sf_passwd_cb(TEST_PASSWD_FILE, 0, test_ctx->id_ctx);
+    assert_int_equal(ret, EOK);
+
+    assert_int_equal(test_ctx->inconsistent, 1);
+    assert_int_equal(test_ctx->users_ncache, 1);
+    assert_int_equal(test_ctx->users_memcache, 1);
+    assert_int_equal(test_ctx->initgr_memcache, 1);
+
+    reset_notified();
+    ret = sf_group_cb(TEST_GROUP_FILE, 0, test_ctx->id_ctx);
+    assert_int_equal(ret, EOK);
+
+    assert_int_equal(test_ctx->inconsistent, 1);
+    assert_int_equal(test_ctx->groups_ncache, 1);
+    assert_int_equal(test_ctx->groups_memcache, 1);
+}
+
+int main(int argc, const char *argv[])
+{
+    int rv;
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_diff_add,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_delete,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_modify,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_members,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_rename,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_apply_users_touched,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_duplicate_names,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_diff_fallback,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+        cmocka_unit_test_setup_teardown(test_notification_resets_caches,
+                                        test_files_ops_setup,
+                                        test_files_ops_teardown),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    tests_set_cwd();
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    rv = cmocka_run_group_tests(tests, NULL, NULL);
+    if (rv == 0) {
+        test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    }
+    return rv;
+}
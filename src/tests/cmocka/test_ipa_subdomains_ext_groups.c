@@ -0,0 +1,548 @@
+/*
+    SSSD
+
+    SSSD tests: IPA external group memberships of AD users
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <talloc.h>
+#include <tevent.h>
+#include <errno.h>
+#include <popt.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "tests/cmocka/common_mock_sdap.h"
+#include "tests/cmocka/common_mock_be.h"
+
+/* Make sure the static functions are available to the tests */
+#include "providers/ipa/ipa_subdomains_ext_groups.c"
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "test_ipa_ext_groups_conf.ldb"
+#define TEST_DOM_NAME "ipa_ext_groups_test"
+#define TEST_ID_PROVIDER "ldap"
+
+#define TEST_USER_NAME "user1"
+#define TEST_GROUP_DN_FMT "cn=group%d,cn=groups,cn=accounts,dc=ipa,dc=test"
+#define TEST_MAX_GROUPS 16
+
+#define new_test(test) \
+    cmocka_unit_test_setup_teardown(ext_groups_test_ ## test, \
+                                    ext_groups_test_setup, \
+                                    ext_groups_test_teardown)
+
+struct ext_groups_test_ctx {
+    struct sss_test_ctx *tctx;
+
+    struct be_ctx *be_ctx;
+    struct sdap_options *sdap_opts;
+    struct sdap_id_ctx *sdap_id_ctx;
+    struct ldb_dn *user_dn;
+    const char *user_name;
+
+    /* groups which the server returns and lookups which fail */
+    bool on_server[TEST_MAX_GROUPS];
+    errno_t lookup_error[TEST_MAX_GROUPS];
+
+    /* groups which were looked up, in the order of the lookups */
+    int lookups[TEST_MAX_GROUPS];
+    size_t num_lookups;
+    size_t running;
+    size_t max_running;
+};
+
+static struct ext_groups_test_ctx *test_ctx;
+
+static const char *test_group_dn(TALLOC_CTX *mem_ctx, int idx)
+{
+    const char *dn;
+
+    dn = talloc_asprintf(mem_ctx, TEST_GROUP_DN_FMT, idx);
+    assert_non_null(dn);
+
+    return dn;
+}
+
+static void store_group(int idx)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct sysdb_attrs *attrs;
+    char *name;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    attrs = sysdb_new_attrs(tmp_ctx);
+    assert_non_null(attrs);
+
+    ret = sysdb_attrs_add_string(attrs, SYSDB_ORIG_DN,
+                                 test_group_dn(tmp_ctx, idx));
+    assert_int_equal(ret, EOK);
+
+    name = talloc_asprintf(tmp_ctx, "group%d", idx);
+    assert_non_null(name);
+    name = sss_create_internal_fqname(tmp_ctx, name,
+                                      test_ctx->tctx->dom->name);
+    assert_non_null(name);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, name, 10000 + idx, attrs,
+                            0, time(NULL));
+    assert_int_equal(ret, EOK);
+
+    talloc_free(tmp_ctx);
+}
+
+struct sdap_id_op *__wrap_sdap_id_op_create(TALLOC_CTX *memctx,
+                                            struct sdap_id_conn_cache *cache)
+{
+    return (struct sdap_id_op *) talloc_new(memctx);
+}
+
+struct test_connect_state {
+    int dummy;
+};
+
+struct tevent_req *__wrap_sdap_id_op_connect_send(struct sdap_id_op *op,
+                                                  TALLOC_CTX *memctx,
+                                                  int *ret_out)
+{
+    struct tevent_req *req;
+    struct test_connect_state *state;
+
+    req = tevent_req_create(memctx, &state, struct test_connect_state);
+    assert_non_null(req);
+
+    *ret_out = EOK;
+    tevent_req_done(req);
+    tevent_req_post(req, test_ctx->tctx->ev);
+
+    return req;
+}
+
+int __wrap_sdap_id_op_connect_recv(struct tevent_req *req, int *dp_error)
+{
+    *dp_error = DP_ERR_OK;
+    return EOK;
+}
+
+struct test_groups_get_state {
+    errno_t ret;
+};
+
+struct tevent_req *__wrap_groups_get_send(TALLOC_CTX *memctx,
+                                          struct tevent_context *ev,
+                                          struct sdap_id_ctx *ctx,
+                                          struct sdap_domain *sdom,
+                                          struct sdap_id_conn_ctx *conn,
+                                          const char *name,
+                                          int filter_type,
+                                          bool noexist_delete,
+                                          bool no_members,
+                                          bool set_non_posix)
+{
+    struct tevent_req *req;
+    struct test_groups_get_state *state;
+    char *shortname;
+    int idx;
+    errno_t ret;
+
+    req = tevent_req_create(memctx, &state, struct test_groups_get_state);
+    assert_non_null(req);
+
+    /* a single group lookup which removes groups missing on the server */
+    assert_int_equal(filter_type, BE_FILTER_NAME);
+    assert_true(noexist_delete);
+    assert_false(no_members);
+
+    /* never more than one chunk of lookups at the same time */
+    test_ctx->running++;
+    assert_true(test_ctx->running <= IPA_EXT_GROUPS_LOOKUP_CHUNK);
+    test_ctx->max_running = MAX(test_ctx->max_running, test_ctx->running);
+
+    ret = sss_parse_internal_fqname(state, name, &shortname, NULL);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(sscanf(shortname, "group%d", &idx), 1);
+    assert_true(idx >= 0 && idx < TEST_MAX_GROUPS);
+
+    test_ctx->lookups[test_ctx->num_lookups] = idx;
+    test_ctx->num_lookups++;
+
+    state->ret = test_ctx->lookup_error[idx];
+    if (state->ret == EOK && test_ctx->on_server[idx]) {
+        store_group(idx);
+    }
+
+    tevent_req_done(req);
+    tevent_req_post(req, ev);
+
+    return req;
+}
+
+int __wrap_groups_get_recv(struct tevent_req *req, int *dp_error_out,
+                           int *sdap_ret)
+{
+    struct test_groups_get_state *state;
+
+    state = tevent_req_data(req, struct test_groups_get_state);
+    test_ctx->running--;
+
+    if (dp_error_out) {
+        *dp_error_out = state->ret == EOK ? DP_ERR_OK : DP_ERR_FATAL;
+    }
+
+    if (sdap_ret) {
+        *sdap_ret = state->ret;
+    }
+
+    return state->ret;
+}
+
+/* The SID based lookups of the external group members are not used by the
+ * tested request */
+struct tevent_req *__wrap_dp_req_send(TALLOC_CTX *mem_ctx,
+                                      struct data_provider *provider,
+                                      const char *domain,
+                                      const char *name,
+                                      uint32_t cli_id,
+                                      const char *sender_name,
+                                      enum dp_targets target,
+                                      enum dp_methods method,
+                                      uint32_t dp_flags,
+                                      void *request_data,
+                                      const char **_request_name)
+{
+    fail();
+    return NULL;
+}
+
+errno_t __wrap__dp_req_recv(TALLOC_CTX *mem_ctx,
+                            struct tevent_req *req,
+                            const char *data_type,
+                            void **_data)
+{
+    fail();
+    return EINVAL;
+}
+
+errno_t __wrap_get_dp_id_data_for_sid(TALLOC_CTX *mem_ctx, const char *sid,
+                                      const char *domain_name,
+                                      struct dp_id_data **_ar)
+{
+    fail();
+    return EINVAL;
+}
+
+static void ext_groups_test_done(struct tevent_req *req)
+{
+    struct ext_groups_test_ctx *ctx;
+    int dp_error;
+
+    ctx = tevent_req_callback_data(req, struct ext_groups_test_ctx);
+
+    ctx->tctx->error = ipa_add_ad_memberships_recv(req, &dp_error);
+    talloc_zfree(req);
+
+    ctx->tctx->done = true;
+}
+
+static errno_t run_add_ad_memberships(int num_groups, const bool *cached)
+{
+    TALLOC_CTX *req_mem_ctx;
+    struct tevent_req *req;
+    char **groups;
+    int i;
+    errno_t ret;
+
+    groups = talloc_zero_array(test_ctx, char *, num_groups + 1);
+    assert_non_null(groups);
+
+    for (i = 0; i < num_groups; i++) {
+        groups[i] = talloc_asprintf(groups, TEST_GROUP_DN_FMT, i);
+        assert_non_null(groups[i]);
+
+        if (cached[i]) {
+            store_group(i);
+        }
+    }
+
+    req_mem_ctx = talloc_new(global_talloc_context);
+    assert_non_null(req_mem_ctx);
+    check_leaks_push(req_mem_ctx);
+
+    req = ipa_add_ad_memberships_send(req_mem_ctx, test_ctx->tctx->ev,
+                                      test_ctx->sdap_id_ctx,
+                                      test_ctx->user_dn,
+                                      test_ctx->tctx->dom, groups,
+                                      test_ctx->tctx->dom);
+    assert_non_null(req);
+    tevent_req_set_callback(req, ext_groups_test_done, test_ctx);
+
+    ret = test_ev_loop(test_ctx->tctx);
+    assert_true(check_leaks_pop(req_mem_ctx) == true);
+    talloc_zfree(req_mem_ctx);
+    talloc_free(groups);
+
+    assert_int_equal(test_ctx->running, 0);
+
+    return ret;
+}
+
+static void assert_lookups(const int *expected, size_t count)
+{
+    size_t i;
+
+    assert_int_equal(test_ctx->num_lookups, count);
+    for (i = 0; i < count; i++) {
+        assert_int_equal(test_ctx->lookups[i], expected[i]);
+    }
+}
+
+static void assert_memberships(const bool *member, int num_groups)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct ldb_message *msg;
+    struct ldb_message_element *el;
+    const char *attrs[] = { SYSDB_ORIG_MEMBEROF, NULL };
+    size_t count = 0;
+    int i;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    ret = sysdb_search_user_by_name(tmp_ctx, test_ctx->tctx->dom,
+                                    test_ctx->user_name, attrs, &msg);
+    assert_int_equal(ret, EOK);
+
+    for (i = 0; i < num_groups; i++) {
+        assert_int_equal(ldb_msg_check_string_attribute(msg,
+                                              SYSDB_ORIG_MEMBEROF,
+                                              test_group_dn(tmp_ctx, i)),
+                         member[i] ? 1 : 0);
+        if (member[i]) {
+            count++;
+        }
+    }
+
+    el = ldb_msg_find_element(msg, SYSDB_ORIG_MEMBEROF);
+    assert_int_equal(el == NULL ? 0 : el->num_values, count);
+
+    talloc_free(tmp_ctx);
+}
+
+static void ext_groups_test_all_cached(void **state)
+{
+    const bool cached[] = { true, true, true };
+    const bool member[] = { true, true, true };
+    errno_t ret;
+
+    ret = run_add_ad_memberships(3, cached);
+    assert_int_equal(ret, EOK);
+
+    assert_lookups(NULL, 0);
+    assert_memberships(member, 3);
+}
+
+static void ext_groups_test_full_chunks(void **state)
+{
+    const bool cached[] = { false, false, false, false };
+    const bool member[] = { true, true, true, true };
+    const int lookups[] = { 0, 1, 2, 3 };
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        test_ctx->on_server[i] = true;
+    }
+
+    ret = run_add_ad_memberships(4, cached);
+    assert_int_equal(ret, EOK);
+
+    assert_lookups(lookups, 4);
+    assert_int_equal(test_ctx->max_running, IPA_EXT_GROUPS_LOOKUP_CHUNK);
+    assert_memberships(member, 4);
+}
+
+static void ext_groups_test_partial_chunk(void **state)
+{
+    const bool cached[] = { true, false, false, true, false, false, false };
+    const bool member[] = { true, true, true, true, true, true, true };
+    const int lookups[] = { 1, 2, 4, 5, 6 };
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < 7; i++) {
+        test_ctx->on_server[i] = true;
+    }
+
+    ret = run_add_ad_memberships(7, cached);
+    assert_int_equal(ret, EOK);
+
+    /* cached groups do not count against the chunk */
+    assert_lookups(lookups, 5);
+    assert_int_equal(test_ctx->max_running, IPA_EXT_GROUPS_LOOKUP_CHUNK);
+    assert_memberships(member, 7);
+}
+
+static void ext_groups_test_not_found(void **state)
+{
+    const bool cached[] = { false, false, false };
+    const bool member[] = { true, false, true };
+    const int lookups[] = { 0, 1, 2 };
+    errno_t ret;
+
+    test_ctx->on_server[0] = true;
+    test_ctx->on_server[2] = true;
+
+    /* a group which does not exist does not fail the request */
+    ret = run_add_ad_memberships(3, cached);
+    assert_int_equal(ret, EOK);
+
+    assert_lookups(lookups, 3);
+    assert_memberships(member, 3);
+}
+
+static void ext_groups_test_lookup_error(void **state)
+{
+    const bool cached[] = { false, false, false, false };
+    const bool member[] = { false, false, false, false };
+    const int lookups[] = { 0, 1 };
+    errno_t ret;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        test_ctx->on_server[i] = true;
+    }
+    test_ctx->lookup_error[1] = EIO;
+
+    ret = run_add_ad_memberships(4, cached);
+    assert_int_equal(ret, EIO);
+
+    /* the next chunk is not started after an error */
+    assert_lookups(lookups, 2);
+    assert_memberships(member, 4);
+}
+
+static int ext_groups_test_setup(void **state)
+{
+    errno_t ret;
+    char *orig_dn;
+
+    test_ctx = talloc_zero(NULL, struct ext_groups_test_ctx);
+    assert_non_null(test_ctx);
+    *state = test_ctx;
+
+    test_ctx->tctx = create_dom_test_ctx(test_ctx, TESTS_PATH, TEST_CONF_DB,
+                                         TEST_DOM_NAME,
+                                         TEST_ID_PROVIDER, NULL);
+    assert_non_null(test_ctx->tctx);
+
+    test_ctx->sdap_opts = mock_sdap_options_ldap(test_ctx,
+                                                 test_ctx->tctx->dom,
+                                                 test_ctx->tctx->confdb,
+                                                 test_ctx->tctx->conf_dom_path);
+    assert_non_null(test_ctx->sdap_opts);
+
+    test_ctx->be_ctx = mock_be_ctx(test_ctx, test_ctx->tctx);
+    assert_non_null(test_ctx->be_ctx);
+
+    test_ctx->sdap_id_ctx = mock_sdap_id_ctx(test_ctx,
+                                             test_ctx->be_ctx,
+                                             test_ctx->sdap_opts);
+    assert_non_null(test_ctx->sdap_id_ctx);
+
+    test_ctx->sdap_id_ctx->conn = talloc_zero(test_ctx->sdap_id_ctx,
+                                              struct sdap_id_conn_ctx);
+    assert_non_null(test_ctx->sdap_id_ctx->conn);
+
+    test_ctx->user_name = sss_create_internal_fqname(test_ctx,
+                                                     TEST_USER_NAME,
+                                                     test_ctx->tctx->dom->name);
+    assert_non_null(test_ctx->user_name);
+
+    orig_dn = talloc_asprintf(test_ctx, "cn=%s,cn=users,dc=ad,dc=test",
+                              TEST_USER_NAME);
+    assert_non_null(orig_dn);
+
+    ret = sysdb_store_user(test_ctx->tctx->dom, test_ctx->user_name, NULL,
+                           2001, 0, NULL, NULL, NULL, orig_dn, NULL, NULL,
+                           0, time(NULL));
+    assert_int_equal(ret, EOK);
+
+    test_ctx->user_dn = sysdb_user_dn(test_ctx, test_ctx->tctx->dom,
+                                      test_ctx->user_name);
+    assert_non_null(test_ctx->user_dn);
+
+    return 0;
+}
+
+static int ext_groups_test_teardown(void **state)
+{
+    talloc_zfree(test_ctx);
+    return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+    int rv;
+    int no_cleanup = 0;
+    poptContext pc;
+    int opt;
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        SSSD_DEBUG_OPTS
+        {"no-cleanup", 'n', POPT_ARG_NONE, &no_cleanup, 0,
+         _("Do not delete the test database after a test run"), NULL },
+        POPT_TABLEEND
+    };
+
+    const struct CMUnitTest tests[] = {
+        new_test(all_cached),
+        new_test(full_chunks),
+        new_test(partial_chunk),
+        new_test(not_found),
+        new_test(lookup_error),
+    };
+
+    /* Set debug level to invalid value so we can decide if -d 0 was used. */
+    debug_level = SSSDBG_INVALID;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while((opt = poptGetNextOpt(pc)) != -1) {
+        switch(opt) {
+        default:
+            fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                    poptBadOption(pc, 0), poptStrerror(opt));
+            poptPrintUsage(pc, stderr, 0);
+            return 1;
+        }
+    }
+    poptFreeContext(pc);
+
+    DEBUG_CLI_INIT(debug_level);
+
+    /* Even though normally the tests should clean up after themselves
+     * they might not after a failed run. Remove the old DB to be sure */
+    tests_set_cwd();
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    test_dom_suite_setup(TESTS_PATH);
+
+    rv = cmocka_run_group_tests(tests, NULL, NULL);
+    if (rv == 0 && !no_cleanup) {
+        test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    }
+    return rv;
+}
@@ -163,6 +163,7 @@ struct pam_test_ctx {
     const char *pam_user_fqdn;
     const char *wrong_user_fqdn;
     int child_status;
+    uint32_t transaction_token;
 };
 
 /* Must be global because it is needed in some wrappers */
@@ -179,6 +180,9 @@ struct pam_ctx *mock_pctx(TALLOC_CTX *mem_ctx)
     ret = sss_hash_create(pctx, 10, &pctx->id_table);
     assert_int_equal(ret, EOK);
 
+    ret = sss_hash_create(pctx, 10, &pctx->transaction_table);
+    assert_int_equal(ret, EOK);
+
     /* Two NULLs so that tests can just assign a const to the first slot
      * should they need it. The code iterates until first NULL anyway
      */
@@ -769,11 +773,54 @@ static void mock_input_pam(TALLOC_CTX *mem_ctx,
     return mock_input_pam_ex(mem_ctx, name, pwd, fa2, NULL, false);
 }
 
-static void mock_input_pam_cert(TALLOC_CTX *mem_ctx, const char *name,
-                                const char *pin, const char *token_name,
-                                const char *module_name, const char *key_id,
-                                const char *label, const char *service,
-                                acct_cb_t acct_cb, const char *cert)
+static void mock_input_pam_transaction(TALLOC_CTX *mem_ctx,
+                                       const char *name,
+                                       uint32_t transaction_token)
+{
+    size_t buf_size;
+    uint8_t *m_buf;
+    uint8_t *buf;
+    struct pam_items pi = { 0 };
+    int ret;
+
+    pi.pam_user = name;
+    pi.pam_user_size = strlen(pi.pam_user) + 1;
+    pi.pam_service = "pam_test_service";
+    pi.pam_service_size = strlen(pi.pam_service) + 1;
+    pi.pam_tty = "/dev/tty";
+    pi.pam_tty_size = strlen(pi.pam_tty) + 1;
+    pi.pam_ruser = "remuser";
+    pi.pam_ruser_size = strlen(pi.pam_ruser) + 1;
+    pi.pam_rhost = "remhost";
+    pi.pam_rhost_size = strlen(pi.pam_rhost) + 1;
+    pi.requested_domains = "";
+    pi.cli_pid = 12345;
+    pi.flags = PAM_CLI_FLAGS_TRANSACTION;
+    pi.transaction_token = transaction_token;
+
+    ret = pack_message_v3(&pi, &buf_size, &m_buf);
+    assert_int_equal(ret, 0);
+
+    buf = talloc_memdup(mem_ctx, m_buf, buf_size);
+    free(m_buf);
+    assert_non_null(buf);
+
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_WRAPPER);
+    will_return(__wrap_sss_packet_get_body, buf);
+    will_return(__wrap_sss_packet_get_body, buf_size);
+
+    /* A reused transaction does not look the name up again */
+    if (transaction_token == 0) {
+        mock_parse_inp(name, NULL, EOK);
+    }
+}
+
+static void mock_input_pam_cert_ex(TALLOC_CTX *mem_ctx, const char *name,
+                                   const char *pin, const char *token_name,
+                                   const char *module_name, const char *key_id,
+                                   const char *label, const char *service,
+                                   acct_cb_t acct_cb, const char *cert,
+                                   uint32_t transaction_token)
 {
     size_t buf_size;
     uint8_t *m_buf;
@@ -818,6 +865,7 @@ static void mock_input_pam_cert(TALLOC_CTX *mem_ctx, const char *name,
     pi.pam_rhost_size = strlen(pi.pam_rhost) + 1;
     pi.requested_domains = "";
     pi.cli_pid = 12345;
+    pi.transaction_token = transaction_token;
 
     ret = pack_message_v3(&pi, &buf_size, &m_buf);
     free(pi.pam_authtok);
@@ -835,11 +883,22 @@ static void mock_input_pam_cert(TALLOC_CTX *mem_ctx, const char *name,
         mock_account_recv(0, 0, NULL, acct_cb, discard_const(cert));
     }
 
-    if (name != NULL) {
+    /* A reused transaction does not look the name up again */
+    if (name != NULL && transaction_token == 0) {
         mock_parse_inp(name, NULL, EOK);
     }
 }
 
+static void mock_input_pam_cert(TALLOC_CTX *mem_ctx, const char *name,
+                                const char *pin, const char *token_name,
+                                const char *module_name, const char *key_id,
+                                const char *label, const char *service,
+                                acct_cb_t acct_cb, const char *cert)
+{
+    mock_input_pam_cert_ex(mem_ctx, name, pin, token_name, module_name,
+                           key_id, label, service, acct_cb, cert, 0);
+}
+
 #ifdef BUILD_PASSKEY
 static int test_pam_passkey_preauth_check(uint32_t status, uint8_t *body, size_t blen)
 {
@@ -1019,6 +1078,50 @@ static int test_pam_simple_check(uint32_t status, uint8_t *body, size_t blen)
     return EOK;
 }
 
+static int test_pam_transaction_check(uint32_t status, uint8_t *body,
+                                      size_t blen)
+{
+    size_t rp = 0;
+    uint32_t val;
+    uint32_t num;
+    uint32_t type;
+    bool found_domain = false;
+
+    assert_int_equal(status, 0);
+
+    SAFEALIGN_COPY_UINT32(&val, body + rp, &rp);
+    assert_int_equal(val, pam_test_ctx->exp_pam_status);
+
+    SAFEALIGN_COPY_UINT32(&num, body + rp, &rp);
+    assert_int_equal(num, 2);
+
+    pam_test_ctx->transaction_token = 0;
+    for (; num > 0; num--) {
+        SAFEALIGN_COPY_UINT32(&type, body + rp, &rp);
+        SAFEALIGN_COPY_UINT32(&val, body + rp, &rp);
+
+        switch (type) {
+        case SSS_PAM_DOMAIN_NAME:
+            assert_int_equal(val, 9);
+            assert_string_equal((char *)(body + rp), TEST_DOM_NAME);
+            found_domain = true;
+            break;
+        case SSS_PAM_TRANSACTION_TOKEN:
+            assert_int_equal(val, sizeof(uint32_t));
+            memcpy(&pam_test_ctx->transaction_token, body + rp, val);
+            break;
+        default:
+            fail();
+        }
+        rp += val;
+    }
+
+    assert_true(found_domain);
+    assert_int_not_equal(pam_test_ctx->transaction_token, 0);
+
+    return EOK;
+}
+
 #define PKCS11_LOGIN_TOKEN_ENV_NAME "PKCS11_LOGIN_TOKEN_NAME"
 
 static int test_pam_cert_check_gdm_smartcard(uint32_t status, uint8_t *body,
@@ -1595,6 +1698,159 @@ void test_pam_acct_mgmt(void **state)
     assert_int_equal(ret, EOK);
 }
 
+void test_pam_acct_mgmt_transaction(void **state)
+{
+    int ret;
+    struct pam_transaction *transaction;
+
+    /* The first request starts a transaction */
+    mock_input_pam_transaction(pam_test_ctx, "pamuser", 0);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_ACCT_MGMT);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    set_cmd_cb(test_pam_transaction_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_ACCT_MGMT,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    ret = pam_transaction_get(pam_test_ctx->pctx->transaction_table,
+                              pam_test_ctx->transaction_token,
+                              client_euid(pam_test_ctx->cctx->creds),
+                              "pamuser", "pam_test_service", &transaction);
+    assert_int_equal(ret, EOK);
+
+    /* The transaction is bound to the user and service */
+    ret = pam_transaction_get(pam_test_ctx->pctx->transaction_table,
+                              pam_test_ctx->transaction_token,
+                              client_euid(pam_test_ctx->cctx->creds),
+                              "wronguser", "pam_test_service", &transaction);
+    assert_int_equal(ret, ENOENT);
+
+    /* The next step reuses it and does not get a new token */
+    pam_test_ctx->tctx->done = false;
+    mock_input_pam_transaction(pam_test_ctx, "pamuser",
+                               pam_test_ctx->transaction_token);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_ACCT_MGMT);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    set_cmd_cb(test_pam_simple_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_ACCT_MGMT,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+}
+
+/* Starts a transaction for pamuser as if an earlier step resolved it */
+static uint32_t pam_test_start_transaction(const char *service)
+{
+    struct ldb_result *res;
+    uint32_t token;
+    errno_t ret;
+
+    ret = sysdb_getpwnam(pam_test_ctx, pam_test_ctx->tctx->dom,
+                         pam_test_ctx->pam_user_fqdn, &res);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(res->count, 1);
+
+    ret = pam_transaction_set(pam_test_ctx->tctx->ev,
+                              pam_test_ctx->pctx->transaction_table,
+                              pam_test_ctx->pctx->id_timeout,
+                              client_euid(pam_test_ctx->cctx->creds),
+                              "pamuser", service,
+                              pam_test_ctx->tctx->dom->name,
+                              res->msgs[0], &token);
+    assert_int_equal(ret, EOK);
+    talloc_free(res);
+
+    return token;
+}
+
+void test_pam_acct_mgmt_transaction_user_changed(void **state)
+{
+    int ret;
+    uint32_t token;
+    struct pam_transaction *transaction;
+    struct sysdb_attrs *attrs;
+
+    token = pam_test_start_transaction("pam_test_service");
+
+    /* The user is refreshed after the transaction started */
+    attrs = sysdb_new_attrs(pam_test_ctx);
+    assert_non_null(attrs);
+    ret = sysdb_attrs_add_time_t(attrs, SYSDB_LAST_UPDATE, time(NULL) + 1);
+    assert_int_equal(ret, EOK);
+    ret = sysdb_set_user_attr(pam_test_ctx->tctx->dom,
+                              pam_test_ctx->pam_user_fqdn,
+                              attrs, SYSDB_MOD_REP);
+    assert_int_equal(ret, EOK);
+
+    /* The stale transaction is dropped, the user is looked up again and a
+     * new transaction is started */
+    mock_input_pam_transaction(pam_test_ctx, "pamuser", token);
+    mock_parse_inp("pamuser", NULL, EOK);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_ACCT_MGMT);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    set_cmd_cb(test_pam_transaction_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_ACCT_MGMT,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    assert_int_not_equal(pam_test_ctx->transaction_token, token);
+    ret = pam_transaction_get(pam_test_ctx->pctx->transaction_table, token,
+                              client_euid(pam_test_ctx->cctx->creds),
+                              "pamuser", "pam_test_service", &transaction);
+    assert_int_equal(ret, ENOENT);
+}
+
+void test_pam_acct_mgmt_transaction_user_deleted(void **state)
+{
+    int ret;
+    uint32_t token;
+    struct pam_transaction *transaction;
+
+    token = pam_test_start_transaction("pam_test_service");
+
+    ret = sysdb_delete_user(pam_test_ctx->tctx->dom,
+                            pam_test_ctx->pam_user_fqdn, 0);
+    assert_int_equal(ret, EOK);
+
+    /* The deleted user must not be served from the transaction */
+    mock_input_pam_transaction(pam_test_ctx, "pamuser", token);
+    /* Once from the cache and once more after asking the backend */
+    mock_parse_inp("pamuser", NULL, EOK);
+    mock_account_recv_simple();
+    mock_parse_inp("pamuser", NULL, EOK);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_ACCT_MGMT);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    pam_test_ctx->exp_pam_status = PAM_USER_UNKNOWN;
+    set_cmd_cb(test_pam_user_unknown_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_ACCT_MGMT,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+
+    ret = pam_transaction_get(pam_test_ctx->pctx->transaction_table, token,
+                              client_euid(pam_test_ctx->cctx->creds),
+                              "pamuser", "pam_test_service", &transaction);
+    assert_int_equal(ret, ENOENT);
+}
+
 void test_pam_open_session(void **state)
 {
     int ret;
@@ -2509,6 +2765,36 @@ void test_pam_preauth_cert_match(void **state)
     assert_int_equal(ret, EOK);
 }
 
+/* The user found by certificate is taken from the transaction and the
+ * request must be forwarded exactly once */
+void test_pam_preauth_cert_match_transaction(void **state)
+{
+    int ret;
+    uint32_t token;
+
+    set_cert_auth_param(pam_test_ctx->pctx, CA_DB);
+
+    token = pam_test_start_transaction("login");
+
+    mock_input_pam_cert_ex(pam_test_ctx, "pamuser", NULL, NULL, NULL, NULL,
+                           NULL, NULL, test_lookup_by_cert_cb,
+                           SSSD_TEST_CERT_0001, token);
+
+    will_return(__wrap_sss_packet_get_cmd, SSS_PAM_PREAUTH);
+    will_return(__wrap_sss_packet_get_body, WRAP_CALL_REAL);
+
+    /* Only one reply is expected, a second one would find no check
+     * callback queued and fail the test */
+    set_cmd_cb(test_pam_cert_check);
+    ret = sss_cmd_execute(pam_test_ctx->cctx, SSS_PAM_PREAUTH,
+                          pam_test_ctx->pam_cmds);
+    assert_int_equal(ret, EOK);
+
+    /* Wait until the test finishes with EOK */
+    ret = test_ev_loop(pam_test_ctx->tctx);
+    assert_int_equal(ret, EOK);
+}
+
 /* Test if PKCS11_LOGIN_TOKEN_NAME is added for the gdm-smartcard service */
 void test_pam_preauth_cert_match_gdm_smartcard(void **state)
 {
@@ -4946,6 +5232,12 @@ int main(int argc, const char *argv[])
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_acct_mgmt,
                                         pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_acct_mgmt_transaction,
+                                        pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_acct_mgmt_transaction_user_changed,
+                                        pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_acct_mgmt_transaction_user_deleted,
+                                        pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_open_session,
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_close_session,
@@ -5022,6 +5314,8 @@ int main(int argc, const char *argv[])
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match,
                                         pam_test_setup, pam_test_teardown),
+        cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_transaction,
+                                        pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_gdm_smartcard,
                                         pam_test_setup, pam_test_teardown),
         cmocka_unit_test_setup_teardown(test_pam_preauth_cert_match_wrong_user,
@@ -27,6 +27,7 @@
 
 #include "tests/cmocka/common_mock.h"
 #include "tests/cmocka/common_mock_resp.h"
+#include "responder/common/responder_packet.h"
 
 #define TESTS_PATH "tp_" BASE_FILE_STEM
 #define TEST_CONF_DB "test_responder_conf.ldb"
@@ -41,6 +42,7 @@
 struct cli_protocol_version *register_cli_protocol_version(void)
 {
     static struct cli_protocol_version responder_test_cli_protocol_version[] = {
+        { 1, "2024-01-01", "test version" },
         { 0, NULL, NULL }
     };
 
@@ -290,6 +292,51 @@ void test_sss_output_fqname(void **state)
     talloc_zfree(res);
 }
 
+void test_inline_protocol_version(void **state)
+{
+    struct parse_inp_test_ctx *parse_inp_ctx = talloc_get_type(*state,
+                                                   struct parse_inp_test_ctx);
+    struct cli_ctx *cctx;
+    struct cli_protocol *prctx;
+    errno_t ret;
+
+    cctx = mock_cctx(parse_inp_ctx, parse_inp_ctx->rctx);
+    assert_non_null(cctx);
+    prctx = mock_prctx(cctx);
+    assert_non_null(prctx);
+    cctx->protocol_ctx = prctx;
+
+    ret = sss_packet_new(prctx->creq, 0, SSS_NSS_GETPWNAM, &prctx->creq->in);
+    assert_int_equal(ret, EOK);
+
+    /* Legacy client without a version in the header */
+    ret = sss_cmd_check_inline_version(cctx);
+    assert_int_equal(ret, EOK);
+    assert_null(prctx->cli_protocol_version);
+
+    /* Supported version is accepted */
+    sss_packet_set_version(prctx->creq->in, 1);
+    ret = sss_cmd_check_inline_version(cctx);
+    assert_int_equal(ret, EOK);
+    assert_non_null(prctx->cli_protocol_version);
+    assert_int_equal(prctx->cli_protocol_version->version, 1);
+
+    /* Unsupported version is rejected */
+    sss_packet_set_version(prctx->creq->in, 42);
+    ret = sss_cmd_check_inline_version(cctx);
+    assert_int_equal(ret, EPROTONOSUPPORT);
+
+    /* SSS_GET_VERSION negotiates on its own */
+    talloc_zfree(prctx->creq->in);
+    ret = sss_packet_new(prctx->creq, 0, SSS_GET_VERSION, &prctx->creq->in);
+    assert_int_equal(ret, EOK);
+    sss_packet_set_version(prctx->creq->in, 42);
+    ret = sss_cmd_check_inline_version(cctx);
+    assert_int_equal(ret, EOK);
+
+    talloc_free(cctx);
+}
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -325,6 +372,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sss_output_fqname,
                                         parse_inp_test_setup,
                                         parse_inp_test_teardown),
+        cmocka_unit_test_setup_teardown(test_inline_protocol_version,
+                                        parse_inp_test_setup,
+                                        parse_inp_test_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
@@ -22,6 +22,7 @@
 #include <tevent.h>
 #include <errno.h>
 #include <popt.h>
+#include <time.h>
 
 #include "tests/cmocka/common_mock.h"
 #include "providers/ldap/ldap_opts.h"
@@ -42,11 +43,6 @@ struct mock_ldap_entry {
 
 struct mock_ldap_entry *global_ldap_entry;
 
-static int mock_ldap_entry_iter(void)
-{
-    return sss_mock_type(int);
-}
-
 static struct mock_ldap_entry *mock_ldap_entry_get(void)
 {
     return sss_mock_ptr_type(struct mock_ldap_entry *);
@@ -115,10 +111,24 @@ int __wrap_ldap_set_option(LDAP *ld,
     return LDAP_OPT_SUCCESS;
 }
 
-char *__wrap_ldap_get_dn(LDAP *ld, LDAPMessage *entry)
+/* index of the next attribute returned by ldap_get_attribute_ber() */
+static size_t mock_ldap_attr_idx;
+
+int __wrap_ldap_get_dn_ber(LDAP *ld, LDAPMessage *entry,
+                           BerElement **berout, BerValue *dn)
 {
     struct mock_ldap_entry *ldap_entry = mock_ldap_entry_get();
-    return discard_const(ldap_entry->dn);
+
+    *berout = NULL;
+    mock_ldap_attr_idx = 0;
+
+    if (ldap_entry->dn == NULL) {
+        return LDAP_DECODING_ERROR;
+    }
+
+    dn->bv_val = discard_const(ldap_entry->dn);
+    dn->bv_len = strlen(ldap_entry->dn);
+    return LDAP_SUCCESS;
 }
 
 void __wrap_ldap_memfree(void *p)
@@ -182,33 +192,48 @@ void __wrap_ldap_value_free_len(struct berval **vals)
     talloc_free(vals);  /* Allocated on global_talloc_context */
 }
 
-char *__wrap_ldap_first_attribute(LDAP *ld,
-                                  LDAPMessage *entry,
-                                  BerElement **berout)
+int __wrap_ldap_get_attribute_ber(LDAP *ld, LDAPMessage *entry,
+                                  BerElement *ber, BerValue *attr,
+                                  BerVarray *vals)
 {
     struct mock_ldap_entry *ldap_entry = mock_ldap_entry_get();
+    struct mock_ldap_attr *mock_attr;
+    size_t count;
+    size_t i;
 
-    if (ldap_entry == NULL) return NULL;
-    if (ldap_entry->attrs == NULL) return NULL;
+    attr->bv_val = NULL;
+    attr->bv_len = 0;
+    *vals = NULL;
 
-    will_return(mock_ldap_entry_iter, 1);
-    return discard_const(ldap_entry->attrs[0].name);
-}
+    if (ldap_entry->attrs == NULL
+            || ldap_entry->attrs[mock_ldap_attr_idx].name == NULL) {
+        return LDAP_SUCCESS;
+    }
 
-char *__wrap_ldap_next_attribute(LDAP *ld,
-                                 LDAPMessage *entry,
-                                 BerElement *ber)
-{
-    struct mock_ldap_entry *ldap_entry = mock_ldap_entry_get();
+    mock_attr = &ldap_entry->attrs[mock_ldap_attr_idx];
+    mock_ldap_attr_idx++;
 
-    int idx = mock_ldap_entry_iter();
-    char *val;
+    /* Like libldap, return pointers to the data instead of copies */
+    attr->bv_val = discard_const(mock_attr->name);
+    attr->bv_len = strlen(mock_attr->name);
 
-    val = discard_const(ldap_entry->attrs[idx].name);
-    if (val != NULL) {
-        will_return(mock_ldap_entry_iter, idx + 1);
+    for (count = 0; mock_attr->values[count]; count++);
+
+    *vals = talloc_zero_array(global_talloc_context, struct berval,
+                              count + 1);
+    assert_non_null(*vals);
+
+    for (i = 0; i < count; i++) {
+        (*vals)[i].bv_val = discard_const(mock_attr->values[i]);
+        (*vals)[i].bv_len = strlen(mock_attr->values[i]);
     }
-    return val;
+
+    return LDAP_SUCCESS;
+}
+
+void __wrap_ber_memfree(void *p)
+{
+    talloc_free(p);  /* Allocated on global_talloc_context */
 }
 
 /* Mock parsing search base without overlinking the test */
@@ -388,6 +413,126 @@ void test_parse_no_map(void **state)
     talloc_free(attrs);
 }
 
+/* Entries parsed into the arena must survive the arena and its owner */
+void test_parse_arena(void **state)
+{
+    int ret;
+    struct sysdb_attrs *attrs[2];
+    struct parse_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                      struct parse_test_ctx);
+    struct mock_ldap_entry test_nomap_entry;
+    struct sdap_parse_arena arena = { NULL, 0 };
+    TALLOC_CTX *owner;
+    TALLOC_CTX *pool;
+    size_t i;
+
+    const char *foo_values[] = { "fooval1", "fooval2", NULL };
+    struct mock_ldap_attr test_nomap_entry_attrs[] = {
+        { .name = "foo", .values = foo_values },
+        { NULL, NULL }
+    };
+
+    test_nomap_entry.dn = "cn=testentry,dc=example,dc=com";
+    test_nomap_entry.attrs = test_nomap_entry_attrs;
+    set_entry_parse(&test_nomap_entry);
+
+    owner = talloc_new(test_ctx);
+    assert_non_null(owner);
+
+    for (i = 0; i < 2; i++) {
+        pool = sdap_parse_arena_get(owner, &arena);
+        assert_non_null(pool);
+        assert_ptr_not_equal(pool, owner);
+
+        ret = sdap_parse_entry(pool, &test_ctx->sh, &test_ctx->sm,
+                               NULL, 0, &attrs[i], false);
+        assert_int_equal(ret, ERR_OK);
+        assert_ptr_equal(talloc_parent(attrs[i]), pool);
+        attrs[i] = talloc_steal(test_ctx, attrs[i]);
+    }
+    assert_int_equal(arena.entries, 2);
+
+    talloc_free(owner);
+
+    for (i = 0; i < 2; i++) {
+        assert_int_equal(attrs[i]->num, 2);
+        assert_entry_has_attr(attrs[i], SYSDB_ORIG_DN,
+                              "cn=testentry,dc=example,dc=com");
+        talloc_free(attrs[i]);
+    }
+}
+
+/* Not a test, run with --bench-entries to compare the time needed to parse a
+ * large search result with and without the parse arena. */
+static int bench_entries;
+
+static void bench_parse(struct parse_test_ctx *test_ctx, bool use_arena)
+{
+    struct sdap_parse_arena arena = { NULL, 0 };
+    struct sysdb_attrs **reply;
+    struct timespec start;
+    struct timespec end;
+    TALLOC_CTX *owner;
+    int ret;
+    int i;
+
+    owner = talloc_new(test_ctx);
+    assert_non_null(owner);
+
+    reply = talloc_array(owner, struct sysdb_attrs *, bench_entries);
+    assert_non_null(reply);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < bench_entries; i++) {
+        ret = sdap_parse_entry(use_arena ? sdap_parse_arena_get(owner, &arena)
+                                         : owner,
+                               &test_ctx->sh, &test_ctx->sm,
+                               NULL, 0, &reply[i], false);
+        assert_int_equal(ret, ERR_OK);
+        reply[i] = talloc_steal(reply, reply[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%-9s %d entries: %8.3f ms\n",
+           use_arena ? "arena" : "no arena", bench_entries,
+           (end.tv_sec - start.tv_sec) * 1000.0
+               + (end.tv_nsec - start.tv_nsec) / 1000000.0);
+
+    talloc_free(owner);
+}
+
+void bench_parse_arena(void **state)
+{
+    struct parse_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                      struct parse_test_ctx);
+    struct mock_ldap_entry entry;
+
+    const char *oc_values[] = { "posixAccount", NULL };
+    const char *uid_values[] = { "tuser1", NULL };
+    const char *gecos_values[] = { "Test User", NULL };
+    const char *member_values[] = {
+        "cn=group1,ou=groups,dc=example,dc=com",
+        "cn=group2,ou=groups,dc=example,dc=com",
+        "cn=group3,ou=groups,dc=example,dc=com",
+        "cn=group4,ou=groups,dc=example,dc=com",
+        NULL
+    };
+    struct mock_ldap_attr entry_attrs[] = {
+        { .name = "objectClass", .values = oc_values },
+        { .name = "uid", .values = uid_values },
+        { .name = "gecos", .values = gecos_values },
+        { .name = "memberOf", .values = member_values },
+        { NULL, NULL }
+    };
+
+    entry.dn = "uid=tuser1,ou=people,dc=example,dc=com";
+    entry.attrs = entry_attrs;
+    set_entry_parse(&entry);
+
+    bench_parse(test_ctx, false);
+    bench_parse(test_ctx, true);
+}
+
 /* Only DN and OC, no real attributes */
 void test_parse_no_attrs(void **state)
 {
@@ -1230,9 +1375,18 @@ int main(int argc, const char *argv[])
     struct poptOption long_options[] = {
         POPT_AUTOHELP
         SSSD_DEBUG_OPTS
+        { "bench-entries", 0, POPT_ARG_INT, &bench_entries, 0,
+          _("Benchmark parsing the given number of entries instead of "
+            "running the tests"), NULL },
         POPT_TABLEEND
     };
 
+    const struct CMUnitTest bench[] = {
+        cmocka_unit_test_setup_teardown(bench_parse_arena,
+                                        parse_entry_test_setup,
+                                        parse_entry_test_teardown),
+    };
+
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_parse_with_map,
                                         parse_entry_test_setup,
@@ -1240,6 +1394,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_parse_no_map,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
+        cmocka_unit_test_setup_teardown(test_parse_arena,
+                                        parse_entry_test_setup,
+                                        parse_entry_test_teardown),
         cmocka_unit_test_setup_teardown(test_parse_no_attrs,
                                         parse_entry_test_setup,
                                         parse_entry_test_teardown),
@@ -1325,5 +1482,9 @@ int main(int argc, const char *argv[])
      * they might not after a failed run. Remove the old DB to be sure */
     tests_set_cwd();
 
+    if (bench_entries > 0) {
+        return cmocka_run_group_tests(bench, NULL, NULL);
+    }
+
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -32,6 +32,9 @@
 #include "tests/common.h"
 #include "tests/cmocka/test_expire_common.h"
 #include "tests/cmocka/test_sdap_access.h"
+#include "providers/ldap/ldap_opts.h"
+#include "providers/ldap/sdap_access.h"
+#include "util/sss_ptr_hash.h"
 
 /* linking against function from sdap_access.c module */
 extern bool nds_check_expired(const char *exp_time_str);
@@ -249,6 +252,275 @@ static void test_sdap_access_rhost(void **state)
     assert_int_equal(EOK, ret); /* Expected access allowed */
 }
 
+struct test_local_filter_ctx {
+    struct ldb_context *ldb;
+    struct sdap_attr_map *user_map;
+    struct ldb_message *user;
+};
+
+static int test_local_filter_setup(void **state)
+{
+    struct test_local_filter_ctx *test_ctx;
+    size_t i;
+
+    test_ctx = talloc_zero(NULL, struct test_local_filter_ctx);
+    assert_non_null(test_ctx);
+
+    test_ctx->ldb = ldb_init(test_ctx, NULL);
+    assert_non_null(test_ctx->ldb);
+
+    /* emulate sdap_get_map() with no overrides */
+    test_ctx->user_map = talloc_memdup(test_ctx, rfc2307bis_user_map,
+                                       sizeof(struct sdap_attr_map)
+                                                        * SDAP_OPTS_USER);
+    assert_non_null(test_ctx->user_map);
+    for (i = 0; i < SDAP_OPTS_USER; i++) {
+        test_ctx->user_map[i].name = test_ctx->user_map[i].def_name;
+    }
+
+    test_ctx->user = ldb_msg_new(test_ctx);
+    assert_non_null(test_ctx->user);
+    ldb_msg_add_string(test_ctx->user, SYSDB_ORIG_MEMBEROF,
+                       "cn=admins,ou=Groups,dc=example,dc=com");
+    ldb_msg_add_string(test_ctx->user, SYSDB_SHADOWPW_EXPIRE, "20000");
+    ldb_msg_add_fmt(test_ctx->user, SYSDB_CACHE_EXPIRE, "%lld",
+                    (long long) time(NULL) + 3600);
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int test_local_filter_teardown(void **state)
+{
+    talloc_free(*state);
+    return 0;
+}
+
+static void assert_local_filter(struct test_local_filter_ctx *test_ctx,
+                                const char *filter,
+                                errno_t exp_ret,
+                                bool exp_allowed)
+{
+    struct sdap_access_local_filter *lf;
+    bool allowed;
+    errno_t ret;
+
+    ret = sdap_access_local_filter_compile(test_ctx, test_ctx->user_map,
+                                           filter, &lf);
+    assert_int_equal(ret, EOK);
+
+    ret = sdap_access_local_filter_eval(lf, test_ctx->ldb, test_ctx->user,
+                                        &allowed);
+    assert_int_equal(ret, exp_ret);
+    if (ret == EOK) {
+        assert_int_equal(allowed, exp_allowed);
+    }
+
+    talloc_free(lf);
+}
+
+static void test_sdap_access_local_filter(void **state)
+{
+    struct test_local_filter_ctx *test_ctx;
+    struct sdap_access_local_filter *lf;
+    errno_t ret;
+
+    test_ctx = talloc_get_type(*state, struct test_local_filter_ctx);
+    assert_non_null(test_ctx);
+
+    /* DNs are compared by components, not as strings */
+    assert_local_filter(test_ctx,
+                        "(memberOf=CN=admins, OU=Groups,DC=example,DC=com)",
+                        EOK, true);
+    assert_local_filter(test_ctx,
+                        "(memberOf=cn=users,ou=groups,dc=example,dc=com)",
+                        EOK, false);
+    assert_local_filter(test_ctx,
+                        "(&(memberOf=cn=admins,ou=groups,dc=example,dc=com)"
+                        "(shadowExpire>=19000))",
+                        EOK, true);
+    assert_local_filter(test_ctx,
+                        "(|(shadowExpire<=100)(!(shadowExpire=20000)))",
+                        EOK, false);
+
+    /* attribute not in the cached entry, the server has to decide */
+    assert_local_filter(test_ctx, "(uidNumber=1000)", EAGAIN, false);
+
+    /* expired entries are not trusted */
+    ldb_msg_remove_attr(test_ctx->user, SYSDB_CACHE_EXPIRE);
+    assert_local_filter(test_ctx, "(shadowExpire=20000)", EAGAIN, false);
+
+    /* attributes which are not cached verbatim cannot be compiled */
+    ret = sdap_access_local_filter_compile(test_ctx, test_ctx->user_map,
+                                           "(employeeType=staff)", &lf);
+    assert_int_equal(ret, ENOTSUP);
+
+    /* neither can substring matches */
+    ret = sdap_access_local_filter_compile(test_ctx, test_ctx->user_map,
+                                           "(memberOf=cn=adm*)", &lf);
+    assert_int_equal(ret, ENOTSUP);
+}
+
+#define TEST_PPOLICY_DN "cn=ppolicy,ou=policies,dc=example,dc=com"
+#define TEST_PPOLICY2_DN "cn=ppolicy,ou=policies,dc=other,dc=com"
+
+static struct sysdb_attrs *ppolicy_user_attrs(TALLOC_CTX *mem_ctx,
+                                              const char *locked_time)
+{
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+
+    attrs = sysdb_new_attrs(mem_ctx);
+    assert_non_null(attrs);
+
+    if (locked_time != NULL) {
+        ret = sysdb_attrs_add_string(attrs, SYSDB_LDAP_ACCESS_LOCKED_TIME,
+                                     locked_time);
+        assert_int_equal(ret, EOK);
+    }
+
+    return attrs;
+}
+
+static void test_sdap_access_prefetch(void **state)
+{
+    struct sdap_access_prefetch *pf;
+    struct sysdb_attrs *results[2];
+    TALLOC_CTX *tmp_ctx;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    pf = talloc_zero(tmp_ctx, struct sdap_access_prefetch);
+    assert_non_null(pf);
+
+    /* the entry matched the access filter and carries the lockout data */
+    results[0] = ppolicy_user_attrs(tmp_ctx, "000001010000Z");
+    ret = sdap_access_prefetch_parse(pf, 1, results);
+    assert_int_equal(ret, EOK);
+    assert_true(pf->filter_match);
+    assert_ptr_equal(pf->user_attrs, results[0]);
+    assert_ptr_equal(talloc_parent(pf->user_attrs), pf);
+    assert_true(sdap_access_ppolicy_locked(pf->user_attrs, PWP_LOCKOUT_ONLY,
+                                           "user1"));
+
+    results[0] = ppolicy_user_attrs(tmp_ctx, NULL);
+    ret = sdap_access_prefetch_parse(pf, 1, results);
+    assert_int_equal(ret, EOK);
+    assert_true(pf->filter_match);
+    assert_false(sdap_access_ppolicy_locked(pf->user_attrs,
+                                            PWP_LOCKOUT_EXPIRE, "user1"));
+
+    /* no entry, the user does not match the access filter */
+    ret = sdap_access_prefetch_parse(pf, 0, NULL);
+    assert_int_equal(ret, EOK);
+    assert_false(pf->filter_match);
+    assert_null(pf->user_attrs);
+
+    /* a base search cannot return more than one entry */
+    results[1] = ppolicy_user_attrs(tmp_ctx, NULL);
+    ret = sdap_access_prefetch_parse(pf, 2, results);
+    assert_int_equal(ret, ERR_INTERNAL);
+
+    talloc_free(tmp_ctx);
+}
+
+static void test_sdap_access_ppolicy_cache_expire(void **state)
+{
+    hash_table_t *cache;
+    time_t now = time(NULL);
+    bool pwd_lockout;
+    errno_t ret;
+
+    cache = sss_ptr_hash_create(NULL, NULL, NULL);
+    assert_non_null(cache);
+
+    assert_false(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN, now,
+                                               &pwd_lockout));
+
+    ret = sdap_access_ppolicy_cache_set(cache, TEST_PPOLICY_DN, true,
+                                        now + 300);
+    assert_int_equal(ret, EOK);
+
+    pwd_lockout = false;
+    assert_true(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN, now,
+                                              &pwd_lockout));
+    assert_true(pwd_lockout);
+
+    /* the value is kept per password policy entry */
+    assert_false(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY2_DN, now,
+                                               &pwd_lockout));
+    ret = sdap_access_ppolicy_cache_set(cache, TEST_PPOLICY2_DN, false,
+                                        now + 600);
+    assert_int_equal(ret, EOK);
+    assert_true(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY2_DN, now,
+                                              &pwd_lockout));
+    assert_false(pwd_lockout);
+
+    /* expired values are dropped */
+    assert_false(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN,
+                                               now + 300, &pwd_lockout));
+    assert_false(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN, now,
+                                               &pwd_lockout));
+    assert_true(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY2_DN,
+                                              now + 300, &pwd_lockout));
+
+    talloc_free(cache);
+}
+
+/* Only the pwdLockout value of the policy is cached. An account which was
+ * found unlocked must still be denied once it gets locked. */
+static void test_sdap_access_ppolicy_locked_after_cached(void **state)
+{
+    struct sysdb_attrs *user_attrs;
+    hash_table_t *cache;
+    TALLOC_CTX *tmp_ctx;
+    time_t now = time(NULL);
+    char locked_time[32];
+    bool pwd_lockout;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(NULL);
+    assert_non_null(tmp_ctx);
+
+    cache = sss_ptr_hash_create(tmp_ctx, NULL, NULL);
+    assert_non_null(cache);
+
+    ret = sdap_access_ppolicy_cache_set(cache, TEST_PPOLICY_DN, true,
+                                        now + 300);
+    assert_int_equal(ret, EOK);
+
+    /* first check, the account is not locked */
+    user_attrs = ppolicy_user_attrs(tmp_ctx, NULL);
+    assert_true(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN, now,
+                                              &pwd_lockout));
+    assert_true(pwd_lockout);
+    assert_false(sdap_access_ppolicy_locked(user_attrs, PWP_LOCKOUT_EXPIRE,
+                                            "user1"));
+
+    /* the server locked the account meanwhile, the cached policy value
+     * still leads to the user attributes being checked */
+    strftime(locked_time, sizeof(locked_time), "%Y%m%d%H%M%SZ",
+             gmtime(&now));
+    user_attrs = ppolicy_user_attrs(tmp_ctx, locked_time);
+    assert_true(sdap_access_ppolicy_cache_get(cache, TEST_PPOLICY_DN,
+                                              now + 1, &pwd_lockout));
+    assert_true(pwd_lockout);
+    assert_true(sdap_access_ppolicy_locked(user_attrs, PWP_LOCKOUT_EXPIRE,
+                                           "user1"));
+
+    /* a temporary lock is ignored in the lockout only mode, a permanent
+     * one is not */
+    assert_false(sdap_access_ppolicy_locked(user_attrs, PWP_LOCKOUT_ONLY,
+                                            "user1"));
+    user_attrs = ppolicy_user_attrs(tmp_ctx, "000001010000Z");
+    assert_true(sdap_access_ppolicy_locked(user_attrs, PWP_LOCKOUT_ONLY,
+                                           "user1"));
+
+    talloc_free(tmp_ctx);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -258,6 +530,12 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_sdap_access_rhost,
                                         test_sdap_access_rhost_setup,
                                         test_sdap_access_rhost_teardown),
+        cmocka_unit_test_setup_teardown(test_sdap_access_local_filter,
+                                        test_local_filter_setup,
+                                        test_local_filter_teardown),
+        cmocka_unit_test(test_sdap_access_prefetch),
+        cmocka_unit_test(test_sdap_access_ppolicy_cache_expire),
+        cmocka_unit_test(test_sdap_access_ppolicy_locked_after_cached),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,106 @@
+/*
+    SSSD
+
+    Event loop statistics - tests
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "util/sss_loop_stats.h"
+
+static void loop_stats_test_timer(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval tv,
+                                  void *pvt)
+{
+    bool *done = pvt;
+
+    usleep(2000);
+    *done = true;
+}
+
+void test_sss_loop_stats(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    struct tevent_context *ev;
+    struct tevent_timer *te;
+    void *owner;
+    struct sss_loop_stat *stats;
+    uint64_t in_histogram;
+    bool done = false;
+    size_t count;
+    size_t i;
+    int j;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(global_talloc_context);
+    assert_non_null(tmp_ctx);
+
+    ev = tevent_context_init(tmp_ctx);
+    assert_non_null(ev);
+
+    ret = sss_loop_stats_setup(ev, 1);
+#ifndef BUILD_CHAIN_ID
+    assert_int_equal(ret, ENOTSUP);
+    talloc_free(tmp_ctx);
+    return;
+#endif
+    assert_int_equal(ret, EOK);
+
+    owner = talloc_named_const(tmp_ctx, 0, "test_owner");
+    assert_non_null(owner);
+
+    te = tevent_add_timer(ev, owner, tevent_timeval_current(),
+                          loop_stats_test_timer, &done);
+    assert_non_null(te);
+
+    while (!done) {
+        assert_int_equal(tevent_loop_once(ev), 0);
+    }
+
+    ret = sss_loop_stats_report(tmp_ctx, &stats, &count);
+    assert_int_equal(ret, EOK);
+
+    for (i = 0; i < count; i++) {
+        if (strcmp(stats[i].name, "timer test_owner") == 0) {
+            break;
+        }
+    }
+    assert_true(i < count);
+
+    assert_int_equal(stats[i].count, 1);
+    assert_true(stats[i].max_usec >= 2000);
+    assert_int_equal(stats[i].total_usec, stats[i].max_usec);
+
+    in_histogram = 0;
+    for (j = 0; j < SSS_LOOP_STATS_BUCKETS; j++) {
+        in_histogram += stats[i].histogram[j];
+    }
+    assert_int_equal(in_histogram, 1);
+    /* 2 ms is above the 1 ms bucket */
+    assert_int_equal(stats[i].histogram[0] + stats[i].histogram[1], 0);
+
+    /* the statistics go away with the event context */
+    talloc_free(ev);
+    ret = sss_loop_stats_report(tmp_ctx, &stats, &count);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(count, 0);
+
+    talloc_free(tmp_ctx);
+}
@@ -0,0 +1,73 @@
+/*
+    SSSD
+
+    talloc memory report - tests
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tests/cmocka/common_mock.h"
+#include "util/sss_talloc_report.h"
+
+static void check_stat(struct sss_talloc_stat *stat, const char *name,
+                       uint64_t blocks, uint64_t bytes, uint64_t total_bytes)
+{
+    assert_string_equal(stat->name, name);
+    assert_int_equal(stat->blocks, blocks);
+    assert_int_equal(stat->bytes, bytes);
+    assert_int_equal(stat->total_bytes, total_bytes);
+}
+
+void test_sss_talloc_report(void **state)
+{
+    TALLOC_CTX *tmp_ctx;
+    TALLOC_CTX *root;
+    void *a;
+    void *b1;
+    void *b2;
+    void *a2;
+    void *ref;
+    struct sss_talloc_stat *stats;
+    size_t count;
+    errno_t ret;
+
+    tmp_ctx = talloc_new(global_talloc_context);
+    assert_non_null(tmp_ctx);
+
+    root = talloc_named_const(global_talloc_context, 0, "test_root");
+    assert_non_null(root);
+    a = talloc_named_const(root, 100, "type_a");
+    assert_non_null(a);
+    b1 = talloc_named_const(a, 10, "type_b");
+    assert_non_null(b1);
+    b2 = talloc_named_const(a, 20, "type_b");
+    assert_non_null(b2);
+    /* nested under a chunk of the same name, counted once in total_bytes */
+    a2 = talloc_named_const(b2, 50, "type_a");
+    assert_non_null(a2);
+    /* references are not counted twice */
+    ref = talloc_reference(root, b1);
+    assert_non_null(ref);
+
+    ret = sss_talloc_report(tmp_ctx, root, &stats, &count);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(count, 3);
+
+    check_stat(&stats[0], "test_root", 1, 0, 180);
+    check_stat(&stats[1], "type_a", 2, 150, 180);
+    check_stat(&stats[2], "type_b", 2, 30, 80);
+
+    talloc_free(root);
+    talloc_free(tmp_ctx);
+}
@@ -0,0 +1,103 @@
+/*
+    SSSD
+
+    Request trace spans - tests
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "tests/cmocka/common_mock.h"
+#include "util/sss_trace.h"
+
+static void assert_trace_record(struct sss_trace_record *record,
+                                enum sss_trace_kind kind,
+                                const char *name,
+                                const char *peer,
+                                uint64_t link_id,
+                                int32_t error)
+{
+    assert_int_equal(record->magic, SSS_TRACE_MAGIC);
+    assert_int_equal(record->version, SSS_TRACE_VERSION);
+    assert_int_equal(record->kind, kind);
+    assert_int_equal(record->pid, getpid());
+    assert_int_equal(record->ppid, getppid());
+    assert_true(record->start_us <= record->end_us);
+    assert_int_equal(record->error, error);
+    assert_int_equal(record->link_id, link_id);
+    assert_string_equal(record->name, name);
+    assert_string_equal(record->peer, peer);
+}
+
+void test_sss_trace(void **state)
+{
+    struct sss_trace_record records[3];
+    struct sss_trace_span *span;
+    char path[] = "sss_trace_test_XXXXXX";
+    TALLOC_CTX *tmp_ctx;
+    ssize_t len;
+    int fd;
+
+    tmp_ctx = talloc_new(global_talloc_context);
+    assert_non_null(tmp_ctx);
+
+    /* tracing is disabled by default */
+    assert_false(sss_trace_enabled());
+    span = sss_trace_span_begin(tmp_ctx, SSS_TRACE_SPAN, "disabled");
+    assert_null(span);
+    sss_trace_span_link(span, "peer", 1);
+    sss_trace_span_end(span, EOK);
+
+    fd = mkstemp(path);
+    assert_true(fd != -1);
+    sss_trace_fd = fd;
+    assert_true(sss_trace_enabled());
+
+    span = sss_trace_span_begin(tmp_ctx, SSS_TRACE_DP_REQUEST, "request %d",
+                                42);
+    assert_non_null(span);
+    sss_trace_span_link(span, "sssd.nss", 1234);
+    sss_trace_span_end(span, EIO);
+
+    /* a span which is freed without being ended is cancelled */
+    span = sss_trace_span_begin(tmp_ctx, SSS_TRACE_SPAN, "cancelled");
+    assert_non_null(span);
+    talloc_free(tmp_ctx);
+
+    /* names which do not fit are truncated */
+    span = sss_trace_span_begin(NULL, SSS_TRACE_CHILD, "%0100d", 0);
+    assert_non_null(span);
+    sss_trace_span_end(span, EOK);
+
+    sss_trace_fd = -1;
+
+    assert_int_equal(lseek(fd, 0, SEEK_SET), 0);
+    len = read(fd, records, sizeof(records));
+    assert_int_equal(len, sizeof(records));
+    assert_int_equal(read(fd, records, 1), 0);
+    close(fd);
+    unlink(path);
+
+    assert_trace_record(&records[0], SSS_TRACE_DP_REQUEST, "request 42",
+                        "sssd.nss", 1234, EIO);
+    assert_trace_record(&records[1], SSS_TRACE_SPAN, "cancelled", "", 0,
+                        ECANCELED);
+    assert_int_equal(strlen(records[2].name), sizeof(records[2].name) - 1);
+    assert_int_equal(records[2].kind, SSS_TRACE_CHILD);
+    assert_int_equal(records[2].error, EOK);
+}
@@ -1707,6 +1707,175 @@ static void test_sysdb_group_missing_ts(void **state)
     talloc_zfree(groupdn);
 }
 
+static void assert_lookup_cache_delta(struct sysdb_ctx *sysdb,
+                                      struct sysdb_lookup_cache_stats *before,
+                                      uint64_t hits,
+                                      uint64_t misses)
+{
+    struct sysdb_lookup_cache_stats after;
+
+    sysdb_get_lookup_cache_stats(sysdb, &after);
+    assert_int_equal(after.hits - before->hits, hits);
+    assert_int_equal(after.misses - before->misses, misses);
+    *before = after;
+}
+
+static void test_sysdb_lookup_cache(void **state)
+{
+    int ret;
+    struct sysdb_ts_test_ctx *test_ctx = talloc_get_type_abort(*state,
+                                                     struct sysdb_ts_test_ctx);
+    struct sysdb_ctx *sysdb = test_ctx->tctx->dom->sysdb;
+    const char *attrs[] = { SYSDB_NAME, SYSDB_GIDNUM, SYSDB_CACHE_EXPIRE,
+                            NULL };
+    const char *name_attrs[] = { SYSDB_NAME, NULL };
+    const char *member_attrs[] = { SYSDB_NAME, SYSDB_MEMBER, NULL };
+    struct sysdb_lookup_cache_stats stats;
+    struct sysdb_lookup_cache_stats after;
+    struct ldb_message **msgs = NULL;
+    struct ldb_message *msg = NULL;
+    struct ldb_dn *groupdn;
+    size_t count;
+
+    groupdn = sysdb_group_dn(test_ctx, test_ctx->tctx->dom, TEST_GROUP_NAME);
+    assert_non_null(groupdn);
+
+    ret = sysdb_transaction_start(sysdb);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME,
+                            TEST_GROUP_GID, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME_2,
+                            TEST_GROUP_GID_2, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_1);
+    assert_int_equal(ret, EOK);
+
+    sysdb_get_lookup_cache_stats(sysdb, &stats);
+
+    /* lookups by name, ID and DN share the cached entry */
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 1);
+
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0),
+                     TEST_NOW_1 + TEST_CACHE_TIMEOUT);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 1, 0);
+
+    ret = sysdb_search_group_by_gid(test_ctx, test_ctx->tctx->dom,
+                                    TEST_GROUP_GID, name_attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    ret = sysdb_search_group_by_gid(test_ctx, test_ctx->tctx->dom,
+                                    TEST_GROUP_GID, name_attrs, &msg);
+    assert_int_equal(ret, EOK);
+    assert_string_equal(ldb_msg_find_attr_as_string(msg, SYSDB_NAME, NULL),
+                        TEST_GROUP_NAME);
+    /* only the requested attributes are returned */
+    assert_int_equal(msg->num_elements, 1);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 1, 1);
+
+    ret = sysdb_search_entry(test_ctx, sysdb, groupdn, LDB_SCOPE_BASE, NULL,
+                             attrs, &count, &msgs);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(count, 1);
+    talloc_zfree(msgs);
+    assert_lookup_cache_delta(sysdb, &stats, 1, 0);
+
+    /* attributes maintained by the memberof plugin are never cached */
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME, member_attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 0);
+
+    /* missing entries are cached as well */
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_3, attrs, &msg);
+    assert_int_equal(ret, ENOENT);
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_3, attrs, &msg);
+    assert_int_equal(ret, ENOENT);
+    assert_lookup_cache_delta(sysdb, &stats, 1, 1);
+
+    /* a write only drops the entry which was written */
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_2, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 1);
+
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME_2,
+                            TEST_GROUP_GID_2, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+    sysdb_get_lookup_cache_stats(sysdb, &after);
+    assert_true(after.invalidations > stats.invalidations);
+    sysdb_get_lookup_cache_stats(sysdb, &stats);
+
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 1, 0);
+
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_2, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    assert_int_equal(ldb_msg_find_attr_as_uint64(msg, SYSDB_CACHE_EXPIRE, 0),
+                     TEST_NOW_2 + TEST_CACHE_TIMEOUT);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 1);
+
+    /* adding the missing entry drops the negative result */
+    ret = sysdb_store_group(test_ctx->tctx->dom, TEST_GROUP_NAME_3,
+                            TEST_GROUP_GID_3, NULL, TEST_CACHE_TIMEOUT,
+                            TEST_NOW_2);
+    assert_int_equal(ret, EOK);
+    sysdb_get_lookup_cache_stats(sysdb, &stats);
+
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_3, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 1);
+
+    /* deleting the entry drops it */
+    ret = sysdb_delete_group(test_ctx->tctx->dom, TEST_GROUP_NAME, 0);
+    assert_int_equal(ret, EOK);
+    sysdb_get_lookup_cache_stats(sysdb, &stats);
+
+    ret = sysdb_search_group_by_gid(test_ctx, test_ctx->tctx->dom,
+                                    TEST_GROUP_GID, name_attrs, &msg);
+    assert_int_equal(ret, ENOENT);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 1);
+
+    ret = sysdb_transaction_commit(sysdb);
+    assert_int_equal(ret, EOK);
+
+    /* nothing is cached outside of a transaction */
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_2, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    ret = sysdb_search_group_by_name(test_ctx, test_ctx->tctx->dom,
+                                     TEST_GROUP_NAME_2, attrs, &msg);
+    assert_int_equal(ret, EOK);
+    talloc_zfree(msg);
+    assert_lookup_cache_delta(sysdb, &stats, 0, 0);
+
+    talloc_free(groupdn);
+}
+
 int main(int argc, const char *argv[])
 {
     int rv;
@@ -1767,6 +1936,9 @@ int main(int argc, const char *argv[])
         cmocka_unit_test_setup_teardown(test_sysdb_group_missing_ts,
                                         test_sysdb_ts_setup,
                                         test_sysdb_ts_teardown),
+        cmocka_unit_test_setup_teardown(test_sysdb_lookup_cache,
+                                        test_sysdb_ts_setup,
+                                        test_sysdb_ts_teardown),
     };
 
     /* Set debug level to invalid value so we can decide if -d 0 was used. */
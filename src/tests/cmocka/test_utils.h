@@ -40,5 +40,14 @@ void test_sss_ptr_hash_overwrite_with_free_cb(void **state);
 void test_sss_ptr_hash_with_lookup_cb(void **state);
 void test_sss_ptr_hash_without_cb(void **state);
 
+/* from src/tests/cmocka/test_sss_talloc_report.c */
+void test_sss_talloc_report(void **state);
+
+/* from src/tests/cmocka/test_sss_loop_stats.c */
+void test_sss_loop_stats(void **state);
+
+/* from src/tests/cmocka/test_sss_trace.c */
+void test_sss_trace(void **state);
+
 
 #endif /* __TESTS__CMOCKA__TEST_UTILS_H__ */
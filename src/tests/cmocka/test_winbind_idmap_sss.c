@@ -0,0 +1,368 @@
+/*
+    SSSD
+
+    ID-mapping plugin for winbind - tests
+
+    The plugin is called the way winbindd calls it, with NULL terminated
+    arrays of mappings, while the libsss_nss_idmap batch calls are replaced
+    by an in-memory table.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+#include <talloc.h>
+
+#include "lib/winbind_idmap_sss/winbind_idmap_sss.h"
+#include "sss_client/idmap/sss_nss_idmap.h"
+#include "lib/idmap/sss_idmap.h"
+#include "util/util_sss_idmap.h"
+
+/* exported by the plugin for winbindd */
+NTSTATUS samba_init_module(void);
+
+struct test_entry {
+    uint32_t id;
+    const char *sid;
+    enum sss_id_type type;
+};
+
+static struct test_entry test_entries[] = {
+    { 1000, "S-1-5-21-1-2-3-1000", SSS_ID_TYPE_UID },
+    { 2000, "S-1-5-21-1-2-3-2000", SSS_ID_TYPE_GID },
+    { 3000, "S-1-5-21-1-2-3-3000", SSS_ID_TYPE_BOTH },
+    { 0, NULL, SSS_ID_TYPE_NOT_SPECIFIED }
+};
+
+/* number of batch calls and of IDs or SIDs looked up */
+static struct {
+    int uid_calls;
+    int gid_calls;
+    int id_calls;
+    int sid_calls;
+    size_t lookups;
+} test_calls;
+
+static struct idmap_methods *test_methods;
+
+NTSTATUS smb_register_idmap(int version, const char *name,
+                            struct idmap_methods *methods)
+{
+    test_methods = methods;
+    return NT_STATUS_OK;
+}
+
+static int test_getsidbyxid_list(const uint32_t *ids, size_t num,
+                                 enum sss_id_type want, char **sids,
+                                 enum sss_id_type *types, int *rets)
+{
+    struct test_entry *e;
+    size_t c;
+
+    test_calls.lookups += num;
+
+    for (c = 0; c < num; c++) {
+        sids[c] = NULL;
+        types[c] = SSS_ID_TYPE_NOT_SPECIFIED;
+        rets[c] = ENOENT;
+
+        for (e = test_entries; e->sid != NULL; e++) {
+            if (e->id != ids[c]) {
+                continue;
+            }
+            if (want != SSS_ID_TYPE_NOT_SPECIFIED
+                    && e->type != want && e->type != SSS_ID_TYPE_BOTH) {
+                continue;
+            }
+
+            sids[c] = strdup(e->sid);
+            if (sids[c] == NULL) {
+                return ENOMEM;
+            }
+            types[c] = e->type;
+            rets[c] = 0;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int sss_nss_getsidbyuid_list(const uint32_t *uids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets)
+{
+    test_calls.uid_calls++;
+    return test_getsidbyxid_list(uids, num, SSS_ID_TYPE_UID,
+                                 sids, types, rets);
+}
+
+int sss_nss_getsidbygid_list(const uint32_t *gids, size_t num,
+                             char **sids, enum sss_id_type *types, int *rets)
+{
+    test_calls.gid_calls++;
+    return test_getsidbyxid_list(gids, num, SSS_ID_TYPE_GID,
+                                 sids, types, rets);
+}
+
+int sss_nss_getsidbyid_list(const uint32_t *ids, size_t num,
+                            char **sids, enum sss_id_type *types, int *rets)
+{
+    test_calls.id_calls++;
+    return test_getsidbyxid_list(ids, num, SSS_ID_TYPE_NOT_SPECIFIED,
+                                 sids, types, rets);
+}
+
+int sss_nss_getidbysid_list(const char * const *sids, size_t num,
+                            uint32_t *ids, enum sss_id_type *types, int *rets)
+{
+    struct test_entry *e;
+    size_t c;
+
+    test_calls.sid_calls++;
+    test_calls.lookups += num;
+
+    for (c = 0; c < num; c++) {
+        ids[c] = 0;
+        types[c] = SSS_ID_TYPE_NOT_SPECIFIED;
+        rets[c] = ENOENT;
+
+        for (e = test_entries; e->sid != NULL; e++) {
+            if (strcmp(e->sid, sids[c]) == 0) {
+                ids[c] = e->id;
+                types[c] = e->type;
+                rets[c] = 0;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+struct test_ctx {
+    struct idmap_domain *dom;
+    struct sss_idmap_ctx *idmap_ctx;
+};
+
+static int setup_winbind_idmap(void **state)
+{
+    struct test_ctx *test_ctx;
+    enum idmap_error_code err;
+    NTSTATUS status;
+
+    memset(&test_calls, 0, sizeof(test_calls));
+
+    test_ctx = talloc_zero(NULL, struct test_ctx);
+    assert_non_null(test_ctx);
+
+    err = sss_idmap_init(sss_idmap_talloc, test_ctx, sss_idmap_talloc_free,
+                         &test_ctx->idmap_ctx);
+    assert_int_equal(err, IDMAP_SUCCESS);
+
+    status = samba_init_module();
+    assert_true(NT_STATUS_IS_OK(status));
+    assert_non_null(test_methods);
+
+    /* winbindd allocates the domain with talloc */
+    test_ctx->dom = talloc_zero(test_ctx, struct idmap_domain);
+    assert_non_null(test_ctx->dom);
+    test_ctx->dom->name = "TEST";
+    test_ctx->dom->methods = test_methods;
+
+    status = test_methods->init(test_ctx->dom);
+    assert_true(NT_STATUS_IS_OK(status));
+
+    *state = test_ctx;
+    return 0;
+}
+
+static int teardown_winbind_idmap(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+
+    talloc_free(test_ctx);
+    return 0;
+}
+
+/* Build a NULL terminated array of mappings like winbindd does */
+static struct id_map **test_map_array(TALLOC_CTX *mem_ctx, size_t num)
+{
+    struct id_map **map;
+    size_t c;
+
+    map = talloc_zero_array(mem_ctx, struct id_map *, num + 1);
+    assert_non_null(map);
+
+    for (c = 0; c < num; c++) {
+        map[c] = talloc_zero(map, struct id_map);
+        assert_non_null(map[c]);
+        map[c]->sid = talloc_zero(map[c], struct dom_sid);
+        assert_non_null(map[c]->sid);
+    }
+
+    return map;
+}
+
+static void test_set_sid(struct test_ctx *test_ctx, struct id_map *map,
+                         const char *sid_str)
+{
+    enum idmap_error_code err;
+    struct dom_sid *sid;
+
+    err = sss_idmap_sid_to_smb_sid(test_ctx->idmap_ctx, sid_str, &sid);
+    assert_int_equal(err, IDMAP_SUCCESS);
+    memcpy(map->sid, sid, sizeof(struct dom_sid));
+    sss_idmap_free_smb_sid(test_ctx->idmap_ctx, sid);
+}
+
+static void test_check_sid(struct test_ctx *test_ctx, struct id_map *map,
+                           const char *sid_str)
+{
+    enum idmap_error_code err;
+    char *str;
+
+    err = sss_idmap_smb_sid_to_sid(test_ctx->idmap_ctx, map->sid, &str);
+    assert_int_equal(err, IDMAP_SUCCESS);
+    assert_string_equal(str, sid_str);
+    sss_idmap_free_sid(test_ctx->idmap_ctx, str);
+}
+
+void test_unixids_to_sids(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    struct id_map **map;
+    NTSTATUS status;
+
+    map = test_map_array(test_ctx, 6);
+    map[0]->xid.id = 1000;
+    map[0]->xid.type = ID_TYPE_UID;
+    map[1]->xid.id = 2000;
+    map[1]->xid.type = ID_TYPE_GID;
+    map[2]->xid.id = 3000;
+    map[2]->xid.type = ID_TYPE_UID;
+    map[3]->xid.id = 3000;
+    map[3]->xid.type = ID_TYPE_BOTH;
+    /* a group is not found by UID */
+    map[4]->xid.id = 2000;
+    map[4]->xid.type = ID_TYPE_UID;
+    map[5]->xid.id = 4000;
+    map[5]->xid.type = ID_TYPE_GID;
+
+    status = test_methods->unixids_to_sids(test_ctx->dom, map);
+    assert_true(NT_STATUS_IS_OK(status));
+
+    /* one batch for each kind of ID, not one request per entry */
+    assert_int_equal(test_calls.uid_calls, 1);
+    assert_int_equal(test_calls.gid_calls, 1);
+    assert_int_equal(test_calls.id_calls, 1);
+    assert_int_equal(test_calls.lookups, 6);
+
+    assert_int_equal(map[0]->status, ID_MAPPED);
+    assert_int_equal(map[0]->xid.type, ID_TYPE_UID);
+    test_check_sid(test_ctx, map[0], "S-1-5-21-1-2-3-1000");
+
+    assert_int_equal(map[1]->status, ID_MAPPED);
+    assert_int_equal(map[1]->xid.type, ID_TYPE_GID);
+    test_check_sid(test_ctx, map[1], "S-1-5-21-1-2-3-2000");
+
+    assert_int_equal(map[2]->status, ID_MAPPED);
+    assert_int_equal(map[2]->xid.type, ID_TYPE_BOTH);
+    test_check_sid(test_ctx, map[2], "S-1-5-21-1-2-3-3000");
+
+    assert_int_equal(map[3]->status, ID_MAPPED);
+    assert_int_equal(map[3]->xid.type, ID_TYPE_BOTH);
+    test_check_sid(test_ctx, map[3], "S-1-5-21-1-2-3-3000");
+
+    assert_int_equal(map[4]->status, ID_UNMAPPED);
+    assert_int_equal(map[5]->status, ID_UNMAPPED);
+
+    talloc_free(map);
+}
+
+void test_sids_to_unixids(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    struct id_map **map;
+    NTSTATUS status;
+
+    map = test_map_array(test_ctx, 4);
+    test_set_sid(test_ctx, map[0], "S-1-5-21-1-2-3-1000");
+    test_set_sid(test_ctx, map[1], "S-1-5-21-1-2-3-2000");
+    test_set_sid(test_ctx, map[2], "S-1-5-21-1-2-3-3000");
+    test_set_sid(test_ctx, map[3], "S-1-5-21-1-2-3-4000");
+
+    status = test_methods->sids_to_unixids(test_ctx->dom, map);
+    assert_true(NT_STATUS_IS_OK(status));
+
+    assert_int_equal(test_calls.sid_calls, 1);
+    assert_int_equal(test_calls.lookups, 4);
+
+    assert_int_equal(map[0]->status, ID_MAPPED);
+    assert_int_equal(map[0]->xid.type, ID_TYPE_UID);
+    assert_int_equal(map[0]->xid.id, 1000);
+
+    assert_int_equal(map[1]->status, ID_MAPPED);
+    assert_int_equal(map[1]->xid.type, ID_TYPE_GID);
+    assert_int_equal(map[1]->xid.id, 2000);
+
+    assert_int_equal(map[2]->status, ID_MAPPED);
+    assert_int_equal(map[2]->xid.type, ID_TYPE_BOTH);
+    assert_int_equal(map[2]->xid.id, 3000);
+
+    assert_int_equal(map[3]->status, ID_UNMAPPED);
+
+    talloc_free(map);
+}
+
+void test_empty_map(void **state)
+{
+    struct test_ctx *test_ctx = talloc_get_type(*state, struct test_ctx);
+    struct id_map **map;
+    NTSTATUS status;
+
+    map = test_map_array(test_ctx, 0);
+
+    status = test_methods->unixids_to_sids(test_ctx->dom, map);
+    assert_true(NT_STATUS_IS_OK(status));
+
+    status = test_methods->sids_to_unixids(test_ctx->dom, map);
+    assert_true(NT_STATUS_IS_OK(status));
+
+    assert_int_equal(test_calls.uid_calls + test_calls.gid_calls
+                     + test_calls.id_calls + test_calls.sid_calls, 0);
+
+    talloc_free(map);
+}
+
+int main(int argc, const char *argv[])
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_unixids_to_sids,
+                                        setup_winbind_idmap,
+                                        teardown_winbind_idmap),
+        cmocka_unit_test_setup_teardown(test_sids_to_unixids,
+                                        setup_winbind_idmap,
+                                        teardown_winbind_idmap),
+        cmocka_unit_test_setup_teardown(test_empty_map,
+                                        setup_winbind_idmap,
+                                        teardown_winbind_idmap),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,143 @@
+#
+# Synthetic LDAP directory generation
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import random
+import ldap_ent
+
+USER_UID_BASE = 100000
+GROUP_GID_BASE = 200000
+DOMAIN_SID = "S-1-5-21-1111111111-2222222222-3333333333"
+
+
+class Directory:
+    """
+    Synthetic RFC2307bis directory
+
+    The groups form trees: group g has the groups g * width + 1 up to
+    g * width + width as nested members as long as the tree is not deeper
+    than depth. Every user is a direct member of groups_per_user groups
+    picked at random, the optional large group has all users as members.
+
+    The generated directory is deterministic for the same arguments.
+    """
+    def __init__(self, base_dn, users, groups, depth=0, width=2,
+                 groups_per_user=1, large_group=False, seed=1):
+        self.base_dn = base_dn
+        self.num_users = users
+        self.num_groups = groups
+        self.depth = depth
+        self.width = max(width, 1)
+        self.large_group = large_group
+
+        rand = random.Random(seed)
+
+        # group -> nesting level, roots are level 0
+        self.parent = {}
+        level = {}
+        for g in range(groups):
+            p = (g - 1) // self.width
+            if g > 0 and level[p] < depth:
+                self.parent[g] = p
+                level[g] = level[p] + 1
+            else:
+                level[g] = 0
+
+        self.member_groups = {g: [] for g in range(groups)}
+        for g, p in self.parent.items():
+            self.member_groups[p].append(g)
+
+        self.member_users = {g: [] for g in range(groups)}
+        self.user_groups = {}
+        for u in range(users):
+            picked = set()
+            if groups > 0:
+                count = min(groups_per_user, groups)
+                picked = set(rand.sample(range(groups), count))
+            self.user_groups[u] = sorted(picked)
+            for g in picked:
+                self.member_users[g].append(u)
+
+    @staticmethod
+    def user_name(u):
+        return "user%d" % u
+
+    @staticmethod
+    def group_name(g):
+        return "group%d" % g
+
+    @staticmethod
+    def large_group_name():
+        return "largegroup"
+
+    def user_sid(self, u):
+        return "%s-%d" % (DOMAIN_SID, USER_UID_BASE + u)
+
+    def group_sid(self, g):
+        return "%s-%d" % (DOMAIN_SID, GROUP_GID_BASE + g)
+
+    def ent_list(self):
+        """
+        Generate the add-modlists of the directory
+
+        Returns:
+            ldap_ent.List with users first, then groups
+        """
+        ent_list = ldap_ent.List(self.base_dn)
+        for u in range(self.num_users):
+            ent_list.add_user(self.user_name(u), USER_UID_BASE + u,
+                              USER_UID_BASE + u)
+
+        for g in range(self.num_groups):
+            ent_list.add_group_bis(
+                self.group_name(g), GROUP_GID_BASE + g,
+                [self.user_name(u) for u in self.member_users[g]],
+                [self.group_name(m) for m in self.member_groups[g]])
+
+        if self.large_group:
+            ent_list.add_group_bis(
+                self.large_group_name(), GROUP_GID_BASE + self.num_groups,
+                [self.user_name(u) for u in range(self.num_users)])
+
+        return ent_list
+
+    def token_groups(self, u):
+        """
+        All groups the user is a member of, directly or through nesting,
+        which is what AD returns in the tokenGroups attribute
+
+        Returns:
+            Sorted list of group numbers
+        """
+        groups = set()
+        for g in self.user_groups[u]:
+            while g is not None and g not in groups:
+                groups.add(g)
+                g = self.parent.get(g)
+
+        return sorted(groups)
+
+    def token_group_sids(self, u):
+        return [self.group_sid(g) for g in self.token_groups(u)]
+
+    def expected_initgroups(self, u):
+        """
+        Names of the groups initgroups of the user should return, primary
+        group excluded
+        """
+        names = [self.group_name(g) for g in self.token_groups(u)]
+        if self.large_group:
+            names.append(self.large_group_name())
+        return sorted(names)
@@ -1151,6 +1151,44 @@ def test_getgrnam_add_remove_ghosts(setup_pw_with_canary,
     assert res == NssReturnCode.NOTFOUND
 
 
+@pytest.mark.skipif(not have_files_provider(),
+                    reason="'files provider' disabled, skipping")
+def test_mod_member_user(setup_pw_with_canary,
+                         setup_gr_with_canary,
+                         files_domain_only):
+    """
+    Test that modifying or removing a member only updates the member, the
+    other members and the memberships are kept
+    """
+    pwd_ops = setup_pw_with_canary
+    user_and_group_setup(pwd_ops,
+                         setup_gr_with_canary,
+                         [USER1, USER2],
+                         [GROUP12],
+                         False)
+    members_check([GROUP12])
+
+    moduser = dict(USER1)
+    moduser['shell'] = '/bin/zsh'
+    pwd_ops.usermod(**moduser)
+    check_user(moduser)
+    members_check([GROUP12])
+
+    # user2 becomes a ghost member of group12
+    pwd_ops.userdel(USER2['name'])
+    time.sleep(1)
+    res, _ = call_sssd_getpwnam(USER2['name'])
+    assert res == NssReturnCode.NOTFOUND
+
+    res, groups = sssd_id_sync(USER1['name'])
+    assert res == sssd_id.NssReturnCode.SUCCESS
+    assert 'group12' in groups
+
+    pwd_ops.useradd(**USER2)
+    check_user(USER2)
+    members_check([GROUP12])
+
+
 def realloc_users(pwd_ops, num):
     # Intentionally not including the last one because
     # canary is added first
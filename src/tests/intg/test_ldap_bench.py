@@ -0,0 +1,295 @@
+#
+# LDAP provider benchmark on a synthetic directory
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""
+Benchmark scenarios for the LDAP provider
+
+The scenarios run only if SSSD_BENCH is set in the environment. The size
+of the synthetic directory is set by SSSD_BENCH_USERS, SSSD_BENCH_GROUPS,
+SSSD_BENCH_DEPTH, SSSD_BENCH_WIDTH and SSSD_BENCH_GROUPS_PER_USER.
+
+Each scenario reports the number of LDAP operations issued by sssd_be,
+the wall time and the peak RSS of sssd_be. The results are appended as
+JSON lines to SSSD_BENCH_OUTPUT if set. If SSSD_BENCH_BASELINE points to
+a JSON file with results of a previous run ({scenario: {metric: value}}),
+a scenario fails when a metric exceeds the baseline by more than
+SSSD_BENCH_TOLERANCE (default 0.2, i.e. 20 %).
+"""
+import os
+import pwd
+import grp
+import json
+import time
+import struct
+import subprocess
+import pytest
+import config
+import ds_openldap
+import ldap_synth
+import sssd_id
+from sssd_nss import NssReturnCode
+from util import unindent
+from test_ldap import create_ldap_entries, cleanup_ldap_entries, \
+    create_conf_fixture, create_sssd_process, cleanup_sssd_process
+
+pytestmark = pytest.mark.skipif("SSSD_BENCH" not in os.environ,
+                                reason="SSSD_BENCH is not set")
+
+LDAP_BASE_DN = "dc=example,dc=com"
+
+# Keep in sync with struct sss_trace_record in src/util/sss_trace.h
+TRACE_RECORD = struct.Struct('=IHHIIQQQQiI16s24s48s')
+TRACE_FILE = config.LOG_PATH + "/sssd_LDAP.trace"
+
+
+def env_int(name, default):
+    return int(os.environ.get(name, default))
+
+
+USERS = env_int("SSSD_BENCH_USERS", 1000)
+GROUPS = env_int("SSSD_BENCH_GROUPS", 200)
+DEPTH = env_int("SSSD_BENCH_DEPTH", 3)
+WIDTH = env_int("SSSD_BENCH_WIDTH", 3)
+GROUPS_PER_USER = env_int("SSSD_BENCH_GROUPS_PER_USER", 3)
+SAMPLE = min(env_int("SSSD_BENCH_SAMPLE", 100), USERS)
+TIMEOUT = env_int("SSSD_BENCH_TIMEOUT", 600)
+
+
+@pytest.fixture(scope="module")
+def directory():
+    return ldap_synth.Directory(LDAP_BASE_DN, USERS, GROUPS,
+                                depth=DEPTH, width=WIDTH,
+                                groups_per_user=GROUPS_PER_USER,
+                                large_group=True)
+
+
+@pytest.fixture(scope="module")
+def ds_inst(request):
+    """LDAP server instance fixture"""
+    ds_inst = ds_openldap.DSOpenLDAP(
+        config.PREFIX, 10389, LDAP_BASE_DN,
+        "cn=admin", "Secret123"
+    )
+
+    try:
+        ds_inst.setup()
+    except Exception:
+        ds_inst.teardown()
+        raise
+    request.addfinalizer(lambda: ds_inst.teardown())
+    return ds_inst
+
+
+@pytest.fixture(scope="module")
+def ldap_conn(request, ds_inst, directory):
+    """LDAP server connection fixture with the synthetic directory"""
+    ldap_conn = ds_inst.bind()
+    ldap_conn.ds_inst = ds_inst
+    ent_list = directory.ent_list()
+    create_ldap_entries(ldap_conn, ent_list)
+
+    def teardown():
+        cleanup_ldap_entries(ldap_conn, ent_list)
+        ldap_conn.unbind_s()
+
+    request.addfinalizer(teardown)
+    return ldap_conn
+
+
+def format_bench_conf(ldap_conn, enumerate=False):
+    return unindent("""\
+        [sssd]
+        domains             = LDAP
+        services            = nss
+        enable_files_domain = false
+
+        [nss]
+        memcache_timeout    = 0
+
+        [domain/LDAP]
+        ldap_auth_disable_tls_never_use_in_production = true
+        ldap_id_use_start_tls = false
+        debug_trace_spans   = true
+        ldap_schema         = rfc2307bis
+        ldap_group_object_class = groupOfNames
+        id_provider         = ldap
+        ldap_uri            = {ldap_conn.ds_inst.ldap_url}
+        ldap_search_base    = {ldap_conn.ds_inst.base_dn}
+        enumerate           = {enumerate}
+    """).format(**locals())
+
+
+def start_sssd(request, contents):
+    """Start SSSD with an empty trace file"""
+    create_conf_fixture(request, contents)
+    if os.path.exists(TRACE_FILE):
+        os.unlink(TRACE_FILE)
+    create_sssd_process()
+    request.addfinalizer(cleanup_sssd_process)
+
+
+@pytest.fixture
+def sssd(request, ldap_conn):
+    start_sssd(request, format_bench_conf(ldap_conn))
+
+
+@pytest.fixture
+def sssd_enumerate(request, ldap_conn):
+    start_sssd(request, format_bench_conf(ldap_conn, enumerate=True))
+
+
+def count_ldap_ops():
+    """Number of LDAP operations recorded in the backend trace file"""
+    ops = 0
+    with open(TRACE_FILE, "rb") as trace_file:
+        data = trace_file.read()
+
+    for offset in range(0, len(data) - TRACE_RECORD.size + 1,
+                        TRACE_RECORD.size):
+        name = TRACE_RECORD.unpack_from(data, offset)[-1]
+        if name.startswith(b"ldap #"):
+            ops += 1
+
+    return ops
+
+
+def backend_pid():
+    for pid in os.listdir("/proc"):
+        if not pid.isdigit():
+            continue
+        try:
+            with open("/proc/%s/cmdline" % pid, "rb") as cmdline_file:
+                cmdline = cmdline_file.read().split(b"\0")
+        except OSError:
+            continue
+        if os.path.basename(cmdline[0]) == b"sssd_be" \
+                and b"LDAP" in cmdline:
+            return pid
+
+    raise Exception("sssd_be is not running")
+
+
+def backend_peak_rss():
+    """Peak resident set size of sssd_be in kB"""
+    with open("/proc/%s/status" % backend_pid()) as status_file:
+        for line in status_file:
+            if line.startswith("VmHWM:"):
+                return int(line.split()[1])
+
+    return 0
+
+
+class Measurement:
+    """Measure a scenario and check the result against the baseline"""
+
+    def __init__(self, scenario):
+        self.scenario = scenario
+        self.ops_before = 0
+        self.start = 0
+
+    def __enter__(self):
+        self.ops_before = count_ldap_ops()
+        self.start = time.monotonic()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        if exc_type is not None:
+            return False
+
+        wall_time = time.monotonic() - self.start
+        # Spans are written when the operation finishes, give the
+        # backend a moment to write the last ones
+        time.sleep(1)
+        result = {
+            "ldap_ops": count_ldap_ops() - self.ops_before,
+            "wall_time": round(wall_time, 3),
+            "peak_rss_kb": backend_peak_rss(),
+        }
+        report(self.scenario, result)
+        return False
+
+
+def report(scenario, result):
+    print("\n%s: %s" % (scenario, result))
+
+    output = os.environ.get("SSSD_BENCH_OUTPUT")
+    if output is not None:
+        with open(output, "a") as output_file:
+            output_file.write(json.dumps({
+                "scenario": scenario,
+                "users": USERS,
+                "groups": GROUPS,
+                "depth": DEPTH,
+                "width": WIDTH,
+                **result,
+            }) + "\n")
+
+    baseline_path = os.environ.get("SSSD_BENCH_BASELINE")
+    if baseline_path is None:
+        return
+
+    with open(baseline_path) as baseline_file:
+        baseline = json.load(baseline_file).get(scenario, {})
+
+    tolerance = float(os.environ.get("SSSD_BENCH_TOLERANCE", 0.2))
+    for metric, value in result.items():
+        if metric in baseline:
+            limit = baseline[metric] * (1 + tolerance)
+            assert value <= limit, \
+                "%s: %s is %s, baseline %s" % (scenario, metric, value,
+                                               baseline[metric])
+
+
+def lookup_groups(directory, users):
+    for u in users:
+        name = directory.user_name(u)
+        (res, errno, groups) = sssd_id.get_user_groups(name)
+        assert res == NssReturnCode.SUCCESS, \
+            "Could not find groups for %s, %d" % (name, errno)
+        missing = set(directory.expected_initgroups(u)) - set(groups)
+        assert not missing, "%s is missing groups %s" % (name, missing)
+
+
+def test_initgroups(directory, sssd):
+    with Measurement("initgroups"):
+        lookup_groups(directory, range(SAMPLE))
+
+
+def test_large_group(directory, sssd):
+    with Measurement("large_group"):
+        group = grp.getgrnam(directory.large_group_name())
+    assert len(group.gr_mem) == USERS
+
+
+def test_refresh(directory, sssd):
+    lookup_groups(directory, range(SAMPLE))
+    subprocess.check_call(["sss_cache", "-E"])
+
+    with Measurement("refresh"):
+        lookup_groups(directory, range(SAMPLE))
+
+
+def test_enumeration(directory, sssd_enumerate):
+    with Measurement("enumeration"):
+        deadline = time.monotonic() + TIMEOUT
+        while True:
+            users = [p for p in pwd.getpwall()
+                     if p.pw_name.startswith("user")]
+            if len(users) >= USERS:
+                break
+            assert time.monotonic() < deadline, \
+                "Enumeration did not finish in %d seconds" % TIMEOUT
+            time.sleep(1)
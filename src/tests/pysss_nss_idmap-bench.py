@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+#  SSSD
+#
+#  Benchmark for list lookups with pysss_nss_idmap
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""
+Compare looking up a list of objects one by one, as pysss_nss_idmap did
+before the batch API was added, with passing the whole list to a single
+call. Requires a running SSSD which can resolve the given objects, e.g.
+
+    pysss_nss_idmap-bench.py -t namebysid -f sids.txt -r 5
+"""
+from __future__ import print_function
+
+import argparse
+import sys
+import time
+
+import pysss_nss_idmap
+
+LOOKUPS = {
+    'sidbyname': pysss_nss_idmap.getsidbyname,
+    'sidbyid': pysss_nss_idmap.getsidbyid,
+    'namebysid': pysss_nss_idmap.getnamebysid,
+    'idbysid': pysss_nss_idmap.getidbysid,
+}
+
+
+def one_by_one(func, values):
+    result = {}
+    for value in values:
+        result.update(func(value))
+    return result
+
+
+def batch(func, values):
+    return func(values)
+
+
+def run(name, lookup, func, values, rounds):
+    timings = []
+    found = 0
+    for _ in range(rounds):
+        start = time.time()
+        found = len(lookup(func, values))
+        timings.append(time.time() - start)
+
+    timings.sort()
+    best = timings[0]
+    print("%-12s %8d values %8d found  best %8.3fs  median %8.3fs  "
+          "%10.0f lookups/s" % (name, len(values), found, best,
+                                timings[len(timings) // 2],
+                                len(values) / best if best > 0 else 0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('-t', '--type', choices=sorted(LOOKUPS.keys()),
+                        default='namebysid', help='lookup to benchmark')
+    parser.add_argument('-f', '--file', required=True,
+                        help='file with one name, ID or SID per line')
+    parser.add_argument('-r', '--rounds', type=int, default=3,
+                        help='number of rounds for each method')
+    args = parser.parse_args()
+
+    with open(args.file) as f:
+        values = [l.strip() for l in f if l.strip()]
+    if args.type == 'sidbyid':
+        values = [int(v) for v in values]
+
+    func = LOOKUPS[args.type]
+    run('one-by-one', one_by_one, func, values, args.rounds)
+    run('batch', batch, func, values, args.rounds)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -28,6 +28,7 @@
 #include <pwd.h>
 #include <grp.h>
 #include <errno.h>
+#include <time.h>
 
 #include "util/util.h"
 #include "tests/common.h"
@@ -135,6 +136,90 @@ void child_handler(int signum)
     }
 }
 
+static int cmp_usec(const void *a, const void *b)
+{
+    uint64_t ua = *(const uint64_t *)a;
+    uint64_t ub = *(const uint64_t *)b;
+
+    return (ua > ub) - (ua < ub);
+}
+
+static uint64_t elapsed_usec(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000000ULL
+           + (end->tv_nsec - start->tv_nsec) / 1000;
+}
+
+/*
+ * Measure the latency of one lookup done by a freshly spawned process,
+ * i.e. the cost a short-lived client pays including opening the socket.
+ * The children are run one after another so they do not interfere.
+ */
+int run_latency_test(TALLOC_CTX *mem_ctx, char **names,
+                     int group, int enoent_fail)
+{
+    struct timespec start;
+    struct timespec end;
+    uint64_t *usec;
+    uint64_t total = 0;
+    int num;
+    int status;
+    int ret;
+    pid_t pid;
+
+    for (num = 0; names[num]; num++);
+    if (num == 0) {
+        return EOK;
+    }
+
+    usec = talloc_array(mem_ctx, uint64_t, num);
+    if (usec == NULL) {
+        return ENOMEM;
+    }
+
+    for (int i = 0; i < num; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        pid = fork();
+        if (pid == -1) {
+            ret = errno;
+            talloc_free(usec);
+            return ret;
+        } else if (pid == 0) {
+            /* child */
+            ret = run_one_testcase(names[i], group, enoent_fail);
+            _exit(ret);
+        }
+
+        ret = waitpid(pid, &status, 0);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (ret == -1) {
+            ret = errno;
+            talloc_free(usec);
+            return ret;
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ++failure_count;
+        }
+
+        usec[i] = elapsed_usec(&start, &end);
+        total += usec[i];
+    }
+
+    qsort(usec, num, sizeof(uint64_t), cmp_usec);
+
+    printf("Process-spawn lookup latency over %d lookups (usec):\n", num);
+    printf("  min: %"PRIu64"\n", usec[0]);
+    printf("  avg: %"PRIu64"\n", total / num);
+    printf("  p50: %"PRIu64"\n", usec[num / 2]);
+    printf("  p95: %"PRIu64"\n", usec[(num * 95) / 100]);
+    printf("  max: %"PRIu64"\n", usec[num - 1]);
+
+    talloc_free(usec);
+    return EOK;
+}
+
 int generate_names(TALLOC_CTX *mem_ctx, const char *prefix,
                    int start, int stop, char ***_out)
 {
@@ -202,6 +287,7 @@ int main(int argc, const char *argv[])
     int pc_stop=DEFAULT_STOP;
     int pc_enoent_fail=0;
     int pc_groups=0;
+    int pc_latency=0;
     int pc_verbosity = 0;
     char *pc_prefix = NULL;
     TALLOC_CTX *ctx = NULL;
@@ -226,6 +312,9 @@ int main(int argc, const char *argv[])
         { "enoent-fail", '\0', POPT_ARG_NONE, &pc_enoent_fail, 0,
                     "Fail on not getting the requested NSS data (default: No)",
                     NULL },
+        { "latency", '\0', POPT_ARG_NONE, &pc_latency, 0,
+                    "Run the lookups one by one and report the latency "
+                    "of each spawned process", NULL },
         { "verbose", 'v', POPT_ARG_NONE, 0, 'v',
                     "Be verbose", NULL },
         POPT_TABLEEND
@@ -272,6 +361,16 @@ int main(int argc, const char *argv[])
         }
     }
 
+    if (pc_latency) {
+        ret = run_latency_test(ctx, names, pc_groups, pc_enoent_fail);
+        if (ret != EOK) {
+            errno = ret;
+            perror("run_latency_test");
+            exit(EXIT_FAILURE);
+        }
+        return (failure_count==0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     /* Reap the children in a handler asynchronously so we can
      * somehow protect against too many processes */
     memset(&action, 0, sizeof(action));
@@ -0,0 +1,700 @@
+/*
+   SSSD
+
+   sysdb benchmark
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Populates a sysdb with a synthetic set of users, groups and sudo rules and
+ * measures the stores, the searches the responders run most often, the
+ * membership diff and update done by initgroups, timestamp-only updates and
+ * deletes which recompute memberOf. Run it with --query-trace to see which
+ * of the searches cannot use an index, and with --drop-index to compare the
+ * timings with and without a given index.
+ *
+ * With --nesting the first groups form a tree of the given depth, group g
+ * is a member of group (g - 1) / --nesting-width.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <popt.h>
+#include <talloc.h>
+
+#include "util/util.h"
+#include "db/sysdb.h"
+#include "db/sysdb_private.h"
+#include "db/sysdb_sudo.h"
+#include "tests/common.h"
+
+#define TESTS_PATH "tp_" BASE_FILE_STEM
+#define TEST_CONF_DB "test_sysdb_bench.ldb"
+#define TEST_DOM_NAME "bench.test"
+
+#define BENCH_ID_BASE 100000
+#define BENCH_CACHE_TIMEOUT 3600
+
+struct bench_opts {
+    int num_users;
+    int num_groups;
+    int groups_per_user;
+    int nesting;
+    int nesting_width;
+    int num_sudo_rules;
+    int num_lookups;
+    int num_deletes;
+    int rounds;
+    const char *drop_index;
+    int query_trace;
+};
+
+struct bench_ctx {
+    struct sss_test_ctx *tctx;
+    struct bench_opts *opts;
+
+    /* groups 1 to num_nested are members of other groups */
+    int num_nested;
+    time_t now;
+
+    /* two half-overlapping group lists for the membership diff */
+    char **ldap_groups;
+    char **sysdb_groups;
+};
+
+typedef errno_t (*bench_fn)(struct bench_ctx *bctx, int i);
+
+static uint64_t bench_now_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const char *bench_user_name(TALLOC_CTX *mem_ctx, int i)
+{
+    return talloc_asprintf(mem_ctx, "user%d@%s", i, TEST_DOM_NAME);
+}
+
+static const char *bench_group_name(TALLOC_CTX *mem_ctx, int i)
+{
+    return talloc_asprintf(mem_ctx, "group%d@%s", i, TEST_DOM_NAME);
+}
+
+static int bench_num_nested(struct bench_opts *opts)
+{
+    int level_size = 1;
+    int parents = 0;
+    int level;
+
+    /* all groups above the deepest level of the tree have children */
+    for (level = 0; level < opts->nesting; level++) {
+        parents += level_size;
+        level_size *= opts->nesting_width;
+        if (parents * opts->nesting_width >= opts->num_groups - 1) {
+            return opts->num_groups - 1;
+        }
+    }
+
+    return parents * opts->nesting_width;
+}
+
+static errno_t bench_store_group(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    errno_t ret;
+
+    ret = sysdb_store_group(bctx->tctx->dom, bench_group_name(tmp_ctx, i),
+                            BENCH_ID_BASE + i, NULL,
+                            BENCH_CACHE_TIMEOUT, bctx->now);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_nest_group(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    int group = i + 1;
+    errno_t ret;
+
+    ret = sysdb_add_group_member(bctx->tctx->dom,
+                     bench_group_name(tmp_ctx,
+                                      (group - 1) / bctx->opts->nesting_width),
+                     bench_group_name(tmp_ctx, group),
+                     SYSDB_MEMBER_GROUP, false);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_store_user(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    errno_t ret;
+
+    ret = sysdb_store_user(bctx->tctx->dom, bench_user_name(tmp_ctx, i),
+                           NULL, BENCH_ID_BASE + i, BENCH_ID_BASE + i, NULL,
+                           "/home/user", "/bin/sh", NULL, NULL, NULL,
+                           BENCH_CACHE_TIMEOUT, bctx->now);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_add_member(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct bench_opts *opts = bctx->opts;
+    int user = i / opts->groups_per_user;
+    int group = (user + i % opts->groups_per_user) % opts->num_groups;
+    errno_t ret;
+
+    ret = sysdb_add_group_member(bctx->tctx->dom,
+                                 bench_group_name(tmp_ctx, group),
+                                 bench_user_name(tmp_ctx, user),
+                                 SYSDB_MEMBER_USER, false);
+    talloc_free(tmp_ctx);
+    return ret == EEXIST ? EOK : ret;
+}
+
+static errno_t bench_store_sudo_rule(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct sysdb_attrs *attrs;
+    errno_t ret;
+
+    attrs = sysdb_new_attrs(tmp_ctx);
+    if (attrs == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    ret = sysdb_attrs_add_string(attrs, SYSDB_NAME,
+                                 talloc_asprintf(attrs, "rule%d", i));
+    if (ret == EOK) {
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_USER,
+                                     talloc_asprintf(attrs, "user%d", i));
+    }
+    if (ret == EOK) {
+        ret = sysdb_attrs_add_string(attrs, SYSDB_SUDO_CACHE_AT_HOST, "ALL");
+    }
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = sysdb_sudo_store(bctx->tctx->dom, &attrs, 1);
+
+done:
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_getpwnam(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_getpwnam(tmp_ctx, bctx->tctx->dom,
+                         bench_user_name(tmp_ctx, i % bctx->opts->num_users),
+                         &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_getpwuid(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_getpwuid(tmp_ctx, bctx->tctx->dom,
+                         BENCH_ID_BASE + i % bctx->opts->num_users, &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_getgrgid(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_getgrgid(tmp_ctx, bctx->tctx->dom,
+                         BENCH_ID_BASE + i % bctx->opts->num_groups, &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_initgroups(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_initgroups(tmp_ctx, bctx->tctx->dom,
+                           bench_user_name(tmp_ctx,
+                                           i % bctx->opts->num_users),
+                           &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_initgroups_views(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_initgroups_with_views(tmp_ctx, bctx->tctx->dom,
+                                      bench_user_name(tmp_ctx,
+                                                i % bctx->opts->num_users),
+                                      &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_enumpwent(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_enumpwent(tmp_ctx, bctx->tctx->dom, &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_enumgrent(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct ldb_result *res;
+    errno_t ret;
+
+    ret = sysdb_enumgrent(tmp_ctx, bctx->tctx->dom, &res);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_sudo_user(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    const char *attrs[] = { SYSDB_NAME, NULL };
+    struct ldb_message **msgs;
+    size_t count;
+    char *filter;
+    char *name;
+    errno_t ret;
+
+    name = talloc_asprintf(tmp_ctx, "user%d", i % bctx->opts->num_users);
+    filter = sysdb_sudo_filter_user(tmp_ctx, name, NULL,
+                                    BENCH_ID_BASE + i % bctx->opts->num_users);
+    if (name == NULL || filter == NULL) {
+        talloc_free(tmp_ctx);
+        return ENOMEM;
+    }
+
+    ret = sysdb_search_sudo_rules(tmp_ctx, bctx->tctx->dom, filter, attrs,
+                                  &count, &msgs);
+    talloc_free(tmp_ctx);
+    return ret == ENOENT ? EOK : ret;
+}
+
+static char **bench_group_list(TALLOC_CTX *mem_ctx, int first, int num)
+{
+    char **list;
+    int i;
+
+    list = talloc_zero_array(mem_ctx, char *, num + 1);
+    if (list == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < num; i++) {
+        list[i] = talloc_asprintf(list, "cn=group%d,cn=groups,dc=%s",
+                                  first + i, TEST_DOM_NAME);
+        if (list[i] == NULL) {
+            talloc_free(list);
+            return NULL;
+        }
+    }
+
+    return list;
+}
+
+static errno_t bench_diff_lists(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    char **add;
+    char **del;
+    errno_t ret;
+
+    ret = diff_string_lists(tmp_ctx, bctx->ldap_groups, bctx->sysdb_groups,
+                            &add, &del, NULL);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Moves the user from its first group to the one after its last group */
+static errno_t bench_update_members(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    struct bench_opts *opts = bctx->opts;
+    int user = i % opts->num_users;
+    const char *add[2] = { NULL, NULL };
+    const char *del[2] = { NULL, NULL };
+    errno_t ret;
+
+    add[0] = bench_group_name(tmp_ctx,
+                              (user + opts->groups_per_user)
+                                  % opts->num_groups);
+    del[0] = bench_group_name(tmp_ctx, user % opts->num_groups);
+    if (add[0] == NULL || del[0] == NULL) {
+        talloc_free(tmp_ctx);
+        return ENOMEM;
+    }
+
+    ret = sysdb_update_members(bctx->tctx->dom,
+                               bench_user_name(tmp_ctx, user),
+                               SYSDB_MEMBER_USER, add, del);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+/* Stores the user unchanged, only the timestamp cache is written */
+static errno_t bench_ts_update(struct bench_ctx *bctx, int i)
+{
+    TALLOC_CTX *tmp_ctx = talloc_new(NULL);
+    int user = i % bctx->opts->num_users;
+    errno_t ret;
+
+    bctx->now++;
+    ret = sysdb_store_user(bctx->tctx->dom, bench_user_name(tmp_ctx, user),
+                           NULL, BENCH_ID_BASE + user, BENCH_ID_BASE + user,
+                           NULL, "/home/user", "/bin/sh", NULL, NULL, NULL,
+                           BENCH_CACHE_TIMEOUT, bctx->now);
+    talloc_free(tmp_ctx);
+    return ret;
+}
+
+static errno_t bench_delete_user(struct bench_ctx *bctx, int i)
+{
+    int user = bctx->opts->num_users - 1 - i;
+
+    return sysdb_delete_user(bctx->tctx->dom, NULL, BENCH_ID_BASE + user);
+}
+
+/* Deletes the deepest nested groups first, their members and parents
+ * need memberOf recomputed */
+static errno_t bench_delete_group(struct bench_ctx *bctx, int i)
+{
+    int last;
+
+    last = bctx->num_nested > 0 ? bctx->num_nested
+                                : bctx->opts->num_groups - 1;
+
+    return sysdb_delete_group(bctx->tctx->dom, NULL,
+                              BENCH_ID_BASE + last - i);
+}
+
+static void bench_report(const char *name, int num, uint64_t usec)
+{
+    printf("%-16s %8d ops %12.3f ms %14.1f ops/s\n", name, num,
+           usec / 1000.0, usec > 0 ? num * 1000000.0 / usec : 0.0);
+}
+
+/* Runs fn once for each i in a single transaction, as the providers store
+ * the objects of one search reply, for benchmarks which change the cache */
+static errno_t bench_run_once(struct bench_ctx *bctx, const char *name,
+                              bench_fn fn, int num)
+{
+    struct sysdb_ctx *sysdb = bctx->tctx->dom->sysdb;
+    bool in_transaction = false;
+    uint64_t start;
+    errno_t ret;
+    int i;
+
+    start = bench_now_usec();
+
+    ret = sysdb_transaction_start(sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    in_transaction = true;
+
+    for (i = 0; i < num; i++) {
+        ret = fn(bctx, i);
+        if (ret != EOK) {
+            goto done;
+        }
+    }
+
+    ret = sysdb_transaction_commit(sysdb);
+    if (ret != EOK) {
+        goto done;
+    }
+    in_transaction = false;
+
+    bench_report(name, num, bench_now_usec() - start);
+
+done:
+    if (in_transaction) {
+        sysdb_transaction_cancel(sysdb);
+    }
+    if (ret != EOK) {
+        fprintf(stderr, "%s failed [%d]: %s\n", name, ret, sss_strerror(ret));
+    }
+    return ret;
+}
+
+static void bench_print_size(struct bench_ctx *bctx, const char *when)
+{
+    struct sysdb_ctx *sysdb = bctx->tctx->dom->sysdb;
+    struct stat st;
+    off_t cache_size = 0;
+    off_t ts_size = 0;
+
+    if (stat(sysdb->ldb_file, &st) == 0) {
+        cache_size = st.st_size;
+    }
+    if (sysdb->ldb_ts_file != NULL && stat(sysdb->ldb_ts_file, &st) == 0) {
+        ts_size = st.st_size;
+    }
+
+    printf("Cache size %s: %.1f KiB, timestamp cache %.1f KiB\n", when,
+           cache_size / 1024.0, ts_size / 1024.0);
+}
+
+static void bench_run(struct bench_ctx *bctx, const char *name,
+                      bench_fn fn, int num)
+{
+    uint64_t start;
+    uint64_t usec;
+    uint64_t best = UINT64_MAX;
+    int round;
+    int i;
+    errno_t ret;
+
+    for (round = 0; round < bctx->opts->rounds; round++) {
+        start = bench_now_usec();
+        for (i = 0; i < num; i++) {
+            ret = fn(bctx, i);
+            if (ret != EOK) {
+                fprintf(stderr, "%s failed [%d]: %s\n",
+                        name, ret, sss_strerror(ret));
+                return;
+            }
+        }
+        usec = bench_now_usec() - start;
+        if (usec < best) {
+            best = usec;
+        }
+    }
+
+    bench_report(name, num, best);
+}
+
+static errno_t bench_populate(struct bench_ctx *bctx)
+{
+    struct bench_opts *opts = bctx->opts;
+    errno_t ret;
+
+    ret = bench_run_once(bctx, "store group", bench_store_group,
+                         opts->num_groups);
+    if (ret == EOK && bctx->num_nested > 0) {
+        ret = bench_run_once(bctx, "nest group", bench_nest_group,
+                             bctx->num_nested);
+    }
+    if (ret == EOK) {
+        ret = bench_run_once(bctx, "store user", bench_store_user,
+                             opts->num_users);
+    }
+    if (ret == EOK && opts->groups_per_user > 0) {
+        ret = bench_run_once(bctx, "add member", bench_add_member,
+                             opts->num_users * opts->groups_per_user);
+    }
+    if (ret == EOK && opts->num_sudo_rules > 0) {
+        ret = bench_run_once(bctx, "store sudo rule", bench_store_sudo_rule,
+                             opts->num_sudo_rules);
+    }
+
+    return ret;
+}
+
+int main(int argc, const char *argv[])
+{
+    poptContext pc;
+    int opt;
+    int debug = SSSDBG_FATAL_FAILURE;
+    struct bench_opts opts = {
+        .num_users = 10000,
+        .num_groups = 1000,
+        .groups_per_user = 5,
+        .nesting = 0,
+        .nesting_width = 2,
+        .num_sudo_rules = 1000,
+        .num_lookups = 1000,
+        .num_deletes = 100,
+        .rounds = 3,
+        .drop_index = NULL,
+        .query_trace = 0,
+    };
+    struct poptOption long_options[] = {
+        POPT_AUTOHELP
+        { "debug-level", 'd', POPT_ARG_INT, &debug, 0,
+          "Set debug level", NULL },
+        { "users", 'u', POPT_ARG_INT, &opts.num_users, 0,
+          "Number of users to create", NULL },
+        { "groups", 'g', POPT_ARG_INT, &opts.num_groups, 0,
+          "Number of groups to create", NULL },
+        { "groups-per-user", 'm', POPT_ARG_INT, &opts.groups_per_user, 0,
+          "Number of groups each user is a member of", NULL },
+        { "nesting", 'n', POPT_ARG_INT, &opts.nesting, 0,
+          "Depth of the group nesting tree", NULL },
+        { "nesting-width", 'w', POPT_ARG_INT, &opts.nesting_width, 0,
+          "Number of nested groups in each group of the tree", NULL },
+        { "sudo-rules", 's', POPT_ARG_INT, &opts.num_sudo_rules, 0,
+          "Number of sudo rules to create", NULL },
+        { "lookups", 'l', POPT_ARG_INT, &opts.num_lookups, 0,
+          "Number of lookups in each benchmark", NULL },
+        { "deletes", 'D', POPT_ARG_INT, &opts.num_deletes, 0,
+          "Number of users and groups to delete", NULL },
+        { "rounds", 'r', POPT_ARG_INT, &opts.rounds, 0,
+          "Number of rounds, the best one is reported", NULL },
+        { "drop-index", 0, POPT_ARG_STRING, &opts.drop_index, 0,
+          "Remove the index of the given attribute before the lookups",
+          NULL },
+        { "query-trace", 0, POPT_ARG_INT, &opts.query_trace, 0,
+          "Log unindexed searches and searches slower than the given "
+          "number of milliseconds", NULL },
+        POPT_TABLEEND
+    };
+    struct bench_ctx bctx = { NULL, &opts, 0, 0, NULL, NULL };
+    uint64_t start;
+    errno_t ret;
+
+    pc = poptGetContext(argv[0], argc, argv, long_options, 0);
+    while ((opt = poptGetNextOpt(pc)) != -1) {
+        fprintf(stderr, "\nInvalid option %s: %s\n\n",
+                poptBadOption(pc, 0), poptStrerror(opt));
+        poptPrintUsage(pc, stderr, 0);
+        return EXIT_FAILURE;
+    }
+    poptFreeContext(pc);
+
+    if (opts.num_users <= 0 || opts.num_groups <= 0 || opts.rounds <= 0
+            || opts.nesting_width <= 0) {
+        fprintf(stderr, "The number of users, groups, rounds and the "
+                        "nesting width must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    if (opts.groups_per_user < 0 || opts.nesting < 0
+            || opts.num_deletes < 0) {
+        fprintf(stderr, "The number of memberships, the nesting depth and "
+                        "the number of deletes must not be negative\n");
+        return EXIT_FAILURE;
+    }
+
+    bctx.num_nested = bench_num_nested(&opts);
+    bctx.now = time(NULL);
+
+    DEBUG_CLI_INIT(debug);
+
+    if (opts.query_trace > 0) {
+        sysdb_query_trace_enable(opts.query_trace);
+    }
+
+    test_dom_suite_setup(TESTS_PATH);
+    bctx.tctx = create_dom_test_ctx(NULL, TESTS_PATH, TEST_CONF_DB,
+                                    TEST_DOM_NAME, "ldap", NULL);
+    if (bctx.tctx == NULL) {
+        fprintf(stderr, "Cannot create the test domain\n");
+        return EXIT_FAILURE;
+    }
+
+    start = bench_now_usec();
+    ret = bench_populate(&bctx);
+    if (ret != EOK) {
+        fprintf(stderr, "Cannot populate the cache [%d]: %s\n",
+                ret, sss_strerror(ret));
+        goto done;
+    }
+    printf("Populated %d users, %d groups (%d nested) and %d sudo rules "
+           "in %.3f s\n", opts.num_users, opts.num_groups, bctx.num_nested,
+           opts.num_sudo_rules, (bench_now_usec() - start) / 1000000.0);
+    bench_print_size(&bctx, "after populating");
+
+    if (opts.drop_index != NULL) {
+        ret = sysdb_ldb_mod_index(bctx.tctx, SYSDB_IDX_DELETE,
+                                  bctx.tctx->dom->sysdb->ldb,
+                                  opts.drop_index);
+        if (ret != EOK) {
+            fprintf(stderr, "Cannot remove index of %s [%d]: %s\n",
+                    opts.drop_index, ret, sss_strerror(ret));
+            goto done;
+        }
+        printf("Removed the index of %s\n", opts.drop_index);
+    }
+
+    bench_run(&bctx, "getpwnam", bench_getpwnam, opts.num_lookups);
+    bench_run(&bctx, "getpwuid", bench_getpwuid, opts.num_lookups);
+    bench_run(&bctx, "getgrgid", bench_getgrgid, opts.num_lookups);
+    bench_run(&bctx, "initgroups", bench_initgroups, opts.num_lookups);
+    bench_run(&bctx, "initgr views", bench_initgroups_views,
+              opts.num_lookups);
+    if (opts.num_sudo_rules > 0) {
+        bench_run(&bctx, "sudo rules", bench_sudo_user, opts.num_lookups);
+    }
+    bench_run(&bctx, "enumpwent", bench_enumpwent, 1);
+    bench_run(&bctx, "enumgrent", bench_enumgrent, 1);
+
+    bctx.ldap_groups = bench_group_list(bctx.tctx, 0, opts.num_groups);
+    bctx.sysdb_groups = bench_group_list(bctx.tctx, opts.num_groups / 2,
+                                         opts.num_groups);
+    if (bctx.ldap_groups == NULL || bctx.sysdb_groups == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+    bench_run(&bctx, "diff lists", bench_diff_lists, 100);
+
+    /* the rest modifies the cache, must run last */
+    bench_run(&bctx, "update members", bench_update_members,
+              opts.num_lookups);
+    bench_run(&bctx, "ts update", bench_ts_update, opts.num_lookups);
+
+    ret = bench_run_once(&bctx, "delete user", bench_delete_user,
+                         MIN(opts.num_deletes, opts.num_users));
+    if (ret != EOK) {
+        goto done;
+    }
+
+    ret = bench_run_once(&bctx, "delete group", bench_delete_group,
+                         MIN(opts.num_deletes,
+                             bctx.num_nested > 0 ? bctx.num_nested
+                                                 : opts.num_groups));
+    if (ret != EOK) {
+        goto done;
+    }
+
+    bench_print_size(&bctx, "at the end");
+    ret = EOK;
+
+done:
+    talloc_free(bctx.tctx);
+    test_dom_suite_cleanup(TESTS_PATH, TEST_CONF_DB, TEST_DOM_NAME);
+    return ret == EOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
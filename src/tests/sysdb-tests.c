@@ -5773,6 +5773,52 @@ START_TEST(test_sysdb_has_enumerated)
 }
 END_TEST
 
+START_TEST(test_sysdb_enum_cursor)
+{
+    errno_t ret;
+    struct sysdb_test_ctx *test_ctx;
+    char *usn;
+
+    /* Setup */
+    ret = setup_sysdb_tests(&test_ctx);
+    sss_ck_fail_if_msg(ret != EOK, "Could not set up the test");
+
+    ret = sysdb_get_enum_cursor(test_ctx, test_ctx->domain,
+                                SYSDB_ENUM_USER_CURSOR, NULL, &usn);
+    sss_ck_fail_if_msg(ret != ENOENT,
+            "Error [%d][%s] reading cursor, ENOENT is expected",
+            ret, strerror(ret));
+
+    ret = sysdb_set_enum_cursor(test_ctx->domain, SYSDB_ENUM_USER_CURSOR,
+                                "ldap://srv1:389", "1042");
+    sss_ck_fail_if_msg(ret != EOK, "Error [%d][%s] saving cursor",
+                        ret, strerror(ret));
+
+    ret = sysdb_get_enum_cursor(test_ctx, test_ctx->domain,
+                                SYSDB_ENUM_USER_CURSOR, "ldap://srv1:389",
+                                &usn);
+    sss_ck_fail_if_msg(ret != EOK, "Error [%d][%s] reading cursor",
+                        ret, strerror(ret));
+    ck_assert_str_eq(usn, "1042");
+
+    /* A cursor saved for another server must not be used */
+    ret = sysdb_get_enum_cursor(test_ctx, test_ctx->domain,
+                                SYSDB_ENUM_USER_CURSOR, "ldap://srv2:389",
+                                &usn);
+    sss_ck_fail_if_msg(ret != ENOENT,
+            "Error [%d][%s] reading foreign cursor, ENOENT is expected",
+            ret, strerror(ret));
+
+    ret = sysdb_get_enum_cursor(test_ctx, test_ctx->domain,
+                                SYSDB_ENUM_GROUP_CURSOR, NULL, &usn);
+    sss_ck_fail_if_msg(ret != ENOENT,
+            "Error [%d][%s] reading group cursor, ENOENT is expected",
+            ret, strerror(ret));
+
+    talloc_free(test_ctx);
+}
+END_TEST
+
 START_TEST(test_sysdb_original_dn_case_insensitive)
 {
     errno_t ret;
@@ -8022,6 +8068,7 @@ Suite *create_sysdb_suite(void)
 
     /* Test sysdb enumerated flag */
     tcase_add_test(tc_sysdb, test_sysdb_has_enumerated);
+    tcase_add_test(tc_sysdb, test_sysdb_enum_cursor);
 
     /* Test originalDN searches */
     tcase_add_test(tc_sysdb, test_sysdb_original_dn_case_insensitive);
@@ -383,6 +383,27 @@ START_TEST(test_diff_string_lists)
     ck_assert_msg(only_l2[0] == NULL, "only_l2 should have zero entries");
     ck_assert_msg(both[0] == NULL, "both should have zero entries");
 
+    talloc_zfree(only_l1);
+    talloc_zfree(only_l2);
+    talloc_zfree(both);
+
+    /* Test with duplicates, they are reported only once */
+    l3[0] = talloc_strdup(l1, "c");
+    l3[1] = talloc_strdup(l1, "d");
+    l3[2] = talloc_strdup(l1, "c");
+
+    ret = diff_string_lists(test_ctx,
+                            l3, l2,
+                            &only_l1, &only_l2, &both);
+
+    ck_assert_msg(ret == EOK, "diff_string_lists returned error [%d]", ret);
+    ck_assert_msg(only_l1[0] == NULL, "only_l1 should have zero entries");
+    ck_assert_msg(strcmp(only_l2[0], "b") == 0, "Missing \"b\" from only_l2");
+    ck_assert_msg(only_l2[1] == NULL, "only_l2 not NULL-terminated");
+    ck_assert_msg(strcmp(both[0], "d") == 0, "Missing \"d\" from both");
+    ck_assert_msg(strcmp(both[1], "c") == 0, "Missing \"c\" from both");
+    ck_assert_msg(both[2] == NULL, "both not NULL-terminated");
+
     talloc_free(test_ctx);
 }
 END_TEST
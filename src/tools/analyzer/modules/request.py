@@ -105,11 +105,8 @@ class RequestAnalyzer:
         if consume:
             self.consumed_logs.append(line.rstrip(line[-1]))
         else:
-            # files source includes newline
-            if type(source).__name__ == 'Files':
-                print(line, end='')
-            else:
-                print(line)
+            # files source includes newline, journald does not
+            print(line.rstrip('\n'))
         return found_results
 
     def print_formatted_verbose(self, source):
@@ -230,6 +227,13 @@ class RequestAnalyzer:
 
         if args.verbose:
             self.print_formatted_verbose(source)
+            return
+
+        indexes = source.index()
+        if indexes is not None:
+            for index in indexes:
+                for line in index.read_commands():
+                    self.print_formatted(line)
         else:
             for line in utl.matched_line(source, patterns):
                 if type(source).__name__ == 'Journald':
@@ -260,6 +264,11 @@ class RequestAnalyzer:
         logger.info(f"******** Checking {resp} responder for Client ID"
                     f" {cid} *******")
         source.set_component(component, args.child)
+        indexes = source.index()
+        if indexes is not None:
+            self.track_request_indexed(source, indexes, args, resp)
+            return
+
         for match in utl.matched_line(source, pattern):
             resp_results = self.consume_line(match, source, args.merge)
 
@@ -276,11 +285,52 @@ class RequestAnalyzer:
         for match in utl.matched_line(source, pattern):
             be_results = self.consume_line(match, source, args.merge)
 
+        self.print_merged(args)
+        if not resp_results and not be_results:
+            logger.warn(f"ID {cid} not found in logs!")
+
+    def track_request_indexed(self, source, indexes, args, resp):
+        """
+        Print Logs pertaining to individual SSSD client request, read only
+        the parts of the log files which the log index points to
+
+        Args:
+            source (Reader): source Reader object
+            indexes (list of FileIndex): Indexes of the responder logs
+            args (Namespace):  populated argparse namespace
+            resp (str): Responder name
+        """
+        cid = args.cid
+        resp_results = False
+        be_results = False
+
+        for index in indexes:
+            for line in index.read_ranges([f'CID#{cid}']):
+                resp_results = self.consume_line(line, source, args.merge)
+
+        logger.info(f"********* Checking Backend for Client ID {cid} ********")
+        source.set_component(source.Component.BE, args.child)
+        for index in source.index():
+            # Request ids are unique only within a single backend
+            be_ids = index.links.get(f'sssd.{resp} CID #{cid}', [])
+            for line in index.read_ranges(be_ids):
+                be_results = self.consume_line(line, source, args.merge)
+
+        self.print_merged(args)
+        if not resp_results and not be_results:
+            logger.warn(f"ID {cid} not found in logs!")
+
+    def print_merged(self, args):
+        """
+        Print consumed lines sorted by timestamp if merge cli option
+        is provided
+
+        Args:
+            args (Namespace):  populated argparse namespace
+        """
         if args.merge:
             # sort by date/timestamp
             sorted_list = sorted(self.consumed_logs,
                                  key=lambda s: s.split(')')[0])
             for entry in sorted_list:
                 print(entry)
-        if not resp_results and not be_results:
-            logger.warn(f"ID {cid} not found in logs!")
@@ -0,0 +1,283 @@
+import os
+import glob
+import errno
+import struct
+import logging
+from sssd.parser import SubparsersAction
+from sssd.parser import Option
+
+logger = logging.getLogger()
+
+# Keep in sync with struct sss_trace_record in src/util/sss_trace.h
+TRACE_RECORD = struct.Struct('=IHHIIQQQQiI16s24s48s')
+TRACE_MAGIC = 0x53535354
+TRACE_VERSION = 1
+
+KIND_SPAN = 0
+KIND_SBUS_CALL = 1
+KIND_DP_REQUEST = 2
+KIND_CHILD = 3
+
+
+class Span:
+    """
+    One trace record and the spans nested under it
+    """
+    def __init__(self, data):
+        (self.magic, self.version, self.kind, self.pid, self.ppid,
+         self.chain_id, self.link_id, self.start, self.end, self.error,
+         _, process, peer, name) = TRACE_RECORD.unpack(data)
+        self.process = process.split(b'\0', 1)[0].decode(errors='replace')
+        self.peer = peer.split(b'\0', 1)[0].decode(errors='replace')
+        self.name = name.split(b'\0', 1)[0].decode(errors='replace')
+        self.children = []
+
+    def duration(self):
+        return self.end - self.start
+
+    def contains(self, other):
+        return self.start <= other.start and other.end <= self.end
+
+
+class Request:
+    """
+    All spans recorded by a responder for one client request
+    """
+    def __init__(self, process, pid, cid):
+        self.process = process
+        self.pid = pid
+        self.cid = cid
+        self.spans = []
+
+    def start(self):
+        return min(span.start for span in self.spans)
+
+    def end(self):
+        return max(span.end for span in self.spans)
+
+
+class TraceAnalyzer:
+    """
+    A trace analyzer module, joins the trace spans recorded by the
+    responders, the backends and the child processes into a latency
+    breakdown of individual requests.
+    """
+    module_parser = None
+    list_opts = [
+        Option('--slow', 'Only list requests which took at least this '
+               'many milliseconds', int),
+    ]
+
+    show_opts = [
+        Option('cid', 'Show request with this ID', int),
+    ]
+
+    def print_module_help(self, args):
+        """
+        Print the module parser help output
+
+        Args:
+            args (Namespace): argparse parsed arguments
+        """
+        self.module_parser.print_help()
+
+    def setup_args(self, parser_grp, cli):
+        """
+        Setup module parser, subcommands, and options
+
+        Args:
+            parser_grp (argparse.Action): Parser group to nest
+               module and subcommands under
+        """
+        desc = "Analyze request trace spans module"
+        self.module_parser = parser_grp.add_parser('trace',
+                                                   description=desc,
+                                                   help='Request latency '
+                                                   'breakdown')
+
+        subparser = self.module_parser.add_subparsers(title=None,
+                                                      dest='subparser',
+                                                      action=SubparsersAction,
+                                                      metavar='COMMANDS')
+
+        subcmd_grp = subparser.add_parser_group('Operation Modes')
+        cli.add_subcommand(subcmd_grp, 'list', 'List traced requests',
+                           self.list_requests, self.list_opts)
+        cli.add_subcommand(subcmd_grp, 'show', 'Show latency breakdown of '
+                           'request ID', self.show_request, self.show_opts)
+
+        self.module_parser.set_defaults(func=self.print_module_help)
+
+        return self.module_parser
+
+    def load_spans(self, logdir):
+        """
+        Read all trace records from the trace files in the log directory
+
+        Args:
+            logdir (str): SSSD log directory
+
+        Returns:
+            List of Span objects
+        """
+        spans = []
+        for path in sorted(glob.glob(os.path.join(logdir, '*.trace'))):
+            try:
+                with open(path, 'rb') as trace_file:
+                    data = trace_file.read()
+            except IOError as err:
+                if err.errno == errno.EACCES:
+                    logger.warning(f'Permission denied reading {path}')
+                    continue
+                raise
+
+            size = TRACE_RECORD.size
+            for offset in range(0, len(data) - size + 1, size):
+                span = Span(data[offset:offset + size])
+                if span.magic != TRACE_MAGIC or span.version != TRACE_VERSION:
+                    logger.warning(f'Invalid trace record in {path}, '
+                                   'skipping the rest of the file')
+                    break
+                spans.append(span)
+
+        return spans
+
+    def join_spans(self, spans):
+        """
+        Build responder requests with the backend and child spans
+        attached to the spans which waited for them
+
+        Args:
+            spans (list of Span): All recorded spans
+
+        Returns:
+            List of Request objects sorted by start time
+        """
+        backends = {s.pid for s in spans if s.kind == KIND_DP_REQUEST}
+        children = {s.pid for s in spans if s.kind == KIND_CHILD}
+
+        # sbus names of responders, the data provider knows responders
+        # only by the name
+        names = {}
+        for span in spans:
+            if span.kind == KIND_SBUS_CALL and span.peer:
+                names[span.pid] = span.peer
+
+        requests = {}
+        dp_requests = {}
+        be_spans = {}
+        child_spans = {}
+        for span in spans:
+            if span.pid in children:
+                child_spans.setdefault(span.pid, []).append(span)
+            elif span.kind == KIND_DP_REQUEST:
+                dp_requests.setdefault((span.peer, span.link_id),
+                                       []).append(span)
+            elif span.pid in backends:
+                be_spans.setdefault((span.pid, span.chain_id),
+                                    []).append(span)
+            elif span.chain_id != 0:
+                key = (span.pid, span.chain_id)
+                if key not in requests:
+                    requests[key] = Request(span.process, span.pid,
+                                            span.chain_id)
+                requests[key].spans.append(span)
+
+        # Child processes are tied to their parent by pid and chain id
+        child_roots = {}
+        for pid, cspans in child_spans.items():
+            root = [s for s in cspans if s.kind == KIND_CHILD]
+            if not root:
+                continue
+            root = root[0]
+            root.children = sorted([s for s in cspans if s is not root],
+                                   key=lambda s: s.start)
+            child_roots.setdefault((root.ppid, root.chain_id),
+                                   []).append(root)
+
+        for dp_list in dp_requests.values():
+            for dp in dp_list:
+                nested = (be_spans.get((dp.pid, dp.chain_id), []) +
+                          child_roots.get((dp.pid, dp.chain_id), []))
+                dp.children = sorted([s for s in nested if dp.contains(s)],
+                                     key=lambda s: s.start)
+
+        for req in requests.values():
+            start = req.start()
+            end = req.end()
+            name = names.get(req.pid)
+            attached = (dp_requests.get((name, req.cid), []) +
+                        child_roots.get((req.pid, req.cid), []))
+
+            # Outer spans first so that inner spans find their parent
+            flat = req.spans + [s for s in attached if start <= s.start <= end]
+            req.spans = []
+            for span in sorted(flat, key=lambda s: (s.start, -s.end)):
+                self.nest(req.spans, span)
+
+        return sorted(requests.values(), key=lambda r: r.start())
+
+    def nest(self, spans, span):
+        """
+        Attach span under the innermost span which waited for it, or to the
+        top level if there is no such span
+        """
+        for parent in spans:
+            if parent is not span and parent.contains(span):
+                self.nest(parent.children, span)
+                return
+        spans.append(span)
+        spans.sort(key=lambda s: s.start)
+
+    def format_us(self, usec):
+        return f'{usec / 1000:.3f} ms'
+
+    def print_span(self, span, base, indent):
+        result = 'ok' if span.error == 0 else f'error {span.error}'
+        offset = self.format_us(span.start - base)
+        label = f'{span.process}: {span.name}'
+        print(f'{"  " * indent}{label:<{60 - 2 * indent}} '
+              f'+{offset:>12} {self.format_us(span.duration()):>12} '
+              f'[{result}]')
+        for child in span.children:
+            self.print_span(child, base, indent + 1)
+
+    def list_requests(self, args):
+        """
+        List traced requests with their total latency
+
+        Args:
+            args (Namespace): populated argparse namespace
+        """
+        requests = self.join_spans(self.load_spans(args.logdir))
+        for req in requests:
+            duration = req.end() - req.start()
+            if args.slow is not None and duration < args.slow * 1000:
+                continue
+            names = ', '.join(s.name for s in req.spans
+                              if s.kind == KIND_SPAN)
+            print(f'{req.process} CID #{req.cid} (pid {req.pid}) '
+                  f'{self.format_us(duration)}: {names}')
+
+    def show_request(self, args):
+        """
+        Print the latency breakdown of a request
+
+        Args:
+            args (Namespace): populated argparse namespace
+        """
+        requests = self.join_spans(self.load_spans(args.logdir))
+        found = False
+        for req in requests:
+            if req.cid != args.cid:
+                continue
+            found = True
+            duration = req.end() - req.start()
+            print(f'{req.process} CID #{req.cid} (pid {req.pid}) '
+                  f'{self.format_us(duration)}')
+            for span in req.spans:
+                self.print_span(span, req.start(), 1)
+            print()
+
+        if not found:
+            print(f'No trace spans found for CID #{args.cid}')
@@ -2,6 +2,7 @@ import glob
 import logging
 
 from sssd.source_reader import Reader
+from sssd.source_index import load_indexes
 
 logger = logging.getLogger()
 
@@ -46,7 +47,7 @@ class Files(Reader):
         """ Retrieve list of SSSD log files, exclude rotated (.gz) files """
         domain_files = []
         exclude_list = ["ifp", "nss", "pam", "sudo", "autofs",
-                        "ssh", "pac", "kcm", ".gz"]
+                        "ssh", "pac", "kcm", ".gz", ".trace"]
         if child:
             file_list = glob.glob(self.path + "*.log")
         else:
@@ -57,6 +58,16 @@ class Files(Reader):
 
         return domain_files
 
+    def index(self):
+        """
+        Retrieve the indexes of the component log files, the indexes are
+        updated with the lines logged since the last run first
+
+        Returns:
+            List of FileIndex objects
+        """
+        return load_indexes(self.log_files)
+
     def set_component(self, component, child):
         """
         Switch the reader to interact with a certain SSSD component
@@ -0,0 +1,237 @@
+import os
+import re
+import json
+import logging
+from concurrent.futures import ProcessPoolExecutor
+
+logger = logging.getLogger()
+
+INDEX_VERSION = 2
+
+# Chain id of the request which logged the line
+ID_RE = re.compile(rb'\[((?:CID|RID)#[0-9]+)\]')
+# Backend request created on behalf of a responder request
+LINK_RE = re.compile(rb'\[(RID#[0-9]+)\].*REQ_TRACE: New request\. '
+                     rb'\[(\S+) CID #([0-9]+)\]')
+# Size of the file head used to detect a file replaced under the same inode
+HEAD_SIZE = 256
+
+
+class FileIndex:
+    """
+    Sidecar index of a single log file, maps chain ids to the ranges of
+    the file with lines logged by the request.
+
+    The index is stored next to the log file as .<name>.idx and extended
+    incrementally, only the part of the log written since the last run is
+    parsed. A rotated or truncated log file is indexed again from the
+    beginning.
+    """
+    def __init__(self, path):
+        self.path = path
+        self.index_path = os.path.join(os.path.dirname(path),
+                                       '.' + os.path.basename(path) + '.idx')
+        self.inode = None
+        self.head = ''
+        self.size = 0
+        # id -> [first timestamp, [[offset, length], ...]]
+        self.ids = {}
+        # 'sssd.nss CID #5' -> ['RID#7', ...]
+        self.links = {}
+        # [[offset, length], ...] of the responder client command lines
+        self.cmds = []
+
+    def load(self):
+        try:
+            with open(self.index_path) as file:
+                data = json.load(file)
+        except (OSError, ValueError):
+            return
+
+        if data.get('version') != INDEX_VERSION:
+            return
+
+        self.inode = data['inode']
+        self.head = data['head']
+        self.size = data['size']
+        self.ids = data['ids']
+        self.links = data['links']
+        self.cmds = data['cmds']
+
+    def save(self):
+        data = {
+            'version': INDEX_VERSION,
+            'inode': self.inode,
+            'head': self.head,
+            'size': self.size,
+            'ids': self.ids,
+            'links': self.links,
+            'cmds': self.cmds,
+        }
+
+        tmp_path = self.index_path + '.tmp'
+        try:
+            with open(tmp_path, 'w') as file:
+                json.dump(data, file, separators=(',', ':'))
+            os.rename(tmp_path, self.index_path)
+        except OSError as err:
+            # The index is only a cache, continue with the in-memory copy
+            logger.debug(f'Unable to store index {self.index_path}: {err}')
+
+    def reset(self):
+        self.size = 0
+        self.ids = {}
+        self.links = {}
+        self.cmds = []
+
+    def update(self):
+        """
+        Parse the part of the log file which is not indexed yet
+
+        Returns:
+            True if the index changed
+        """
+        with open(self.path, 'rb') as file:
+            stat = os.fstat(file.fileno())
+            head = file.read(HEAD_SIZE).hex()
+
+            if (stat.st_ino != self.inode or stat.st_size < self.size
+                    or not head.startswith(self.head)):
+                self.reset()
+
+            self.inode = stat.st_ino
+            self.head = head
+            if stat.st_size == self.size:
+                return False
+
+            file.seek(self.size)
+            offset = self.size
+            for line in file:
+                if not line.endswith(b'\n'):
+                    # Line is still being written, index it next time
+                    break
+
+                if line.startswith(b'   *  '):
+                    # Backtrace repeats lines which were already indexed
+                    offset += len(line)
+                    continue
+
+                match = ID_RE.search(line)
+                if match is not None:
+                    self.add_line(match.group(1).decode(), line, offset)
+                    if b'REQ_TRACE' in line:
+                        self.add_link(line)
+
+                if b'[cmd' in line:
+                    add_range(self.cmds, line, offset)
+
+                offset += len(line)
+
+            self.size = offset
+
+        return True
+
+    def add_line(self, id, line, offset):
+        entry = self.ids.get(id)
+        if entry is None:
+            ts = line.split(b')', 1)[0].lstrip(b'(').decode(errors='replace')
+            entry = [ts, []]
+            self.ids[id] = entry
+
+        add_range(entry[1], line, offset)
+
+    def add_link(self, line):
+        match = LINK_RE.search(line)
+        if match is None:
+            return
+
+        key = f'{match.group(2).decode()} CID #{match.group(3).decode()}'
+        rids = self.links.setdefault(key, [])
+        rid = match.group(1).decode()
+        if rid not in rids:
+            rids.append(rid)
+
+    def read_ranges(self, ids):
+        """
+        Read the lines logged by the requests
+
+        Args:
+            ids (list of str): Chain ids, e.g. CID#5 or RID#7
+
+        Returns:
+            List of lines in the order they were logged
+        """
+        ranges = []
+        for id in ids:
+            if id in self.ids:
+                ranges.extend(self.ids[id][1])
+
+        return self.read(ranges)
+
+    def read_commands(self):
+        """
+        Read the lines logged when a responder received a client command
+
+        Returns:
+            List of lines in the order they were logged
+        """
+        return self.read(self.cmds)
+
+    def read(self, ranges):
+        lines = []
+        with open(self.path, 'rb') as file:
+            for offset, length in sorted(ranges):
+                file.seek(offset)
+                data = file.read(length).decode(errors='replace')
+                lines.extend(data.splitlines(keepends=True))
+
+        return lines
+
+
+def add_range(ranges, line, offset):
+    if ranges and sum(ranges[-1]) == offset:
+        # Extend the range of consecutive lines
+        ranges[-1][1] += len(line)
+    else:
+        ranges.append([offset, len(line)])
+
+
+def update_index(path):
+    """
+    Bring the index of a log file up to date, runs in a worker process
+
+    Returns:
+        Up to date FileIndex or None if the log file can not be read
+    """
+    index = FileIndex(path)
+    index.load()
+    try:
+        changed = index.update()
+    except OSError as err:
+        logger.warning(f'Could not index log file {path}, skipping')
+        logger.warning(err)
+        return None
+
+    if changed:
+        index.save()
+
+    return index
+
+
+def load_indexes(paths):
+    """
+    Update the indexes of log files in parallel
+
+    Args:
+        paths (list of str): Log files
+
+    Returns:
+        List of FileIndex objects in the same order as paths
+    """
+    if len(paths) < 2:
+        indexes = [update_index(path) for path in paths]
+    else:
+        with ProcessPoolExecutor() as executor:
+            indexes = list(executor.map(update_index, paths))
+
+    return [index for index in indexes if index is not None]
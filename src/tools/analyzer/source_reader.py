@@ -25,3 +25,13 @@ class Reader(ABC):
     @abstractmethod
     def set_component(self):
         pass
+
+    def index(self):
+        """
+        Retrieve the indexes of the current component, sources which can
+        not be indexed fall back to reading every entry
+
+        Returns:
+            List of FileIndex objects or None if indexing is not supported
+        """
+        return None
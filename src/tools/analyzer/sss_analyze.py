@@ -2,6 +2,7 @@ import argparse
 
 from sssd.modules import request
 from sssd.modules import error
+from sssd.modules import trace
 from sssd.parser import SubparsersAction
 
 
@@ -57,10 +58,12 @@ class Analyzer:
         # Currently only the 'request' module exists
         req = request.RequestAnalyzer()
         err = error.ErrorAnalyzer()
+        trc = trace.TraceAnalyzer()
         cli = Analyzer()
 
         req.setup_args(parser_grp, cli)
         err.setup_args(parser_grp, cli)
+        trc.setup_args(parser_grp, cli)
 
     def setup_args(self):
         """
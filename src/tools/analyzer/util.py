@@ -35,9 +35,9 @@ class Utils:
         Yields:
             lines matching the provided pattern(s)
         """
+        re_objs = [re.compile(pattern) for pattern in patterns]
         for line in source:
-            for pattern in patterns:
-                re_obj = re.compile(pattern)
+            for re_obj in re_objs:
                 if re_obj.search(line):
                     if line.startswith('   *  '):
                         continue
@@ -338,6 +338,8 @@ int main(int argc, const char **argv)
         SSS_TOOL_COMMAND_FLAGS("logs-remove", "Remove existing SSSD log files", sssctl_logs_remove, SSS_TOOL_FLAG_SKIP_CMD_INIT),
         SSS_TOOL_COMMAND_FLAGS("logs-fetch", "Archive SSSD log files in tarball", sssctl_logs_fetch, SSS_TOOL_FLAG_SKIP_CMD_INIT),
         SSS_TOOL_COMMAND("debug-level", "Change or print information about SSSD debug level", sssctl_debug_level),
+        SSS_TOOL_COMMAND("memory-report", "Report memory usage of running SSSD processes", sssctl_memory_report),
+        SSS_TOOL_COMMAND("loop-report", "Report event handlers blocking running SSSD processes", sssctl_loop_report),
         SSS_TOOL_COMMAND_FLAGS("analyze", "Analyze logged data", sssctl_analyze, SSS_TOOL_FLAG_SKIP_CMD_INIT|SSS_TOOL_FLAG_SKIP_ROOT_CHECK),
         SSS_TOOL_DELIMITER("Configuration files tools:"),
         SSS_TOOL_COMMAND_FLAGS("config-check", "Perform static analysis of SSSD configuration", sssctl_config_check, SSS_TOOL_FLAG_SKIP_CMD_INIT),
@@ -89,6 +89,12 @@ errno_t sssctl_logs_fetch(struct sss_cmdline *cmdline,
 errno_t sssctl_debug_level(struct sss_cmdline *cmdline,
                            struct sss_tool_ctx *tool_ctx);
 
+errno_t sssctl_memory_report(struct sss_cmdline *cmdline,
+                             struct sss_tool_ctx *tool_ctx);
+
+errno_t sssctl_loop_report(struct sss_cmdline *cmdline,
+                           struct sss_tool_ctx *tool_ctx);
+
 errno_t sssctl_analyze(struct sss_cmdline *cmdline,
                        struct sss_tool_ctx *tool_ctx);
 
@@ -34,6 +34,7 @@
 #include <glob.h>
 
 #include "util/util.h"
+#include "util/sss_loop_stats.h"
 #include "tools/common/sss_tools.h"
 #include "tools/common/sss_process.h"
 #include "tools/sssctl/sssctl.h"
@@ -586,6 +587,274 @@ fini:
     return ret;
 }
 
+static errno_t do_memory_report(TALLOC_CTX *mem_ctx,
+                                struct sbus_sync_connection *conn,
+                                const char *busname,
+                                const char *target,
+                                uint32_t top)
+{
+    const char **names;
+    uint64_t *blocks;
+    uint64_t *bytes;
+    uint64_t *total_bytes;
+    size_t i;
+    errno_t ret;
+
+    ret = sbus_call_service_tallocReport(mem_ctx, conn, busname, SSS_BUS_PATH,
+                                         top, &names, &blocks, &bytes,
+                                         &total_bytes);
+    if (ret != EOK) {
+        return ENOENT;
+    }
+
+    PRINT("%s:\n", target);
+    PRINT("%1$14s %2$14s %3$10s  %4$s\n",
+          _("Total bytes"), _("Bytes"), _("Blocks"), _("Name"));
+    for (i = 0; names[i] != NULL; i++) {
+        PRINT("%1$14"PRIu64" %2$14"PRIu64" %3$10"PRIu64"  %4$s\n",
+              total_bytes[i], bytes[i], blocks[i], names[i]);
+    }
+    PRINT("\n");
+
+    return EOK;
+}
+
+errno_t sssctl_memory_report(struct sss_cmdline *cmdline,
+                             struct sss_tool_ctx *tool_ctx)
+{
+    int ret;
+    int pc_services = 0;
+    int top = 20;
+    int sample = -1;
+    bool all_targets;
+    const char **pc_domains = NULL;
+    const char **targets = NULL;
+    const char **curr_target;
+    const char *target;
+    const char *busname;
+    struct sbus_sync_connection *conn;
+    struct debuglevel_tool_ctx *ctx = NULL;
+    struct poptOption long_options[] = {
+        {"domain", '\0', POPT_ARG_ARGV, &pc_domains,
+            0, _("Target a specific domain"), _("domain")},
+        POPT_SERV_OPTION(SSSD, pc_services, _("Target the SSSD service")),
+        POPT_SERV_OPTION(NSS, pc_services, _("Target the NSS service")),
+        POPT_SERV_OPTION(PAM, pc_services, _("Target the PAM service")),
+        POPT_SERV_OPTION(SUDO, pc_services, _("Target the SUDO service")),
+        POPT_SERV_OPTION(AUTOFS, pc_services, _("Target the AUTOFS service")),
+        POPT_SERV_OPTION(SSH, pc_services, _("Target the SSH service")),
+        POPT_SERV_OPTION(PAC, pc_services, _("Target the PAC service")),
+        POPT_SERV_OPTION(IFP, pc_services, _("Target the IFP service")),
+        {"top", '\0', POPT_ARG_INT, &top,
+            0, _("Number of contexts to show, 0 shows all"), NULL},
+        {"sample", '\0', POPT_ARG_INT, &sample,
+            0, _("Log the fastest growing contexts every given number of "
+                 "seconds, 0 stops the sampling"), _("seconds")},
+        POPT_TABLEEND
+    };
+
+    ctx = talloc_zero(NULL, struct debuglevel_tool_ctx);
+    if (ctx == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not allocate memory for tools context\n");
+        ret = ENOMEM;
+        goto fini;
+    }
+
+    ret = sss_tool_popt(cmdline, long_options, SSS_TOOL_OPT_OPTIONAL,
+                        NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        goto fini;
+    }
+
+    CHECK(top < 0, fini, "The number of contexts must not be negative.");
+
+    targets = get_targets(ctx, pc_services, pc_domains);
+    CHECK(targets == NULL, fini, "Could not allocate memory.");
+    all_targets = EMPTY_TARGETS(targets);
+
+    ret = sss_tool_confdb_init(ctx, &ctx->confdb);
+    CHECK(ret != EOK, fini, "Could not connect to configuration database.");
+
+    ret = get_confdb_sections(ctx, ctx->confdb, &ctx->sections);
+    CHECK(ret != EOK, fini, "Could not get all configuration sections.");
+
+    conn = connect_to_sbus(ctx);
+    if (conn == NULL) {
+        ERROR("SSSD is not running.\n");
+        ret = EIO;
+        goto fini;
+    }
+
+    curr_target = (all_targets ?
+                   discard_const_p(const char *, ctx->sections) : targets);
+    for (; *curr_target != NULL; curr_target++) {
+        target = REMOVE_PREFIX(*curr_target, "config/");
+        busname = get_busname(ctx, ctx->confdb, target);
+        if (busname == NULL) {
+            ret = ENOENT;
+        } else if (sample >= 0) {
+            ret = sbus_call_service_tallocSampling(conn, busname,
+                                                   SSS_BUS_PATH, sample, top);
+            if (ret == EOK) {
+                PRINT(_("%1$-25s Memory sampling %2$s\n"), target,
+                      sample > 0 ? _("started") : _("stopped"));
+            } else {
+                ret = ENOENT;
+            }
+        } else {
+            ret = do_memory_report(ctx, conn, busname, target, top);
+        }
+
+        if (ret == ENOENT && !all_targets) {
+            PRINT(_("%1$-25s Unreachable service\n"), target);
+        }
+    }
+
+    ret = EOK;
+
+fini:
+    talloc_free(ctx);
+
+    return ret;
+}
+
+static errno_t do_loop_report(TALLOC_CTX *mem_ctx,
+                              struct sbus_sync_connection *conn,
+                              const char *busname,
+                              const char *target,
+                              uint32_t top)
+{
+    const char **names;
+    uint64_t *counts;
+    uint64_t *total_usec;
+    uint64_t *max_usec;
+    uint64_t *histogram;
+    uint64_t *h;
+    size_t i;
+    errno_t ret;
+
+    ret = sbus_call_service_loopStats(mem_ctx, conn, busname, SSS_BUS_PATH,
+                                      top, &names, &counts, &total_usec,
+                                      &max_usec, &histogram);
+    if (ret != EOK) {
+        return ENOENT;
+    }
+
+    PRINT("%s:\n", target);
+    if (names[0] == NULL) {
+        PRINT(_("No event handlers were measured, see event_loop_threshold "
+                "in sssd.conf(5)\n\n"));
+        return EOK;
+    }
+
+    PRINT("%1$10s %2$10s %3$10s %4$8s %5$8s %6$8s %7$8s %8$8s %9$8s  %10$s\n",
+          _("Count"), _("Avg ms"), _("Max ms"), "<100us", "<1ms", "<10ms",
+          "<100ms", "<1s", ">=1s", _("Handler"));
+    for (i = 0; names[i] != NULL; i++) {
+        h = &histogram[i * SSS_LOOP_STATS_BUCKETS];
+        PRINT("%1$10"PRIu64" %2$10.3f %3$10.3f "
+              "%4$8"PRIu64" %5$8"PRIu64" %6$8"PRIu64" "
+              "%7$8"PRIu64" %8$8"PRIu64" %9$8"PRIu64"  %10$s\n",
+              counts[i],
+              counts[i] != 0 ? total_usec[i] / 1000.0 / counts[i] : 0.0,
+              max_usec[i] / 1000.0,
+              h[0], h[1], h[2], h[3], h[4], h[5], names[i]);
+    }
+    PRINT("\n");
+
+    return EOK;
+}
+
+errno_t sssctl_loop_report(struct sss_cmdline *cmdline,
+                           struct sss_tool_ctx *tool_ctx)
+{
+    int ret;
+    int pc_services = 0;
+    int top = 20;
+    bool all_targets;
+    const char **pc_domains = NULL;
+    const char **targets = NULL;
+    const char **curr_target;
+    const char *target;
+    const char *busname;
+    struct sbus_sync_connection *conn;
+    struct debuglevel_tool_ctx *ctx = NULL;
+    struct poptOption long_options[] = {
+        {"domain", '\0', POPT_ARG_ARGV, &pc_domains,
+            0, _("Target a specific domain"), _("domain")},
+        POPT_SERV_OPTION(SSSD, pc_services, _("Target the SSSD service")),
+        POPT_SERV_OPTION(NSS, pc_services, _("Target the NSS service")),
+        POPT_SERV_OPTION(PAM, pc_services, _("Target the PAM service")),
+        POPT_SERV_OPTION(SUDO, pc_services, _("Target the SUDO service")),
+        POPT_SERV_OPTION(AUTOFS, pc_services, _("Target the AUTOFS service")),
+        POPT_SERV_OPTION(SSH, pc_services, _("Target the SSH service")),
+        POPT_SERV_OPTION(PAC, pc_services, _("Target the PAC service")),
+        POPT_SERV_OPTION(IFP, pc_services, _("Target the IFP service")),
+        {"top", '\0', POPT_ARG_INT, &top,
+            0, _("Number of handlers to show, 0 shows all"), NULL},
+        POPT_TABLEEND
+    };
+
+    ctx = talloc_zero(NULL, struct debuglevel_tool_ctx);
+    if (ctx == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE,
+              "Could not allocate memory for tools context\n");
+        ret = ENOMEM;
+        goto fini;
+    }
+
+    ret = sss_tool_popt(cmdline, long_options, SSS_TOOL_OPT_OPTIONAL,
+                        NULL, NULL);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to parse command arguments\n");
+        goto fini;
+    }
+
+    CHECK(top < 0, fini, "The number of handlers must not be negative.");
+
+    targets = get_targets(ctx, pc_services, pc_domains);
+    CHECK(targets == NULL, fini, "Could not allocate memory.");
+    all_targets = EMPTY_TARGETS(targets);
+
+    ret = sss_tool_confdb_init(ctx, &ctx->confdb);
+    CHECK(ret != EOK, fini, "Could not connect to configuration database.");
+
+    ret = get_confdb_sections(ctx, ctx->confdb, &ctx->sections);
+    CHECK(ret != EOK, fini, "Could not get all configuration sections.");
+
+    conn = connect_to_sbus(ctx);
+    if (conn == NULL) {
+        ERROR("SSSD is not running.\n");
+        ret = EIO;
+        goto fini;
+    }
+
+    curr_target = (all_targets ?
+                   discard_const_p(const char *, ctx->sections) : targets);
+    for (; *curr_target != NULL; curr_target++) {
+        target = REMOVE_PREFIX(*curr_target, "config/");
+        busname = get_busname(ctx, ctx->confdb, target);
+        if (busname == NULL) {
+            ret = ENOENT;
+        } else {
+            ret = do_loop_report(ctx, conn, busname, target, top);
+        }
+
+        if (ret == ENOENT && !all_targets) {
+            PRINT(_("%1$-25s Unreachable service\n"), target);
+        }
+    }
+
+    ret = EOK;
+
+fini:
+    talloc_free(ctx);
+
+    return ret;
+}
+
 errno_t sssctl_analyze(struct sss_cmdline *cmdline,
                        struct sss_tool_ctx *)
 {
@@ -739,6 +739,11 @@ static errno_t prepare_child_argv(TALLOC_CTX *mem_ctx,
 
     if (!extra_args_only) {
         argc++;
+
+        /* trace file descriptor */
+        if (sss_trace_fd != -1) {
+            argc++;
+        }
     }
 
     if (extra_argv) {
@@ -812,6 +817,15 @@ static errno_t prepare_child_argv(TALLOC_CTX *mem_ctx,
             ret = ENOMEM;
             goto fail;
         }
+
+        if (sss_trace_fd != -1) {
+            argv[--argc] = talloc_asprintf(argv, "--trace-fd=%d",
+                                           sss_trace_fd);
+            if (argv[argc] == NULL) {
+                ret = ENOMEM;
+                goto fail;
+            }
+        }
     }
 
     argv[--argc] = talloc_strdup(argv, binary);
@@ -873,6 +887,16 @@ void exec_child_ex(TALLOC_CTX *mem_ctx,
         exit(EXIT_FAILURE);
     }
 
+    /* The trace file is opened with O_CLOEXEC, keep it open only for the
+     * child which is told about it. */
+    if (sss_trace_fd != -1 && fcntl(sss_trace_fd, F_SETFD, 0) == -1) {
+        err = errno;
+        DEBUG(SSSDBG_MINOR_FAILURE,
+              "Unable to pass the trace file to the child [%d][%s].\n",
+              err, strerror(err));
+        sss_trace_fd = -1;
+    }
+
     ret = prepare_child_argv(mem_ctx, debug_fd,
                              binary, extra_argv, extra_args_only,
                              &argv);
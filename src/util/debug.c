@@ -51,6 +51,7 @@ enum sss_logger_t sss_logger = STDERR_LOGGER;
 const char *debug_log_file = "sssd";
 FILE *_sss_debug_file;
 uint64_t debug_chain_id;
+int sss_trace_fd = -1;
 /* Default value says 'BUG' because this is just a precautionary measure and
  * it is expected value is always set explicitly by every SSSD process. 'BUG'
  * should make any potential oversight more prominent in the logs. */
@@ -55,6 +55,7 @@ extern int debug_timestamps;
 extern int debug_microseconds;
 extern enum sss_logger_t sss_logger;
 extern const char *debug_log_file;   /* only file name, excluding path */
+extern int sss_trace_fd;             /* see util/sss_trace.h */
 
 
 /* converts log level from "old" notation and opens log file if needed */
@@ -150,7 +151,9 @@ int rotate_debug_files(void);
         {"debug-timestamps", 0, POPT_ARG_INT, &debug_timestamps, 0, \
          _("Add debug timestamps"), NULL}, \
         {"debug-microseconds", 0, POPT_ARG_INT, &debug_microseconds, 0, \
-         _("Show timestamps with microseconds"), NULL},
+         _("Show timestamps with microseconds"), NULL}, \
+        {"trace-fd", 0, POPT_ARG_INT, &sss_trace_fd, 0, \
+         _("An open file descriptor for the trace spans"), NULL},
 
 
 #define PRINT(fmt, ...) fprintf(stdout, gettext(fmt), ##__VA_ARGS__)
@@ -34,8 +34,11 @@
 #include <ldb.h>
 #include "util/util.h"
 #include "confdb/confdb.h"
+#include "db/sysdb.h"
 #include "util/sss_chain_id.h"
 #include "util/sss_chain_id_tevent.h"
+#include "util/sss_loop_stats.h"
+#include "util/sss_trace.h"
 
 #ifdef HAVE_PRCTL
 #include <sys/prctl.h>
@@ -428,6 +431,15 @@ errno_t server_common_rotate_logs(struct confdb_ctx *confdb,
         debug_level = debug_convert_old_level(debug_level);
     }
 
+    /* Reopen the trace file as well so it can be rotated with the logs. */
+    if (sss_trace_enabled()) {
+        ret = sss_trace_open();
+        if (ret != EOK) {
+            DEBUG(SSSDBG_MINOR_FAILURE,
+                  "Could not reopen the trace file, keeping the old one\n");
+        }
+    }
+
     return EOK;
 }
 
@@ -490,6 +502,9 @@ int server_setup(const char *name, bool is_responder,
     bool dt;
     bool dm;
     bool backtrace_enabled;
+    bool trace_spans;
+    int query_trace;
+    int loop_threshold;
     struct tevent_signal *tes;
     struct logrotate_ctx *lctx;
     char *locale;
@@ -695,6 +710,38 @@ int server_setup(const char *name, bool is_responder,
     }
     sss_debug_backtrace_enable(backtrace_enabled);
 
+    ret = confdb_get_bool(ctx->confdb_ctx, conf_entry,
+                          CONFDB_SERVICE_DEBUG_TRACE_SPANS,
+                          false,
+                          &trace_spans);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Error reading %s from confdb (%d) [%s]\n",
+              CONFDB_SERVICE_DEBUG_TRACE_SPANS, ret, strerror(ret));
+        return ret;
+    }
+
+    if (trace_spans) {
+        ret = sss_trace_open();
+        if (ret != EOK) {
+            /* Tracing is a debugging aid, do not refuse to start. */
+            DEBUG(SSSDBG_CRIT_FAILURE, "Trace spans will not be recorded\n");
+        }
+    }
+
+    ret = confdb_get_int(ctx->confdb_ctx, conf_entry,
+                         CONFDB_SERVICE_DEBUG_SYSDB_QUERY_TRACE,
+                         0,
+                         &query_trace);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Error reading %s from confdb (%d) [%s]\n",
+              CONFDB_SERVICE_DEBUG_SYSDB_QUERY_TRACE, ret, strerror(ret));
+        return ret;
+    }
+
+    if (query_trace > 0) {
+        sysdb_query_trace_enable(query_trace);
+    }
+
     /* before opening the log file set up log rotation */
     lctx = talloc_zero(ctx, struct logrotate_ctx);
     if (!lctx) return ENOMEM;
@@ -748,6 +795,23 @@ int server_setup(const char *name, bool is_responder,
 
     sss_chain_id_setup(ctx->event_ctx);
 
+    ret = confdb_get_int(ctx->confdb_ctx, conf_entry,
+                         CONFDB_SERVICE_EVENT_LOOP_THRESHOLD,
+                         0, &loop_threshold);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_FATAL_FAILURE, "Error reading %s from confdb (%d) [%s]\n",
+              CONFDB_SERVICE_EVENT_LOOP_THRESHOLD, ret, strerror(ret));
+        return ret;
+    }
+
+    if (loop_threshold > 0) {
+        ret = sss_loop_stats_setup(ctx->event_ctx, loop_threshold);
+        if (ret != EOK) {
+            /* Only a debugging aid, do not refuse to start. */
+            DEBUG(SSSDBG_CRIT_FAILURE, "Event handlers will not be measured\n");
+        }
+    }
+
     sss_log(SSS_LOG_INFO, "Starting up");
 
     DEBUG(SSSDBG_TRACE_FUNC, "CONFDB: %s\n", conf_db);
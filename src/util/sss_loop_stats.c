@@ -0,0 +1,406 @@
+/*
+    SSSD
+
+    Event loop statistics
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "util/sss_loop_stats.h"
+
+struct loop_stats_ctx {
+    struct tevent_context *ev;
+    uint64_t threshold_usec;
+
+    hash_table_t *table;
+    struct sss_loop_stat **stats;
+    size_t count;
+
+#ifdef BUILD_CHAIN_ID
+    /* trace callbacks that were set before, e.g. the chain id ones */
+    tevent_trace_callback_t loop_cb;
+    void *loop_pvt;
+    tevent_trace_fd_callback_t fd_cb;
+    void *fd_pvt;
+    tevent_trace_timer_callback_t timer_cb;
+    void *timer_pvt;
+    tevent_trace_immediate_callback_t immediate_cb;
+    void *immediate_pvt;
+#endif /* BUILD_CHAIN_ID */
+
+    /* handler being run, the event itself may be freed by the handler */
+    bool running;
+    char name[64];
+    struct timespec start;
+};
+
+static struct loop_stats_ctx *loop_stats = NULL;
+
+#ifdef BUILD_CHAIN_ID
+
+static struct sss_loop_stat *loop_stats_get_stat(struct loop_stats_ctx *ctx,
+                                                 const char *name)
+{
+    struct sss_loop_stat **stats;
+    struct sss_loop_stat *stat;
+    errno_t ret;
+
+    stat = sss_ptr_hash_lookup(ctx->table, name, struct sss_loop_stat);
+    if (stat != NULL) {
+        return stat;
+    }
+
+    if (ctx->count % 64 == 0) {
+        stats = talloc_realloc(ctx, ctx->stats, struct sss_loop_stat *,
+                               ctx->count + 64);
+        if (stats == NULL) {
+            return NULL;
+        }
+        ctx->stats = stats;
+    }
+
+    stat = talloc_zero(ctx, struct sss_loop_stat);
+    if (stat == NULL) {
+        return NULL;
+    }
+
+    stat->name = talloc_strdup(stat, name);
+    if (stat->name == NULL) {
+        talloc_free(stat);
+        return NULL;
+    }
+
+    ret = sss_ptr_hash_add(ctx->table, name, stat, struct sss_loop_stat);
+    if (ret != EOK) {
+        talloc_free(stat);
+        return NULL;
+    }
+
+    ctx->stats[ctx->count++] = stat;
+    return stat;
+}
+
+static void loop_stats_begin(struct loop_stats_ctx *ctx,
+                             const char *kind,
+                             const void *event)
+{
+    const void *owner;
+    const char *name = NULL;
+    void *data;
+
+    /* tevent does not expose where the event was created or its handler,
+     * the owner of the event is the best description we have */
+    owner = talloc_parent(event);
+    if (owner != NULL) {
+        name = talloc_get_name(owner);
+        if (name != NULL && strcmp(name, "struct tevent_req") == 0) {
+            data = _tevent_req_data(discard_const(owner));
+            if (data != NULL) {
+                name = talloc_get_name(data);
+            }
+        }
+    }
+
+    snprintf(ctx->name, sizeof(ctx->name), "%s %s",
+             kind, name != NULL ? name : "UNOWNED");
+
+    ctx->running = true;
+    clock_gettime(CLOCK_MONOTONIC, &ctx->start);
+}
+
+static void loop_stats_end(struct loop_stats_ctx *ctx)
+{
+    struct sss_loop_stat *stat;
+    struct timespec now;
+    uint64_t usec;
+    uint64_t limit;
+    int bucket;
+
+    if (!ctx->running) {
+        return;
+    }
+    ctx->running = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usec = (now.tv_sec - ctx->start.tv_sec) * 1000000
+           + (now.tv_nsec - ctx->start.tv_nsec) / 1000;
+
+    stat = loop_stats_get_stat(ctx, ctx->name);
+    if (stat == NULL) {
+        /* statistics are best effort */
+        return;
+    }
+
+    for (bucket = 0, limit = 100;
+         bucket < SSS_LOOP_STATS_BUCKETS - 1 && usec >= limit;
+         bucket++, limit *= 10);
+
+    stat->count++;
+    stat->total_usec += usec;
+    stat->histogram[bucket]++;
+    if (usec > stat->max_usec) {
+        stat->max_usec = usec;
+    }
+
+    if (ctx->threshold_usec != 0 && usec >= ctx->threshold_usec) {
+        DEBUG(SSSDBG_IMPORTANT_INFO,
+              "Event handler [%s] blocked the event loop for %"PRIu64" ms\n",
+              ctx->name, usec / 1000);
+    }
+}
+
+static int loop_stats_destructor(struct loop_stats_ctx *ctx)
+{
+    loop_stats = NULL;
+    return 0;
+}
+
+static void loop_stats_trace_loop(enum tevent_trace_point point,
+                                  void *private_data)
+{
+    struct loop_stats_ctx *ctx;
+
+    ctx = talloc_get_type(private_data, struct loop_stats_ctx);
+
+    /* There is no trace point after the handler, the loop iteration ends
+     * right after it. Finish before the chain id is reset so that the
+     * message is logged with the chain id of the handler. */
+    if (point == TEVENT_TRACE_AFTER_LOOP_ONCE) {
+        loop_stats_end(ctx);
+    }
+
+    if (ctx->loop_cb != NULL) {
+        ctx->loop_cb(point, ctx->loop_pvt);
+    }
+}
+
+static void loop_stats_trace_fde(struct tevent_fd *fde,
+                                 enum tevent_event_trace_point point,
+                                 void *private_data)
+{
+    struct loop_stats_ctx *ctx;
+
+    ctx = talloc_get_type(private_data, struct loop_stats_ctx);
+
+    if (ctx->fd_cb != NULL) {
+        ctx->fd_cb(fde, point, ctx->fd_pvt);
+    }
+
+    if (point == TEVENT_EVENT_TRACE_BEFORE_HANDLER) {
+        loop_stats_begin(ctx, "fd", fde);
+    }
+}
+
+static void loop_stats_trace_timer(struct tevent_timer *te,
+                                   enum tevent_event_trace_point point,
+                                   void *private_data)
+{
+    struct loop_stats_ctx *ctx;
+
+    ctx = talloc_get_type(private_data, struct loop_stats_ctx);
+
+    if (ctx->timer_cb != NULL) {
+        ctx->timer_cb(te, point, ctx->timer_pvt);
+    }
+
+    if (point == TEVENT_EVENT_TRACE_BEFORE_HANDLER) {
+        loop_stats_begin(ctx, "timer", te);
+    }
+}
+
+static void loop_stats_trace_immediate(struct tevent_immediate *im,
+                                       enum tevent_event_trace_point point,
+                                       void *private_data)
+{
+    struct loop_stats_ctx *ctx;
+
+    ctx = talloc_get_type(private_data, struct loop_stats_ctx);
+
+    if (ctx->immediate_cb != NULL) {
+        ctx->immediate_cb(im, point, ctx->immediate_pvt);
+    }
+
+    if (point == TEVENT_EVENT_TRACE_BEFORE_HANDLER) {
+        loop_stats_begin(ctx, "immediate", im);
+    }
+}
+
+errno_t sss_loop_stats_setup(struct tevent_context *ev,
+                             uint32_t threshold_ms)
+{
+    struct loop_stats_ctx *ctx;
+
+    if (loop_stats != NULL) {
+        loop_stats->threshold_usec = (uint64_t)threshold_ms * 1000;
+        return EOK;
+    }
+
+    ctx = talloc_zero(ev, struct loop_stats_ctx);
+    if (ctx == NULL) {
+        return ENOMEM;
+    }
+
+    ctx->ev = ev;
+    ctx->threshold_usec = (uint64_t)threshold_ms * 1000;
+
+    ctx->table = sss_ptr_hash_create(ctx, NULL, NULL);
+    if (ctx->table == NULL) {
+        talloc_free(ctx);
+        return ENOMEM;
+    }
+
+    talloc_set_destructor(ctx, loop_stats_destructor);
+
+    tevent_get_trace_callback(ev, &ctx->loop_cb, &ctx->loop_pvt);
+    tevent_get_trace_fd_callback(ev, &ctx->fd_cb, &ctx->fd_pvt);
+    tevent_get_trace_timer_callback(ev, &ctx->timer_cb, &ctx->timer_pvt);
+    tevent_get_trace_immediate_callback(ev, &ctx->immediate_cb,
+                                        &ctx->immediate_pvt);
+
+    tevent_set_trace_callback(ev, loop_stats_trace_loop, ctx);
+    tevent_set_trace_fd_callback(ev, loop_stats_trace_fde, ctx);
+    tevent_set_trace_timer_callback(ev, loop_stats_trace_timer, ctx);
+    tevent_set_trace_immediate_callback(ev, loop_stats_trace_immediate, ctx);
+
+    loop_stats = ctx;
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Measuring event handlers, handlers running "
+          "for %u ms or longer are logged\n", threshold_ms);
+
+    return EOK;
+}
+
+#else /* BUILD_CHAIN_ID not defined */
+
+errno_t sss_loop_stats_setup(struct tevent_context *ev,
+                             uint32_t threshold_ms)
+{
+    DEBUG(SSSDBG_CONF_SETTINGS, "Event handlers can not be measured, "
+          "tevent does not support event trace callbacks\n");
+    return ENOTSUP;
+}
+
+#endif /* BUILD_CHAIN_ID */
+
+static int loop_stat_cmp_max(const void *a, const void *b)
+{
+    const struct sss_loop_stat *sa = a;
+    const struct sss_loop_stat *sb = b;
+
+    if (sa->max_usec != sb->max_usec) {
+        return sa->max_usec < sb->max_usec ? 1 : -1;
+    }
+
+    return strcmp(sa->name, sb->name);
+}
+
+errno_t sss_loop_stats_report(TALLOC_CTX *mem_ctx,
+                              struct sss_loop_stat **_stats,
+                              size_t *_count)
+{
+    struct sss_loop_stat *stats;
+    size_t count;
+    size_t i;
+
+    count = loop_stats != NULL ? loop_stats->count : 0;
+
+    stats = talloc_array(mem_ctx, struct sss_loop_stat, count);
+    if (stats == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        stats[i] = *loop_stats->stats[i];
+        stats[i].name = talloc_strdup(stats, loop_stats->stats[i]->name);
+        if (stats[i].name == NULL) {
+            talloc_free(stats);
+            return ENOMEM;
+        }
+    }
+
+    qsort(stats, count, sizeof(struct sss_loop_stat), loop_stat_cmp_max);
+
+    *_stats = stats;
+    *_count = count;
+
+    return EOK;
+}
+
+errno_t generic_loop_stats(TALLOC_CTX *mem_ctx,
+                           struct sbus_request *sbus_req,
+                           void *pvt_data,
+                           uint32_t max_entries,
+                           const char ***_names,
+                           uint64_t **_counts,
+                           uint64_t **_total_usec,
+                           uint64_t **_max_usec,
+                           uint64_t **_histogram)
+{
+    struct sss_loop_stat *stats;
+    const char **names;
+    uint64_t *counts;
+    uint64_t *total_usec;
+    uint64_t *max_usec;
+    uint64_t *histogram;
+    size_t count;
+    size_t i;
+    errno_t ret;
+
+    ret = sss_loop_stats_report(mem_ctx, &stats, &count);
+    if (ret != EOK) {
+        return ret;
+    }
+
+    if (max_entries != 0 && count > max_entries) {
+        count = max_entries;
+    }
+
+    names = talloc_zero_array(mem_ctx, const char *, count + 1);
+    counts = talloc_array(mem_ctx, uint64_t, count);
+    total_usec = talloc_array(mem_ctx, uint64_t, count);
+    max_usec = talloc_array(mem_ctx, uint64_t, count);
+    histogram = talloc_array(mem_ctx, uint64_t,
+                             count * SSS_LOOP_STATS_BUCKETS);
+    if (names == NULL || counts == NULL || total_usec == NULL
+            || max_usec == NULL || histogram == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        names[i] = stats[i].name;
+        counts[i] = stats[i].count;
+        total_usec[i] = stats[i].total_usec;
+        max_usec[i] = stats[i].max_usec;
+        memcpy(&histogram[i * SSS_LOOP_STATS_BUCKETS], stats[i].histogram,
+               sizeof(stats[i].histogram));
+    }
+
+    *_names = names;
+    *_counts = counts;
+    *_total_usec = total_usec;
+    *_max_usec = max_usec;
+    *_histogram = histogram;
+
+    return EOK;
+}
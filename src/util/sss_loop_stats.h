@@ -0,0 +1,77 @@
+/*
+    SSSD
+
+    Event loop statistics
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SSS_LOOP_STATS_H_
+#define _SSS_LOOP_STATS_H_
+
+#include <stdint.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util_errors.h"
+
+struct sbus_request;
+
+/* Histogram buckets of handler run times: below 100 us, 1 ms, 10 ms,
+ * 100 ms, 1 s and the rest */
+#define SSS_LOOP_STATS_BUCKETS 6
+
+/* Run times of the fd, timer and immediate handlers that belong to the same
+ * owner. The owner is the talloc parent of the event, or the state of the
+ * tevent request if the event belongs to a request, e.g.
+ * "timer struct sdap_op" or "immediate struct cache_req_state". */
+struct sss_loop_stat {
+    const char *name;
+    uint64_t count;
+    uint64_t total_usec;
+    uint64_t max_usec;
+    uint64_t histogram[SSS_LOOP_STATS_BUCKETS];
+};
+
+/**
+ * Start measuring how long the handlers of @ev run. Handlers running for
+ * @threshold_ms or longer are logged.
+ *
+ * Must be called after sss_chain_id_setup(), the trace callbacks that are
+ * already set on @ev keep working.
+ */
+errno_t sss_loop_stats_setup(struct tevent_context *ev,
+                             uint32_t threshold_ms);
+
+/**
+ * Statistics collected so far sorted by max_usec, slowest first. Returns
+ * no statistics if sss_loop_stats_setup() was not called.
+ */
+errno_t sss_loop_stats_report(TALLOC_CTX *mem_ctx,
+                              struct sss_loop_stat **_stats,
+                              size_t *_count);
+
+/* sssd.service.loopStats handler, no private data. The histogram contains
+ * SSS_LOOP_STATS_BUCKETS values for each name. */
+errno_t generic_loop_stats(TALLOC_CTX *mem_ctx,
+                           struct sbus_request *sbus_req,
+                           void *pvt_data,
+                           uint32_t max_entries,
+                           const char ***_names,
+                           uint64_t **_counts,
+                           uint64_t **_total_usec,
+                           uint64_t **_max_usec,
+                           uint64_t **_histogram);
+
+#endif /* _SSS_LOOP_STATS_H_ */
@@ -181,6 +181,7 @@ void pam_print_data(int l, struct pam_data *pd)
     DEBUG(l, "priv: %d\n", pd->priv);
     DEBUG(l, "cli_pid: %d\n", pd->cli_pid);
     DEBUG(l, "child_pid: %d\n", pd->child_pid);
+    DEBUG(l, "transaction token: %u\n", pd->transaction_token);
     DEBUG(l, "logon name: %s\n", PAM_SAFE_ITEM(pd->logon_name));
     DEBUG(l, "flags: %d\n", pd->cli_flags);
 }
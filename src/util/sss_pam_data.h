@@ -58,6 +58,7 @@ struct pam_data {
     struct sss_auth_token *newauthtok;
     uint32_t cli_pid;
     uint32_t child_pid;
+    uint32_t transaction_token;
     char *logon_name;
     uint32_t cli_flags;
 
@@ -0,0 +1,481 @@
+/*
+    SSSD
+
+    talloc memory report
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util.h"
+#include "util/sss_ptr_hash.h"
+#include "util/sss_talloc_report.h"
+
+/* A chunk on the path from the root to the chunk being visited */
+struct talloc_report_frame {
+    struct sss_talloc_stat *stat;
+    uint64_t total_bytes;
+    bool outermost;
+};
+
+struct talloc_report_state {
+    /* the report itself lives here, the walk skips it */
+    TALLOC_CTX *ctx;
+    hash_table_t *table;
+    struct sss_talloc_stat **stats;
+    size_t count;
+
+    /* frames[i] is the ancestor at depth i */
+    struct talloc_report_frame *frames;
+    int num_frames;
+
+    int skip_depth;
+    errno_t error;
+};
+
+struct talloc_sampling_ctx {
+    struct tevent_context *ev;
+    struct tevent_timer *timer;
+    uint32_t interval;
+    uint32_t max_entries;
+
+    /* previous sample sorted by name */
+    struct sss_talloc_stat *prev;
+    size_t prev_count;
+};
+
+#define SSS_TALLOC_SAMPLING_ENTRIES 10
+
+static struct talloc_sampling_ctx *sampling_ctx = NULL;
+
+static void talloc_report_pop(struct talloc_report_state *state)
+{
+    struct talloc_report_frame *frame;
+
+    frame = &state->frames[--state->num_frames];
+    if (frame->outermost) {
+        frame->stat->total_bytes += frame->total_bytes;
+    }
+
+    if (state->num_frames > 0) {
+        state->frames[state->num_frames - 1].total_bytes += frame->total_bytes;
+    }
+}
+
+static struct sss_talloc_stat *
+talloc_report_get_stat(struct talloc_report_state *state, const char *name)
+{
+    struct sss_talloc_stat *stat;
+    errno_t ret;
+
+    stat = sss_ptr_hash_lookup(state->table, name, struct sss_talloc_stat);
+    if (stat != NULL) {
+        return stat;
+    }
+
+    if (state->count % 64 == 0) {
+        state->stats = talloc_realloc(state->ctx, state->stats,
+                                      struct sss_talloc_stat *,
+                                      state->count + 64);
+        if (state->stats == NULL) {
+            return NULL;
+        }
+    }
+
+    stat = talloc_zero(state->ctx, struct sss_talloc_stat);
+    if (stat == NULL) {
+        return NULL;
+    }
+
+    stat->name = talloc_strdup(stat, name);
+    if (stat->name == NULL) {
+        talloc_free(stat);
+        return NULL;
+    }
+
+    ret = sss_ptr_hash_add(state->table, name, stat, struct sss_talloc_stat);
+    if (ret != EOK) {
+        talloc_free(stat);
+        return NULL;
+    }
+
+    state->stats[state->count++] = stat;
+    return stat;
+}
+
+static void talloc_report_cb(const void *ptr,
+                             int depth,
+                             int max_depth,
+                             int is_ref,
+                             void *private_data)
+{
+    struct talloc_report_state *state;
+    struct talloc_report_frame *frame;
+    struct sss_talloc_stat *stat;
+    const char *name;
+    size_t size;
+    int i;
+
+    state = talloc_get_type(private_data, struct talloc_report_state);
+    if (state->error != EOK) {
+        return;
+    }
+
+    if (state->skip_depth >= 0) {
+        if (depth > state->skip_depth) {
+            return;
+        }
+        state->skip_depth = -1;
+    }
+
+    if (ptr == state->ctx || ptr == sampling_ctx) {
+        /* do not report the memory used by the report itself */
+        state->skip_depth = depth;
+        return;
+    }
+
+    if (is_ref) {
+        /* the memory is reported under its parent */
+        return;
+    }
+
+    while (state->num_frames > depth) {
+        talloc_report_pop(state);
+    }
+
+    if ((size_t)depth >= talloc_array_length(state->frames)) {
+        state->frames = talloc_realloc(state->ctx, state->frames,
+                                       struct talloc_report_frame, depth + 32);
+        if (state->frames == NULL) {
+            state->error = ENOMEM;
+            return;
+        }
+    }
+
+    name = talloc_get_name(ptr);
+    stat = talloc_report_get_stat(state, name != NULL ? name : "UNNAMED");
+    if (stat == NULL) {
+        state->error = ENOMEM;
+        return;
+    }
+
+    size = talloc_get_size(ptr);
+    stat->blocks++;
+    stat->bytes += size;
+
+    frame = &state->frames[state->num_frames++];
+    frame->stat = stat;
+    frame->total_bytes = size;
+    frame->outermost = true;
+    for (i = 0; i < state->num_frames - 1; i++) {
+        if (state->frames[i].stat == stat) {
+            frame->outermost = false;
+            break;
+        }
+    }
+}
+
+static int talloc_stat_cmp_total(const void *a, const void *b)
+{
+    const struct sss_talloc_stat *sa = a;
+    const struct sss_talloc_stat *sb = b;
+
+    if (sa->total_bytes != sb->total_bytes) {
+        return sa->total_bytes < sb->total_bytes ? 1 : -1;
+    }
+
+    return strcmp(sa->name, sb->name);
+}
+
+static int talloc_stat_cmp_name(const void *a, const void *b)
+{
+    const struct sss_talloc_stat *sa = a;
+    const struct sss_talloc_stat *sb = b;
+
+    return strcmp(sa->name, sb->name);
+}
+
+errno_t sss_talloc_report(TALLOC_CTX *mem_ctx,
+                          const void *root,
+                          struct sss_talloc_stat **_stats,
+                          size_t *_count)
+{
+    struct talloc_report_state *state;
+    struct sss_talloc_stat *stats;
+    size_t i;
+    errno_t ret;
+
+    /* Not allocated on mem_ctx, the walk must be able to skip it */
+    state = talloc_zero(NULL, struct talloc_report_state);
+    if (state == NULL) {
+        return ENOMEM;
+    }
+    state->ctx = state;
+    state->skip_depth = -1;
+
+    state->table = sss_ptr_hash_create(state, NULL, NULL);
+    if (state->table == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    talloc_report_depth_cb(root, 0, -1, talloc_report_cb, state);
+    if (state->error != EOK) {
+        ret = state->error;
+        goto done;
+    }
+
+    while (state->num_frames > 0) {
+        talloc_report_pop(state);
+    }
+
+    stats = talloc_array(mem_ctx, struct sss_talloc_stat, state->count);
+    if (stats == NULL) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < state->count; i++) {
+        stats[i] = *state->stats[i];
+        stats[i].name = talloc_strdup(stats, state->stats[i]->name);
+        if (stats[i].name == NULL) {
+            talloc_free(stats);
+            ret = ENOMEM;
+            goto done;
+        }
+    }
+
+    qsort(stats, state->count, sizeof(struct sss_talloc_stat),
+          talloc_stat_cmp_total);
+
+    *_stats = stats;
+    *_count = state->count;
+    ret = EOK;
+
+done:
+    talloc_free(state);
+    return ret;
+}
+
+struct talloc_growth {
+    const struct sss_talloc_stat *stat;
+    int64_t growth;
+};
+
+static int talloc_growth_cmp(const void *a, const void *b)
+{
+    const struct talloc_growth *ga = a;
+    const struct talloc_growth *gb = b;
+
+    if (ga->growth != gb->growth) {
+        return ga->growth < gb->growth ? 1 : -1;
+    }
+
+    return strcmp(ga->stat->name, gb->stat->name);
+}
+
+static void talloc_sampling_log(struct talloc_sampling_ctx *sctx,
+                                struct sss_talloc_stat *stats,
+                                size_t count)
+{
+    struct talloc_growth *growth;
+    struct sss_talloc_stat *prev;
+    size_t num_growth = 0;
+    int64_t diff;
+    size_t i;
+
+    growth = talloc_array(NULL, struct talloc_growth, count);
+    if (growth == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Out of memory\n");
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        prev = bsearch(&stats[i], sctx->prev, sctx->prev_count,
+                       sizeof(struct sss_talloc_stat), talloc_stat_cmp_name);
+        diff = (int64_t)(stats[i].total_bytes
+                         - (prev != NULL ? prev->total_bytes : 0));
+        if (diff > 0) {
+            growth[num_growth].stat = &stats[i];
+            growth[num_growth].growth = diff;
+            num_growth++;
+        }
+    }
+
+    qsort(growth, num_growth, sizeof(struct talloc_growth), talloc_growth_cmp);
+
+    for (i = 0; i < num_growth && i < sctx->max_entries; i++) {
+        DEBUG(SSSDBG_IMPORTANT_INFO,
+              "Memory growth of [%s]: +%"PRId64" bytes, %"PRIu64" bytes "
+              "in %"PRIu64" blocks, %"PRIu64" bytes total\n",
+              growth[i].stat->name, growth[i].growth, growth[i].stat->bytes,
+              growth[i].stat->blocks, growth[i].stat->total_bytes);
+    }
+
+    talloc_free(growth);
+}
+
+static void talloc_sampling_schedule(struct talloc_sampling_ctx *sctx);
+
+static void talloc_sampling_timer(struct tevent_context *ev,
+                                  struct tevent_timer *te,
+                                  struct timeval tv,
+                                  void *pvt)
+{
+    struct talloc_sampling_ctx *sctx;
+    struct sss_talloc_stat *stats;
+    size_t count;
+    errno_t ret;
+
+    sctx = talloc_get_type(pvt, struct talloc_sampling_ctx);
+    sctx->timer = NULL;
+
+    ret = sss_talloc_report(sctx, NULL, &stats, &count);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to walk the talloc hierarchy "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        goto done;
+    }
+
+    qsort(stats, count, sizeof(struct sss_talloc_stat), talloc_stat_cmp_name);
+
+    /* The first sample is only the base line */
+    if (sctx->prev != NULL) {
+        talloc_sampling_log(sctx, stats, count);
+    }
+
+    talloc_free(sctx->prev);
+    sctx->prev = stats;
+    sctx->prev_count = count;
+
+done:
+    talloc_sampling_schedule(sctx);
+}
+
+static void talloc_sampling_schedule(struct talloc_sampling_ctx *sctx)
+{
+    struct timeval tv;
+
+    tv = tevent_timeval_current_ofs(sctx->interval, 0);
+    sctx->timer = tevent_add_timer(sctx->ev, sctx, tv,
+                                   talloc_sampling_timer, sctx);
+    if (sctx->timer == NULL) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to schedule talloc sampling\n");
+    }
+}
+
+errno_t sss_talloc_sampling_set(struct tevent_context *ev,
+                                uint32_t interval,
+                                uint32_t max_entries)
+{
+    if (interval == 0) {
+        if (sampling_ctx != NULL) {
+            DEBUG(SSSDBG_IMPORTANT_INFO, "Memory sampling stopped\n");
+        }
+        talloc_zfree(sampling_ctx);
+        return EOK;
+    }
+
+    if (sampling_ctx == NULL) {
+        /* Top level context so that the walk can skip it */
+        sampling_ctx = talloc_zero(NULL, struct talloc_sampling_ctx);
+        if (sampling_ctx == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    sampling_ctx->ev = ev;
+    sampling_ctx->interval = interval;
+    sampling_ctx->max_entries = max_entries != 0 ? max_entries
+                                                 : SSS_TALLOC_SAMPLING_ENTRIES;
+
+    talloc_zfree(sampling_ctx->timer);
+    talloc_sampling_schedule(sampling_ctx);
+    if (sampling_ctx->timer == NULL) {
+        talloc_zfree(sampling_ctx);
+        return ENOMEM;
+    }
+
+    DEBUG(SSSDBG_IMPORTANT_INFO, "Memory sampling every %u seconds, "
+          "logging the %u fastest growing contexts\n",
+          interval, sampling_ctx->max_entries);
+
+    return EOK;
+}
+
+errno_t generic_talloc_report(TALLOC_CTX *mem_ctx,
+                              struct sbus_request *sbus_req,
+                              void *pvt_data,
+                              uint32_t max_entries,
+                              const char ***_names,
+                              uint64_t **_blocks,
+                              uint64_t **_bytes,
+                              uint64_t **_total_bytes)
+{
+    struct sss_talloc_stat *stats;
+    const char **names;
+    uint64_t *blocks;
+    uint64_t *bytes;
+    uint64_t *total_bytes;
+    size_t count;
+    size_t i;
+    errno_t ret;
+
+    ret = sss_talloc_report(mem_ctx, NULL, &stats, &count);
+    if (ret != EOK) {
+        DEBUG(SSSDBG_OP_FAILURE, "Unable to walk the talloc hierarchy "
+              "[%d]: %s\n", ret, sss_strerror(ret));
+        return ret;
+    }
+
+    if (max_entries != 0 && count > max_entries) {
+        count = max_entries;
+    }
+
+    names = talloc_zero_array(mem_ctx, const char *, count + 1);
+    blocks = talloc_array(mem_ctx, uint64_t, count);
+    bytes = talloc_array(mem_ctx, uint64_t, count);
+    total_bytes = talloc_array(mem_ctx, uint64_t, count);
+    if (names == NULL || blocks == NULL || bytes == NULL
+            || total_bytes == NULL) {
+        return ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        names[i] = stats[i].name;
+        blocks[i] = stats[i].blocks;
+        bytes[i] = stats[i].bytes;
+        total_bytes[i] = stats[i].total_bytes;
+    }
+
+    *_names = names;
+    *_blocks = blocks;
+    *_bytes = bytes;
+    *_total_bytes = total_bytes;
+
+    return EOK;
+}
+
+errno_t generic_talloc_sampling(TALLOC_CTX *mem_ctx,
+                                struct sbus_request *sbus_req,
+                                struct tevent_context *ev,
+                                uint32_t interval,
+                                uint32_t max_entries)
+{
+    return sss_talloc_sampling_set(ev, interval, max_entries);
+}
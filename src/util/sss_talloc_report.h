@@ -0,0 +1,84 @@
+/*
+    SSSD
+
+    talloc memory report
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SSS_TALLOC_REPORT_H_
+#define _SSS_TALLOC_REPORT_H_
+
+#include <stdint.h>
+#include <talloc.h>
+#include <tevent.h>
+
+#include "util/util_errors.h"
+
+struct sbus_request;
+
+/* Memory held by talloc chunks of the same name. The name is the type for
+ * chunks allocated with talloc(), e.g. "struct dp_req", or the location for
+ * talloc_new(). */
+struct sss_talloc_stat {
+    const char *name;
+
+    /* number of chunks and the memory of the chunks themselves */
+    uint64_t blocks;
+    uint64_t bytes;
+
+    /* memory of the chunks including everything allocated under them,
+     * chunks nested under a chunk of the same name are counted once */
+    uint64_t total_bytes;
+};
+
+/**
+ * Walk the talloc hierarchy under @root and aggregate the memory by chunk
+ * name. With @root NULL the whole hierarchy is walked, which requires null
+ * tracking to be enabled.
+ *
+ * The statistics are sorted by total_bytes, largest first.
+ */
+errno_t sss_talloc_report(TALLOC_CTX *mem_ctx,
+                          const void *root,
+                          struct sss_talloc_stat **_stats,
+                          size_t *_count);
+
+/**
+ * Walk the whole talloc hierarchy every @interval seconds and log the
+ * @max_entries names whose total_bytes grew most since the previous walk,
+ * 10 if @max_entries is 0. Interval 0 stops the sampling.
+ */
+errno_t sss_talloc_sampling_set(struct tevent_context *ev,
+                                uint32_t interval,
+                                uint32_t max_entries);
+
+/* sssd.service.tallocReport handler, no private data */
+errno_t generic_talloc_report(TALLOC_CTX *mem_ctx,
+                              struct sbus_request *sbus_req,
+                              void *pvt_data,
+                              uint32_t max_entries,
+                              const char ***_names,
+                              uint64_t **_blocks,
+                              uint64_t **_bytes,
+                              uint64_t **_total_bytes);
+
+/* sssd.service.tallocSampling handler, private data is the tevent context */
+errno_t generic_talloc_sampling(TALLOC_CTX *mem_ctx,
+                                struct sbus_request *sbus_req,
+                                struct tevent_context *ev,
+                                uint32_t interval,
+                                uint32_t max_entries);
+
+#endif /* _SSS_TALLOC_REPORT_H_ */
@@ -0,0 +1,175 @@
+/*
+    SSSD
+
+    Request trace spans
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "util/util.h"
+#include "util/sss_chain_id.h"
+#include "util/sss_trace.h"
+
+struct sss_trace_span {
+    struct sss_trace_record record;
+    bool ended;
+};
+
+static uint64_t sss_trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+errno_t sss_trace_open(void)
+{
+    mode_t old_umask;
+    char *path;
+    int fd;
+    int ret;
+
+    ret = asprintf(&path, "%s/%s.trace", LOG_PATH, debug_log_file);
+    if (ret == -1) {
+        return ENOMEM;
+    }
+
+    old_umask = umask(SSS_DFL_UMASK);
+    /* exec_child_ex() clears O_CLOEXEC for the children which are given
+     * --trace-fd. Records are smaller than PIPE_BUF so O_APPEND keeps
+     * writers from interleaving. */
+    fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    ret = errno;
+    umask(old_umask);
+    if (fd == -1) {
+        DEBUG(SSSDBG_CRIT_FAILURE, "Unable to open [%s] [%d]: %s\n",
+              path, ret, strerror(ret));
+        free(path);
+        return ret;
+    }
+
+    DEBUG(SSSDBG_CONF_SETTINGS, "Writing trace spans to [%s]\n", path);
+    free(path);
+
+    if (sss_trace_fd != -1) {
+        close(sss_trace_fd);
+    }
+    sss_trace_fd = fd;
+
+    return EOK;
+}
+
+bool sss_trace_enabled(void)
+{
+    return sss_trace_fd != -1;
+}
+
+static void sss_trace_write(struct sss_trace_record *record)
+{
+    ssize_t written;
+
+    record->end_us = sss_trace_now();
+
+    written = write(sss_trace_fd, record, sizeof(struct sss_trace_record));
+    if (written != sizeof(struct sss_trace_record)) {
+        DEBUG(SSSDBG_MINOR_FAILURE, "Unable to write trace span [%s]\n",
+              record->name);
+    }
+}
+
+static int sss_trace_span_destructor(struct sss_trace_span *span)
+{
+    if (!span->ended && sss_trace_enabled()) {
+        span->record.error = ECANCELED;
+        sss_trace_write(&span->record);
+    }
+
+    return 0;
+}
+
+struct sss_trace_span *
+sss_trace_span_begin(TALLOC_CTX *mem_ctx,
+                     enum sss_trace_kind kind,
+                     const char *fmt, ...)
+{
+    struct sss_trace_span *span;
+    va_list ap;
+
+    if (!sss_trace_enabled()) {
+        return NULL;
+    }
+
+    span = talloc_zero(mem_ctx, struct sss_trace_span);
+    if (span == NULL) {
+        return NULL;
+    }
+
+    span->record.magic = SSS_TRACE_MAGIC;
+    span->record.version = SSS_TRACE_VERSION;
+    span->record.kind = kind;
+    span->record.pid = getpid();
+    span->record.ppid = getppid();
+    span->record.chain_id = debug_chain_id;
+    span->record.start_us = sss_trace_now();
+    strncpy(span->record.process, debug_prg_name,
+            sizeof(span->record.process) - 1);
+
+    va_start(ap, fmt);
+    vsnprintf(span->record.name, sizeof(span->record.name), fmt, ap);
+    va_end(ap);
+
+    talloc_set_destructor(span, sss_trace_span_destructor);
+
+    return span;
+}
+
+void sss_trace_span_link(struct sss_trace_span *span,
+                         const char *peer,
+                         uint64_t link_id)
+{
+    if (span == NULL) {
+        return;
+    }
+
+    span->record.link_id = link_id;
+    if (peer != NULL) {
+        strncpy(span->record.peer, peer, sizeof(span->record.peer) - 1);
+    }
+}
+
+void sss_trace_span_end(struct sss_trace_span *span, errno_t error)
+{
+    if (span == NULL) {
+        return;
+    }
+
+    if (sss_trace_enabled()) {
+        span->record.error = error;
+        sss_trace_write(&span->record);
+    }
+
+    span->ended = true;
+    talloc_free(span);
+}
@@ -0,0 +1,103 @@
+/*
+    SSSD
+
+    Request trace spans
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SSS_TRACE_H_
+#define _SSS_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <talloc.h>
+
+#include "util/util_errors.h"
+#include "util/debug.h"
+
+/* A span is a timed part of a request. Spans of one process are tied
+ * together by the chain id, data provider requests are tied to the responder
+ * request by the client id the responder sends along, children are tied to
+ * their parent by the parent's pid and the chain id passed on the command
+ * line.
+ *
+ * Spans are written as fixed size records to <LOG_PATH>/<process>.trace
+ * and rendered by 'sssctl analyze trace'. Children write to the trace file
+ * of their parent, the descriptor is passed with --trace-fd. */
+
+#define SSS_TRACE_MAGIC 0x53535354 /* SSST */
+#define SSS_TRACE_VERSION 1
+
+enum sss_trace_kind {
+    SSS_TRACE_SPAN = 0,
+    /* outgoing sbus call, peer is our own sbus name */
+    SSS_TRACE_SBUS_CALL,
+    /* data provider request, peer and link_id are the sbus name and the
+     * chain id of the responder which asked for it */
+    SSS_TRACE_DP_REQUEST,
+    /* whole lifetime of a child process */
+    SSS_TRACE_CHILD,
+};
+
+/* On-disk format, keep in sync with src/tools/analyzer/modules/trace.py */
+struct sss_trace_record {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t kind;
+    uint32_t pid;
+    uint32_t ppid;
+    uint64_t chain_id;
+    uint64_t link_id;
+    /* microseconds since the epoch */
+    uint64_t start_us;
+    uint64_t end_us;
+    int32_t error;
+    uint32_t reserved;
+    char process[16];
+    char peer[24];
+    char name[48];
+};
+
+/* The trace file descriptor is sss_trace_fd from util/debug.h, -1 if
+ * tracing is disabled. Children get it from the --trace-fd option. */
+
+struct sss_trace_span;
+
+/* Open the trace file of the current process, close-on-exec. Called again
+ * when the logs are rotated, the old file is closed only if the new one
+ * could be opened. */
+errno_t sss_trace_open(void);
+
+bool sss_trace_enabled(void);
+
+/* Start a new span. Returns NULL if tracing is disabled or on error, all
+ * other functions accept NULL. The span is recorded when it is ended or
+ * when it is freed, a freed span which was not ended is recorded with
+ * ECANCELED. */
+struct sss_trace_span *
+sss_trace_span_begin(TALLOC_CTX *mem_ctx,
+                     enum sss_trace_kind kind,
+                     const char *fmt, ...) SSS_ATTRIBUTE_PRINTF(3, 4);
+
+/* Set the sbus name and the chain id which tie the span to a request of
+ * another process. */
+void sss_trace_span_link(struct sss_trace_span *span,
+                         const char *peer,
+                         uint64_t link_id);
+
+/* Record the span with the result of the traced operation and free it. */
+void sss_trace_span_end(struct sss_trace_span *span, errno_t error);
+
+#endif /* _SSS_TRACE_H_ */
@@ -175,10 +175,101 @@ const char **dup_string_list(TALLOC_CTX *memctx, const char **str_list)
     return dup_list;
 }
 
+/* Position of a string in the list it comes from, the lists are sorted by
+ * the string and then by the position so that the first occurrence of a
+ * duplicate string comes first. */
+struct diff_item {
+    const char *str;
+    size_t idx;
+};
+
+enum diff_state {
+    DIFF_ONLY = 0,
+    DIFF_BOTH,
+    DIFF_DUPLICATE
+};
+
+static int diff_item_cmp(const void *a, const void *b)
+{
+    const struct diff_item *i1 = a;
+    const struct diff_item *i2 = b;
+    int ret;
+
+    ret = strcmp(i1->str, i2->str);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return (i1->idx > i2->idx) - (i1->idx < i2->idx);
+}
+
+static struct diff_item *diff_sorted_items(TALLOC_CTX *mem_ctx,
+                                           char **list,
+                                           size_t *_count)
+{
+    struct diff_item *items;
+    size_t count;
+    size_t i;
+
+    for (count = 0; list != NULL && list[count] != NULL; count++);
+
+    items = talloc_array(mem_ctx, struct diff_item, count + 1);
+    if (items == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        items[i].str = list[i];
+        items[i].idx = i;
+    }
+
+    qsort(items, count, sizeof(struct diff_item), diff_item_cmp);
+
+    *_count = count;
+    return items;
+}
+
+static char **diff_collect(TALLOC_CTX *mem_ctx,
+                           char **list,
+                           size_t count,
+                           const uint8_t *states,
+                           enum diff_state wanted)
+{
+    char **out;
+    size_t num = 0;
+    size_t i;
+
+    out = talloc_array(mem_ctx, char *, count + 1);
+    if (out == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (states[i] != wanted) {
+            continue;
+        }
+
+        out[num] = talloc_strdup(out, list[i]);
+        if (out[num] == NULL) {
+            talloc_free(out);
+            return NULL;
+        }
+        num++;
+    }
+    out[num] = NULL;
+
+    return out;
+}
+
 /* Take two string lists (terminated on a NULL char*)
  * and return up to three arrays of strings based on
  * shared ownership.
  *
+ * Both lists are sorted and walked in parallel, which is much cheaper than
+ * hashing every string for the long membership lists the providers diff.
+ * The results keep the order of the input lists and duplicates are
+ * reported only once.
+ *
  * Pass NULL to any return type you don't care about
  */
 errno_t diff_string_lists(TALLOC_CTX *memctx,
@@ -188,182 +279,113 @@ errno_t diff_string_lists(TALLOC_CTX *memctx,
                           char ***_list2_only,
                           char ***_both_lists)
 {
-    int error;
-    errno_t ret;
-    int i;
-    int i2 = 0;
-    int i12 = 0;
-    hash_table_t *table;
-    hash_key_t key;
-    hash_value_t value;
-    char **list1 = NULL;
-    char **list2 = NULL;
+    TALLOC_CTX *tmp_ctx;
+    struct diff_item *items1;
+    struct diff_item *items2;
+    uint8_t *states1;
+    uint8_t *states2;
     char **list1_only = NULL;
     char **list2_only = NULL;
     char **both_lists = NULL;
-    unsigned long count;
-    hash_key_t *keys;
+    size_t count1;
+    size_t count2;
+    size_t i1;
+    size_t i2;
+    int cmp;
+    errno_t ret;
 
-    TALLOC_CTX *tmp_ctx = talloc_new(memctx);
-    if (!tmp_ctx) {
+    tmp_ctx = talloc_new(memctx);
+    if (tmp_ctx == NULL) {
         return ENOMEM;
     }
 
-    if (!_list1) {
-        list1 = talloc_array(tmp_ctx, char *, 1);
-        if (!list1) {
-            talloc_free(tmp_ctx);
-            return ENOMEM;
-        }
-        list1[0] = NULL;
-    }
-    else {
-        list1 = _list1;
+    items1 = diff_sorted_items(tmp_ctx, _list1, &count1);
+    items2 = diff_sorted_items(tmp_ctx, _list2, &count2);
+    states1 = talloc_zero_array(tmp_ctx, uint8_t, count1 + 1);
+    states2 = talloc_zero_array(tmp_ctx, uint8_t, count2 + 1);
+    if (items1 == NULL || items2 == NULL
+            || states1 == NULL || states2 == NULL) {
+        ret = ENOMEM;
+        goto done;
     }
 
-    if (!_list2) {
-        list2 = talloc_array(tmp_ctx, char *, 1);
-        if (!list2) {
-            talloc_free(tmp_ctx);
-            return ENOMEM;
+    for (i1 = 1; i1 < count1; i1++) {
+        if (strcmp(items1[i1].str, items1[i1 - 1].str) == 0) {
+            states1[items1[i1].idx] = DIFF_DUPLICATE;
         }
-        list2[0] = NULL;
-    }
-    else {
-        list2 = _list2;
-    }
-
-    error = hash_create(0, &table, NULL, NULL);
-    if (error != HASH_SUCCESS) {
-        talloc_free(tmp_ctx);
-        return EIO;
     }
 
-    key.type = HASH_KEY_STRING;
-    value.type = HASH_VALUE_UNDEF;
-
-    /* Add all entries from list 1 into a hash table */
-    i = 0;
-    while (list1[i]) {
-        key.str = talloc_strdup(tmp_ctx, list1[i]);
-        error = hash_enter(table, &key, &value);
-        if (error != HASH_SUCCESS) {
-            ret = EIO;
-            goto done;
+    for (i2 = 1; i2 < count2; i2++) {
+        if (strcmp(items2[i2].str, items2[i2 - 1].str) == 0) {
+            states2[items2[i2].idx] = DIFF_DUPLICATE;
         }
-        i++;
     }
 
-    /* Iterate through list 2 and remove matching items */
-    i = 0;
-    while (list2[i]) {
-        key.str = talloc_strdup(tmp_ctx, list2[i]);
-        error = hash_delete(table, &key);
-        if (error == HASH_SUCCESS) {
-            if (_both_lists) {
-                /* String was present in both lists */
-                i12++;
-                both_lists = talloc_realloc(tmp_ctx, both_lists, char *, i12+1);
-                if (!both_lists) {
-                    ret = ENOMEM;
-                    goto done;
-                }
-                both_lists[i12-1] = talloc_strdup(both_lists, list2[i]);
-                if (!both_lists[i12-1]) {
-                    ret = ENOMEM;
-                    goto done;
-                }
-
-                both_lists[i12] = NULL;
-            }
+    i1 = 0;
+    i2 = 0;
+    while (i1 < count1 && i2 < count2) {
+        if (states1[items1[i1].idx] == DIFF_DUPLICATE) {
+            i1++;
+            continue;
         }
-        else if (error == HASH_ERROR_KEY_NOT_FOUND) {
-            if (_list2_only) {
-                /* String was present only in list2 */
-                i2++;
-                list2_only = talloc_realloc(tmp_ctx, list2_only,
-                                            char *, i2+1);
-                if (!list2_only) {
-                    ret = ENOMEM;
-                    goto done;
-                }
-                list2_only[i2-1] = talloc_strdup(list2_only, list2[i]);
-                if (!list2_only[i2-1]) {
-                    ret = ENOMEM;
-                    goto done;
-                }
 
-                list2_only[i2] = NULL;
-            }
+        if (states2[items2[i2].idx] == DIFF_DUPLICATE) {
+            i2++;
+            continue;
         }
-        else {
-            /* An error occurred */
-            ret = EIO;
-            goto done;
+
+        cmp = strcmp(items1[i1].str, items2[i2].str);
+        if (cmp == 0) {
+            states1[items1[i1].idx] = DIFF_BOTH;
+            states2[items2[i2].idx] = DIFF_BOTH;
+            i1++;
+            i2++;
+        } else if (cmp < 0) {
+            i1++;
+        } else {
+            i2++;
         }
-        i++;
     }
 
-    /* Get the leftover entries in the hash table */
     if (_list1_only) {
-        error = hash_keys(table, &count, &keys);
-        if (error != HASH_SUCCESS) {
-            ret = EIO;
+        list1_only = diff_collect(tmp_ctx, _list1, count1, states1, DIFF_ONLY);
+        if (list1_only == NULL) {
+            ret = ENOMEM;
             goto done;
         }
+    }
 
-        list1_only = talloc_array(tmp_ctx, char *, count+1);
-        if (!list1_only) {
+    if (_list2_only) {
+        list2_only = diff_collect(tmp_ctx, _list2, count2, states2, DIFF_ONLY);
+        if (list2_only == NULL) {
             ret = ENOMEM;
             goto done;
         }
+    }
 
-        for (i = 0; i < count; i++) {
-            list1_only[i] = talloc_strdup(list1_only, keys[i].str);
-            if (!list1_only[i]) {
-                ret = ENOMEM;
-                goto done;
-            }
+    if (_both_lists) {
+        both_lists = diff_collect(tmp_ctx, _list2, count2, states2, DIFF_BOTH);
+        if (both_lists == NULL) {
+            ret = ENOMEM;
+            goto done;
         }
-        list1_only[count] = NULL;
-
-        free(keys);
+    }
 
+    if (_list1_only) {
         *_list1_only = talloc_steal(memctx, list1_only);
     }
 
     if (_list2_only) {
-        if (list2_only) {
-            *_list2_only = talloc_steal(memctx, list2_only);
-        }
-        else {
-            *_list2_only = talloc_array(memctx, char *, 1);
-            if (!(*_list2_only)) {
-                ret = ENOMEM;
-                goto done;
-            }
-            *_list2_only[0] = NULL;
-        }
+        *_list2_only = talloc_steal(memctx, list2_only);
     }
 
     if (_both_lists) {
-        if (both_lists) {
-            *_both_lists = talloc_steal(memctx, both_lists);
-        }
-        else {
-            *_both_lists = talloc_array(memctx, char *, 1);
-            if (!(*_both_lists)) {
-                ret = ENOMEM;
-                goto done;
-            }
-            *_both_lists[0] = NULL;
-        }
+        *_both_lists = talloc_steal(memctx, both_lists);
     }
 
     ret = EOK;
 
 done:
-    hash_destroy(table);
     talloc_free(tmp_ctx);
     return ret;
 }
@@ -80,9 +80,10 @@ static void watchdog_handler(int sig)
     }
 }
 
-static void watchdog_reset(void)
+/* returns the number of ticks since the previous reset */
+static int watchdog_reset(void)
 {
-    __sync_and_and_fetch(&watchdog_ctx.ticks, 0);
+    return __sync_fetch_and_and(&watchdog_ctx.ticks, 0);
 }
 
 static void watchdog_event_handler(struct tevent_context *ev,
@@ -90,9 +91,18 @@ static void watchdog_event_handler(struct tevent_context *ev,
                                    struct timeval current_time,
                                    void *private_data)
 {
+    int ticks;
+
     if (!watchdog_ctx.armed) {
         /* first thing reset the watchdog ticks */
-        watchdog_reset();
+        ticks = watchdog_reset();
+        if (ticks > 1) {
+            /* one tick is expected, more mean this timer was late */
+            DEBUG(SSSDBG_IMPORTANT_INFO,
+                  "Event loop missed %d watchdog ticks, it was blocked for "
+                  "more than %ld seconds\n",
+                  ticks - 1, (long)watchdog_ctx.interval.tv_sec);
+        }
     } else {
         DEBUG(SSSDBG_IMPORTANT_INFO,
               "Watchdog armed, process might be terminated soon.\n");